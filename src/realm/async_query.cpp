@@ -0,0 +1,266 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/async_query.hpp>
+#include <realm/db.hpp>
+#include <realm/query.hpp>
+#include <realm/table_view.hpp>
+#include <realm/util/to_string.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+
+using namespace realm;
+using namespace realm::_impl;
+
+struct AsyncQuery::Job {
+    enum class State { queued, running, done, cancelled };
+
+    TransactionRef frozen;
+    std::unique_ptr<Query> query;
+    // Identifies the query and the version for sharing the job, or empty
+    std::string description;
+
+    std::mutex mutex;
+    std::condition_variable done;
+    State state = State::queued;
+    // The requests which have not been cancelled
+    size_t num_requests = 0;
+    // The requests with a callback, which are kept alive until it is called
+    std::vector<AsyncQueryRef> callbacks;
+    std::unique_ptr<ConstTableView> view;
+    std::exception_ptr error;
+
+    void run();
+};
+
+void AsyncQuery::Job::run()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (state == State::cancelled)
+            return;
+        state = State::running;
+    }
+
+    std::unique_ptr<ConstTableView> result;
+    std::exception_ptr result_error;
+    try {
+        result = std::make_unique<TableView>(query->find_all()); // Throws
+    }
+    catch (...) {
+        result_error = std::current_exception();
+    }
+
+    std::vector<AsyncQueryRef> to_call;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        view = std::move(result);
+        error = result_error;
+        state = State::done;
+        to_call.swap(callbacks);
+    }
+    done.notify_all();
+    query.reset();
+
+    for (auto& request : to_call) {
+        if (!request->is_cancelled())
+            request->m_callback(*request);
+    }
+}
+
+
+AsyncQuery::AsyncQuery(std::shared_ptr<Job> job, Callback callback)
+    : m_job(std::move(job))
+    , m_callback(std::move(callback))
+{
+}
+
+AsyncQuery::~AsyncQuery() noexcept
+{
+    cancel();
+}
+
+bool AsyncQuery::is_ready() const
+{
+    if (m_cancelled)
+        return true;
+    std::lock_guard<std::mutex> lock(m_job->mutex);
+    return m_job->state == Job::State::done;
+}
+
+bool AsyncQuery::wait()
+{
+    std::unique_lock<std::mutex> lock(m_job->mutex);
+    m_job->done.wait(lock, [&] { return m_cancelled || m_job->state == Job::State::done; });
+    return !m_cancelled;
+}
+
+const ConstTableView* AsyncQuery::get_view()
+{
+    if (!wait())
+        return nullptr;
+    if (m_job->error)
+        std::rethrow_exception(m_job->error);
+    return m_job->view.get();
+}
+
+TransactionRef AsyncQuery::get_transaction() const
+{
+    return m_job->frozen;
+}
+
+void AsyncQuery::cancel()
+{
+    if (m_cancelled.exchange(true))
+        return;
+    // The reference held by the job is released after the lock
+    AsyncQueryRef self;
+    {
+        std::lock_guard<std::mutex> lock(m_job->mutex);
+        auto& callbacks = m_job->callbacks;
+        auto it = std::find_if(callbacks.begin(), callbacks.end(),
+                               [&](const AsyncQueryRef& request) { return request.get() == this; });
+        if (it != callbacks.end()) {
+            self = std::move(*it);
+            callbacks.erase(it);
+        }
+        if (--m_job->num_requests == 0 && m_job->state == Job::State::queued)
+            m_job->state = Job::State::cancelled;
+    }
+    // Wake up the threads waiting for this request
+    m_job->done.notify_all();
+}
+
+
+struct QueryExecutor::State {
+    std::mutex mutex;
+    std::condition_variable work;
+    std::deque<std::shared_ptr<AsyncQuery::Job>> queue;
+    // The jobs which are queued or running, by description
+    std::map<std::string, std::weak_ptr<AsyncQuery::Job>> in_flight;
+    bool stop = false;
+};
+
+QueryExecutor::QueryExecutor()
+    : m_state(std::make_shared<State>())
+{
+    unsigned num_threads = std::max(1u, std::min(4u, std::thread::hardware_concurrency()));
+    for (unsigned i = 0; i < num_threads; ++i)
+        m_threads.emplace_back(run, m_state); // Throws
+}
+
+QueryExecutor::~QueryExecutor() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        m_state->stop = true;
+    }
+    m_state->work.notify_all();
+    for (auto& thread : m_threads) {
+        // The executor is destroyed by one of its threads when it releases the
+        // last reference to the database, held by the frozen transaction of a
+        // job. That thread stops by itself once it is done with the job.
+        if (thread.get_id() == std::this_thread::get_id()) {
+            thread.detach();
+        }
+        else {
+            thread.join();
+        }
+    }
+}
+
+AsyncQueryRef QueryExecutor::submit(TransactionRef frozen, std::unique_ptr<Query> query,
+                                    AsyncQuery::Callback callback)
+{
+    // Queries restricted by a view or a list are not described by their
+    // conditions alone, and are never shared
+    std::string description;
+    if (query->produces_results_in_table_order()) {
+        try {
+            description = util::to_string(frozen->get_version_of_current_transaction().version) + ' ' +
+                          util::to_string(query->get_table()->get_key().value) + ' ' +
+                          query->get_description(); // Throws
+        }
+        catch (const std::exception&) {
+            description.clear();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    std::shared_ptr<AsyncQuery::Job> job;
+    if (!description.empty()) {
+        auto it = m_state->in_flight.find(description);
+        if (it != m_state->in_flight.end())
+            job = it->second.lock();
+    }
+
+    if (job) {
+        std::lock_guard<std::mutex> job_lock(job->mutex);
+        if (job->state == AsyncQuery::Job::State::queued || job->state == AsyncQuery::Job::State::running) {
+            AsyncQueryRef request(new AsyncQuery(job, std::move(callback)));
+            ++job->num_requests;
+            if (request->m_callback)
+                job->callbacks.push_back(request);
+            return request;
+        }
+    }
+
+    job = std::make_shared<AsyncQuery::Job>();
+    job->frozen = std::move(frozen);
+    job->query = std::move(query);
+    job->description = description;
+    job->num_requests = 1;
+    AsyncQueryRef request(new AsyncQuery(job, std::move(callback)));
+    if (request->m_callback)
+        job->callbacks.push_back(request);
+    if (!description.empty())
+        m_state->in_flight[description] = job;
+    m_state->queue.push_back(job);
+    m_state->work.notify_one();
+    return request;
+}
+
+void QueryExecutor::run(std::shared_ptr<State> state)
+{
+    for (;;) {
+        std::shared_ptr<AsyncQuery::Job> job;
+        {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->work.wait(lock, [&] { return state->stop || !state->queue.empty(); });
+            if (state->queue.empty())
+                return;
+            job = std::move(state->queue.front());
+            state->queue.pop_front();
+        }
+
+        job->run();
+
+        if (!job->description.empty()) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            auto it = state->in_flight.find(job->description);
+            if (it != state->in_flight.end() && it->second.lock() == job)
+                state->in_flight.erase(it);
+        }
+        // This may release the last reference to the database
+        job.reset();
+    }
+}
@@ -0,0 +1,123 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_ASYNC_QUERY_HPP
+#define REALM_ASYNC_QUERY_HPP
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace realm {
+
+class ConstTableView;
+class Query;
+class Transaction;
+using TransactionRef = std::shared_ptr<Transaction>;
+
+namespace _impl {
+class QueryExecutor;
+}
+
+/// A query run by DB::find_all_async() on a background thread, on a frozen
+/// snapshot of the database. The result is a view in a frozen transaction,
+/// which can be read from any thread.
+///
+/// Requests for the same query on the same version, which are in flight at the
+/// same time, are run once and share the result.
+class AsyncQuery {
+public:
+    /// Called on the background thread when the query has run, unless the
+    /// request was cancelled. It must not throw.
+    using Callback = std::function<void(AsyncQuery&)>;
+
+    /// Cancels the request if it has not completed.
+    ~AsyncQuery() noexcept;
+
+    /// True when the query has run, or the request was cancelled.
+    bool is_ready() const;
+
+    /// Block until is_ready(). Returns false if the request was cancelled.
+    bool wait();
+
+    /// Wait for the query, and return the matching objects, or null if the
+    /// request was cancelled. Rethrows what the query threw. The view is owned
+    /// by this object.
+    const ConstTableView* get_view();
+
+    /// The frozen transaction holding the view.
+    TransactionRef get_transaction() const;
+
+    /// Give up the result. The query is not run if it has not started and no
+    /// other request shares it. A query which is running is not interrupted,
+    /// but the callback of this request is not called.
+    void cancel();
+    bool is_cancelled() const noexcept;
+
+private:
+    struct Job;
+
+    AsyncQuery(std::shared_ptr<Job>, Callback);
+
+    std::shared_ptr<Job> m_job;
+    Callback m_callback;
+    std::atomic<bool> m_cancelled{false};
+
+    friend class _impl::QueryExecutor;
+};
+
+using AsyncQueryRef = std::shared_ptr<AsyncQuery>;
+
+namespace _impl {
+
+/// The threads running the queries of DB::find_all_async()
+class QueryExecutor {
+public:
+    QueryExecutor();
+    /// Must not be called while a query is queued or running, other than by
+    /// the thread running it, which finishes on its own.
+    ~QueryExecutor() noexcept;
+
+    /// Queue the query, which belongs to the frozen transaction, or join the
+    /// request for the same query on the same version if one is in flight.
+    AsyncQueryRef submit(TransactionRef frozen, std::unique_ptr<Query> query, AsyncQuery::Callback callback);
+
+private:
+    struct State;
+
+    std::shared_ptr<State> m_state;
+    std::vector<std::thread> m_threads;
+
+    static void run(std::shared_ptr<State> state);
+};
+
+} // namespace _impl
+
+
+// Implementation:
+
+inline bool AsyncQuery::is_cancelled() const noexcept
+{
+    return m_cancelled;
+}
+
+} // namespace realm
+
+#endif // REALM_ASYNC_QUERY_HPP
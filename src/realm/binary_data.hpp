@@ -20,6 +20,7 @@
 #define REALM_BINARY_DATA_HPP
 
 #include <realm/owned_data.hpp>
+#include <realm/string_data.hpp>
 #include <realm/util/features.h>
 #include <realm/utilities.hpp>
 
@@ -219,7 +220,7 @@ inline bool BinaryData::contains(BinaryData d) const noexcept
     if (is_null() && !d.is_null())
         return false;
 
-    return d.m_size == 0 || std::search(m_data, m_data + m_size, d.m_data, d.m_data + d.m_size) != m_data + m_size;
+    return d.m_size == 0 || search_substring(m_data, m_size, d.m_data, d.m_size) != m_size;
 }
 
 template <class C, class T>
@@ -26,7 +26,12 @@
 #include "realm/array_timestamp.hpp"
 #include "realm/array_key.hpp"
 #include "realm/array_backlink.hpp"
+#include "realm/index_composite.hpp"
+#include "realm/index_hash.hpp"
+#include "realm/index_list.hpp"
+#include "realm/index_range.hpp"
 #include "realm/index_string.hpp"
+#include "realm/index_trigram.hpp"
 #include "realm/column_type_traits.hpp"
 #include "realm/replication.hpp"
 #include <iostream>
@@ -1840,6 +1845,13 @@ void ClusterTree::clear(CascadeState& state)
         if (StringIndex* index = m_owner->get_search_index(col_key)) {
             index->clear();
         }
+        m_owner->for_each_optional_indexes([&](auto& indexes) {
+            if (auto index = indexes.get(col_key))
+                index->clear();
+        });
+    }
+    for (CompositeIndex* index : m_owner->get_composite_indexes()) {
+        index->clear();
     }
 
     if (state.m_group) {
@@ -1933,9 +1945,42 @@ Obj ClusterTree::insert(ObjKey k, const FieldValues& values)
                     break;
             }
         }
+        if (TrigramIndex* index = table->get_trigram_index(col_key)) {
+            index->insert(k, init_value.is_null() ? StringData() : init_value.get<String>());
+        }
+        if (RangeIndex* index = table->get_range_index(col_key)) {
+            // Nulls are not indexed, and the other types default to null when nullable
+            if (init_value.is_null() && !col_key.get_attrs().test(col_attr_Nullable)) {
+                switch (col_key.get_type()) {
+                    case col_type_Int:
+                        init_value = Mixed(ArrayInteger::default_value(false));
+                        break;
+                    case col_type_Float:
+                        init_value = Mixed(ArrayFloat::default_value(false));
+                        break;
+                    case col_type_Double:
+                        init_value = Mixed(ArrayDouble::default_value(false));
+                        break;
+                    case col_type_Timestamp:
+                        init_value = Mixed(ArrayTimestamp::default_value(false));
+                        break;
+                    default:
+                        break;
+                }
+            }
+            index->insert(k, init_value);
+        }
+        if (HashIndex* index = table->get_hash_index(col_key)) {
+            // The object already holds its initial values
+            index->insert(k);
+        }
         return false;
     };
     get_owner()->for_each_public_column(insert_in_column);
+    // Composite indexes read the values of the new object
+    for (CompositeIndex* index : table->get_composite_indexes()) {
+        index->insert(k);
+    }
 
     if (Replication* repl = table->get_repl()) {
         repl->create_object(table, k);
@@ -2005,6 +2050,13 @@ void ClusterTree::erase(ObjKey k, CascadeState& state)
         if (StringIndex* index = m_owner->get_search_index(col_key)) {
             index->erase(k);
         }
+        m_owner->for_each_optional_indexes([&](auto& indexes) {
+            if (auto index = indexes.get(col_key))
+                index->erase(k);
+        });
+    }
+    for (CompositeIndex* index : m_owner->get_composite_indexes()) {
+        index->erase(k);
     }
 
     size_t root_size = m_root->erase(k, state);
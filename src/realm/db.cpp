@@ -1070,6 +1070,7 @@ void DB::do_open(const std::string& path, bool no_create_file, bool is_backend,
                 case 9:
                 case 10:
                 case 11:
+                case 12:
                     file_format_ok = true;
                     break;
             }
@@ -1487,6 +1488,7 @@ size_t DB::get_allocated_size() const
 
 DB::~DB() noexcept
 {
+    m_query_executor.reset();
     close();
 
     if (m_replication) {
@@ -2352,6 +2354,18 @@ TransactionRef DB::start_frozen(VersionID version_id)
     return TransactionRef(tr, TransactionDeleter);
 }
 
+AsyncQueryRef DB::find_all_async(Query& query, VersionID version, AsyncQuery::Callback callback)
+{
+    TransactionRef frozen = start_frozen(version);                                        // Throws
+    std::unique_ptr<Query> imported = frozen->import_copy_of(query, PayloadPolicy::Copy); // Throws
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex);
+        if (!m_query_executor)
+            m_query_executor = std::make_unique<_impl::QueryExecutor>(); // Throws
+    }
+    return m_query_executor->submit(std::move(frozen), std::move(imported), std::move(callback)); // Throws
+}
+
 Transaction::Transaction(DBRef _db, SlabAlloc* alloc, DB::ReadLockInfo& rli, DB::TransactStage stage)
     : Group(alloc)
     , db(_db)
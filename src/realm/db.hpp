@@ -26,6 +26,7 @@
 #include <realm/util/thread.hpp>
 #include <realm/util/interprocess_condvar.hpp>
 #include <realm/util/interprocess_mutex.hpp>
+#include <realm/async_query.hpp>
 #include <realm/group.hpp>
 #include <realm/handover_defs.hpp>
 #include <realm/impl/transact_log.hpp>
@@ -224,6 +225,15 @@ public:
     // an invalid TransactionRef is returned.
     TransactionRef start_write(bool nonblocking = false);
 
+    /// Run `query` on a background thread, on a frozen snapshot of `version`,
+    /// by default the latest one. The query is imported into the snapshot
+    /// before this returns, so the original can still be used, and the
+    /// snapshot is held until the returned request is destroyed. Waiting
+    /// requests for the same query on the same version share one run.
+    /// The threads are started by the first call.
+    AsyncQueryRef find_all_async(Query& query, VersionID version = VersionID(),
+                                 AsyncQuery::Callback callback = nullptr);
+
 
     // report statistics of last commit done on THIS DB.
     // The free space reported is what can be expected to be freed
@@ -367,6 +377,7 @@ protected:
 
 private:
     std::recursive_mutex m_mutex;
+    std::unique_ptr<_impl::QueryExecutor> m_query_executor;
     int m_transaction_count = 0;
     SlabAlloc m_alloc;
     Replication* m_replication = nullptr;
@@ -316,7 +316,7 @@ int Group::get_target_file_format_version_for_session(int /* current_file_format
     // Please see Group::get_file_format_version() for information about the
     // individual file format versions.
 
-    return 11;
+    return 12;
 }
 
 void Group::get_version_and_history_info(const Array& top, _impl::History::version_type& version, int& history_type,
@@ -374,7 +374,7 @@ void Transaction::upgrade_file_format(int target_file_format_version)
     // Be sure to revisit the following upgrade logic when a new file format
     // version is introduced. The following assert attempt to help you not
     // forget it.
-    REALM_ASSERT_EX(target_file_format_version == 11, target_file_format_version);
+    REALM_ASSERT_EX(target_file_format_version == 12, target_file_format_version);
 
     int current_file_format_version = get_file_format_version();
     REALM_ASSERT(current_file_format_version < target_file_format_version);
@@ -382,7 +382,7 @@ void Transaction::upgrade_file_format(int target_file_format_version)
     // SharedGroup::do_open() must ensure this. Be sure to revisit the
     // following upgrade logic when SharedGroup::do_open() is changed (or
     // vice versa).
-    REALM_ASSERT_EX(current_file_format_version >= 5 && current_file_format_version <= 10,
+    REALM_ASSERT_EX(current_file_format_version >= 5 && current_file_format_version <= 11,
                     current_file_format_version);
 
 
@@ -539,7 +539,7 @@ void Group::open(ref_type top_ref, const std::string& file_path)
         case 0:
             file_format_ok = (top_ref == 0);
             break;
-        case 11:
+        case 12:
             file_format_ok = true;
             break;
     }
@@ -857,6 +857,11 @@ TableRef Group::add_table_with_primary_key(StringData name, DataType pk_type, St
     if (pk_type != type_String) {
         table->add_search_index(pk_col);
     }
+    // Older libraries would create objects with keys which are not derived
+    // from the primary key, so the flag needs a file they cannot write to
+    if (pk_type == type_Int && m_file_format_version >= 12) {
+        table->set_hashed_int_primary_key(true);
+    }
 
     return TableRef(table, table ? table->m_alloc.get_instance_version() : 0);
 }
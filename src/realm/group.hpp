@@ -816,6 +816,14 @@ private:
     ///  11 Same as 10, but version 10 files will have search index added on
     ///     string primary key columns.
     ///
+    ///  12 Optional entries after the 12 fixed entries of the table top array,
+    ///     for the trigram, range, composite, list and hash indexes, and for
+    ///     the flags of the table. The flags tell if the object keys of a table
+    ///     are derived from its int primary key. A library which does not know
+    ///     these entries would not update the indexes, and would create objects
+    ///     which are not found by their primary key, so older files are
+    ///     upgraded by only changing the version.
+    ///
     /// IMPORTANT: When introducing a new file format version, be sure to review
     /// the file validity checks in Group::open() and SharedGroup::do_open, the file
     /// format selection logic in
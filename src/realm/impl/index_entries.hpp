@@ -0,0 +1,138 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_IMPL_INDEX_ENTRIES_HPP
+#define REALM_IMPL_INDEX_ENTRIES_HPP
+
+#include <realm/binary_data.hpp>
+#include <realm/keys.hpp>
+#include <realm/mixed.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace realm {
+namespace _impl {
+
+// Helpers for indexes which keep their entries as byte strings in a sorted
+// B+tree of binaries. An entry is a sequence of encoded values followed by an
+// object key, and entries compare (as unsigned bytes) like the tuples they
+// encode.
+
+// Big endian with the sign bit flipped, so that the bytes compare like the
+// signed values
+inline void append_index_int(std::string& out, int64_t value, size_t bytes)
+{
+    uint64_t v = uint64_t(value) ^ (uint64_t(1) << (bytes * 8 - 1));
+    for (size_t i = bytes; i > 0; --i)
+        out += char((v >> ((i - 1) * 8)) & 0xff);
+}
+
+// Each value starts with a marker byte telling if it is null. Strings end with
+// 00 01, and a zero byte inside a string is written as 00 ff, so no encoded
+// value is a prefix of another. Only int, bool, timestamp and string values
+// can be encoded.
+inline void append_index_value(std::string& out, Mixed value)
+{
+    if (value.is_null()) {
+        out += '\0';
+        return;
+    }
+    out += '\1';
+    switch (value.get_type()) {
+        case type_Int:
+            append_index_int(out, value.get<int64_t>(), 8);
+            break;
+        case type_Bool:
+            out += value.get<bool>() ? '\1' : '\0';
+            break;
+        case type_Timestamp: {
+            Timestamp t = value.get<Timestamp>();
+            append_index_int(out, t.get_seconds(), 8);
+            append_index_int(out, t.get_nanoseconds(), 4);
+            break;
+        }
+        case type_String: {
+            StringData str = value.get<StringData>();
+            for (size_t i = 0; i < str.size(); ++i) {
+                out += str[i];
+                if (str[i] == '\0')
+                    out += '\xff';
+            }
+            out += '\0';
+            out += '\1';
+            break;
+        }
+        default:
+            REALM_UNREACHABLE();
+    }
+}
+
+inline std::string make_index_entry(std::string prefix, ObjKey key)
+{
+    append_index_int(prefix, key.value, 8);
+    return prefix;
+}
+
+// The key is in the last 8 bytes of an entry
+inline ObjKey get_index_entry_key(BinaryData entry)
+{
+    uint64_t v = 0;
+    for (size_t i = entry.size() - 8; i < entry.size(); ++i)
+        v = (v << 8) | uint8_t(entry.data()[i]);
+    return ObjKey(int64_t(v ^ (uint64_t(1) << 63)));
+}
+
+// Three way comparison of an entry with a prefix, where entries starting with
+// the prefix compare equal
+inline int compare_index_prefix(BinaryData entry, const std::string& prefix)
+{
+    size_t n = std::min(entry.size(), prefix.size());
+    if (int c = std::memcmp(entry.data(), prefix.data(), n))
+        return c;
+    return entry.size() < prefix.size() ? -1 : 0;
+}
+
+inline int compare_index_entry(BinaryData entry, const std::string& other)
+{
+    if (int c = compare_index_prefix(entry, other))
+        return c;
+    return entry.size() > other.size() ? 1 : 0;
+}
+
+// The first position in [begin, end) of `entries` for which `less` is false
+template <class Entries, class Less>
+size_t index_partition_point(const Entries& entries, size_t begin, size_t end, Less less)
+{
+    while (begin < end) {
+        size_t mid = begin + (end - begin) / 2;
+        if (less(entries.get(mid))) {
+            begin = mid + 1;
+        }
+        else {
+            end = mid;
+        }
+    }
+    return begin;
+}
+
+} // namespace _impl
+} // namespace realm
+
+#endif // REALM_IMPL_INDEX_ENTRIES_HPP
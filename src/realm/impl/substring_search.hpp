@@ -0,0 +1,98 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_IMPL_SUBSTRING_SEARCH_HPP
+#define REALM_IMPL_SUBSTRING_SEARCH_HPP
+
+#include <realm/util/features.h>
+#include <realm/utilities.hpp>
+
+#include <cstddef>
+
+#ifdef REALM_COMPILER_SSE
+#include <emmintrin.h> // SSE2
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace realm {
+namespace _impl {
+
+/// Find the first position `i` in `data` where a needle of `needle_size`
+/// bytes could start, i.e. where `data[i]` is one of `first_a` and
+/// `first_b`, and `data[i + needle_size - 1]` is one of `last_a` and
+/// `last_b`, and for which `verify(i)` returns true. Returns `size` if
+/// there is no such position.
+///
+/// For a case sensitive search the two alternatives are simply the same
+/// byte. Requiring both the first and the last byte to match rejects almost
+/// all positions in practice, so `verify()` is rarely called. SSE2 is part
+/// of the x86-64 baseline, so on those targets 16 positions are tested at a
+/// time without any runtime detection.
+template <class Verify>
+inline size_t find_substring_candidate(const char* data, size_t size, size_t needle_size, char first_a,
+                                       char first_b, char last_a, char last_b, Verify verify)
+{
+    if (needle_size == 0)
+        return 0;
+    if (needle_size > size)
+        return size;
+
+    const size_t end = size - needle_size + 1; // One past the last possible start position
+    const char* last = data + needle_size - 1;
+    size_t i = 0;
+
+#ifdef REALM_COMPILER_SSE
+    const __m128i fa = _mm_set1_epi8(first_a);
+    const __m128i fb = _mm_set1_epi8(first_b);
+    const __m128i la = _mm_set1_epi8(last_a);
+    const __m128i lb = _mm_set1_epi8(last_b);
+    for (; i + 16 <= end; i += 16) {
+        __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(last + i));
+        __m128i eq_first = _mm_or_si128(_mm_cmpeq_epi8(block_first, fa), _mm_cmpeq_epi8(block_first, fb));
+        __m128i eq_last = _mm_or_si128(_mm_cmpeq_epi8(block_last, la), _mm_cmpeq_epi8(block_last, lb));
+        unsigned mask = unsigned(_mm_movemask_epi8(_mm_and_si128(eq_first, eq_last)));
+        while (mask) {
+#ifdef _MSC_VER
+            unsigned long bit;
+            _BitScanForward(&bit, mask);
+#else
+            unsigned bit = unsigned(__builtin_ctz(mask));
+#endif
+            if (verify(i + bit))
+                return i + bit;
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    for (; i < end; ++i) {
+        char f = data[i];
+        char l = last[i];
+        if ((f == first_a || f == first_b) && (l == last_a || l == last_b) && verify(i))
+            return i;
+    }
+    return size;
+}
+
+} // namespace _impl
+} // namespace realm
+
+#endif // REALM_IMPL_SUBSTRING_SEARCH_HPP
@@ -0,0 +1,184 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/index_composite.hpp>
+#include <realm/cluster_tree.hpp>
+#include <realm/column_binary.hpp>
+#include <realm/impl/index_entries.hpp>
+
+#include <algorithm>
+
+using namespace realm;
+using namespace realm::_impl;
+
+CompositeIndex::CompositeIndex(const std::vector<ColKey>& columns, const ClusterTree* target, Allocator& alloc)
+    : m_top(alloc)
+    , m_columns(columns)
+    , m_target(target)
+{
+    m_top.create(Array::type_HasRefs, false, s_top_size, 0); // Throws
+    Array column_keys(alloc);
+    column_keys.create(Array::type_Normal); // Throws
+    column_keys.set_parent(&m_top, s_columns_ndx);
+    column_keys.update_parent(); // Throws
+    for (auto col_key : columns)
+        column_keys.add(col_key.value); // Throws
+    BinaryColumn entries(alloc);
+    entries.set_parent(&m_top, s_entries_ndx);
+    entries.create(); // Throws
+}
+
+void CompositeIndex::load_columns()
+{
+    Array column_keys(get_alloc());
+    column_keys.init_from_ref(m_top.get_as_ref(s_columns_ndx));
+    m_columns.clear();
+    for (size_t i = 0; i < column_keys.size(); ++i)
+        m_columns.push_back(ColKey(column_keys.get(i)));
+}
+
+std::string CompositeIndex::get_prefix(ObjKey key) const
+{
+    ConstObj obj = m_target->get(key);
+    std::string prefix;
+    for (auto col_key : m_columns)
+        append_index_value(prefix, obj.get_any(col_key));
+    return prefix;
+}
+
+size_t CompositeIndex::size() const
+{
+    BinaryColumn entries(get_alloc());
+    entries.init_from_ref(m_top.get_as_ref(s_entries_ndx));
+    return entries.size();
+}
+
+std::pair<size_t, size_t> CompositeIndex::find_range(const std::string& prefix) const
+{
+    BinaryColumn entries(get_alloc());
+    entries.init_from_ref(m_top.get_as_ref(s_entries_ndx));
+    size_t begin = index_partition_point(entries, 0, entries.size(),
+                                         [&](BinaryData entry) { return compare_index_prefix(entry, prefix) < 0; });
+    size_t end = index_partition_point(entries, begin, entries.size(),
+                                       [&](BinaryData entry) { return compare_index_prefix(entry, prefix) == 0; });
+    return {begin, end};
+}
+
+void CompositeIndex::find_all(const std::vector<Mixed>& values, std::vector<ObjKey>& result) const
+{
+    REALM_ASSERT(values.size() <= m_columns.size());
+    std::string prefix;
+    for (auto& value : values)
+        append_index_value(prefix, value);
+    auto range = find_range(prefix);
+
+    BinaryColumn entries(get_alloc());
+    entries.init_from_ref(m_top.get_as_ref(s_entries_ndx));
+    size_t first = result.size();
+    result.reserve(first + (range.second - range.first));
+    for (size_t i = range.first; i < range.second; ++i)
+        result.push_back(get_index_entry_key(entries.get(i)));
+    // Entries with the same full prefix are already ordered by key
+    if (values.size() < m_columns.size())
+        std::sort(result.begin() + first, result.end());
+}
+
+size_t CompositeIndex::count(const std::vector<Mixed>& values) const
+{
+    std::string prefix;
+    for (auto& value : values)
+        append_index_value(prefix, value);
+    auto range = find_range(prefix);
+    return range.second - range.first;
+}
+
+void CompositeIndex::insert_entry(const std::string& entry)
+{
+    BinaryColumn entries(get_alloc());
+    entries.set_parent(&m_top, s_entries_ndx);
+    entries.init_from_parent();
+    size_t pos = index_partition_point(entries, 0, entries.size(),
+                                       [&](BinaryData other) { return compare_index_entry(other, entry) < 0; });
+    entries.insert(pos, BinaryData(entry.data(), entry.size())); // Throws
+}
+
+void CompositeIndex::erase_entry(const std::string& entry)
+{
+    BinaryColumn entries(get_alloc());
+    entries.set_parent(&m_top, s_entries_ndx);
+    entries.init_from_parent();
+    size_t pos = index_partition_point(entries, 0, entries.size(),
+                                       [&](BinaryData other) { return compare_index_entry(other, entry) < 0; });
+    REALM_ASSERT(pos < entries.size() && compare_index_entry(entries.get(pos), entry) == 0);
+    entries.erase(pos); // Throws
+}
+
+void CompositeIndex::insert(ObjKey key)
+{
+    insert_entry(make_index_entry(get_prefix(key), key)); // Throws
+}
+
+void CompositeIndex::set(ObjKey key, ColKey col_key, Mixed new_value)
+{
+    ConstObj obj = m_target->get(key);
+    std::string old_prefix;
+    std::string new_prefix;
+    for (auto col : m_columns) {
+        Mixed value = obj.get_any(col);
+        append_index_value(old_prefix, value);
+        append_index_value(new_prefix, col == col_key ? new_value : value);
+    }
+    if (old_prefix == new_prefix)
+        return;
+    erase_entry(make_index_entry(std::move(old_prefix), key)); // Throws
+    insert_entry(make_index_entry(std::move(new_prefix), key)); // Throws
+}
+
+void CompositeIndex::erase(ObjKey key)
+{
+    erase_entry(make_index_entry(get_prefix(key), key)); // Throws
+}
+
+void CompositeIndex::clear()
+{
+    BinaryColumn entries(get_alloc());
+    entries.set_parent(&m_top, s_entries_ndx);
+    entries.init_from_parent();
+    entries.clear(); // Throws
+}
+
+void CompositeIndex::verify() const
+{
+#ifdef REALM_DEBUG
+    REALM_ASSERT(m_top.size() == s_top_size);
+    BinaryColumn entries(get_alloc());
+    entries.init_from_ref(m_top.get_as_ref(s_entries_ndx));
+    REALM_ASSERT(entries.size() == m_target->size());
+    // Entries are strictly ordered and match the objects
+    std::string prev;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        BinaryData entry = entries.get(i);
+        std::string current(entry.data(), entry.size());
+        REALM_ASSERT(current.size() > 8);
+        REALM_ASSERT(i == 0 || compare_index_entry(BinaryData(prev.data(), prev.size()), current) < 0);
+        ObjKey key = get_index_entry_key(entry);
+        REALM_ASSERT(make_index_entry(get_prefix(key), key) == current);
+        prev = std::move(current);
+    }
+#endif
+}
@@ -0,0 +1,161 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_INDEX_COMPOSITE_HPP
+#define REALM_INDEX_COMPOSITE_HPP
+
+#include <realm/array.hpp>
+#include <realm/keys.hpp>
+#include <realm/mixed.hpp>
+
+#include <string>
+#include <vector>
+
+namespace realm {
+
+class ClusterTree;
+
+/// A composite index covers an ordered list of int, string, timestamp and
+/// bool columns. It finds the objects whose first N columns have given values
+/// with one binary search, for any N up to the number of columns, so an index
+/// on (tenant, status) also answers conditions on the tenant alone.
+///
+/// Every object has one entry: the values of its columns encoded into a byte
+/// string which compares (as unsigned bytes) like the tuple of values, followed
+/// by the object key. Entries are kept sorted in a B+tree of binaries.
+class CompositeIndex {
+public:
+    CompositeIndex(const std::vector<ColKey>& columns, const ClusterTree* target, Allocator&);
+    CompositeIndex(ref_type, ArrayParent*, size_t ndx_in_parent, const ClusterTree* target, Allocator&);
+
+    static bool type_supported(realm::DataType type)
+    {
+        return type == type_Int || type == type_String || type == type_Timestamp || type == type_Bool;
+    }
+
+    // Accessor concept:
+    Allocator& get_alloc() const noexcept;
+    void destroy() noexcept;
+    void set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept;
+    void update_from_parent(size_t old_baseline) noexcept;
+    void refresh_accessor_tree(const ClusterTree* target);
+    ref_type get_ref() const noexcept;
+
+    // CompositeIndex interface:
+
+    /// The indexed columns, in index order
+    const std::vector<ColKey>& get_columns() const noexcept;
+    bool has_column(ColKey col_key) const noexcept;
+
+    // insert() reads the values of a new object from the table. set() and
+    // erase() read the old values, so they must be called before the object
+    // is modified.
+    void insert(ObjKey key);
+    void set(ObjKey key, ColKey col_key, Mixed new_value);
+    void erase(ObjKey key);
+    void clear();
+
+    /// Number of entries, which is the number of objects in the table.
+    size_t size() const;
+
+    /// Add the keys of the objects whose first `values.size()` columns are
+    /// equal to `values` to \a result, sorted by key.
+    void find_all(const std::vector<Mixed>& values, std::vector<ObjKey>& result) const;
+    size_t count(const std::vector<Mixed>& values) const;
+
+    void verify() const;
+
+private:
+    enum { s_columns_ndx = 0, s_entries_ndx = 1, s_top_size = 2 };
+
+    Array m_top;
+    std::vector<ColKey> m_columns;
+    const ClusterTree* m_target;
+
+    void load_columns();
+    // The encoded values of the object, without the key
+    std::string get_prefix(ObjKey key) const;
+    // The positions [first, second) of the entries starting with `prefix`
+    std::pair<size_t, size_t> find_range(const std::string& prefix) const;
+
+    void insert_entry(const std::string& entry);
+    void erase_entry(const std::string& entry);
+};
+
+
+// Implementation:
+
+inline CompositeIndex::CompositeIndex(ref_type ref, ArrayParent* parent, size_t ndx_in_parent,
+                                      const ClusterTree* target, Allocator& alloc)
+    : m_top(alloc)
+    , m_target(target)
+{
+    m_top.init_from_ref(ref);
+    m_top.set_parent(parent, ndx_in_parent);
+    load_columns();
+}
+
+inline Allocator& CompositeIndex::get_alloc() const noexcept
+{
+    return m_top.get_alloc();
+}
+
+inline void CompositeIndex::destroy() noexcept
+{
+    m_top.destroy_deep();
+}
+
+inline void CompositeIndex::set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept
+{
+    m_top.set_parent(parent, ndx_in_parent);
+}
+
+inline void CompositeIndex::update_from_parent(size_t old_baseline) noexcept
+{
+    m_top.update_from_parent(old_baseline);
+}
+
+inline void CompositeIndex::refresh_accessor_tree(const ClusterTree* target)
+{
+    m_top.init_from_parent();
+    m_target = target;
+    load_columns();
+}
+
+inline ref_type CompositeIndex::get_ref() const noexcept
+{
+    return m_top.get_ref();
+}
+
+inline const std::vector<ColKey>& CompositeIndex::get_columns() const noexcept
+{
+    return m_columns;
+}
+
+inline bool CompositeIndex::has_column(ColKey col_key) const noexcept
+{
+    for (auto col : m_columns) {
+        if (col == col_key)
+            return true;
+    }
+    return false;
+}
+
+} // namespace realm
+
+#endif // REALM_INDEX_COMPOSITE_HPP
@@ -0,0 +1,302 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/index_hash.hpp>
+#include <realm/column_integer.hpp>
+
+#include <algorithm>
+#include <tuple>
+
+using namespace realm;
+
+namespace {
+
+bool same_value(Mixed a, Mixed b) noexcept
+{
+    if (a.is_null() || b.is_null())
+        return a.is_null() && b.is_null();
+    return a.get_type() == b.get_type() && a == b;
+}
+
+} // anonymous namespace
+
+
+HashIndex::HashIndex(const ClusterColumn& target_column, Allocator& alloc)
+    : m_top(alloc)
+    , m_target_column(target_column)
+{
+    m_top.create(Array::type_HasRefs, false, s_top_size, 0); // Throws
+    IntegerColumn hashes(alloc);
+    hashes.set_parent(&m_top, s_hashes_ndx);
+    hashes.create(); // Throws
+    IntegerColumn keys(alloc);
+    keys.set_parent(&m_top, s_keys_ndx);
+    keys.create(); // Throws
+    m_top.set(s_flags_ndx, RefOrTagged::make_tagged(0)); // Throws
+}
+
+int64_t HashIndex::hash(Mixed value) noexcept
+{
+    if (value.is_null())
+        return 0;
+    if (value.get_type() == type_Int) {
+        // Hash the little endian bytes, so the hash does not depend on the platform
+        uint64_t v = uint64_t(value.get<int64_t>());
+        unsigned char bytes[8];
+        for (size_t i = 0; i < 8; ++i)
+            bytes[i] = static_cast<unsigned char>(v >> (8 * i));
+        return int64_t(cityhash_64(bytes, sizeof(bytes)));
+    }
+    REALM_ASSERT(value.get_type() == type_String);
+    StringData str = value.get<StringData>();
+    return int64_t(cityhash_64(reinterpret_cast<const unsigned char*>(str.data()), str.size()));
+}
+
+size_t HashIndex::size() const
+{
+    return IntegerColumn(get_alloc(), m_top.get_as_ref(s_keys_ndx)).size();
+}
+
+ObjKey HashIndex::get_key(size_t pos) const
+{
+    return ObjKey(IntegerColumn(get_alloc(), m_top.get_as_ref(s_keys_ndx)).get(pos));
+}
+
+std::pair<size_t, size_t> HashIndex::find_range(int64_t hash) const
+{
+    IntegerColumn hashes(get_alloc(), m_top.get_as_ref(s_hashes_ndx));
+    auto it = std::lower_bound(hashes.cbegin(), hashes.cend(), hash);
+    size_t begin = it.get_position();
+    // Ranges are short, usually a single entry, so scan for the end of it
+    auto end = hashes.cend();
+    while (it != end && *it == hash)
+        ++it;
+    return {begin, it.get_position()};
+}
+
+size_t HashIndex::find_entry(int64_t hash, ObjKey key) const
+{
+    auto range = find_range(hash);
+    IntegerColumn keys(get_alloc(), m_top.get_as_ref(s_keys_ndx));
+    return std::lower_bound(keys.cbegin() + range.first, keys.cbegin() + range.second, key.value).get_position();
+}
+
+bool HashIndex::matches(ObjKey key, Mixed value) const
+{
+    return same_value(m_target_column.get_value(key), value);
+}
+
+template <class Callback>
+void HashIndex::for_each_match(Mixed value, size_t begin, size_t end, Callback&& callback) const
+{
+    if (begin == end)
+        return;
+    IntegerColumn keys(get_alloc(), m_top.get_as_ref(s_keys_ndx));
+    if (!has_collisions()) {
+        // All entries have the same value, so checking one of them is enough
+        if (!matches(ObjKey(keys.get(begin)), value))
+            return;
+        for (auto it = keys.cbegin() + begin, stop = keys.cbegin() + end; it != stop; ++it)
+            callback(ObjKey(*it));
+        return;
+    }
+    for (auto it = keys.cbegin() + begin, stop = keys.cbegin() + end; it != stop; ++it) {
+        ObjKey key(*it);
+        if (matches(key, value))
+            callback(key);
+    }
+}
+
+ObjKey HashIndex::find_first(Mixed value) const
+{
+    auto range = find_range(hash(value));
+    ObjKey result;
+    for_each_match(value, range.first, range.second, [&](ObjKey key) {
+        if (!result)
+            result = key;
+    });
+    return result;
+}
+
+void HashIndex::find_all(Mixed value, std::vector<ObjKey>& result) const
+{
+    auto range = find_range(hash(value));
+    result.reserve(result.size() + (range.second - range.first));
+    // Entries with the same hash are already ordered by key
+    for_each_match(value, range.first, range.second, [&](ObjKey key) { result.push_back(key); });
+}
+
+size_t HashIndex::count(Mixed value) const
+{
+    auto range = find_range(hash(value));
+    if (range.first == range.second)
+        return 0;
+    if (!has_collisions())
+        return matches(get_key(range.first), value) ? range.second - range.first : 0;
+    size_t n = 0;
+    for_each_match(value, range.first, range.second, [&](ObjKey) { ++n; });
+    return n;
+}
+
+void HashIndex::set_has_collisions()
+{
+    int64_t flags = m_top.get_as_ref_or_tagged(s_flags_ndx).get_as_int();
+    m_top.set(s_flags_ndx, RefOrTagged::make_tagged(flags | flag_collisions)); // Throws
+}
+
+void HashIndex::insert_entry(Mixed value, ObjKey key)
+{
+    int64_t h = hash(value);
+    auto range = find_range(h);
+    if (range.first != range.second && !has_collisions() && !matches(get_key(range.first), value))
+        set_has_collisions(); // Throws
+
+    IntegerColumn keys_column(get_alloc(), m_top.get_as_ref(s_keys_ndx));
+    size_t pos = std::lower_bound(keys_column.cbegin() + range.first, keys_column.cbegin() + range.second, key.value)
+                     .get_position();
+    auto insert = [&](size_t ndx, int64_t v) {
+        IntegerColumn column(get_alloc());
+        column.set_parent(&m_top, ndx);
+        column.init_from_parent();
+        if (pos == column.size()) {
+            column.add(v); // Throws
+        }
+        else {
+            column.insert(pos, v); // Throws
+        }
+    };
+    insert(s_hashes_ndx, h);
+    insert(s_keys_ndx, key.value);
+}
+
+void HashIndex::erase_entry(Mixed value, ObjKey key)
+{
+    size_t pos = find_entry(hash(value), key);
+    REALM_ASSERT(pos < size() && get_key(pos) == key);
+    for (size_t ndx : {size_t(s_hashes_ndx), size_t(s_keys_ndx)}) {
+        IntegerColumn column(get_alloc());
+        column.set_parent(&m_top, ndx);
+        column.init_from_parent();
+        column.erase(pos); // Throws
+    }
+}
+
+void HashIndex::insert(ObjKey key)
+{
+    insert_entry(m_target_column.get_value(key), key); // Throws
+}
+
+void HashIndex::set(ObjKey key, Mixed new_value)
+{
+    Mixed old_value = m_target_column.get_value(key);
+    if (hash(old_value) == hash(new_value)) {
+        // The entry stays where it is, but the other objects with the hash may
+        // now have a different value
+        if (!has_collisions() && !same_value(old_value, new_value)) {
+            auto range = find_range(hash(new_value));
+            if (range.second - range.first > 1)
+                set_has_collisions(); // Throws
+        }
+        return;
+    }
+    erase_entry(old_value, key);  // Throws
+    insert_entry(new_value, key); // Throws
+}
+
+void HashIndex::erase(ObjKey key)
+{
+    erase_entry(m_target_column.get_value(key), key); // Throws
+}
+
+void HashIndex::clear()
+{
+    for (size_t ndx : {size_t(s_hashes_ndx), size_t(s_keys_ndx)}) {
+        IntegerColumn column(get_alloc());
+        column.set_parent(&m_top, ndx);
+        column.init_from_parent();
+        column.clear(); // Throws
+    }
+    m_top.set(s_flags_ndx, RefOrTagged::make_tagged(0)); // Throws
+}
+
+void HashIndex::insert_bulk()
+{
+    REALM_ASSERT(size() == 0);
+
+    struct Entry {
+        int64_t hash;
+        int64_t key;
+        Mixed value;
+    };
+    std::vector<Entry> entries;
+    entries.reserve(m_target_column.size());
+    for (auto it = m_target_column.begin(), end = m_target_column.end(); it != end; ++it) {
+        Mixed value = it->get_any(m_target_column.get_column_key());
+        entries.push_back({hash(value), it->get_key().value, value});
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return std::tie(a.hash, a.key) < std::tie(b.hash, b.key);
+    });
+
+    // The values point into the clusters, so compare them before the index is
+    // modified
+    bool collisions = false;
+    for (size_t i = 1; i < entries.size() && !collisions; ++i) {
+        if (entries[i].hash == entries[i - 1].hash)
+            collisions = !same_value(entries[i - 1].value, entries[i].value);
+    }
+
+    IntegerColumn hashes(get_alloc());
+    hashes.set_parent(&m_top, s_hashes_ndx);
+    hashes.init_from_parent();
+    IntegerColumn keys(get_alloc());
+    keys.set_parent(&m_top, s_keys_ndx);
+    keys.init_from_parent();
+    for (auto& entry : entries) {
+        hashes.add(entry.hash); // Throws
+        keys.add(entry.key);    // Throws
+    }
+    if (collisions)
+        set_has_collisions(); // Throws
+}
+
+void HashIndex::verify() const
+{
+#ifdef REALM_DEBUG
+    REALM_ASSERT(m_top.size() == s_top_size);
+    Allocator& alloc = get_alloc();
+    IntegerColumn hashes(alloc, m_top.get_as_ref(s_hashes_ndx));
+    IntegerColumn keys(alloc, m_top.get_as_ref(s_keys_ndx));
+    REALM_ASSERT(hashes.size() == keys.size());
+    REALM_ASSERT(keys.size() == m_target_column.size());
+    // Entries are sorted by hash and then by key, and match the column. Without
+    // the collision flag, entries with the same hash have the same value.
+    for (size_t i = 0; i < keys.size(); ++i) {
+        ObjKey key(keys.get(i));
+        int64_t h = hashes.get(i);
+        Mixed value = m_target_column.get_value(key);
+        REALM_ASSERT(hash(value) == h);
+        if (i > 0) {
+            int64_t prev = hashes.get(i - 1);
+            REALM_ASSERT(prev < h || (prev == h && keys.get(i - 1) < key.value));
+            if (prev == h && !has_collisions())
+                REALM_ASSERT(matches(ObjKey(keys.get(i - 1)), value));
+        }
+    }
+#endif
+}
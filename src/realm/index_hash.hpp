@@ -0,0 +1,161 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_INDEX_HASH_HPP
+#define REALM_INDEX_HASH_HPP
+
+#include <realm/array.hpp>
+#include <realm/index_string.hpp>
+#include <realm/mixed.hpp>
+
+#include <vector>
+
+namespace realm {
+
+/// A hash index is an alternative to the search index for equality lookups
+/// on a string or int column. Where the search index walks one level per four
+/// bytes of the value, a lookup in the hash index is a binary search among
+/// fixed size integers, whatever the length of the value, which suits long
+/// values like UUIDs and emails.
+///
+/// Entries are stored in two parallel B+trees of integers, holding a 64 bit
+/// hash of the value and the object key, sorted by hash and then by key. As
+/// long as no two different values with the same hash have been added, all
+/// entries with the same hash have the same value, and a lookup only reads the
+/// value of one object to rule out a collision with the looked up value.
+class HashIndex {
+public:
+    HashIndex(const ClusterColumn& target_column, Allocator&);
+    HashIndex(ref_type, ArrayParent*, size_t ndx_in_parent, const ClusterColumn& target_column, Allocator&);
+
+    static bool type_supported(realm::DataType type)
+    {
+        return type == type_Int || type == type_String;
+    }
+
+    // Accessor concept:
+    Allocator& get_alloc() const noexcept;
+    void destroy() noexcept;
+    void set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept;
+    void update_from_parent(size_t old_baseline) noexcept;
+    void refresh_accessor_tree(const ClusterColumn& target_column);
+    ref_type get_ref() const noexcept;
+
+    // HashIndex interface:
+
+    // insert() reads the value of the new object from the target column.
+    // set() and erase() read the old value, so they must be called before the
+    // column is modified.
+    void insert(ObjKey key);
+    void set(ObjKey key, Mixed new_value);
+    void erase(ObjKey key);
+    void clear();
+    /// Add all objects of the target column, which must be empty, at once.
+    void insert_bulk();
+
+    /// The hash of a value, as stored in the index. It only depends on the
+    /// value, so it is the same on every platform.
+    static int64_t hash(Mixed value) noexcept;
+
+    /// Number of entries, which is the number of objects.
+    size_t size() const;
+
+    ObjKey find_first(Mixed value) const;
+    /// Add the keys of the objects with the value to \a result, sorted by key.
+    void find_all(Mixed value, std::vector<ObjKey>& result) const;
+    size_t count(Mixed value) const;
+
+    /// True if different values with the same hash have been added.
+    bool has_collisions() const noexcept;
+
+    void verify() const;
+
+private:
+    enum { s_hashes_ndx = 0, s_keys_ndx = 1, s_flags_ndx = 2, s_top_size = 3 };
+    enum { flag_collisions = 1 };
+
+    Array m_top;
+    ClusterColumn m_target_column;
+
+    // The positions [first, second) of the entries with the hash
+    std::pair<size_t, size_t> find_range(int64_t hash) const;
+    // The position of the entry (hash, key), or where it would be inserted
+    size_t find_entry(int64_t hash, ObjKey key) const;
+    ObjKey get_key(size_t pos) const;
+    // The matching keys among the entries in [begin, end), which have the hash
+    // of `value`
+    template <class Callback>
+    void for_each_match(Mixed value, size_t begin, size_t end, Callback&& callback) const;
+    bool matches(ObjKey key, Mixed value) const;
+
+    void set_has_collisions();
+    void insert_entry(Mixed value, ObjKey key);
+    void erase_entry(Mixed value, ObjKey key);
+};
+
+
+// Implementation:
+
+inline HashIndex::HashIndex(ref_type ref, ArrayParent* parent, size_t ndx_in_parent,
+                            const ClusterColumn& target_column, Allocator& alloc)
+    : m_top(alloc)
+    , m_target_column(target_column)
+{
+    m_top.init_from_ref(ref);
+    m_top.set_parent(parent, ndx_in_parent);
+}
+
+inline Allocator& HashIndex::get_alloc() const noexcept
+{
+    return m_top.get_alloc();
+}
+
+inline void HashIndex::destroy() noexcept
+{
+    m_top.destroy_deep();
+}
+
+inline void HashIndex::set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept
+{
+    m_top.set_parent(parent, ndx_in_parent);
+}
+
+inline void HashIndex::update_from_parent(size_t old_baseline) noexcept
+{
+    m_top.update_from_parent(old_baseline);
+}
+
+inline void HashIndex::refresh_accessor_tree(const ClusterColumn& target_column)
+{
+    m_top.init_from_parent();
+    m_target_column = target_column;
+}
+
+inline ref_type HashIndex::get_ref() const noexcept
+{
+    return m_top.get_ref();
+}
+
+inline bool HashIndex::has_collisions() const noexcept
+{
+    return (m_top.get_as_ref_or_tagged(s_flags_ndx).get_as_int() & flag_collisions) != 0;
+}
+
+} // namespace realm
+
+#endif // REALM_INDEX_HASH_HPP
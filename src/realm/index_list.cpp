@@ -0,0 +1,200 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/index_list.hpp>
+#include <realm/cluster_tree.hpp>
+#include <realm/column_binary.hpp>
+#include <realm/list.hpp>
+#include <realm/impl/index_entries.hpp>
+
+#include <algorithm>
+
+using namespace realm;
+using namespace realm::_impl;
+
+ListIndex::ListIndex(const ClusterColumn& target_column, Allocator& alloc)
+    : m_top(alloc)
+    , m_target_column(target_column)
+{
+    m_top.create(Array::type_HasRefs, false, s_top_size, 0); // Throws
+    BinaryColumn entries(alloc);
+    entries.set_parent(&m_top, s_entries_ndx);
+    entries.create(); // Throws
+}
+
+std::vector<std::string> ListIndex::get_prefixes(ObjKey key) const
+{
+    ConstObj obj = m_target_column.get_cluster_tree()->get(key);
+    auto list = obj.get_listbase_ptr(m_target_column.get_column_key());
+    std::vector<std::string> prefixes(list->size());
+    for (size_t i = 0; i < prefixes.size(); ++i)
+        append_index_value(prefixes[i], list->get_any(i));
+    return prefixes;
+}
+
+size_t ListIndex::size() const
+{
+    BinaryColumn entries(get_alloc());
+    entries.init_from_ref(m_top.get_as_ref(s_entries_ndx));
+    return entries.size();
+}
+
+bool ListIndex::to_column_type(Mixed& value) const
+{
+    if (value.is_null())
+        return true;
+    DataType type = m_target_column.get_data_type();
+    if (value.get_type() == type)
+        return true;
+    // A query may compare the elements of an int list with a float or double,
+    // which only matches if it is a whole number
+    if (type == type_Int && (value.get_type() == type_Float || value.get_type() == type_Double)) {
+        double d = value.get_type() == type_Float ? double(value.get<float>()) : value.get<double>();
+        if (d >= -9.2e18 && d <= 9.2e18 && d == double(int64_t(d))) {
+            value = Mixed(int64_t(d));
+            return true;
+        }
+    }
+    return false;
+}
+
+std::pair<size_t, size_t> ListIndex::find_range(Mixed value) const
+{
+    if (!to_column_type(value))
+        return {0, 0};
+    std::string prefix;
+    append_index_value(prefix, value);
+    BinaryColumn entries(get_alloc());
+    entries.init_from_ref(m_top.get_as_ref(s_entries_ndx));
+    size_t begin = index_partition_point(entries, 0, entries.size(),
+                                         [&](BinaryData entry) { return compare_index_prefix(entry, prefix) < 0; });
+    size_t end = index_partition_point(entries, begin, entries.size(),
+                                       [&](BinaryData entry) { return compare_index_prefix(entry, prefix) == 0; });
+    return {begin, end};
+}
+
+void ListIndex::find_all(Mixed value, std::vector<ObjKey>& result) const
+{
+    auto range = find_range(value);
+    BinaryColumn entries(get_alloc());
+    entries.init_from_ref(m_top.get_as_ref(s_entries_ndx));
+    size_t first = result.size();
+    result.reserve(first + (range.second - range.first));
+    // Entries with the same value are ordered by key, so the entries of a
+    // list holding the value several times are next to each other
+    for (size_t i = range.first; i < range.second; ++i) {
+        ObjKey key = get_index_entry_key(entries.get(i));
+        if (result.size() == first || result.back() != key)
+            result.push_back(key);
+    }
+}
+
+size_t ListIndex::count(Mixed value) const
+{
+    auto range = find_range(value);
+    return range.second - range.first;
+}
+
+void ListIndex::insert_entry(const std::string& entry)
+{
+    BinaryColumn entries(get_alloc());
+    entries.set_parent(&m_top, s_entries_ndx);
+    entries.init_from_parent();
+    size_t pos = index_partition_point(entries, 0, entries.size(),
+                                       [&](BinaryData other) { return compare_index_entry(other, entry) < 0; });
+    entries.insert(pos, BinaryData(entry.data(), entry.size())); // Throws
+}
+
+void ListIndex::erase_entry(const std::string& entry)
+{
+    BinaryColumn entries(get_alloc());
+    entries.set_parent(&m_top, s_entries_ndx);
+    entries.init_from_parent();
+    size_t pos = index_partition_point(entries, 0, entries.size(),
+                                       [&](BinaryData other) { return compare_index_entry(other, entry) < 0; });
+    REALM_ASSERT(pos < entries.size() && compare_index_entry(entries.get(pos), entry) == 0);
+    entries.erase(pos); // Throws
+}
+
+void ListIndex::insert(ObjKey key, Mixed value)
+{
+    std::string prefix;
+    append_index_value(prefix, value);
+    insert_entry(make_index_entry(std::move(prefix), key)); // Throws
+}
+
+void ListIndex::erase(ObjKey key, Mixed value)
+{
+    std::string prefix;
+    append_index_value(prefix, value);
+    erase_entry(make_index_entry(std::move(prefix), key)); // Throws
+}
+
+void ListIndex::set(ObjKey key, Mixed old_value, Mixed new_value)
+{
+    std::string old_prefix;
+    std::string new_prefix;
+    append_index_value(old_prefix, old_value);
+    append_index_value(new_prefix, new_value);
+    if (old_prefix == new_prefix)
+        return;
+    erase_entry(make_index_entry(std::move(old_prefix), key)); // Throws
+    insert_entry(make_index_entry(std::move(new_prefix), key)); // Throws
+}
+
+void ListIndex::insert(ObjKey key)
+{
+    for (auto& prefix : get_prefixes(key))
+        insert_entry(make_index_entry(std::move(prefix), key)); // Throws
+}
+
+void ListIndex::erase(ObjKey key)
+{
+    for (auto& prefix : get_prefixes(key))
+        erase_entry(make_index_entry(std::move(prefix), key)); // Throws
+}
+
+void ListIndex::clear()
+{
+    BinaryColumn entries(get_alloc());
+    entries.set_parent(&m_top, s_entries_ndx);
+    entries.init_from_parent();
+    entries.clear(); // Throws
+}
+
+void ListIndex::verify() const
+{
+#ifdef REALM_DEBUG
+    REALM_ASSERT(m_top.size() == s_top_size);
+    BinaryColumn entries(get_alloc());
+    entries.init_from_ref(m_top.get_as_ref(s_entries_ndx));
+    // Entries are ordered, and every list has exactly one entry per element
+    std::vector<std::string> expected;
+    for (auto it = m_target_column.begin(), end = m_target_column.end(); it != end; ++it) {
+        ObjKey key = it->get_key();
+        for (auto& prefix : get_prefixes(key))
+            expected.push_back(make_index_entry(std::move(prefix), key));
+    }
+    std::sort(expected.begin(), expected.end(), [](const std::string& a, const std::string& b) {
+        return compare_index_entry(BinaryData(a.data(), a.size()), b) < 0;
+    });
+    REALM_ASSERT(entries.size() == expected.size());
+    for (size_t i = 0; i < entries.size(); ++i)
+        REALM_ASSERT(compare_index_entry(entries.get(i), expected[i]) == 0);
+#endif
+}
@@ -0,0 +1,144 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_INDEX_LIST_HPP
+#define REALM_INDEX_LIST_HPP
+
+#include <realm/array.hpp>
+#include <realm/index_string.hpp>
+#include <realm/mixed.hpp>
+
+#include <string>
+#include <vector>
+
+namespace realm {
+
+/// A list index is the search index of a list of int, string, timestamp or
+/// bool values. It maps every element to the object owning the list, so an
+/// equality condition on the elements finds the objects with a matching list
+/// without reading any list.
+///
+/// Every element has one entry: the encoded value followed by the object key,
+/// kept sorted in a B+tree of binaries. A list holding a value several times
+/// has as many equal entries.
+class ListIndex {
+public:
+    ListIndex(const ClusterColumn& target_column, Allocator&);
+    ListIndex(ref_type, ArrayParent*, size_t ndx_in_parent, const ClusterColumn& target_column, Allocator&);
+
+    static bool type_supported(realm::DataType type)
+    {
+        return type == type_Int || type == type_String || type == type_Timestamp || type == type_Bool;
+    }
+
+    // Accessor concept:
+    Allocator& get_alloc() const noexcept;
+    void destroy() noexcept;
+    void set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept;
+    void update_from_parent(size_t old_baseline) noexcept;
+    void refresh_accessor_tree(const ClusterColumn& target_column);
+    ref_type get_ref() const noexcept;
+
+    // ListIndex interface:
+
+    // Add or remove one element of the list of an object
+    void insert(ObjKey key, Mixed value);
+    void erase(ObjKey key, Mixed value);
+    void set(ObjKey key, Mixed old_value, Mixed new_value);
+    // Add or remove all the elements of the list of an object. erase() reads
+    // the list, so it must be called before the list is cleared or the object
+    // is removed.
+    void insert(ObjKey key);
+    void erase(ObjKey key);
+    void clear();
+
+    /// Number of entries, which is the total number of list elements.
+    size_t size() const;
+
+    /// Add the keys of the objects with at least one element equal to \a
+    /// value to \a result, sorted by key and without duplicates.
+    void find_all(Mixed value, std::vector<ObjKey>& result) const;
+    /// Number of elements equal to \a value, over all lists.
+    size_t count(Mixed value) const;
+
+    void verify() const;
+
+private:
+    enum { s_entries_ndx = 0, s_top_size = 1 };
+
+    Array m_top;
+    ClusterColumn m_target_column;
+
+    // Convert a query value to the type of the elements. Returns false if no
+    // element can be equal to it.
+    bool to_column_type(Mixed& value) const;
+    // The positions [first, second) of the entries for `value`
+    std::pair<size_t, size_t> find_range(Mixed value) const;
+    // The encoded elements of the list of the object, without the key
+    std::vector<std::string> get_prefixes(ObjKey key) const;
+
+    void insert_entry(const std::string& entry);
+    void erase_entry(const std::string& entry);
+};
+
+
+// Implementation:
+
+inline ListIndex::ListIndex(ref_type ref, ArrayParent* parent, size_t ndx_in_parent,
+                            const ClusterColumn& target_column, Allocator& alloc)
+    : m_top(alloc)
+    , m_target_column(target_column)
+{
+    m_top.init_from_ref(ref);
+    m_top.set_parent(parent, ndx_in_parent);
+}
+
+inline Allocator& ListIndex::get_alloc() const noexcept
+{
+    return m_top.get_alloc();
+}
+
+inline void ListIndex::destroy() noexcept
+{
+    m_top.destroy_deep();
+}
+
+inline void ListIndex::set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept
+{
+    m_top.set_parent(parent, ndx_in_parent);
+}
+
+inline void ListIndex::update_from_parent(size_t old_baseline) noexcept
+{
+    m_top.update_from_parent(old_baseline);
+}
+
+inline void ListIndex::refresh_accessor_tree(const ClusterColumn& target_column)
+{
+    m_top.init_from_parent();
+    m_target_column = target_column;
+}
+
+inline ref_type ListIndex::get_ref() const noexcept
+{
+    return m_top.get_ref();
+}
+
+} // namespace realm
+
+#endif // REALM_INDEX_LIST_HPP
@@ -0,0 +1,320 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/index_range.hpp>
+#include <realm/column_integer.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+using namespace realm;
+
+namespace {
+
+// Map a double to an integer with the same order. Positive doubles already
+// compare like their bit patterns; for negative ones the magnitude bits are
+// flipped so that a larger magnitude gives a smaller integer.
+int64_t encode_double(double d) noexcept
+{
+    if (d == 0)
+        d = 0; // -0.0 == 0.0
+    int64_t bits;
+    std::memcpy(&bits, &d, sizeof(bits));
+    return bits < 0 ? bits ^ std::numeric_limits<int64_t>::max() : bits;
+}
+
+double decode_double(int64_t bits) noexcept
+{
+    if (bits < 0)
+        bits ^= std::numeric_limits<int64_t>::max();
+    double d;
+    std::memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+} // anonymous namespace
+
+
+RangeIndex::RangeIndex(const ClusterColumn& target_column, Allocator& alloc)
+    : m_top(alloc)
+    , m_target_column(target_column)
+{
+    m_top.create(Array::type_HasRefs, false, s_top_size, 0); // Throws
+    IntegerColumn values(alloc);
+    values.set_parent(&m_top, s_values_ndx);
+    values.create(); // Throws
+    IntegerColumn keys(alloc);
+    keys.set_parent(&m_top, s_keys_ndx);
+    keys.create(); // Throws
+    if (target_column.get_data_type() == type_Timestamp) {
+        IntegerColumn nanoseconds(alloc);
+        nanoseconds.set_parent(&m_top, s_nanoseconds_ndx);
+        nanoseconds.create(); // Throws
+    }
+}
+
+bool RangeIndex::to_value(Mixed value, Value& result) noexcept
+{
+    if (value.is_null())
+        return false;
+    switch (value.get_type()) {
+        case type_Int:
+            result = {value.get<int64_t>(), 0};
+            return true;
+        case type_Float: {
+            float f = value.get<float>();
+            if (std::isnan(f))
+                return false;
+            result = {encode_double(f), 0};
+            return true;
+        }
+        case type_Double: {
+            double d = value.get<double>();
+            if (std::isnan(d))
+                return false;
+            result = {encode_double(d), 0};
+            return true;
+        }
+        case type_Timestamp: {
+            Timestamp t = value.get<Timestamp>();
+            if (t.is_null())
+                return false;
+            result = {t.get_seconds(), t.get_nanoseconds()};
+            return true;
+        }
+        default:
+            break;
+    }
+    return false;
+}
+
+size_t RangeIndex::size() const
+{
+    return IntegerColumn(get_alloc(), m_top.get_as_ref(s_keys_ndx)).size();
+}
+
+RangeIndex::Value RangeIndex::get(size_t pos) const
+{
+    Allocator& alloc = get_alloc();
+    Value value;
+    value.hi = IntegerColumn(alloc, m_top.get_as_ref(s_values_ndx)).get(pos);
+    if (has_nanoseconds())
+        value.lo = IntegerColumn(alloc, m_top.get_as_ref(s_nanoseconds_ndx)).get(pos);
+    return value;
+}
+
+ObjKey RangeIndex::get_key(size_t pos) const
+{
+    return ObjKey(IntegerColumn(get_alloc(), m_top.get_as_ref(s_keys_ndx)).get(pos));
+}
+
+Mixed RangeIndex::get_value(size_t pos) const
+{
+    Value value = get(pos);
+    switch (m_target_column.get_data_type()) {
+        case type_Float:
+            return Mixed(float(decode_double(value.hi)));
+        case type_Double:
+            return Mixed(decode_double(value.hi));
+        case type_Timestamp:
+            return Mixed(Timestamp(value.hi, int32_t(value.lo)));
+        default:
+            break;
+    }
+    return Mixed(value.hi);
+}
+
+size_t RangeIndex::lower_bound(const Value& value) const
+{
+    Allocator& alloc = get_alloc();
+    IntegerColumn values(alloc, m_top.get_as_ref(s_values_ndx));
+    size_t pos = std::lower_bound(values.cbegin(), values.cend(), value.hi).get_position();
+    if (!has_nanoseconds())
+        return pos;
+    // Among the entries with the same seconds, search the nanoseconds
+    size_t end = std::upper_bound(values.cbegin() + pos, values.cend(), value.hi).get_position();
+    IntegerColumn nanoseconds(alloc, m_top.get_as_ref(s_nanoseconds_ndx));
+    return std::lower_bound(nanoseconds.cbegin() + pos, nanoseconds.cbegin() + end, value.lo).get_position();
+}
+
+size_t RangeIndex::upper_bound(const Value& value) const
+{
+    Allocator& alloc = get_alloc();
+    IntegerColumn values(alloc, m_top.get_as_ref(s_values_ndx));
+    size_t end = std::upper_bound(values.cbegin(), values.cend(), value.hi).get_position();
+    if (!has_nanoseconds())
+        return end;
+    size_t pos = std::lower_bound(values.cbegin(), values.cbegin() + end, value.hi).get_position();
+    IntegerColumn nanoseconds(alloc, m_top.get_as_ref(s_nanoseconds_ndx));
+    return std::upper_bound(nanoseconds.cbegin() + pos, nanoseconds.cbegin() + end, value.lo).get_position();
+}
+
+size_t RangeIndex::find_entry(const Value& value, ObjKey key) const
+{
+    size_t begin = lower_bound(value);
+    size_t end = upper_bound(value);
+    IntegerColumn keys(get_alloc(), m_top.get_as_ref(s_keys_ndx));
+    return std::lower_bound(keys.cbegin() + begin, keys.cbegin() + end, key.value).get_position();
+}
+
+std::pair<size_t, size_t> RangeIndex::find_range(Condition cond, Mixed value) const
+{
+    Value v;
+    if (!to_value(value, v))
+        return {0, 0};
+    switch (cond) {
+        case Condition::equal:
+            return {lower_bound(v), upper_bound(v)};
+        case Condition::greater:
+            return {upper_bound(v), size()};
+        case Condition::greater_equal:
+            return {lower_bound(v), size()};
+        case Condition::less:
+            return {0, lower_bound(v)};
+        case Condition::less_equal:
+            return {0, upper_bound(v)};
+    }
+    return {0, 0};
+}
+
+void RangeIndex::get_keys(size_t begin, size_t end, std::vector<ObjKey>& result) const
+{
+    IntegerColumn keys(get_alloc(), m_top.get_as_ref(s_keys_ndx));
+    size_t first = result.size();
+    result.reserve(first + (end - begin));
+    for (auto it = keys.cbegin() + begin, stop = keys.cbegin() + end; it != stop; ++it)
+        result.push_back(ObjKey(*it));
+    std::sort(result.begin() + first, result.end());
+}
+
+size_t RangeIndex::find_min() const
+{
+    return size() == 0 ? npos : 0;
+}
+
+size_t RangeIndex::find_max() const
+{
+    size_t sz = size();
+    if (sz == 0)
+        return npos;
+    // Entries with equal values are ordered by key, so find the first of them
+    return lower_bound(get(sz - 1));
+}
+
+void RangeIndex::insert_entry(const Value& value, ObjKey key)
+{
+    Allocator& alloc = get_alloc();
+    size_t pos = find_entry(value, key);
+    auto insert = [&](size_t ndx, int64_t v) {
+        IntegerColumn column(alloc);
+        column.set_parent(&m_top, ndx);
+        column.init_from_parent();
+        if (pos == column.size()) {
+            column.add(v); // Throws
+        }
+        else {
+            column.insert(pos, v); // Throws
+        }
+    };
+    insert(s_values_ndx, value.hi);
+    insert(s_keys_ndx, key.value);
+    if (has_nanoseconds())
+        insert(s_nanoseconds_ndx, value.lo);
+}
+
+void RangeIndex::erase_entry(const Value& value, ObjKey key)
+{
+    Allocator& alloc = get_alloc();
+    size_t pos = find_entry(value, key);
+    REALM_ASSERT(pos < size() && get_key(pos) == key);
+    auto erase = [&](size_t ndx) {
+        IntegerColumn column(alloc);
+        column.set_parent(&m_top, ndx);
+        column.init_from_parent();
+        column.erase(pos); // Throws
+    };
+    erase(s_values_ndx);
+    erase(s_keys_ndx);
+    if (has_nanoseconds())
+        erase(s_nanoseconds_ndx);
+}
+
+void RangeIndex::insert(ObjKey key, Mixed value)
+{
+    Value v;
+    if (to_value(value, v))
+        insert_entry(v, key); // Throws
+}
+
+void RangeIndex::set(ObjKey key, Mixed new_value)
+{
+    Value old_v;
+    Value new_v;
+    bool old_indexed = to_value(m_target_column.get_value(key), old_v);
+    bool new_indexed = to_value(new_value, new_v);
+    if (old_indexed && new_indexed && old_v == new_v)
+        return;
+    if (old_indexed)
+        erase_entry(old_v, key); // Throws
+    if (new_indexed)
+        insert_entry(new_v, key); // Throws
+}
+
+void RangeIndex::erase(ObjKey key)
+{
+    Value v;
+    if (to_value(m_target_column.get_value(key), v))
+        erase_entry(v, key); // Throws
+}
+
+void RangeIndex::clear()
+{
+    Allocator& alloc = get_alloc();
+    for (size_t ndx = 0; ndx < s_top_size; ++ndx) {
+        IntegerColumn column(alloc);
+        column.set_parent(&m_top, ndx);
+        if (column.init_from_parent())
+            column.clear(); // Throws
+    }
+}
+
+void RangeIndex::verify() const
+{
+#ifdef REALM_DEBUG
+    REALM_ASSERT(m_top.size() == s_top_size);
+    Allocator& alloc = get_alloc();
+    IntegerColumn values(alloc, m_top.get_as_ref(s_values_ndx));
+    IntegerColumn keys(alloc, m_top.get_as_ref(s_keys_ndx));
+    REALM_ASSERT(values.size() == keys.size());
+    if (has_nanoseconds())
+        REALM_ASSERT(IntegerColumn(alloc, m_top.get_as_ref(s_nanoseconds_ndx)).size() == keys.size());
+    // Entries are sorted by value and then by key, and match the column
+    for (size_t i = 0; i < keys.size(); ++i) {
+        Value v = get(i);
+        ObjKey key(keys.get(i));
+        if (i > 0) {
+            Value prev = get(i - 1);
+            REALM_ASSERT(prev < v || (prev == v && keys.get(i - 1) < key.value));
+        }
+        Value actual;
+        REALM_ASSERT(to_value(m_target_column.get_value(key), actual) && actual == v);
+    }
+#endif
+}
@@ -0,0 +1,176 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_INDEX_RANGE_HPP
+#define REALM_INDEX_RANGE_HPP
+
+#include <realm/array.hpp>
+#include <realm/index_string.hpp>
+#include <realm/mixed.hpp>
+
+#include <vector>
+
+namespace realm {
+
+/// A range index keeps the values of an int, timestamp, float or double
+/// column in order, together with the keys of their objects. It answers
+/// comparisons (`<`, `<=`, `>`, `>=`, `==`) with two binary searches, and
+/// gives the smallest and largest value without scanning the column.
+///
+/// Entries are stored in two parallel B+trees of integers, sorted by value and
+/// then by object key. Floats and doubles are mapped to integers with the same
+/// order, and timestamps keep their nanoseconds in a third tree. Null and NaN
+/// never satisfy a comparison, so they are not part of the index.
+class RangeIndex {
+public:
+    enum class Condition { equal, greater, greater_equal, less, less_equal };
+
+    /// An indexed value, ordered like the column values it represents.
+    struct Value {
+        int64_t hi = 0;
+        int64_t lo = 0; // Nanoseconds of a timestamp, otherwise zero
+
+        bool operator<(const Value& other) const noexcept
+        {
+            return hi < other.hi || (hi == other.hi && lo < other.lo);
+        }
+        bool operator==(const Value& other) const noexcept
+        {
+            return hi == other.hi && lo == other.lo;
+        }
+    };
+
+    RangeIndex(const ClusterColumn& target_column, Allocator&);
+    RangeIndex(ref_type, ArrayParent*, size_t ndx_in_parent, const ClusterColumn& target_column, Allocator&);
+
+    static bool type_supported(realm::DataType type)
+    {
+        return type == type_Int || type == type_Timestamp || type == type_Float || type == type_Double;
+    }
+
+    // Accessor concept:
+    Allocator& get_alloc() const noexcept;
+    void destroy() noexcept;
+    void set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept;
+    void update_from_parent(size_t old_baseline) noexcept;
+    void refresh_accessor_tree(const ClusterColumn& target_column);
+    ref_type get_ref() const noexcept;
+
+    // RangeIndex interface:
+
+    void insert(ObjKey key, Mixed value);
+    // set() and erase() read the old value from the target column, so they
+    // must be called before the column is modified.
+    void set(ObjKey key, Mixed new_value);
+    void erase(ObjKey key);
+    void clear();
+
+    /// Convert a column value to its indexed form. Returns false for null and
+    /// NaN, which are not indexed.
+    static bool to_value(Mixed value, Value& result) noexcept;
+
+    /// Number of indexed (non-null) values.
+    size_t size() const;
+
+    /// The positions [first, second) of the entries for which `entry cond
+    /// value` holds. Positions are ordered by value.
+    std::pair<size_t, size_t> find_range(Condition cond, Mixed value) const;
+
+    /// Add the keys of the entries in positions [begin, end) to \a result,
+    /// sorted by key.
+    void get_keys(size_t begin, size_t end, std::vector<ObjKey>& result) const;
+
+    ObjKey get_key(size_t pos) const;
+    Mixed get_value(size_t pos) const;
+
+    /// The position of the smallest (or largest) value. Ties go to the lowest
+    /// key, as for a scan. Returns npos if the index is empty.
+    size_t find_min() const;
+    size_t find_max() const;
+
+    void verify() const;
+
+private:
+    enum { s_values_ndx = 0, s_keys_ndx = 1, s_nanoseconds_ndx = 2, s_top_size = 3 };
+
+    Array m_top;
+    ClusterColumn m_target_column;
+
+    bool has_nanoseconds() const;
+    Value get(size_t pos) const;
+    // The first position with a value not less than (upper: greater than) `value`
+    size_t lower_bound(const Value& value) const;
+    size_t upper_bound(const Value& value) const;
+    // The position of the entry (value, key), or where it would be inserted
+    size_t find_entry(const Value& value, ObjKey key) const;
+
+    void insert_entry(const Value& value, ObjKey key);
+    void erase_entry(const Value& value, ObjKey key);
+};
+
+
+// Implementation:
+
+inline RangeIndex::RangeIndex(ref_type ref, ArrayParent* parent, size_t ndx_in_parent,
+                              const ClusterColumn& target_column, Allocator& alloc)
+    : m_top(alloc)
+    , m_target_column(target_column)
+{
+    m_top.init_from_ref(ref);
+    m_top.set_parent(parent, ndx_in_parent);
+}
+
+inline Allocator& RangeIndex::get_alloc() const noexcept
+{
+    return m_top.get_alloc();
+}
+
+inline void RangeIndex::destroy() noexcept
+{
+    m_top.destroy_deep();
+}
+
+inline void RangeIndex::set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept
+{
+    m_top.set_parent(parent, ndx_in_parent);
+}
+
+inline void RangeIndex::update_from_parent(size_t old_baseline) noexcept
+{
+    m_top.update_from_parent(old_baseline);
+}
+
+inline void RangeIndex::refresh_accessor_tree(const ClusterColumn& target_column)
+{
+    m_top.init_from_parent();
+    m_target_column = target_column;
+}
+
+inline ref_type RangeIndex::get_ref() const noexcept
+{
+    return m_top.get_ref();
+}
+
+inline bool RangeIndex::has_nanoseconds() const
+{
+    return m_top.get_as_ref(s_nanoseconds_ndx) != 0;
+}
+
+} // namespace realm
+
+#endif // REALM_INDEX_RANGE_HPP
@@ -18,6 +18,7 @@
 
 #include <cstdio>
 #include <iomanip>
+#include <algorithm>
 
 #ifdef REALM_DEBUG
 #include <iostream>
@@ -28,6 +29,8 @@
 #include <realm/table.hpp>
 #include <realm/timestamp.hpp>
 #include <realm/column_integer.hpp>
+#include <realm/cluster.hpp>
+#include <realm/column_type_traits.hpp>
 
 using namespace realm;
 using namespace realm::util;
@@ -54,6 +57,11 @@ bool ClusterColumn::is_nullable() const
     return m_column_key.get_attrs().test(col_attr_Nullable);
 }
 
+Mixed ClusterColumn::get_value(ObjKey key) const
+{
+    return m_cluster_tree->get(key).get_any(m_column_key);
+}
+
 StringData ClusterColumn::get_index_data(ObjKey key, StringConversionBuffer& buffer) const
 {
     ConstObj obj = m_cluster_tree->get(key);
@@ -1167,7 +1175,8 @@ bool StringIndex::leaf_insert(ObjKey obj_key, key_type key, size_t offset, Strin
 }
 
 
-void StringIndex::distinct(BPlusTree<ObjKey>& result) const
+template <class Callback>
+void StringIndex::for_each_distinct(Callback&& callback) const
 {
     Allocator& alloc = m_array->get_alloc();
     const size_t array_size = m_array->size();
@@ -1177,7 +1186,7 @@ void StringIndex::distinct(BPlusTree<ObjKey>& result) const
         for (size_t i = 1; i < array_size; ++i) {
             size_t ref = m_array->get_as_ref(i);
             StringIndex ndx(ref, nullptr, 0, m_target_column, alloc);
-            ndx.distinct(result);
+            ndx.for_each_distinct(callback);
         }
     }
     else {
@@ -1187,20 +1196,20 @@ void StringIndex::distinct(BPlusTree<ObjKey>& result) const
             // low bit set indicate literal ref (shifted)
             if (ref & 1) {
                 ObjKey k = ObjKey((uint64_t(ref) >> 1));
-                result.add(k);
+                callback(k);
             }
             else {
                 // A real ref either points to a list or a subindex
                 char* header = alloc.translate(to_ref(ref));
                 if (Array::get_context_flag_from_header(header)) {
                     StringIndex ndx(to_ref(ref), m_array.get(), i, m_target_column, alloc);
-                    ndx.distinct(result);
+                    ndx.for_each_distinct(callback);
                 }
                 else {
                     IntegerColumn sub(alloc, to_ref(ref)); // Throws
                     if (sub.size() == 1) {                 // Optimization.
                         ObjKey k = ObjKey(sub.get(0));     // get first match
-                        result.add(k);
+                        callback(k);
                     }
                     else {
                         // Add all unique values from this sorted list
@@ -1209,7 +1218,7 @@ void StringIndex::distinct(BPlusTree<ObjKey>& result) const
                         SortedListComparator slc(m_target_column);
                         StringConversionBuffer buffer;
                         while (it != it_end) {
-                            result.add(ObjKey(*it));
+                            callback(ObjKey(*it));
                             StringData it_data = get(ObjKey(*it), buffer);
                             it = std::upper_bound(it, it_end, it_data, slc);
                         }
@@ -1220,6 +1229,160 @@ void StringIndex::distinct(BPlusTree<ObjKey>& result) const
     }
 }
 
+void StringIndex::distinct(BPlusTree<ObjKey>& result) const
+{
+    for_each_distinct([&](ObjKey k) { result.add(k); });
+}
+
+size_t StringIndex::count_distinct() const
+{
+    size_t count = 0;
+    for_each_distinct([&](ObjKey) { ++count; });
+    return count;
+}
+
+// A prefix to look up, and its upper and lower case variants, which have
+// the same length
+struct StringIndex::PrefixSearch {
+    StringData prefix;
+    std::string upper;
+    std::string lower;
+    bool case_insensitive;
+    // Keys are compared in 4 byte chunks where a value ending inside the chunk
+    // is followed by an 'X' and zeros, and null is all zeros. Prefixes with
+    // such bytes find values which do not match, so every value is checked.
+    bool check_all;
+
+    bool matches(StringData value) const
+    {
+        if (value.is_null() || value.size() < prefix.size())
+            return false;
+        if (case_insensitive)
+            return equal_case_fold(value.prefix(prefix.size()), upper.c_str(), lower.c_str());
+        return value.begins_with(prefix);
+    }
+
+    // The ranges of the keys at `offset` of values starting with the prefix,
+    // one for every case variant of the bytes of the prefix in the chunk
+    std::vector<std::pair<key_type, key_type>> key_ranges(size_t offset) const
+    {
+        std::vector<std::pair<key_type, key_type>> ranges;
+        size_t n = std::min(prefix.size() - offset, size_t(s_index_key_length));
+        if (n == 0) {
+            ranges.emplace_back(std::numeric_limits<key_type>::min(), std::numeric_limits<key_type>::max());
+            return ranges;
+        }
+        size_t variants = case_insensitive ? size_t(1) << n : 1;
+        for (size_t v = 0; v < variants; ++v) {
+            uint32_t first = 0;
+            for (size_t i = 0; i < n; ++i) {
+                char c = (v >> i) & 1 ? lower[offset + i] : upper[offset + i];
+                first |= uint32_t(static_cast<unsigned char>(c)) << (24 - 8 * i);
+            }
+            uint32_t last = n == s_index_key_length ? first : first | (0xffffffffu >> (8 * n));
+            // The first byte is fixed, so the range does not cross the sign bit
+            ranges.emplace_back(key_type(first), key_type(last));
+        }
+        std::sort(ranges.begin(), ranges.end());
+        ranges.erase(std::unique(ranges.begin(), ranges.end()), ranges.end());
+        return ranges;
+    }
+};
+
+bool StringIndex::find_all_prefix(StringData prefix, std::vector<ObjKey>& result, bool case_insensitive) const
+{
+    PrefixSearch search;
+    search.prefix = prefix;
+    search.case_insensitive = case_insensitive;
+    if (case_insensitive) {
+        auto upper = case_map(prefix, true);
+        auto lower = case_map(prefix, false);
+        if (!upper || !lower || upper->size() != prefix.size() || lower->size() != prefix.size())
+            return false;
+        search.upper = std::move(*upper);
+        search.lower = std::move(*lower);
+    }
+    else {
+        search.upper = search.lower = std::string(prefix.data(), prefix.size());
+    }
+    auto special = [](const std::string& str) {
+        return str.find('X') != std::string::npos || str.find('\0') != std::string::npos;
+    };
+    search.check_all = prefix.size() == 0 || special(search.upper) || special(search.lower);
+
+    size_t first = result.size();
+    find_all_prefix(search, 0, result);
+    std::sort(result.begin() + first, result.end());
+    return true;
+}
+
+void StringIndex::find_all_prefix(const PrefixSearch& search, size_t offset, std::vector<ObjKey>& result) const
+{
+    for (auto& range : search.key_ranges(offset))
+        find_prefix_range(search, offset, range.first, range.second, result);
+}
+
+void StringIndex::find_prefix_range(const PrefixSearch& search, size_t offset, key_type first, key_type last,
+                                    std::vector<ObjKey>& result) const
+{
+    Allocator& alloc = m_array->get_alloc();
+    Array keys(alloc);
+    get_child(*m_array, 0, keys);
+    // Before the last chunk of the prefix, only the part in this chunk has
+    // been compared
+    bool last_chunk = search.prefix.size() - offset <= s_index_key_length;
+
+    for (size_t pos = keys.lower_bound_int(first); pos < keys.size(); ++pos) {
+        key_type key = key_type(keys.get(pos));
+        size_t pos_refs = pos + 1; // first entry in refs points to offsets
+        if (m_array->is_inner_bptree_node()) {
+            // The key is the last key of the child
+            StringIndex node(m_array->get_as_ref(pos_refs), m_array.get(), pos_refs, m_target_column, alloc);
+            node.find_prefix_range(search, offset, first, last, result);
+            if (key >= last)
+                break;
+            continue;
+        }
+        if (key > last)
+            break;
+
+        int64_t ref = m_array->get(pos_refs);
+        if (!last_chunk && !(ref & 1) && Array::get_context_flag_from_header(alloc.translate(to_ref(ref)))) {
+            StringIndex subindex(to_ref(ref), m_array.get(), pos_refs, m_target_column, alloc);
+            subindex.find_all_prefix(search, offset + s_index_key_length, result);
+            continue;
+        }
+        collect_prefix_matches(search, ref, search.check_all || !last_chunk, result);
+    }
+}
+
+void StringIndex::collect_prefix_matches(const PrefixSearch& search, int64_t ref, bool check,
+                                         std::vector<ObjKey>& result) const
+{
+    StringConversionBuffer buffer;
+    auto add = [&](ObjKey key) {
+        if (!check || search.matches(get(key, buffer)))
+            result.push_back(key);
+    };
+
+    // low bit set indicate literal ref (shifted)
+    if (ref & 1) {
+        add(ObjKey(int64_t(uint64_t(ref) >> 1)));
+        return;
+    }
+    Allocator& alloc = m_array->get_alloc();
+    if (Array::get_context_flag_from_header(alloc.translate(to_ref(ref)))) {
+        // A subindex or a node of one, where every entry is below `ref`
+        StringIndex node(to_ref(ref), nullptr, 0, m_target_column, alloc);
+        for (size_t i = 1; i < node.m_array->size(); ++i)
+            node.collect_prefix_matches(search, node.m_array->get(i), check, result);
+        return;
+    }
+    IntegerColumn list(alloc, to_ref(ref)); // Throws
+    for (auto it = list.cbegin(); it != list.cend(); ++it)
+        add(ObjKey(*it));
+}
+
 StringData StringIndex::get(ObjKey key, StringConversionBuffer& buffer) const
 {
     return m_target_column.get_index_data(key, buffer);
@@ -1331,6 +1494,157 @@ void StringIndex::erase(ObjKey key)
     }
 }
 
+template <class T>
+void StringIndex::collect_bulk_entries(std::vector<BulkEntry>& entries) const
+{
+    using LeafType = typename ColumnTypeTraits<T>::cluster_leaf_type;
+    LeafType leaf(m_array->get_alloc());
+    ColKey col_key = m_target_column.get_column_key();
+
+    auto collect = [&](const Cluster* cluster) {
+        cluster->init_leaf(col_key, &leaf);
+        size_t sz = leaf.size();
+        for (size_t i = 0; i < sz; i++) {
+            entries.emplace_back();
+            BulkEntry& entry = entries.back();
+            entry.value = to_str(leaf.get(i), entry.buffer);
+            entry.converted = entry.value.data() == entry.buffer.data();
+            entry.key = cluster->get_real_key(i);
+        }
+        return false; // Continue
+    };
+    m_target_column.get_cluster_tree()->traverse(collect);
+}
+
+// Orders the entries like the index does: by the key at every level, then
+// (in the lists below s_max_offset) by value, and then by object key
+bool StringIndex::bulk_entry_less(const BulkEntry& a, const BulkEntry& b) noexcept
+{
+    StringData va = a.get();
+    StringData vb = b.get();
+    if (va == vb)
+        return a.key < b.key;
+    for (size_t offset = 0; offset <= s_max_offset; offset += s_index_key_length) {
+        key_type ka = create_key(va, offset);
+        key_type kb = create_key(vb, offset);
+        if (ka != kb)
+            return ka < kb;
+        // All keys past the end of both values are 0
+        if (offset > va.size() && offset > vb.size())
+            break;
+    }
+    return va < vb;
+}
+
+ref_type StringIndex::build_bulk(Allocator& alloc, const BulkEntry* begin, const BulkEntry* end, size_t offset)
+{
+    // Leaves are filled up one at a time, and the inner nodes are built
+    // level by level once all leaves exist
+    std::vector<ref_type> nodes;
+    std::unique_ptr<IndexArray> leaf;
+    Array keys(alloc);
+
+    for (const BulkEntry* first = begin; first != end;) {
+        StringData value = first->get();
+        key_type key = create_key(value, offset);
+        const BulkEntry* last = first + 1;
+        while (last != end && create_key(last->get(), offset) == key)
+            ++last;
+
+        int64_t slot;
+        size_t suboffset = offset + s_index_key_length;
+        if (last - first == 1) {
+            slot = int64_t((uint64_t(first->key.value) << 1) + 1); // shift to indicate literal
+        }
+        else if ((last - 1)->get() == value || suboffset > s_max_offset) {
+            // Only duplicates, or too deep to branch further. The entries are
+            // already sorted by value and object key.
+            IntegerColumn list(alloc);
+            list.create(); // Throws
+            for (const BulkEntry* e = first; e != last; ++e)
+                list.add(e->key.value); // Throws
+            slot = int64_t(list.get_ref());
+        }
+        else {
+            slot = int64_t(build_bulk(alloc, first, last, suboffset)); // Throws
+        }
+
+        if (!leaf) {
+            leaf.reset(create_node(alloc, true)); // Throws
+            get_child(*leaf, 0, keys);
+        }
+        keys.add(key);    // Throws
+        leaf->add(slot); // Throws
+        if (keys.size() == REALM_MAX_BPNODE_SIZE) {
+            nodes.push_back(leaf->get_ref());
+            leaf.reset();
+        }
+        first = last;
+    }
+    if (leaf || nodes.empty()) {
+        if (!leaf)
+            leaf.reset(create_node(alloc, true)); // Throws
+        nodes.push_back(leaf->get_ref());
+    }
+
+    while (nodes.size() > 1) {
+        std::vector<ref_type> parents;
+        for (size_t i = 0; i < nodes.size(); i += REALM_MAX_BPNODE_SIZE) {
+            StringIndex node(inner_node_tag(), alloc);
+            size_t n = std::min(nodes.size(), i + REALM_MAX_BPNODE_SIZE);
+            for (size_t j = i; j < n; ++j)
+                node.node_add_key(nodes[j]); // Throws
+            parents.push_back(node.get_ref());
+        }
+        nodes = std::move(parents);
+    }
+    return nodes[0];
+}
+
+void StringIndex::insert_bulk()
+{
+    REALM_ASSERT(is_empty());
+
+    std::vector<BulkEntry> entries;
+    entries.reserve(m_target_column.size());
+    DataType type = m_target_column.get_data_type();
+    bool nullable = m_target_column.is_nullable();
+    if (type == type_Int) {
+        if (nullable) {
+            collect_bulk_entries<util::Optional<int64_t>>(entries);
+        }
+        else {
+            collect_bulk_entries<int64_t>(entries);
+        }
+    }
+    else if (type == type_Bool) {
+        if (nullable) {
+            collect_bulk_entries<util::Optional<bool>>(entries);
+        }
+        else {
+            collect_bulk_entries<bool>(entries);
+        }
+    }
+    else if (type == type_String) {
+        collect_bulk_entries<String>(entries);
+    }
+    else if (type == type_Timestamp) {
+        collect_bulk_entries<Timestamp>(entries);
+    }
+    else {
+        REALM_ASSERT_RELEASE(false && "Data type does not support search index");
+    }
+    if (entries.empty())
+        return;
+
+    std::sort(entries.begin(), entries.end(), bulk_entry_less);
+
+    ref_type ref = build_bulk(m_array->get_alloc(), entries.data(), entries.data() + entries.size(), 0); // Throws
+    m_array->destroy_deep();
+    m_array->init_from_ref(ref);
+    m_array->update_parent();
+}
+
 namespace {
 
 bool has_duplicate_values(const Array& node, const ClusterColumn& target_col) noexcept
@@ -1494,14 +1808,14 @@ void StringIndex::verify() const
         }
     }
     else {
-        size_t column_size = m_target_column.size();
         for (size_t i = 1; i < array_size; ++i) {
             int64_t ref = m_array->get(i);
 
             // low bit set indicate literal ref (shifted)
             if (ref & 1) {
-                size_t r = to_size_t((uint64_t(ref) >> 1));
-                REALM_ASSERT_EX(r < column_size, r, column_size);
+                // Object keys are not dense, so check that the object exists
+                ObjKey k = ObjKey(int64_t(uint64_t(ref) >> 1));
+                REALM_ASSERT_EX(m_target_column.get_cluster_tree()->is_valid(k), k.value);
             }
             else {
                 // A real ref either points to a list or a subindex
@@ -22,6 +22,7 @@
 #include <cstring>
 #include <memory>
 #include <array>
+#include <vector>
 
 #include <realm/array.hpp>
 #include <realm/cluster_tree.hpp>
@@ -141,8 +142,13 @@ public:
     {
         return m_column_key;
     }
+    const ClusterTree* get_cluster_tree() const
+    {
+        return m_cluster_tree;
+    }
     bool is_nullable() const;
     StringData get_index_data(ObjKey key, StringConversionBuffer& buffer) const;
+    Mixed get_value(ObjKey key) const;
 
 private:
     const ClusterTree* m_cluster_tree;
@@ -204,6 +210,12 @@ public:
 
     void erase(ObjKey key);
 
+    /// Fill an empty index with the values of all objects in the target
+    /// column. The values are collected cluster by cluster and sorted, and the
+    /// nodes are then built bottom-up, which is much faster than inserting the
+    /// objects one at a time.
+    void insert_bulk();
+
     template <class T>
     ObjKey find_first(T value) const;
     template <class T>
@@ -212,12 +224,19 @@ public:
     FindRes find_all_no_copy(T value, InternalFindResult& result) const;
     template <class T>
     size_t count(T value) const;
+    /// Add the objects with a value starting with `prefix` to `result`,
+    /// ordered by key. Returns false, without adding anything, if the case
+    /// variants of the prefix differ in length so that they cannot be looked
+    /// up byte by byte.
+    bool find_all_prefix(StringData prefix, std::vector<ObjKey>& result, bool case_insensitive = false) const;
     template <class T>
     void update_ref(T value, size_t old_row_ndx, size_t new_row_ndx);
 
     void clear();
 
     void distinct(BPlusTree<ObjKey>& result) const;
+    /// The number of distinct values, null included, in the indexed column
+    size_t count_distinct() const;
     bool has_duplicate_values() const noexcept;
 
     void verify() const;
@@ -273,6 +292,41 @@ private:
 
     static IndexArray* create_node(Allocator&, bool is_leaf);
 
+    // A value and its object, as collected by insert_bulk(). Strings point
+    // into the cluster leaves, which are not modified while the index is
+    // built. Other types are converted into `buffer`, as the entries are
+    // moved around by the sort.
+    struct BulkEntry {
+        StringData value;
+        bool converted;
+        StringConversionBuffer buffer;
+        ObjKey key;
+
+        StringData get() const noexcept
+        {
+            return converted ? StringData(buffer.data(), value.size()) : value;
+        }
+    };
+    template <class T>
+    void collect_bulk_entries(std::vector<BulkEntry>& entries) const;
+    static bool bulk_entry_less(const BulkEntry& a, const BulkEntry& b) noexcept;
+    // Build the (sub)index for the sorted entries [begin, end), which all
+    // have the same keys before `offset`. Returns the ref of the root.
+    static ref_type build_bulk(Allocator&, const BulkEntry* begin, const BulkEntry* end, size_t offset);
+    // Call `callback` with the key of one object for every distinct value
+    template <class Callback>
+    void for_each_distinct(Callback&& callback) const;
+
+    struct PrefixSearch;
+    // Look up the prefix in this (sub)index, whose values share the first
+    // `offset` bytes
+    void find_all_prefix(const PrefixSearch&, size_t offset, std::vector<ObjKey>& result) const;
+    // Look up the entries with a key in [first, last] in this node
+    void find_prefix_range(const PrefixSearch&, size_t offset, key_type first, key_type last,
+                           std::vector<ObjKey>& result) const;
+    // Add all objects below the entry `ref`, checking their value if `check`
+    void collect_prefix_matches(const PrefixSearch&, int64_t ref, bool check, std::vector<ObjKey>& result) const;
+
     void insert_with_offset(ObjKey key, StringData value, size_t offset);
     void insert_row_list(size_t ref, size_t offset, StringData value);
     void insert_to_existing_list(ObjKey key, StringData value, IntegerColumn& list);
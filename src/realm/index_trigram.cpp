@@ -0,0 +1,280 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/index_trigram.hpp>
+#include <realm/column_integer.hpp>
+
+#include <algorithm>
+
+using namespace realm;
+
+namespace {
+
+inline unsigned char fold_ascii(unsigned char c) noexcept
+{
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+inline size_t trigram_byte(TrigramIndex::trigram_type trigram, int level) noexcept
+{
+    return (trigram >> (8 * (2 - level))) & 0xff;
+}
+
+} // anonymous namespace
+
+
+void TrigramIndex::get_trigrams(StringData value, std::vector<trigram_type>& trigrams, bool ascii_only)
+{
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(value.data());
+    for (size_t i = 0; i + 3 <= value.size(); ++i) {
+        unsigned char c0 = data[i], c1 = data[i + 1], c2 = data[i + 2];
+        if (ascii_only && ((c0 | c1 | c2) & 0x80))
+            continue;
+        trigrams.push_back(trigram_type(fold_ascii(c0)) << 16 | trigram_type(fold_ascii(c1)) << 8 |
+                           trigram_type(fold_ascii(c2)));
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+}
+
+void TrigramIndex::create_node(Array& node)
+{
+    node.create(Array::type_HasRefs, false, s_node_size, 0); // Throws
+}
+
+void TrigramIndex::get_or_create_child(Array& parent, size_t ndx, Array& child)
+{
+    child.set_parent(&parent, ndx);
+    if (ref_type ref = parent.get_as_ref(ndx)) {
+        child.init_from_ref(ref);
+    }
+    else {
+        create_node(child);   // Throws
+        child.update_parent(); // Throws
+    }
+}
+
+ref_type TrigramIndex::get_list_ref(trigram_type trigram) const
+{
+    Allocator& alloc = get_alloc();
+    ref_type ref = m_top.get_as_ref(trigram_byte(trigram, 0));
+    for (int level = 1; ref && level < 3; ++level) {
+        char* header = alloc.translate(ref);
+        ref = to_ref(Array::get(header, trigram_byte(trigram, level)));
+    }
+    return ref;
+}
+
+void TrigramIndex::add_key(trigram_type trigram, ObjKey key)
+{
+    Allocator& alloc = get_alloc();
+    Array level_1(alloc);
+    Array level_2(alloc);
+    get_or_create_child(m_top, trigram_byte(trigram, 0), level_1);   // Throws
+    get_or_create_child(level_1, trigram_byte(trigram, 1), level_2); // Throws
+
+    IntegerColumn keys(alloc);
+    keys.set_parent(&level_2, trigram_byte(trigram, 2));
+    if (!keys.init_from_parent()) {
+        keys.create(); // Throws
+    }
+
+    // Objects are mostly created in key order, so check the back first
+    size_t sz = keys.size();
+    if (sz == 0 || keys.get(sz - 1) < key.value) {
+        keys.add(key.value); // Throws
+        return;
+    }
+    auto it = std::lower_bound(keys.cbegin(), keys.cend(), key.value);
+    if (it == keys.cend() || *it != key.value)
+        keys.insert(it.get_position(), key.value); // Throws
+}
+
+void TrigramIndex::remove_key(trigram_type trigram, ObjKey key)
+{
+    Allocator& alloc = get_alloc();
+    Array level_1(alloc);
+    Array level_2(alloc);
+    ref_type ref = m_top.get_as_ref(trigram_byte(trigram, 0));
+    if (!ref)
+        return;
+    level_1.init_from_ref(ref);
+    level_1.set_parent(&m_top, trigram_byte(trigram, 0));
+    ref = level_1.get_as_ref(trigram_byte(trigram, 1));
+    if (!ref)
+        return;
+    level_2.init_from_ref(ref);
+    level_2.set_parent(&level_1, trigram_byte(trigram, 1));
+
+    IntegerColumn keys(alloc);
+    keys.set_parent(&level_2, trigram_byte(trigram, 2));
+    if (!keys.init_from_parent())
+        return;
+
+    auto it = std::lower_bound(keys.cbegin(), keys.cend(), key.value);
+    if (it == keys.cend() || *it != key.value)
+        return;
+    if (keys.size() == 1) {
+        keys.destroy();
+        level_2.set(trigram_byte(trigram, 2), 0); // Throws
+    }
+    else {
+        keys.erase(it.get_position()); // Throws
+    }
+}
+
+void TrigramIndex::insert(ObjKey key, StringData value)
+{
+    std::vector<trigram_type> trigrams;
+    get_trigrams(value, trigrams);
+    for (auto trigram : trigrams)
+        add_key(trigram, key); // Throws
+}
+
+void TrigramIndex::set(ObjKey key, StringData new_value)
+{
+    StringConversionBuffer buffer;
+    StringData old_value = m_target_column.get_index_data(key, buffer);
+    if (old_value == new_value)
+        return;
+
+    std::vector<trigram_type> old_trigrams;
+    std::vector<trigram_type> new_trigrams;
+    get_trigrams(old_value, old_trigrams);
+    get_trigrams(new_value, new_trigrams);
+
+    // Only touch the lists of the trigrams which are gained or lost
+    std::vector<trigram_type> diff;
+    std::set_difference(old_trigrams.begin(), old_trigrams.end(), new_trigrams.begin(), new_trigrams.end(),
+                        std::back_inserter(diff));
+    for (auto trigram : diff)
+        remove_key(trigram, key); // Throws
+    diff.clear();
+    std::set_difference(new_trigrams.begin(), new_trigrams.end(), old_trigrams.begin(), old_trigrams.end(),
+                        std::back_inserter(diff));
+    for (auto trigram : diff)
+        add_key(trigram, key); // Throws
+}
+
+void TrigramIndex::erase(ObjKey key)
+{
+    StringConversionBuffer buffer;
+    StringData old_value = m_target_column.get_index_data(key, buffer);
+    std::vector<trigram_type> trigrams;
+    get_trigrams(old_value, trigrams);
+    for (auto trigram : trigrams)
+        remove_key(trigram, key); // Throws
+}
+
+void TrigramIndex::clear()
+{
+    Allocator& alloc = get_alloc();
+    for (size_t i = 0; i < s_node_size; ++i) {
+        if (ref_type ref = m_top.get_as_ref(i)) {
+            Array::destroy_deep(ref, alloc);
+            m_top.set(i, 0); // Throws
+        }
+    }
+}
+
+size_t TrigramIndex::count(trigram_type trigram) const
+{
+    ref_type ref = get_list_ref(trigram);
+    return ref ? IntegerColumn(get_alloc(), ref).size() : 0;
+}
+
+bool TrigramIndex::find_candidates(const std::vector<StringData>& fragments, bool case_insensitive,
+                                   std::vector<ObjKey>& result) const
+{
+    std::vector<trigram_type> trigrams;
+    for (auto fragment : fragments)
+        get_trigrams(fragment, trigrams, case_insensitive);
+    if (trigrams.empty())
+        return false;
+
+    Allocator& alloc = get_alloc();
+    std::vector<std::pair<size_t, ref_type>> lists;
+    for (auto trigram : trigrams) {
+        ref_type ref = get_list_ref(trigram);
+        if (!ref)
+            return true; // No value contains this trigram
+        lists.emplace_back(IntegerColumn(alloc, ref).size(), ref);
+    }
+
+    // Intersect the lists, starting with the shortest one
+    std::sort(lists.begin(), lists.end());
+    IntegerColumn shortest(alloc, lists[0].second);
+    std::vector<int64_t> keys;
+    keys.reserve(shortest.size());
+    for (size_t i = 0; i < shortest.size(); ++i)
+        keys.push_back(shortest.get(i));
+
+    for (size_t l = 1; l < lists.size() && !keys.empty(); ++l) {
+        IntegerColumn list(alloc, lists[l].second);
+        auto pos = list.cbegin();
+        auto end = list.cend();
+        auto out = keys.begin();
+        for (int64_t key : keys) {
+            pos = std::lower_bound(pos, end, key);
+            if (pos == end)
+                break;
+            if (*pos == key)
+                *out++ = key;
+        }
+        keys.erase(out, keys.end());
+    }
+
+    result.reserve(result.size() + keys.size());
+    for (int64_t key : keys)
+        result.push_back(ObjKey(key));
+    return true;
+}
+
+void TrigramIndex::verify() const
+{
+#ifdef REALM_DEBUG
+    Allocator& alloc = get_alloc();
+    REALM_ASSERT(m_top.size() == s_node_size);
+    for (size_t b0 = 0; b0 < s_node_size; ++b0) {
+        ref_type ref_1 = m_top.get_as_ref(b0);
+        if (!ref_1)
+            continue;
+        Array level_1(alloc);
+        level_1.init_from_ref(ref_1);
+        REALM_ASSERT(level_1.size() == s_node_size);
+        for (size_t b1 = 0; b1 < s_node_size; ++b1) {
+            ref_type ref_2 = level_1.get_as_ref(b1);
+            if (!ref_2)
+                continue;
+            Array level_2(alloc);
+            level_2.init_from_ref(ref_2);
+            REALM_ASSERT(level_2.size() == s_node_size);
+            for (size_t b2 = 0; b2 < s_node_size; ++b2) {
+                ref_type ref = level_2.get_as_ref(b2);
+                if (!ref)
+                    continue;
+                // Key lists are never empty, and sorted without duplicates
+                IntegerColumn keys(alloc, ref);
+                REALM_ASSERT(keys.size() > 0);
+                for (size_t i = 1; i < keys.size(); ++i)
+                    REALM_ASSERT(keys.get(i - 1) < keys.get(i));
+            }
+        }
+    }
+#endif
+}
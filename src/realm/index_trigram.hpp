@@ -0,0 +1,154 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_INDEX_TRIGRAM_HPP
+#define REALM_INDEX_TRIGRAM_HPP
+
+#include <realm/array.hpp>
+#include <realm/index_string.hpp>
+
+#include <vector>
+
+namespace realm {
+
+/// A trigram index maps every three byte sequence occurring in the values of
+/// a string column to the objects whose value contains it. It narrows
+/// `contains`, `like`, `begins_with` and `ends_with` queries down to a set of
+/// candidates, which the query then checks against the actual condition.
+/// ASCII letters are folded to lower case, so the same index serves the case
+/// insensitive variants of those conditions.
+///
+/// The trigrams are kept in a trie with one level per byte, where every node
+/// is an array of 256 refs (zero for absent children). The children of the
+/// last level are sorted lists of object keys.
+class TrigramIndex {
+public:
+    using trigram_type = uint32_t;
+
+    TrigramIndex(const ClusterColumn& target_column, Allocator&);
+    TrigramIndex(ref_type, ArrayParent*, size_t ndx_in_parent, const ClusterColumn& target_column, Allocator&);
+
+    static bool type_supported(realm::DataType type)
+    {
+        return type == type_String;
+    }
+
+    // Accessor concept:
+    Allocator& get_alloc() const noexcept;
+    void destroy() noexcept;
+    void set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept;
+    void update_from_parent(size_t old_baseline) noexcept;
+    void refresh_accessor_tree(const ClusterColumn& target_column);
+    ref_type get_ref() const noexcept;
+
+    // TrigramIndex interface:
+
+    void insert(ObjKey key, StringData value);
+    // set() and erase() read the old value from the target column, so they
+    // must be called before the column is modified.
+    void set(ObjKey key, StringData new_value);
+    void erase(ObjKey key);
+    void clear();
+
+    /// Find the objects whose value contains every trigram of every string in
+    /// \a fragments and add them to \a result in key order. With \a
+    /// case_insensitive, trigrams holding non-ASCII bytes are skipped since
+    /// the bytes of their other case are not known. Returns false, leaving \a
+    /// result untouched, if there is no usable trigram at all; in that case
+    /// the index cannot narrow down the search.
+    bool find_candidates(const std::vector<StringData>& fragments, bool case_insensitive,
+                         std::vector<ObjKey>& result) const;
+
+    /// Number of objects with a value containing \a trigram.
+    size_t count(trigram_type trigram) const;
+
+    /// Add the distinct trigrams of \a value to \a trigrams, which is left
+    /// sorted and without duplicates. ASCII letters are folded to lower case.
+    static void get_trigrams(StringData value, std::vector<trigram_type>& trigrams, bool ascii_only = false);
+
+    void verify() const;
+
+private:
+    static constexpr size_t s_node_size = 256;
+
+    Array m_top;
+    ClusterColumn m_target_column;
+
+    static void create_node(Array& node);
+    // Attach `child` to the node at `ndx` in `parent`, creating it if needed
+    static void get_or_create_child(Array& parent, size_t ndx, Array& child);
+    // The ref of the key list for `trigram`, or 0 if no value contains it
+    ref_type get_list_ref(trigram_type trigram) const;
+
+    void add_key(trigram_type trigram, ObjKey key);
+    void remove_key(trigram_type trigram, ObjKey key);
+};
+
+
+// Implementation:
+
+inline TrigramIndex::TrigramIndex(const ClusterColumn& target_column, Allocator& alloc)
+    : m_top(alloc)
+    , m_target_column(target_column)
+{
+    create_node(m_top); // Throws
+}
+
+inline TrigramIndex::TrigramIndex(ref_type ref, ArrayParent* parent, size_t ndx_in_parent,
+                                  const ClusterColumn& target_column, Allocator& alloc)
+    : m_top(alloc)
+    , m_target_column(target_column)
+{
+    m_top.init_from_ref(ref);
+    m_top.set_parent(parent, ndx_in_parent);
+}
+
+inline Allocator& TrigramIndex::get_alloc() const noexcept
+{
+    return m_top.get_alloc();
+}
+
+inline void TrigramIndex::destroy() noexcept
+{
+    m_top.destroy_deep();
+}
+
+inline void TrigramIndex::set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept
+{
+    m_top.set_parent(parent, ndx_in_parent);
+}
+
+inline void TrigramIndex::update_from_parent(size_t old_baseline) noexcept
+{
+    m_top.update_from_parent(old_baseline);
+}
+
+inline void TrigramIndex::refresh_accessor_tree(const ClusterColumn& target_column)
+{
+    m_top.init_from_parent();
+    m_target_column = target_column;
+}
+
+inline ref_type TrigramIndex::get_ref() const noexcept
+{
+    return m_top.get_ref();
+}
+
+} // namespace realm
+
+#endif // REALM_INDEX_TRIGRAM_HPP
@@ -0,0 +1,439 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/key_bitmap.hpp>
+#include <realm/node.hpp>
+#include <realm/utilities.hpp>
+
+#include <algorithm>
+#include <iterator>
+
+using namespace realm;
+
+namespace {
+
+inline size_t count_bits(uint64_t word) noexcept
+{
+    return size_t(fast_popcount64(int64_t(word)));
+}
+
+} // anonymous namespace
+
+
+bool KeyBitmap::Block::contains(uint16_t low) const noexcept
+{
+    if (is_bitmap())
+        return (bitmap[low >> 6] >> (low & 63)) & 1;
+    return std::binary_search(array.begin(), array.end(), low);
+}
+
+void KeyBitmap::Block::recount() noexcept
+{
+    size = 0;
+    for (size_t i = 0; i < s_bitmap_words; ++i) {
+        if (i % s_rank_words == 0)
+            ranks[i / s_rank_words] = uint16_t(size);
+        size += count_bits(bitmap[i]);
+    }
+}
+
+void KeyBitmap::Block::to_bitmap()
+{
+    bitmap.assign(s_bitmap_words, 0);               // Throws
+    ranks.assign(s_bitmap_words / s_rank_words, 0); // Throws
+    for (uint16_t low : array)
+        bitmap[low >> 6] |= uint64_t(1) << (low & 63);
+    std::vector<uint16_t>().swap(array);
+    recount();
+}
+
+void KeyBitmap::Block::to_array()
+{
+    std::vector<uint16_t> result;
+    result.reserve(size); // Throws
+    for (size_t i = 0; i < s_bitmap_words; ++i) {
+        uint64_t word = bitmap[i];
+        while (word) {
+            result.push_back(uint16_t(i * 64 + lowest_bit(word)));
+            word &= word - 1;
+        }
+    }
+    array.swap(result);
+    std::vector<uint64_t>().swap(bitmap);
+    std::vector<uint16_t>().swap(ranks);
+}
+
+void KeyBitmap::Block::normalize()
+{
+    if (is_bitmap() && size <= s_max_array_size) {
+        to_array(); // Throws
+    }
+    else if (!is_bitmap() && size > s_max_array_size) {
+        to_bitmap(); // Throws
+    }
+}
+
+
+KeyBitmap::KeyBitmap(const std::vector<ObjKey>& keys)
+{
+    for (ObjKey key : keys)
+        add(key); // Throws
+}
+
+auto KeyBitmap::find_block(uint64_t high) noexcept -> Block*
+{
+    auto it = std::lower_bound(m_blocks.begin(), m_blocks.end(), high,
+                               [](const Block& block, uint64_t h) { return block.high < h; });
+    return (it != m_blocks.end() && it->high == high) ? &*it : nullptr;
+}
+
+auto KeyBitmap::find_block(uint64_t high) const noexcept -> const Block*
+{
+    return const_cast<KeyBitmap*>(this)->find_block(high);
+}
+
+void KeyBitmap::update_begin() noexcept
+{
+    m_size = 0;
+    for (auto& block : m_blocks) {
+        block.begin = m_size;
+        m_size += block.size;
+    }
+}
+
+void KeyBitmap::add(ObjKey key)
+{
+    uint64_t bits = to_bits(key);
+    uint64_t high = bits >> 16;
+    uint16_t low = uint16_t(bits);
+
+    // Keys usually come in ascending order, so try the last block first
+    Block* block;
+    if (m_blocks.empty() || m_blocks.back().high < high) {
+        m_blocks.emplace_back(high); // Throws
+        block = &m_blocks.back();
+        block->begin = m_size;
+    }
+    else if (m_blocks.back().high == high) {
+        block = &m_blocks.back();
+    }
+    else {
+        auto it = std::lower_bound(m_blocks.begin(), m_blocks.end(), high,
+                                   [](const Block& b, uint64_t h) { return b.high < h; });
+        if (it->high != high)
+            it = m_blocks.emplace(it, high); // Throws
+        block = &*it;
+    }
+
+    if (block->is_bitmap()) {
+        uint64_t& word = block->bitmap[low >> 6];
+        uint64_t mask = uint64_t(1) << (low & 63);
+        if (word & mask)
+            return;
+        word |= mask;
+        for (size_t i = (low >> 6) / s_rank_words + 1; i < block->ranks.size(); ++i)
+            ++block->ranks[i];
+    }
+    else {
+        auto& array = block->array;
+        if (array.empty() || array.back() < low) {
+            array.push_back(low); // Throws
+        }
+        else {
+            auto it = std::lower_bound(array.begin(), array.end(), low);
+            if (*it == low)
+                return;
+            array.insert(it, low); // Throws
+        }
+    }
+    ++block->size;
+    ++m_size;
+    if (block != &m_blocks.back())
+        update_begin();
+    if (!block->is_bitmap() && block->size > s_max_array_size)
+        block->to_bitmap(); // Throws
+}
+
+bool KeyBitmap::contains(ObjKey key) const noexcept
+{
+    uint64_t bits = to_bits(key);
+    const Block* block = find_block(bits >> 16);
+    return block && block->contains(uint16_t(bits));
+}
+
+bool KeyBitmap::erase(ObjKey key)
+{
+    uint64_t bits = to_bits(key);
+    Block* block = find_block(bits >> 16);
+    uint16_t low = uint16_t(bits);
+    if (!block || !block->contains(low))
+        return false;
+
+    if (block->is_bitmap()) {
+        block->bitmap[low >> 6] &= ~(uint64_t(1) << (low & 63));
+        for (size_t i = (low >> 6) / s_rank_words + 1; i < block->ranks.size(); ++i)
+            --block->ranks[i];
+    }
+    else {
+        block->array.erase(std::lower_bound(block->array.begin(), block->array.end(), low));
+    }
+    if (--block->size == 0) {
+        m_blocks.erase(m_blocks.begin() + (block - m_blocks.data()));
+    }
+    else {
+        block->normalize(); // Throws
+    }
+    update_begin();
+    return true;
+}
+
+void KeyBitmap::clear() noexcept
+{
+    m_blocks.clear();
+    m_size = 0;
+}
+
+size_t KeyBitmap::get_memory_usage() const noexcept
+{
+    size_t bytes = m_blocks.size() * sizeof(Block);
+    for (auto& block : m_blocks) {
+        bytes += block.array.size() * sizeof(uint16_t) + block.bitmap.size() * sizeof(uint64_t) +
+                 block.ranks.size() * sizeof(uint16_t);
+    }
+    return bytes;
+}
+
+ObjKey KeyBitmap::get(size_t ndx) const noexcept
+{
+    REALM_ASSERT(ndx < m_size);
+    // The last block starting at or before `ndx`
+    auto it = std::upper_bound(m_blocks.begin(), m_blocks.end(), ndx,
+                               [](size_t n, const Block& block) { return n < block.begin; });
+    const Block& block = *(it - 1);
+    uint64_t base = block.high << 16;
+    size_t n = ndx - block.begin;
+    if (!block.is_bitmap())
+        return from_bits(base + block.array[n]);
+
+    // Find the words holding the key through the ranks, and then the word
+    auto rank = std::upper_bound(block.ranks.begin(), block.ranks.end(), n) - 1;
+    n -= *rank;
+    size_t i = size_t(rank - block.ranks.begin()) * s_rank_words;
+    for (;;) {
+        size_t bits = count_bits(block.bitmap[i]);
+        if (n < bits)
+            break;
+        n -= bits;
+        ++i;
+    }
+    uint64_t word = block.bitmap[i];
+    for (; n > 0; --n)
+        word &= word - 1;
+    return from_bits(base + i * 64 + lowest_bit(word));
+}
+
+size_t KeyBitmap::find(ObjKey key) const noexcept
+{
+    uint64_t bits = to_bits(key);
+    const Block* block = find_block(bits >> 16);
+    uint16_t low = uint16_t(bits);
+    if (!block || !block->contains(low))
+        return realm::npos;
+    if (!block->is_bitmap())
+        return block->begin + size_t(std::lower_bound(block->array.begin(), block->array.end(), low) -
+                                     block->array.begin());
+
+    size_t word_ndx = low >> 6;
+    size_t n = block->begin + block->ranks[word_ndx / s_rank_words];
+    for (size_t i = word_ndx - word_ndx % s_rank_words; i < word_ndx; ++i)
+        n += count_bits(block->bitmap[i]);
+    return n + count_bits(block->bitmap[word_ndx] & ((uint64_t(1) << (low & 63)) - 1));
+}
+
+std::vector<ObjKey> KeyBitmap::to_vector() const
+{
+    std::vector<ObjKey> keys;
+    keys.reserve(m_size); // Throws
+    for_each([&](ObjKey key) {
+        keys.push_back(key);
+        return false;
+    });
+    return keys;
+}
+
+KeyBitmap& KeyBitmap::operator|=(const KeyBitmap& other)
+{
+    std::vector<Block> result;
+    result.reserve(m_blocks.size() + other.m_blocks.size()); // Throws
+    auto a = m_blocks.begin(), a_end = m_blocks.end();
+    auto b = other.m_blocks.begin(), b_end = other.m_blocks.end();
+    while (a != a_end || b != b_end) {
+        if (b == b_end || (a != a_end && a->high < b->high)) {
+            result.push_back(std::move(*a++));
+            continue;
+        }
+        if (a == a_end || b->high < a->high) {
+            result.push_back(*b++); // Throws
+            continue;
+        }
+
+        Block block = std::move(*a++);
+        if (!block.is_bitmap() && !b->is_bitmap()) {
+            std::vector<uint16_t> merged;
+            merged.reserve(block.size + b->size); // Throws
+            std::set_union(block.array.begin(), block.array.end(), b->array.begin(), b->array.end(),
+                           std::back_inserter(merged));
+            block.size = merged.size();
+            block.array.swap(merged);
+            block.normalize(); // Throws
+        }
+        else {
+            if (!block.is_bitmap())
+                block.to_bitmap(); // Throws
+            if (b->is_bitmap()) {
+                for (size_t i = 0; i < s_bitmap_words; ++i)
+                    block.bitmap[i] |= b->bitmap[i];
+            }
+            else {
+                for (uint16_t low : b->array)
+                    block.bitmap[low >> 6] |= uint64_t(1) << (low & 63);
+            }
+            block.recount();
+        }
+        ++b;
+        result.push_back(std::move(block));
+    }
+
+    m_blocks.swap(result);
+    update_begin();
+    return *this;
+}
+
+KeyBitmap& KeyBitmap::operator&=(const KeyBitmap& other)
+{
+    std::vector<Block> result;
+    auto a = m_blocks.begin(), a_end = m_blocks.end();
+    auto b = other.m_blocks.begin(), b_end = other.m_blocks.end();
+    while (a != a_end && b != b_end) {
+        if (a->high < b->high) {
+            ++a;
+            continue;
+        }
+        if (b->high < a->high) {
+            ++b;
+            continue;
+        }
+
+        Block block = std::move(*a++);
+        if (!block.is_bitmap()) {
+            // Keep the keys of the array which are in the other block
+            auto& array = block.array;
+            if (b->is_bitmap()) {
+                array.erase(std::remove_if(array.begin(), array.end(), [&](uint16_t low) { return !b->contains(low); }),
+                            array.end());
+            }
+            else {
+                std::vector<uint16_t> common;
+                std::set_intersection(array.begin(), array.end(), b->array.begin(), b->array.end(),
+                                      std::back_inserter(common)); // Throws
+                array.swap(common);
+            }
+            block.size = array.size();
+        }
+        else if (!b->is_bitmap()) {
+            std::vector<uint16_t> common;
+            for (uint16_t low : b->array) {
+                if (block.contains(low))
+                    common.push_back(low); // Throws
+            }
+            block.array.swap(common);
+            block.size = block.array.size();
+            std::vector<uint64_t>().swap(block.bitmap);
+            std::vector<uint16_t>().swap(block.ranks);
+        }
+        else {
+            for (size_t i = 0; i < s_bitmap_words; ++i)
+                block.bitmap[i] &= b->bitmap[i];
+            block.recount();
+            block.normalize(); // Throws
+        }
+        ++b;
+        if (block.size)
+            result.push_back(std::move(block)); // Throws
+    }
+
+    m_blocks.swap(result);
+    update_begin();
+    return *this;
+}
+
+KeyBitmap& KeyBitmap::operator-=(const KeyBitmap& other)
+{
+    std::vector<Block> result;
+    result.reserve(m_blocks.size()); // Throws
+    auto b = other.m_blocks.begin(), b_end = other.m_blocks.end();
+    for (auto& a : m_blocks) {
+        while (b != b_end && b->high < a.high)
+            ++b;
+        if (b == b_end || b->high != a.high) {
+            result.push_back(std::move(a));
+            continue;
+        }
+
+        Block block = std::move(a);
+        if (!block.is_bitmap()) {
+            auto& array = block.array;
+            array.erase(std::remove_if(array.begin(), array.end(), [&](uint16_t low) { return b->contains(low); }),
+                        array.end());
+            block.size = array.size();
+        }
+        else {
+            if (b->is_bitmap()) {
+                for (size_t i = 0; i < s_bitmap_words; ++i)
+                    block.bitmap[i] &= ~b->bitmap[i];
+            }
+            else {
+                for (uint16_t low : b->array)
+                    block.bitmap[low >> 6] &= ~(uint64_t(1) << (low & 63));
+            }
+            block.recount();
+            block.normalize(); // Throws
+        }
+        if (block.size)
+            result.push_back(std::move(block));
+    }
+
+    m_blocks.swap(result);
+    update_begin();
+    return *this;
+}
+
+bool KeyBitmap::operator==(const KeyBitmap& other) const noexcept
+{
+    if (m_size != other.m_size || m_blocks.size() != other.m_blocks.size())
+        return false;
+    // A block is held as a bitmap if and only if it has more than
+    // s_max_array_size keys, so equal blocks are held the same way
+    for (size_t i = 0; i < m_blocks.size(); ++i) {
+        const Block& a = m_blocks[i];
+        const Block& b = other.m_blocks[i];
+        if (a.high != b.high || a.size != b.size || a.array != b.array || a.bitmap != b.bitmap)
+            return false;
+    }
+    return true;
+}
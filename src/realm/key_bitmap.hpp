@@ -0,0 +1,212 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_KEY_BITMAP_HPP
+#define REALM_KEY_BITMAP_HPP
+
+#include <realm/keys.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace realm {
+
+/// A compressed set of object keys, for holding and combining large query
+/// results.
+///
+/// The keys are split in blocks of 2^16 consecutive values. The keys of a
+/// block are held as a sorted array of their low 16 bits, or as a bitmap of
+/// 2^16 bits once there are more than 4096 of them, so a key takes at most two
+/// bytes, and dense ranges of keys much less. Union, intersection and
+/// difference work block by block. The keys can also be accessed by their
+/// position in ascending order, so a bitmap can hold the keys of a view.
+class KeyBitmap {
+public:
+    KeyBitmap() = default;
+    explicit KeyBitmap(const std::vector<ObjKey>& keys);
+
+    /// Adding keys in ascending order is cheapest.
+    void add(ObjKey key);
+    bool contains(ObjKey key) const noexcept;
+    /// Returns true if the key was in the set.
+    bool erase(ObjKey key);
+
+    size_t size() const noexcept;
+    bool empty() const noexcept;
+    void clear() noexcept;
+
+    /// The key at position `ndx` in ascending order, which must be less than
+    /// size().
+    ObjKey get(size_t ndx) const noexcept;
+    /// The position of `key` in ascending order, or `realm::npos` if it is not
+    /// in the set.
+    size_t find(ObjKey key) const noexcept;
+
+    /// The number of bytes used for holding the keys
+    size_t get_memory_usage() const noexcept;
+
+    /// Call `func` with each key, in ascending order. Stops if it returns true.
+    template <class F>
+    void for_each(F&& func) const;
+    std::vector<ObjKey> to_vector() const;
+
+    KeyBitmap& operator|=(const KeyBitmap& other);
+    KeyBitmap& operator&=(const KeyBitmap& other);
+    KeyBitmap& operator-=(const KeyBitmap& other);
+
+    bool operator==(const KeyBitmap& other) const noexcept;
+    bool operator!=(const KeyBitmap& other) const noexcept;
+
+private:
+    static constexpr size_t s_max_array_size = 4096;
+    static constexpr size_t s_bitmap_words = 1024;
+    // Words of the bitmap per entry in `ranks`
+    static constexpr size_t s_rank_words = 16;
+
+    struct Block {
+        // The high 48 bits of the keys
+        uint64_t high;
+        size_t size = 0;
+        // The number of keys in the blocks before this one
+        size_t begin = 0;
+        // The low 16 bits of the keys in ascending order, unless the bitmap is used
+        std::vector<uint16_t> array;
+        std::vector<uint64_t> bitmap;
+        // With the bitmap, the number of keys before every s_rank_words words
+        std::vector<uint16_t> ranks;
+
+        explicit Block(uint64_t h) noexcept
+            : high(h)
+        {
+        }
+        bool is_bitmap() const noexcept
+        {
+            return !bitmap.empty();
+        }
+        bool contains(uint16_t low) const noexcept;
+        // Recompute the size and ranks from the bitmap
+        void recount() noexcept;
+        // Switch between array and bitmap so that the size decides which is used
+        void normalize();
+        void to_bitmap();
+        void to_array();
+    };
+
+    // Ordered by `high`
+    std::vector<Block> m_blocks;
+    size_t m_size = 0;
+
+    // Keys are signed, so flip the sign bit to keep them ordered as unsigned
+    static uint64_t to_bits(ObjKey key) noexcept
+    {
+        return uint64_t(key.value) ^ (uint64_t(1) << 63);
+    }
+    static ObjKey from_bits(uint64_t bits) noexcept
+    {
+        return ObjKey(int64_t(bits ^ (uint64_t(1) << 63)));
+    }
+    static unsigned lowest_bit(uint64_t word) noexcept;
+
+    Block* find_block(uint64_t high) noexcept;
+    const Block* find_block(uint64_t high) const noexcept;
+    // Recompute the positions of the blocks and the total size
+    void update_begin() noexcept;
+};
+
+KeyBitmap operator|(KeyBitmap a, const KeyBitmap& b);
+KeyBitmap operator&(KeyBitmap a, const KeyBitmap& b);
+KeyBitmap operator-(KeyBitmap a, const KeyBitmap& b);
+
+
+// Implementation:
+
+inline size_t KeyBitmap::size() const noexcept
+{
+    return m_size;
+}
+
+inline bool KeyBitmap::empty() const noexcept
+{
+    return m_size == 0;
+}
+
+inline bool KeyBitmap::operator!=(const KeyBitmap& other) const noexcept
+{
+    return !(*this == other);
+}
+
+inline unsigned KeyBitmap::lowest_bit(uint64_t word) noexcept
+{
+#ifdef _MSC_VER
+    unsigned long bit;
+    _BitScanForward64(&bit, word);
+    return unsigned(bit);
+#else
+    return unsigned(__builtin_ctzll(word));
+#endif
+}
+
+template <class F>
+void KeyBitmap::for_each(F&& func) const
+{
+    for (auto& block : m_blocks) {
+        uint64_t base = block.high << 16;
+        if (block.is_bitmap()) {
+            for (size_t i = 0; i < s_bitmap_words; ++i) {
+                uint64_t word = block.bitmap[i];
+                while (word) {
+                    if (func(from_bits(base + i * 64 + lowest_bit(word))))
+                        return;
+                    word &= word - 1;
+                }
+            }
+        }
+        else {
+            for (uint16_t low : block.array) {
+                if (func(from_bits(base + low)))
+                    return;
+            }
+        }
+    }
+}
+
+inline KeyBitmap operator|(KeyBitmap a, const KeyBitmap& b)
+{
+    a |= b;
+    return a;
+}
+
+inline KeyBitmap operator&(KeyBitmap a, const KeyBitmap& b)
+{
+    a &= b;
+    return a;
+}
+
+inline KeyBitmap operator-(KeyBitmap a, const KeyBitmap& b)
+{
+    a -= b;
+    return a;
+}
+
+} // namespace realm
+
+#endif // REALM_KEY_BITMAP_HPP
@@ -180,6 +180,11 @@ std::pair<ref_type, size_t> ConstLstBase::get_to_dot_parent(size_t) const
     return {};
 }
 
+ListIndex* ConstLstBase::get_list_index() const
+{
+    return m_const_obj->get_table()->get_list_index(m_col_key);
+}
+
 void ConstLstBase::erase_repl(Replication* repl, size_t ndx) const
 {
     repl->list_erase(*this, ndx);
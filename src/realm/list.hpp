@@ -22,6 +22,7 @@
 #include <realm/obj.hpp>
 #include <realm/bplustree.hpp>
 #include <realm/obj_list.hpp>
+#include <realm/index_list.hpp>
 #include <realm/array_basic.hpp>
 #include <realm/array_key.hpp>
 #include <realm/array_bool.hpp>
@@ -212,6 +213,8 @@ protected:
         }
         m_deleted.insert(it, ndx);
     }
+    // The search index of the column, if it has one
+    ListIndex* get_list_index() const;
     void erase_repl(Replication* repl, size_t ndx) const;
     void move_repl(Replication* repl, size_t from, size_t to) const;
     void swap_repl(Replication* repl, size_t ndx1, size_t ndx2) const;
@@ -676,6 +679,9 @@ public:
             if (Replication* repl = this->m_const_obj->get_replication()) {
                 ConstLstBase::clear_repl(repl);
             }
+            if (ListIndex* index = this->get_list_index()) {
+                index->erase(m_obj.get_key());
+            }
             m_tree->clear();
             m_obj.bump_content_version();
         }
@@ -704,14 +710,23 @@ protected:
     }
     void do_set(size_t ndx, T value)
     {
+        if (ListIndex* index = this->get_list_index()) {
+            index->set(m_obj.get_key(), get(ndx), value);
+        }
         m_tree->set(ndx, value);
     }
     void do_insert(size_t ndx, T value)
     {
+        if (ListIndex* index = this->get_list_index()) {
+            index->insert(m_obj.get_key(), value);
+        }
         m_tree->insert(ndx, value);
     }
     void do_remove(size_t ndx)
     {
+        if (ListIndex* index = this->get_list_index()) {
+            index->erase(m_obj.get_key(), get(ndx));
+        }
         m_tree->erase(ndx);
     }
     void set_repl(Replication* repl, size_t ndx, T value);
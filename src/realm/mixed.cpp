@@ -84,6 +84,19 @@ inline int compare_float(Float a_raw, Float b_raw)
     // nans are treated as being less than all non-nan values
     return a_nan ? -1 : 1;
 }
+
+// Consistent with compare_float(): -0.0 equals 0.0, and NaNs are compared by
+// their bits
+template <typename Float>
+inline uint64_t hash_float(Float value) noexcept
+{
+    if (value == 0)
+        value = 0;
+    using IntType = typename _impl::IntTypeForSize<sizeof(Float)>::type;
+    IntType bits;
+    memcpy(&bits, &value, sizeof(Float));
+    return uint64_t(bits);
+}
 } // namespace _impl
 
 int Mixed::compare(const Mixed& b) const
@@ -141,6 +154,42 @@ int Mixed::compare(const Mixed& b) const
     return 0;
 }
 
+uint64_t Mixed::hash() const noexcept
+{
+    if (is_null())
+        return 0;
+    switch (get_type()) {
+        case type_Int:
+            return uint64_t(get<int64_t>());
+        case type_Bool:
+            return get<bool>() ? 2 : 1;
+        case type_Float:
+            return _impl::hash_float(get<float>());
+        case type_Double:
+            return _impl::hash_float(get<double>());
+        case type_String: {
+            StringData str = get<StringData>();
+            return murmur2_or_cityhash(reinterpret_cast<const unsigned char*>(str.data()), str.size());
+        }
+        case type_Binary: {
+            BinaryData bin = get<BinaryData>();
+            return murmur2_or_cityhash(reinterpret_cast<const unsigned char*>(bin.data()), bin.size());
+        }
+        case type_Timestamp: {
+            Timestamp ts = get<Timestamp>();
+            return uint64_t(ts.get_seconds()) * 1000000007 + uint64_t(ts.get_nanoseconds());
+        }
+        case type_Link:
+            return uint64_t(get<ObjKey>().value);
+        case type_OldTable:
+        case type_OldDateTime:
+        case type_OldMixed:
+        case type_LinkList:
+            break;
+    }
+    return 0;
+}
+
 // LCOV_EXCL_START
 std::ostream& operator<<(std::ostream& out, const Mixed& m)
 {
@@ -166,6 +166,8 @@ public:
 
     bool is_null() const;
     int compare(const Mixed& b) const;
+    /// Values which compare equal have the same hash.
+    uint64_t hash() const noexcept;
     bool operator==(const Mixed& other) const
     {
         return compare(other) == 0;
@@ -27,7 +27,11 @@
 #include "realm/array_key.hpp"
 #include "realm/array_backlink.hpp"
 #include "realm/column_type_traits.hpp"
+#include "realm/index_composite.hpp"
+#include "realm/index_hash.hpp"
+#include "realm/index_range.hpp"
 #include "realm/index_string.hpp"
+#include "realm/index_trigram.hpp"
 #include "realm/cluster_tree.hpp"
 #include "realm/spec.hpp"
 #include "realm/table_view.hpp"
@@ -791,6 +795,18 @@ Obj& Obj::set(ColKey col_key, Mixed value)
     return *this;
 }
 
+namespace {
+// Composite indexes read the other values of the object, so this must be
+// called before the value is changed
+void update_composite_indexes(const Table& table, ColKey col_key, ObjKey key, Mixed value)
+{
+    for (CompositeIndex* index : table.get_composite_indexes()) {
+        if (index->has_column(col_key))
+            index->set(key, col_key, value);
+    }
+}
+}
+
 template <>
 Obj& Obj::set<int64_t>(ColKey col_key, int64_t value, bool is_default)
 {
@@ -806,6 +822,13 @@ Obj& Obj::set<int64_t>(ColKey col_key, int64_t value, bool is_default)
     if (StringIndex* index = m_table->get_search_index(col_key)) {
         index->set<int64_t>(m_key, value);
     }
+    if (RangeIndex* index = m_table->get_range_index(col_key)) {
+        index->set(m_key, value);
+    }
+    if (HashIndex* index = m_table->get_hash_index(col_key)) {
+        index->set(m_key, value);
+    }
+    update_composite_indexes(*m_table, col_key, m_key, value);
 
     Allocator& alloc = get_alloc();
     alloc.bump_content_version();
@@ -864,6 +887,13 @@ Obj& Obj::add_int(ColKey col_key, int64_t value)
             if (StringIndex* index = m_table->get_search_index(col_key)) {
                 index->set<int64_t>(m_key, new_val);
             }
+            if (RangeIndex* index = m_table->get_range_index(col_key)) {
+                index->set(m_key, new_val);
+            }
+            if (HashIndex* index = m_table->get_hash_index(col_key)) {
+                index->set(m_key, new_val);
+            }
+            update_composite_indexes(*m_table, col_key, m_key, new_val);
             values.set(m_row_ndx, new_val);
         }
         else {
@@ -879,6 +909,13 @@ Obj& Obj::add_int(ColKey col_key, int64_t value)
         if (StringIndex* index = m_table->get_search_index(col_key)) {
             index->set<int64_t>(m_key, new_val);
         }
+        if (RangeIndex* index = m_table->get_range_index(col_key)) {
+            index->set(m_key, new_val);
+        }
+        if (HashIndex* index = m_table->get_hash_index(col_key)) {
+            index->set(m_key, new_val);
+        }
+        update_composite_indexes(*m_table, col_key, m_key, new_val);
         values.set(m_row_ndx, new_val);
     }
 
@@ -951,6 +988,51 @@ inline void check_range(const BinaryData& val)
     if (REALM_UNLIKELY(val.size() > ArrayBlob::max_binary_size))
         throw LogicError(LogicError::binary_too_big);
 }
+
+// Only string columns can have a trigram index
+template <class T>
+inline void update_trigram_index(const Table&, ColKey, ObjKey, const T&)
+{
+}
+inline void update_trigram_index(const Table& table, ColKey col_key, ObjKey key, StringData value)
+{
+    if (TrigramIndex* index = table.get_trigram_index(col_key))
+        index->set(key, value);
+}
+
+// Ints are handled by Obj::set<int64_t>() and Obj::add_int()
+template <class T>
+inline void update_range_index(const Table&, ColKey, ObjKey, const T&)
+{
+}
+inline void update_range_index_value(const Table& table, ColKey col_key, ObjKey key, Mixed value)
+{
+    if (RangeIndex* index = table.get_range_index(col_key))
+        index->set(key, value);
+}
+inline void update_range_index(const Table& table, ColKey col_key, ObjKey key, float value)
+{
+    update_range_index_value(table, col_key, key, value);
+}
+inline void update_range_index(const Table& table, ColKey col_key, ObjKey key, double value)
+{
+    update_range_index_value(table, col_key, key, value);
+}
+inline void update_range_index(const Table& table, ColKey col_key, ObjKey key, Timestamp value)
+{
+    update_range_index_value(table, col_key, key, value);
+}
+
+// Ints are handled by Obj::set<int64_t>() and Obj::add_int()
+template <class T>
+inline void update_hash_index(const Table&, ColKey, ObjKey, const T&)
+{
+}
+inline void update_hash_index(const Table& table, ColKey col_key, ObjKey key, StringData value)
+{
+    if (HashIndex* index = table.get_hash_index(col_key))
+        index->set(key, value);
+}
 }
 
 // helper functions for filtering out calls to set_spec()
@@ -986,6 +1068,10 @@ Obj& Obj::set(ColKey col_key, T value, bool is_default)
     if (StringIndex* index = m_table->get_search_index(col_key)) {
         index->set<T>(m_key, value);
     }
+    update_trigram_index(*m_table, col_key, m_key, value);
+    update_range_index(*m_table, col_key, m_key, value);
+    update_hash_index(*m_table, col_key, m_key, value);
+    update_composite_indexes(*m_table, col_key, m_key, value);
 
     Allocator& alloc = get_alloc();
     alloc.bump_content_version();
@@ -1276,6 +1362,16 @@ Obj& Obj::set_null(ColKey col_key, bool is_default)
         if (StringIndex* index = m_table->get_search_index(col_key)) {
             index->set(m_key, null{});
         }
+        if (TrigramIndex* index = m_table->get_trigram_index(col_key)) {
+            index->set(m_key, StringData());
+        }
+        if (RangeIndex* index = m_table->get_range_index(col_key)) {
+            index->set(m_key, Mixed());
+        }
+        if (HashIndex* index = m_table->get_hash_index(col_key)) {
+            index->set(m_key, Mixed());
+        }
+        update_composite_indexes(*m_table, col_key, m_key, Mixed());
 
         switch (col_type) {
             case col_type_Int:
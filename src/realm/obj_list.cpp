@@ -24,12 +24,14 @@ using namespace realm;
 
 size_t ObjList::size() const
 {
-    return m_key_values->size();
+    return m_key_bitmap ? m_key_bitmap->size() : m_key_values->size();
 }
 
 // Get key for object this view is "looking" at.
 ObjKey ObjList::get_key(size_t ndx) const
 {
+    if (m_key_bitmap)
+        return m_key_bitmap->get(ndx);
     return ObjKey(m_key_values->get(ndx));
 }
 
@@ -37,6 +39,7 @@ void ObjList::do_sort(const DescriptorOrdering& ordering)
 {
     if (ordering.is_empty())
         return;
+    REALM_ASSERT(!m_key_bitmap);
     size_t sz = size();
     if (sz == 0)
         return;
@@ -101,8 +104,8 @@ ObjList::ObjList(KeyColumn* key_values, ConstTableRef parent)
 ConstObj ObjList::get_object(size_t row_ndx) const
 {
     REALM_ASSERT(m_table);
-    REALM_ASSERT(row_ndx < m_key_values->size());
-    ObjKey key(m_key_values->get(row_ndx));
+    REALM_ASSERT(row_ndx < size());
+    ObjKey key = get_key(row_ndx);
     REALM_ASSERT(key != realm::null_key);
     return m_table->get_object(key);
 }
@@ -110,8 +113,8 @@ ConstObj ObjList::get_object(size_t row_ndx) const
 ConstObj ObjList::try_get_object(size_t row_ndx) const
 {
     REALM_ASSERT(m_table);
-    REALM_ASSERT(row_ndx < m_key_values->size());
-    ObjKey key(m_key_values->get(row_ndx));
+    REALM_ASSERT(row_ndx < size());
+    ObjKey key = get_key(row_ndx);
     REALM_ASSERT(key != realm::null_key);
     return m_table->is_valid(key) ? m_table->get_object(key) : ConstObj();
 }
@@ -22,6 +22,7 @@
 #include <realm/array_key.hpp>
 #include <realm/table_ref.hpp>
 #include <realm/handover_defs.hpp>
+#include <realm/key_bitmap.hpp>
 #include <realm/obj.hpp>
 
 namespace realm {
@@ -105,6 +106,9 @@ protected:
     // Null if, and only if, the view is detached.
     mutable ConstTableRef m_table;
     KeyColumn* m_key_values = nullptr;
+    // If not null, the keys are held here in ascending order instead of in
+    // m_key_values
+    const KeyBitmap* m_key_bitmap = nullptr;
     size_t m_limit_count = 0;
     uint64_t m_debug_cookie;
 
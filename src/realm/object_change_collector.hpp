@@ -0,0 +1,143 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_OBJECT_CHANGE_COLLECTOR_HPP
+#define REALM_OBJECT_CHANGE_COLLECTOR_HPP
+
+#include <realm/db.hpp>
+#include <realm/impl/transact_log.hpp>
+
+#include <map>
+#include <unordered_set>
+
+namespace realm {
+
+/// Instruction observer which records the keys of the objects created,
+/// modified and removed in each table while a transaction is advanced. Pass it
+/// to Transaction::advance_read() (or promote_to_write()) and hand it to
+/// ConstTableView::sync_if_needed() afterwards, which lets a view that was in
+/// sync before the advance patch its key list instead of rerunning its query.
+///
+/// The collector accumulates changes over every advance it is passed to, so it
+/// must be passed to all advances of the transaction from the point where it
+/// was constructed.
+class ObjectChangeCollector : public _impl::NullInstructionObserver {
+public:
+    struct TableChanges {
+        // Created or modified objects which must be reevaluated
+        std::unordered_set<ObjKey> changed;
+        std::unordered_set<ObjKey> removed;
+        // Set if the changes to the table cannot be described by the sets above
+        bool cleared = false;
+    };
+
+    ObjectChangeCollector(const Transaction& tr)
+        : m_transaction(&tr)
+        , m_base_version(tr.get_version())
+    {
+    }
+
+    const Transaction* get_transaction() const noexcept
+    {
+        return m_transaction;
+    }
+    // The version of the transaction at the point where collection began
+    DB::version_type get_base_version() const noexcept
+    {
+        return m_base_version;
+    }
+    bool schema_changed() const noexcept
+    {
+        return m_schema_changed;
+    }
+    // Returns nullptr if no objects in the table were touched
+    const TableChanges* get_table_changes(TableKey key) const
+    {
+        auto it = m_tables.find(key);
+        return it == m_tables.end() ? nullptr : &it->second;
+    }
+
+    bool select_table(TableKey key)
+    {
+        m_current = &m_tables[key];
+        return true;
+    }
+    bool insert_group_level_table(TableKey)
+    {
+        m_schema_changed = true;
+        return true;
+    }
+    bool erase_group_level_table(TableKey)
+    {
+        m_schema_changed = true;
+        return true;
+    }
+    bool create_object(ObjKey key)
+    {
+        m_current->removed.erase(key);
+        m_current->changed.insert(key);
+        return true;
+    }
+    bool remove_object(ObjKey key)
+    {
+        m_current->changed.erase(key);
+        m_current->removed.insert(key);
+        return true;
+    }
+    bool clear_table(size_t)
+    {
+        m_current->cleared = true;
+        return true;
+    }
+    bool modify_object(ColKey, ObjKey key)
+    {
+        m_current->changed.insert(key);
+        return true;
+    }
+    bool select_list(ColKey, ObjKey key)
+    {
+        m_current->changed.insert(key);
+        return true;
+    }
+    bool insert_column(ColKey)
+    {
+        m_schema_changed = true;
+        return true;
+    }
+    bool erase_column(ColKey)
+    {
+        m_schema_changed = true;
+        return true;
+    }
+    bool set_link_type(ColKey)
+    {
+        m_schema_changed = true;
+        return true;
+    }
+
+private:
+    const Transaction* m_transaction;
+    DB::version_type m_base_version;
+    std::map<TableKey, TableChanges> m_tables;
+    TableChanges* m_current = nullptr;
+    bool m_schema_changed = false;
+};
+
+} // namespace realm
+
+#endif // REALM_OBJECT_CHANGE_COLLECTOR_HPP
@@ -156,9 +156,17 @@ struct agg_none
 struct agg_shortcut_pred : sor<agg_any, agg_all, agg_none> {
 };
 
+// list of constants eg: name IN {'a', 'b', $0}
+struct list_value : sor<dq_string, sq_string, timestamp, number, argument, true_value, false_value, null_value, base64> {
+};
+struct list_begin : one<'{'> {
+};
+struct list_literal : if_must<list_begin, star<blank>, opt<list<list_value, one<','>, blank>>, star<blank>, one<'}'>> {
+};
+
 // expressions and operators
 struct expr : sor<dq_string, sq_string, timestamp, number, argument, true_value, false_value, null_value, base64,
-                  collection_operator_match, subquery, key_path> {
+                  list_literal, collection_operator_match, subquery, key_path> {
 };
 struct case_insensitive : TAOCPP_PEGTL_ISTRING("[c]") {};
 
@@ -289,8 +297,14 @@ struct ParserState
         pending_comparison_type = Predicate::ComparisonType::Unspecified;
     }
 
+    std::shared_ptr<std::vector<Expression>> list_values;
+
     void add_expression(Expression && exp)
     {
+        if (list_values) {
+            list_values->push_back(std::move(exp));
+            return;
+        }
         Predicate *current = last_predicate();
         if (current->type == Predicate::Type::Comparison && current->cmpr.expr[1].type == parser::Expression::Type::None) {
             current->cmpr.expr[1] = std::move(exp);
@@ -402,6 +416,29 @@ EXPRESSION_ACTION(null_value, Expression::Type::Null)
 EXPRESSION_ACTION(argument_index, Expression::Type::Argument)
 EXPRESSION_ACTION(base64, Expression::Type::Base64)
 
+template<> struct action< list_begin >
+{
+    template< typename Input >
+    static void apply(const Input& in, ParserState & state)
+    {
+        DEBUG_PRINT_TOKEN("<begin list>" + in.string());
+        state.list_values = std::make_shared<std::vector<Expression>>();
+    }
+};
+
+template<> struct action< list_literal >
+{
+    template< typename Input >
+    static void apply(const Input& in, ParserState & state)
+    {
+        DEBUG_PRINT_TOKEN("<end list>" + in.string());
+        Expression exp(Expression::Type::List);
+        exp.list_values = std::move(state.list_values);
+        state.list_values.reset();
+        state.add_expression(std::move(exp));
+    }
+};
+
 template<> struct action< timestamp >
 {
     template< typename Input >
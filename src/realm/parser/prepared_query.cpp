@@ -0,0 +1,129 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "prepared_query.hpp"
+
+#include "parser_utils.hpp"
+
+#include <realm/query.hpp>
+#include <realm/sort_descriptor.hpp>
+
+#include <algorithm>
+
+using namespace realm;
+using namespace realm::query_builder;
+
+namespace {
+
+size_t num_arguments(const parser::Predicate& predicate);
+
+size_t num_arguments(const parser::Expression& expr)
+{
+    size_t n = 0;
+    if (expr.type == parser::Expression::Type::Argument)
+        n = util::stot<size_t>(expr.s) + 1;
+    if (expr.list_values) {
+        for (auto& value : *expr.list_values)
+            n = std::max(n, num_arguments(value));
+    }
+    if (expr.subquery)
+        n = std::max(n, num_arguments(*expr.subquery));
+    return n;
+}
+
+size_t num_arguments(const parser::Predicate& predicate)
+{
+    size_t n = std::max(num_arguments(predicate.cmpr.expr[0]), num_arguments(predicate.cmpr.expr[1]));
+    for (auto& sub : predicate.cpnd.sub_predicates)
+        n = std::max(n, num_arguments(sub));
+    return n;
+}
+
+} // anonymous namespace
+
+
+PreparedQuery::PreparedQuery(const std::string& query_string)
+    : m_query_string(query_string)
+    , m_result(parser::parse(query_string)) // Throws
+    , m_num_arguments(num_arguments(m_result.predicate))
+{
+}
+
+Query PreparedQuery::bind(ConstTableRef table, Arguments& args, parser::KeyPathMapping mapping) const
+{
+    Query query = table->where();
+    apply_predicate(query, m_result.predicate, args, std::move(mapping)); // Throws
+    return query;
+}
+
+DescriptorOrdering PreparedQuery::bind_ordering(ConstTableRef table, Arguments& args,
+                                                parser::KeyPathMapping mapping) const
+{
+    DescriptorOrdering ordering;
+    apply_ordering(ordering, table, m_result.ordering, args, std::move(mapping)); // Throws
+    return ordering;
+}
+
+
+QueryCache::QueryCache(size_t capacity)
+    : m_capacity(std::max(capacity, size_t(1)))
+{
+}
+
+std::shared_ptr<const PreparedQuery> QueryCache::get(const std::string& query_string)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_by_string.find(query_string);
+        if (it != m_by_string.end()) {
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+            return *it->second;
+        }
+    }
+
+    // Parse without holding the lock, so other threads are not held up by it
+    auto prepared = std::make_shared<const PreparedQuery>(query_string); // Throws
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_by_string.find(query_string);
+    if (it != m_by_string.end()) {
+        // Another thread prepared it in the meantime
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return *it->second;
+    }
+    m_entries.push_front(prepared);                       // Throws
+    m_by_string.emplace(query_string, m_entries.begin()); // Throws
+    if (m_entries.size() > m_capacity) {
+        m_by_string.erase(m_entries.back()->get_query_string());
+        m_entries.pop_back();
+    }
+    return prepared;
+}
+
+size_t QueryCache::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+void QueryCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_by_string.clear();
+    m_entries.clear();
+}
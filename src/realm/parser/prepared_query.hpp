@@ -0,0 +1,104 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_PREPARED_QUERY_HPP
+#define REALM_PREPARED_QUERY_HPP
+
+#include <realm/parser/parser.hpp>
+#include <realm/parser/query_builder.hpp>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace realm {
+namespace query_builder {
+
+// A query string parsed once, which makes queries for any value of its
+// arguments. The `$0`, `$1`... placeholders are kept in the parsed predicate,
+// so binding arguments only builds the query from it, without running the
+// grammar again. A prepared query is immutable, and can be bound by several
+// threads at the same time.
+class PreparedQuery {
+public:
+    // Throws std::runtime_error if the query string is invalid
+    explicit PreparedQuery(const std::string& query_string);
+
+    // Make the query on `table` for the given arguments
+    Query bind(ConstTableRef table, Arguments& args,
+               parser::KeyPathMapping mapping = parser::KeyPathMapping()) const;
+    // The sort, distinct, limit and include clauses of the query string
+    DescriptorOrdering bind_ordering(ConstTableRef table, Arguments& args,
+                                     parser::KeyPathMapping mapping = parser::KeyPathMapping()) const;
+
+    // One more than the highest argument index used, so 0 for a query
+    // without arguments
+    size_t get_num_arguments() const noexcept
+    {
+        return m_num_arguments;
+    }
+    const std::string& get_query_string() const noexcept
+    {
+        return m_query_string;
+    }
+    const parser::ParserResult& get_parser_result() const noexcept
+    {
+        return m_result;
+    }
+
+private:
+    std::string m_query_string;
+    parser::ParserResult m_result;
+    size_t m_num_arguments = 0;
+};
+
+// Prepared queries by query string, for applications which make many queries
+// differing only in their arguments. Holds the most recently used queries up
+// to the capacity. Query strings which do not parse are not cached. The cache
+// can be used from several threads.
+class QueryCache {
+public:
+    explicit QueryCache(size_t capacity = 1000);
+
+    // The prepared query for the string, which is parsed on a miss. Throws
+    // std::runtime_error if the query string is invalid.
+    std::shared_ptr<const PreparedQuery> get(const std::string& query_string);
+
+    size_t size() const;
+    size_t get_capacity() const noexcept
+    {
+        return m_capacity;
+    }
+    void clear();
+
+private:
+    using Entry = std::shared_ptr<const PreparedQuery>;
+
+    const size_t m_capacity;
+    mutable std::mutex m_mutex;
+    // Most recently used first
+    std::list<Entry> m_entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> m_by_string;
+};
+
+} // namespace query_builder
+} // namespace realm
+
+#endif // REALM_PREPARED_QUERY_HPP
@@ -48,9 +48,33 @@ void do_add_null_comparison_to_query(Query &, Predicate::Operator, const ValueEx
     throw std::logic_error("Comparing a value to 'null' is not supported.");
 }
 
+// A nullable column of the queried table is matched by a query_engine.hpp node
+// like Query::equal(col, null()) would, which may use a search index
+bool is_nullable_table_column(const PropertyExpression& expr)
+{
+    if (expr.link_chain.size() != 1 || expr.dest_type_is_backlink())
+        return false;
+    ColumnAttrMask attrs = expr.get_dest_col_key().get_attrs();
+    return attrs.test(col_attr_Nullable) && !attrs.test(col_attr_List);
+}
+
 template<typename T>
 void do_add_null_comparison_to_query(Query &query, Predicate::Operator op, const PropertyExpression &expr)
 {
+    if (is_nullable_table_column(expr)) {
+        switch (op) {
+            case Predicate::Operator::NotEqual:
+                query.not_equal(expr.get_dest_col_key(), realm::null());
+                return;
+            case Predicate::Operator::In:
+                REALM_FALLTHROUGH;
+            case Predicate::Operator::Equal:
+                query.equal(expr.get_dest_col_key(), realm::null());
+                return;
+            default:
+                break;
+        }
+    }
     Columns<T> column = expr.link_chain_getter().template column<T>(expr.get_dest_col_key());
     switch (op) {
         case Predicate::Operator::NotEqual:
@@ -505,9 +529,81 @@ void internal_add_comparison_to_query(Query& query, LHS_T& lhs, const Predicate:
     }
 }
 
+// "prop.@size op constant" and "list.@count op constant", where prop or list is a
+// column of the queried table, are matched by the size nodes of query_engine.hpp
+bool add_size_condition_to_query(Query& query, ExpressionContainer& lhs, const Predicate::Comparison& cmp,
+                                 ExpressionContainer& rhs)
+{
+    bool value_on_lhs = lhs.type == ExpressionContainer::ExpressionInternal::exp_Value;
+    ExpressionContainer& size_exp = value_on_lhs ? rhs : lhs;
+    ExpressionContainer& value_exp = value_on_lhs ? lhs : rhs;
+    if (value_exp.type != ExpressionContainer::ExpressionInternal::exp_Value)
+        return false;
+
+    const PropertyExpression* pe;
+    bool is_list;
+    switch (size_exp.type) {
+        case ExpressionContainer::ExpressionInternal::exp_OpSizeString:
+            pe = &size_exp.get_size_string().pe;
+            is_list = false;
+            break;
+        case ExpressionContainer::ExpressionInternal::exp_OpSizeBinary:
+            pe = &size_exp.get_size_binary().pe;
+            is_list = false;
+            break;
+        case ExpressionContainer::ExpressionInternal::exp_OpCount:
+            pe = &size_exp.get_count().pe;
+            is_list = true;
+            break;
+        default:
+            return false;
+    }
+    if (pe->link_chain.size() != 1 || pe->dest_type_is_backlink())
+        return false;
+    ColKey col = pe->get_dest_col_key();
+    ColumnAttrMask attrs = col.get_attrs();
+    if (is_list ? pe->get_dest_type() != type_LinkList : attrs.test(col_attr_List))
+        return false;
+
+    // The size nodes skip null strings and binaries, which only matters to
+    // 'not equal' as a null size is never equal to, or ordered against, a number
+    bool nullable = attrs.test(col_attr_Nullable);
+    int64_t value = value_exp.get_value().value_of_type_for_query<Int>();
+    switch (cmp.op) {
+        case Predicate::Operator::In:
+            REALM_FALLTHROUGH;
+        case Predicate::Operator::Equal:
+            query.size_equal(col, value);
+            return true;
+        case Predicate::Operator::NotEqual:
+            if (nullable)
+                return false;
+            query.size_not_equal(col, value);
+            return true;
+        case Predicate::Operator::LessThan:
+            value_on_lhs ? query.size_greater(col, value) : query.size_less(col, value);
+            return true;
+        case Predicate::Operator::LessThanOrEqual:
+            value_on_lhs ? query.size_greater_equal(col, value) : query.size_less_equal(col, value);
+            return true;
+        case Predicate::Operator::GreaterThan:
+            value_on_lhs ? query.size_less(col, value) : query.size_greater(col, value);
+            return true;
+        case Predicate::Operator::GreaterThanOrEqual:
+            value_on_lhs ? query.size_less_equal(col, value) : query.size_greater_equal(col, value);
+            return true;
+        default:
+            return false;
+    }
+}
+
 void add_comparison_to_query(Query& query, ExpressionContainer& lhs, const Predicate::Comparison& cmp,
                              ExpressionContainer& rhs)
 {
+    if (cmp.compare_type == Predicate::ComparisonType::Unspecified &&
+        add_size_condition_to_query(query, lhs, cmp, rhs))
+        return;
+
     DataType comparison_type = lhs.get_comparison_type(rhs);
     switch (lhs.type) {
         case ExpressionContainer::ExpressionInternal::exp_Value:
@@ -693,11 +789,84 @@ bool is_property_operation(parser::Expression::Type type)
     return type == parser::Expression::Type::KeyPath || type == parser::Expression::Type::SubQuery;
 }
 
+void add_comparison_to_query(Query& query, const Predicate& pred, Arguments& args, parser::KeyPathMapping& mapping);
+
+template <typename T>
+void add_values_to_in_query(Query& query, ColKey col, const std::vector<parser::Expression>& list, Arguments& args)
+{
+    std::vector<Mixed> values;
+    for (auto& value : list) {
+        ValueExpression exp(&args, &value);
+        if (exp.is_null()) {
+            values.push_back(Mixed());
+        }
+        else {
+            values.push_back(Mixed(exp.template value_of_type_for_query<T>()));
+        }
+    }
+    query.in(col, values);
+}
+
+// "keypath IN {v1, v2, ...}"
+void add_list_comparison_to_query(Query& query, const Predicate::Comparison& cmpr, Arguments& args,
+                                  parser::KeyPathMapping& mapping)
+{
+    realm_precondition(cmpr.op == Predicate::Operator::In, "A list of values can only be used with 'IN'");
+    realm_precondition(cmpr.expr[0].type == parser::Expression::Type::KeyPath,
+                       "The expression preceeding 'IN {...}' must be a keypath");
+    const std::vector<parser::Expression>& list = *cmpr.expr[1].list_values;
+
+    // A column of the queried table is matched in a single node by Query::in()
+    ExpressionContainer lhs(query, cmpr.expr[0], args, mapping);
+    if (lhs.type == ExpressionContainer::ExpressionInternal::exp_Property &&
+        cmpr.compare_type == Predicate::ComparisonType::Unspecified &&
+        cmpr.option == Predicate::OperatorOption::None && lhs.get_property().link_chain.size() == 1) {
+        PropertyExpression& prop = lhs.get_property();
+        ColKey col = prop.get_dest_col_key();
+        if (!prop.dest_type_is_backlink() && !col.get_attrs().test(col_attr_List)) {
+            switch (prop.get_dest_type()) {
+                case type_Int:
+                    add_values_to_in_query<Int>(query, col, list, args);
+                    return;
+                case type_String:
+                    add_values_to_in_query<StringData>(query, col, list, args);
+                    return;
+                case type_Timestamp:
+                    add_values_to_in_query<Timestamp>(query, col, list, args);
+                    return;
+                default:
+                    break;
+            }
+        }
+    }
+
+    // Otherwise the list is expanded to "keypath == v1 OR keypath == v2 ..."
+    query.group();
+    for (auto& value : list) {
+        Predicate element(Predicate::Type::Comparison);
+        element.cmpr = cmpr;
+        element.cmpr.op = Predicate::Operator::Equal;
+        element.cmpr.expr[1] = value;
+        query.Or();
+        add_comparison_to_query(query, element, args, mapping);
+    }
+    if (list.empty()) {
+        query.and_query(std::unique_ptr<realm::Expression>(new FalseExpression));
+    }
+    query.end_group();
+}
+
 void add_comparison_to_query(Query& query, const Predicate& pred, Arguments& args, parser::KeyPathMapping& mapping)
 {
     Predicate::Comparison cmpr = pred.cmpr;
     auto lhs_type = cmpr.expr[0].type, rhs_type = cmpr.expr[1].type;
 
+    realm_precondition(lhs_type != parser::Expression::Type::List, "A list of values can only follow 'IN'");
+    if (rhs_type == parser::Expression::Type::List) {
+        add_list_comparison_to_query(query, cmpr, args, mapping);
+        return;
+    }
+
     if (!is_property_operation(lhs_type) && !is_property_operation(rhs_type)) {
         // value vs value expressions are not supported (ex: 2 < 3 or null != null)
         throw std::logic_error("Predicate expressions must compare a keypath and another keypath or a constant value");
@@ -21,12 +21,14 @@
 #include <realm/array.hpp>
 #include <realm/column_fwd.hpp>
 #include <realm/db.hpp>
+#include <realm/index_composite.hpp>
 #include <realm/query_engine.hpp>
 #include <realm/query_expression.hpp>
 #include <realm/table_view.hpp>
 #include <realm/table_tpl.hpp>
 
 #include <algorithm>
+#include <unordered_map>
 
 
 using namespace realm;
@@ -625,6 +627,90 @@ Query& Query::links_to(ColKey origin_column, const std::vector<ObjKey>& target_k
     return *this;
 }
 
+Query& Query::in(ColKey column_key, const std::vector<Mixed>& values)
+{
+    m_table->check_column(column_key);
+    DataType type = DataType(column_key.get_type());
+    bool nullable = column_key.get_attrs().test(col_attr_Nullable);
+
+    auto check_type = [](const Mixed& value, DataType expected) {
+        if (!value.is_null() && value.get_type() != expected)
+            throw LogicError{LogicError::type_mismatch};
+    };
+
+    std::unique_ptr<ParentNode> node;
+    switch (type) {
+        case type_Int:
+            if (nullable) {
+                std::unordered_set<util::Optional<int64_t>> needles;
+                for (auto& value : values) {
+                    check_type(value, type_Int);
+                    needles.insert(value.is_null() ? util::none : util::make_optional(value.get<int64_t>()));
+                }
+                if (!needles.empty())
+                    node.reset(new IntegerNode<ArrayIntNull, Equal>(std::move(needles), column_key));
+            }
+            else {
+                std::unordered_set<int64_t> needles;
+                for (auto& value : values) {
+                    check_type(value, type_Int);
+                    if (!value.is_null())
+                        needles.insert(value.get<int64_t>());
+                }
+                if (!needles.empty())
+                    node.reset(new IntegerNode<ArrayInteger, Equal>(std::move(needles), column_key));
+            }
+            break;
+        case type_String: {
+            std::vector<StringData> needles;
+            for (auto& value : values) {
+                check_type(value, type_String);
+                needles.push_back(value.is_null() ? StringData() : value.get<StringData>());
+            }
+            if (!needles.empty())
+                node.reset(new StringNode<Equal>(needles, column_key));
+            break;
+        }
+        case type_Link:
+        case type_LinkList: {
+            std::vector<ObjKey> target_keys;
+            for (auto& value : values) {
+                check_type(value, type_Link);
+                if (!value.is_null())
+                    target_keys.push_back(value.get<ObjKey>());
+            }
+            if (!target_keys.empty())
+                node.reset(new LinksToNode(column_key, target_keys));
+            break;
+        }
+        case type_Timestamp: {
+            // There is no multi-value timestamp node, so this is an OR of equality conditions
+            if (values.empty())
+                break;
+            group();
+            for (auto& value : values) {
+                check_type(value, type_Timestamp);
+                Or();
+                if (value.is_null())
+                    add_condition<Equal>(column_key, null{});
+                else
+                    add_condition<Equal>(column_key, value.get<Timestamp>());
+            }
+            return end_group();
+        }
+        default:
+            throw LogicError{LogicError::type_mismatch};
+    }
+
+    if (!node) {
+        // Nothing can match an empty set
+        add_expression_node(std::unique_ptr<Expression>(new FalseExpression));
+        return *this;
+    }
+    add_node(std::move(node));
+    return *this;
+}
+
 // int64 constant vs column
 Query& Query::equal(ColKey column_key, int64_t value)
 {
@@ -898,8 +984,8 @@ R Query::aggregate(ColKey column_key, size_t* resultcount, ObjKey* return_ndx) c
         if (!m_view) {
             auto pn = root_node();
             auto node = pn->m_children[find_best_node(pn)];
-            if (node->has_search_index()) {
-                node->index_based_aggregate(size_t(-1), [&](ConstObj& obj) -> bool {
+            if (node->has_index_matches()) {
+                node->index_matches_aggregate(size_t(-1), [&](ConstObj& obj) -> bool {
                     if (eval_object(obj)) {
                         st.template match<action, false>(size_t(obj.get_key().value), 0, obj.get<T>(column_key));
                         return true;
@@ -1317,12 +1403,12 @@ void Query::find_all(ConstTableView& ret, size_t begin, size_t end, size_t limit
         else {
             auto pn = root_node();
             auto node = pn->m_children[find_best_node(pn)];
-            if (node->has_search_index()) {
+            if (node->has_index_matches()) {
                 // translate begin/end limiters into corresponding keys
                 auto begin_key = (begin >= m_table->size()) ? ObjKey() : m_table->get_object(begin).get_key();
                 auto end_key = (end >= m_table->size()) ? ObjKey() : m_table->get_object(end).get_key();
                 KeyColumn* refs = ret.m_key_values;
-                node->index_based_aggregate(limit, [&](ConstObj& obj) -> bool {
+                node->index_matches_aggregate(limit, [&](ConstObj& obj) -> bool {
                     auto key = obj.get_key();
                     if (begin_key && key < begin_key)
                         return false;
@@ -1381,6 +1467,80 @@ TableView Query::find_all(size_t start, size_t end, size_t limit)
     return ret;
 }
 
+void Query::for_each(util::FunctionRef<bool(ConstObj&)> func) const
+{
+#if REALM_METRICS
+    std::unique_ptr<MetricTimer> metric_timer = QueryInfo::track(this, QueryInfo::type_FindAll);
+#endif
+
+    do_for_each(func);
+}
+
+void Query::do_for_each(util::FunctionRef<bool(ConstObj&)> func) const
+{
+    init();
+
+    if (m_view) {
+        for (size_t t = 0; t < m_view->size(); t++) {
+            ConstObj obj = m_view->get_object(t);
+            if (eval_object(obj) && func(obj))
+                return;
+        }
+        return;
+    }
+
+    ParentNode* node = nullptr;
+    if (has_conditions()) {
+        auto pn = root_node();
+        node = pn->m_children[find_best_node(pn)];
+        if (node->has_index_matches()) {
+            // Only the match which stops the iteration counts against the
+            // limit of one, so no object is read after it
+            node->index_matches_aggregate(1, [&](ConstObj& obj) -> bool {
+                return eval_object(obj) && func(obj);
+            });
+            return;
+        }
+        node = pn;
+    }
+
+    auto f = [&node, &func, this](const Cluster* cluster) {
+        size_t e = cluster->node_size();
+        if (node)
+            node->set_cluster(cluster);
+        size_t row = node ? node->find_first(0, e) : 0;
+        while (row < e) {
+            ConstObj obj(m_table, cluster->get_mem(), cluster->get_real_key(row), row);
+            if (func(obj))
+                return true;
+            row = node ? node->find_first(row + 1, e) : row + 1;
+        }
+        // Continue
+        return false;
+    };
+
+    m_table->traverse_clusters(f);
+}
+
+KeyBitmap Query::find_all_keys() const
+{
+#if REALM_METRICS
+    std::unique_ptr<MetricTimer> metric_timer = QueryInfo::track(this, QueryInfo::type_FindAll);
+#endif
+
+    return do_find_all_keys();
+}
+
+KeyBitmap Query::do_find_all_keys() const
+{
+    KeyBitmap keys;
+    do_for_each([&](ConstObj& obj) {
+        keys.add(obj.get_key()); // Throws
+        return false;
+    });
+    return keys;
+}
+
 
 size_t Query::do_count(size_t limit) const
 {
@@ -1413,8 +1573,14 @@ size_t Query::do_count(size_t limit) const
         size_t counter = 0;
         auto pn = root_node();
         auto node = pn->m_children[find_best_node(pn)];
-        if (node->has_search_index()) {
-            node->index_based_aggregate(limit, [&](ConstObj& obj) -> bool {
+        if (node->has_index_matches()) {
+            // A single condition is counted from the index lookup, without reading the objects
+            if (pn->m_children.size() == 1) {
+                size_t index_count = node->index_matches_count();
+                if (index_count != npos)
+                    return std::min(index_count, limit);
+            }
+            node->index_matches_aggregate(limit, [&](ConstObj& obj) -> bool {
                 if (eval_object(obj)) {
                     ++counter;
                     return true;
@@ -1514,11 +1680,329 @@ size_t Query::count(const DescriptorOrdering& descriptor)
         return do_count(limit);
     }
 
+    // A single distinct on one column is counted from its search index
+    if (descriptor.size() == 1) {
+        auto& columns = static_cast<const DistinctDescriptor*>(descriptor[0])->get_column_keys();
+        if (columns.size() == 1 && columns[0].size() == 1)
+            return do_count_distinct(columns[0][0]);
+    }
+
     TableView ret(m_table, *this, start, end, limit);
     ret.apply_descriptor_ordering(descriptor);
     return ret.size();
 }
 
+size_t Query::count_distinct(ColKey column_key)
+{
+#if REALM_METRICS
+    std::unique_ptr<MetricTimer> metric_timer = QueryInfo::track(this, QueryInfo::type_Count);
+#endif
+
+    return do_count_distinct(column_key);
+}
+
+size_t Query::do_count_distinct(ColKey column_key)
+{
+    if (!has_conditions() && !m_view) {
+        if (auto index = m_table->get_search_index(column_key))
+            return index->count_distinct();
+    }
+
+    TableView tv(m_table, *this, 0, size_t(-1), size_t(-1));
+    tv.distinct(column_key);
+    return tv.size();
+}
+
+namespace {
+
+// Reads the values of a column from the leaf of the cluster being searched
+class GroupByLeaf {
+public:
+    virtual ~GroupByLeaf() = default;
+    virtual void init(const Cluster* cluster) = 0;
+    virtual Mixed get(size_t row) const = 0;
+};
+
+template <class T>
+class GroupByLeafImpl : public GroupByLeaf {
+public:
+    GroupByLeafImpl(Allocator& alloc, ColKey column_key)
+        : m_leaf(alloc)
+        , m_column_key(column_key)
+    {
+    }
+    void init(const Cluster* cluster) override
+    {
+        cluster->init_leaf(m_column_key, &m_leaf);
+    }
+    Mixed get(size_t row) const override
+    {
+        return Mixed(m_leaf.get(row));
+    }
+
+private:
+    typename ColumnTypeTraits<T>::cluster_leaf_type m_leaf;
+    ColKey m_column_key;
+};
+
+std::unique_ptr<GroupByLeaf> make_group_by_leaf(const Table& table, ColKey column_key)
+{
+    Allocator& alloc = table.get_alloc();
+    switch (column_key.get_type()) {
+        case col_type_Int:
+            if (column_key.get_attrs().test(col_attr_Nullable))
+                return std::make_unique<GroupByLeafImpl<util::Optional<int64_t>>>(alloc, column_key);
+            return std::make_unique<GroupByLeafImpl<int64_t>>(alloc, column_key);
+        case col_type_Bool:
+            return std::make_unique<GroupByLeafImpl<util::Optional<bool>>>(alloc, column_key);
+        case col_type_Float:
+            return std::make_unique<GroupByLeafImpl<util::Optional<float>>>(alloc, column_key);
+        case col_type_Double:
+            return std::make_unique<GroupByLeafImpl<util::Optional<double>>>(alloc, column_key);
+        case col_type_String:
+            return std::make_unique<GroupByLeafImpl<StringData>>(alloc, column_key);
+        case col_type_Binary:
+            return std::make_unique<GroupByLeafImpl<BinaryData>>(alloc, column_key);
+        case col_type_Timestamp:
+            return std::make_unique<GroupByLeafImpl<Timestamp>>(alloc, column_key);
+        case col_type_Link:
+            return std::make_unique<GroupByLeafImpl<ObjKey>>(alloc, column_key);
+        default:
+            break;
+    }
+    throw LogicError{LogicError::type_mismatch};
+}
+
+void check_group_by_aggregate(const Table& table, const GroupByAggregate& aggregate)
+{
+    if (aggregate.type == GroupByAggregate::Type::count)
+        return;
+    ColumnType type = aggregate.column_key.get_type();
+    bool numeric = type == col_type_Int || type == col_type_Float || type == col_type_Double;
+    bool ordered = numeric || type == col_type_Timestamp;
+    bool minmax =
+        aggregate.type == GroupByAggregate::Type::minimum || aggregate.type == GroupByAggregate::Type::maximum;
+    if (table.is_list(aggregate.column_key) || !(minmax ? ordered : numeric))
+        throw LogicError{LogicError::type_mismatch};
+}
+
+// The state of one aggregate of one group
+struct GroupByState {
+    size_t count = 0;
+    int64_t int_sum = 0;
+    double sum = 0;
+    Mixed value;
+
+    void add(GroupByAggregate::Type type, Mixed v)
+    {
+        if (v.is_null())
+            return;
+        ++count;
+        switch (type) {
+            case GroupByAggregate::Type::count:
+                break;
+            case GroupByAggregate::Type::sum:
+            case GroupByAggregate::Type::average:
+                if (v.get_type() == type_Int)
+                    int_sum += v.get<int64_t>();
+                else if (v.get_type() == type_Float)
+                    sum += v.get<float>();
+                else
+                    sum += v.get<double>();
+                break;
+            case GroupByAggregate::Type::minimum:
+                if (value.is_null() || v.compare(value) < 0)
+                    value = v;
+                break;
+            case GroupByAggregate::Type::maximum:
+                if (value.is_null() || v.compare(value) > 0)
+                    value = v;
+                break;
+        }
+    }
+
+    Mixed get(GroupByAggregate::Type type, ColKey column_key, size_t group_count) const
+    {
+        bool is_int = column_key && column_key.get_type() == col_type_Int;
+        switch (type) {
+            case GroupByAggregate::Type::count:
+                return Mixed(int64_t(group_count));
+            case GroupByAggregate::Type::sum:
+                return is_int ? Mixed(int_sum) : Mixed(sum);
+            case GroupByAggregate::Type::average:
+                if (count == 0)
+                    return Mixed();
+                return Mixed((is_int ? double(int_sum) : sum) / count);
+            case GroupByAggregate::Type::minimum:
+            case GroupByAggregate::Type::maximum:
+                break;
+        }
+        return value;
+    }
+};
+
+struct MixedHash {
+    size_t operator()(const Mixed& value) const noexcept
+    {
+        return size_t(value.hash());
+    }
+};
+
+// The number of objects with the value, looked up in the search index
+size_t count_in_index(const StringIndex& index, Mixed value)
+{
+    if (value.is_null())
+        return index.count(null{});
+    switch (value.get_type()) {
+        case type_Int:
+            return index.count(value.get<int64_t>());
+        case type_Bool:
+            return index.count(value.get<bool>());
+        case type_String:
+            return index.count(value.get<StringData>());
+        case type_Timestamp:
+            return index.count(value.get<Timestamp>());
+        default:
+            break;
+    }
+    REALM_UNREACHABLE();
+}
+
+} // anonymous namespace
+
+std::vector<GroupByResult> Query::group_by(ColKey group_column_key,
+                                           const std::vector<GroupByAggregate>& aggregates) const
+{
+    m_table->check_column(group_column_key);
+    if (m_table->is_list(group_column_key))
+        throw LogicError{LogicError::type_mismatch};
+    bool only_count = true;
+    for (auto& aggregate : aggregates) {
+        if (aggregate.type != GroupByAggregate::Type::count) {
+            m_table->check_column(aggregate.column_key);
+            check_group_by_aggregate(*m_table, aggregate);
+            only_count = false;
+        }
+    }
+
+    std::vector<GroupByResult> results;
+    auto by_value = [](const GroupByResult& a, const GroupByResult& b) { return a.value.compare(b.value) < 0; };
+
+    if (only_count && !has_conditions() && !m_view) {
+        // Stream the groups out of the index, one distinct value at a time
+        if (auto index = m_table->get_search_index(group_column_key)) {
+            BPlusTree<ObjKey> keys(Allocator::get_default());
+            keys.create();
+            index->distinct(keys);
+            for (size_t i = 0; i < keys.size(); ++i) {
+                Mixed value = m_table->get_object(keys.get(i)).get_any(group_column_key);
+                size_t count = count_in_index(*index, value);
+                results.push_back({value, count, std::vector<Mixed>(aggregates.size(), Mixed(int64_t(count)))});
+            }
+            keys.destroy();
+            std::sort(results.begin(), results.end(), by_value);
+            return results;
+        }
+    }
+
+    const size_t num_aggregates = aggregates.size();
+    std::unordered_map<Mixed, size_t, MixedHash> groups;
+    std::vector<size_t> counts;
+    std::vector<GroupByState> states;
+    // `get_value(i)` reads the value of the column of aggregate `i`
+    auto add = [&](Mixed group_value, auto&& get_value) {
+        auto it = groups.emplace(group_value, counts.size()).first;
+        size_t group = it->second;
+        if (group == counts.size()) {
+            counts.push_back(0);
+            states.resize(states.size() + num_aggregates);
+        }
+        ++counts[group];
+        GroupByState* group_states = states.data() + group * num_aggregates;
+        for (size_t i = 0; i < num_aggregates; ++i) {
+            if (aggregates[i].type != GroupByAggregate::Type::count)
+                group_states[i].add(aggregates[i].type, get_value(i));
+        }
+    };
+
+    init();
+    ParentNode* node = nullptr;
+    bool use_index = false;
+    if (has_conditions()) {
+        auto pn = root_node();
+        node = pn->m_children[find_best_node(pn)];
+        use_index = node->has_index_matches();
+        if (!use_index)
+            node = pn;
+    }
+
+    if (m_view || use_index) {
+        auto add_object = [&](const ConstObj& obj) {
+            add(obj.get_any(group_column_key), [&](size_t i) { return obj.get_any(aggregates[i].column_key); });
+        };
+        if (m_view) {
+            for (size_t t = 0; t < m_view->size(); t++) {
+                ConstObj obj = m_view->get_object(t);
+                if (eval_object(obj))
+                    add_object(obj);
+            }
+        }
+        else {
+            node->index_matches_aggregate(size_t(-1), [&](ConstObj& obj) -> bool {
+                if (eval_object(obj)) {
+                    add_object(obj);
+                    return true;
+                }
+                return false;
+            });
+        }
+    }
+    else {
+        // A single pass over the clusters, reading the values from the leaves
+        const Table& table = *m_table;
+        std::unique_ptr<GroupByLeaf> group_leaf = make_group_by_leaf(table, group_column_key);
+        std::vector<std::unique_ptr<GroupByLeaf>> leaves(num_aggregates);
+        for (size_t i = 0; i < num_aggregates; ++i) {
+            if (aggregates[i].type != GroupByAggregate::Type::count)
+                leaves[i] = make_group_by_leaf(table, aggregates[i].column_key);
+        }
+
+        auto f = [&](const Cluster* cluster) {
+            size_t e = cluster->node_size();
+            if (node)
+                node->set_cluster(cluster);
+            group_leaf->init(cluster);
+            for (auto& leaf : leaves) {
+                if (leaf)
+                    leaf->init(cluster);
+            }
+            size_t row = node ? node->find_first(0, e) : 0;
+            while (row < e) {
+                add(group_leaf->get(row), [&](size_t i) { return leaves[i]->get(row); });
+                row = node ? node->find_first(row + 1, e) : row + 1;
+            }
+            // Continue
+            return false;
+        };
+        table.traverse_clusters(f);
+    }
+
+    results.reserve(groups.size());
+    for (auto& group : groups) {
+        size_t ndx = group.second;
+        GroupByResult result{group.first, counts[ndx], {}};
+        result.aggregates.reserve(num_aggregates);
+        for (size_t i = 0; i < num_aggregates; ++i) {
+            auto& aggregate = aggregates[i];
+            result.aggregates.push_back(
+                states[ndx * num_aggregates + i].get(aggregate.type, aggregate.column_key, counts[ndx]));
+        }
+        results.push_back(std::move(result));
+    }
+    std::sort(results.begin(), results.end(), by_value);
+    return results;
+}
+
 // todo, not sure if start, end and limit could be useful for delete.
 size_t Query::remove()
 {
@@ -1691,6 +2175,119 @@ std::string Query::get_description() const
     return get_description(state);
 }
 
+namespace {
+
+// Let a composite index answer the `column == value` conditions of the top
+// level of a query which cover a prefix of its columns. The index matches are
+// given to the node of the first covered condition, and are cheap enough to
+// make it the node which drives the query.
+void use_composite_index(const Table& table, ParentNode* root)
+{
+    for (ParentNode* node : root->m_children)
+        node->m_planned_matches.reset();
+
+    auto& indexes = table.get_composite_indexes();
+    if (indexes.empty())
+        return;
+
+    std::vector<std::pair<ParentNode*, Mixed>> conditions;
+    for (ParentNode* node : root->m_children) {
+        Mixed value;
+        if (node->get_equal_value(value))
+            conditions.emplace_back(node, value);
+    }
+
+    // Use the index covering the most conditions
+    const CompositeIndex* best_index = nullptr;
+    std::vector<ParentNode*> best_nodes;
+    std::vector<Mixed> best_values;
+    for (const CompositeIndex* index : indexes) {
+        std::vector<ParentNode*> nodes;
+        std::vector<Mixed> values;
+        for (ColKey col_key : index->get_columns()) {
+            auto it = std::find_if(conditions.begin(), conditions.end(), [&](const std::pair<ParentNode*, Mixed>& c) {
+                return c.first->m_condition_column_key == col_key;
+            });
+            if (it == conditions.end())
+                break;
+            nodes.push_back(it->first);
+            values.push_back(it->second);
+        }
+        if (values.size() > best_values.size()) {
+            best_index = index;
+            best_nodes = std::move(nodes);
+            best_values = std::move(values);
+        }
+    }
+    if (!best_index)
+        return;
+
+    std::vector<ObjKey> keys;
+    best_index->find_all(best_values, keys);
+    double distance = double(table.size() + 1) / (keys.size() + 1);
+    // The matches are never more than those of a single covered condition
+    for (ParentNode* node : best_nodes)
+        distance = std::max(distance, node->m_dD);
+
+    ParentNode* node = best_nodes.front();
+    node->m_planned_matches.assign(std::move(keys));
+    node->m_dT = 0.0;
+    node->m_dD = distance;
+}
+
+// Conditions with more index matches than this many times those of the
+// condition with the fewest are not intersected. Their matches would cost more
+// to collect than evaluating them on the objects left by the others.
+constexpr size_t s_max_intersection_ratio = 16;
+
+// Intersect the index matches of the conditions of the top level of a query,
+// which are all ANDed, and give the intersection to the condition with the
+// fewest matches. It then drives the query, and the other conditions are only
+// evaluated for the objects in the intersection. Only conditions whose index
+// matches are exact, and so counted, take part.
+void use_index_intersection(const Table& table, ParentNode* root)
+{
+    std::vector<std::pair<size_t, ParentNode*>> nodes;
+    for (ParentNode* node : root->m_children) {
+        if (!node->has_index_matches())
+            continue;
+        size_t count = node->index_matches_count();
+        if (count != npos && node->index_matches_exact())
+            nodes.emplace_back(count, node);
+    }
+    if (nodes.size() < 2)
+        return;
+    std::stable_sort(nodes.begin(), nodes.end(),
+                     [](const std::pair<size_t, ParentNode*>& a, const std::pair<size_t, ParentNode*>& b) {
+                         return a.first < b.first;
+                     });
+
+    ParentNode* node = nodes.front().second;
+    KeyBitmap keys;
+    if (!node->index_matches_keys(keys)) // Throws
+        return;
+    size_t max_matches = std::max(nodes.front().first, size_t(1)) * s_max_intersection_ratio;
+    double distance = node->m_dD;
+    size_t num_intersected = 1;
+    for (size_t i = 1; i < nodes.size() && nodes[i].first <= max_matches && !keys.empty(); ++i) {
+        KeyBitmap matches;
+        if (!nodes[i].second->index_matches_keys(matches)) // Throws
+            continue;
+        keys &= matches;
+        // The matches are never more than those of a single intersected condition
+        distance = std::max(distance, nodes[i].second->m_dD);
+        ++num_intersected;
+    }
+    if (num_intersected < 2)
+        return;
+
+    node->m_planned_matches.assign(keys.to_vector()); // Throws
+    node->m_dT = 0.0;
+    node->m_dD = std::max(distance, double(table.size() + 1) / (keys.size() + 1));
+}
+
+} // anonymous namespace
+
 void Query::init() const
 {
     m_table.check();
@@ -1698,6 +2295,8 @@ void Query::init() const
         root->init();
         std::vector<ParentNode*> vec;
         root->gather_children(vec);
+        use_composite_index(*m_table, root);
+        use_index_intersection(*m_table, root);
     }
 }
 
@@ -1848,6 +2447,15 @@ void Query::get_outside_versions(TableVersions& versions) const
     }
 }
 
+bool Query::links_to_own_table() const
+{
+    if (!m_table || !has_conditions())
+        return false;
+    std::vector<TableKey> tables;
+    root_node()->get_link_dependencies(tables);
+    return std::find(tables.begin(), tables.end(), m_table.unchecked_ptr()->get_key()) != tables.end();
+}
+
 TableVersions Query::sync_view_if_needed() const
 {
     if (m_view) {
@@ -39,6 +39,9 @@
 #include <realm/binary_data.hpp>
 #include <realm/timestamp.hpp>
 #include <realm/handover_defs.hpp>
+#include <realm/key_bitmap.hpp>
+#include <realm/mixed.hpp>
+#include <realm/util/function_ref.hpp>
 #include <realm/util/serializer.hpp>
 
 namespace realm {
@@ -79,6 +82,43 @@ struct QueryGroup {
     State m_state = State::Default;
 };
 
+/// An aggregate computed for every group by Query::group_by()
+struct GroupByAggregate {
+    enum class Type { count, sum, minimum, maximum, average };
+
+    Type type;
+    ColKey column_key;
+
+    static GroupByAggregate count()
+    {
+        return {Type::count, ColKey()};
+    }
+    static GroupByAggregate sum(ColKey column_key)
+    {
+        return {Type::sum, column_key};
+    }
+    static GroupByAggregate minimum(ColKey column_key)
+    {
+        return {Type::minimum, column_key};
+    }
+    static GroupByAggregate maximum(ColKey column_key)
+    {
+        return {Type::maximum, column_key};
+    }
+    static GroupByAggregate average(ColKey column_key)
+    {
+        return {Type::average, column_key};
+    }
+};
+
+/// The matching objects which have the same value in the group column
+struct GroupByResult {
+    Mixed value;
+    size_t count;
+    /// The requested aggregates, in the order of the request
+    std::vector<Mixed> aggregates;
+};
+
 class Query final {
 public:
     Query(ConstTableRef table, ConstTableView* tv = nullptr);
@@ -100,6 +140,10 @@ public:
     // Find links that point to specific target objects
     Query& links_to(ColKey column_key, const std::vector<ObjKey>& target_obj);
 
+    // Find objects whose value in the column equals one of 'values'. A null in 'values' matches null. Supported
+    // for int, string, timestamp and link columns (with ObjKey values).
+    Query& in(ColKey column_key, const std::vector<Mixed>& values);
+
     // Conditions: null
     Query& equal(ColKey column_key, null);
     Query& not_equal(ColKey column_key, null);
@@ -225,11 +269,35 @@ public:
     // Searching
     ObjKey find();
     TableView find_all(size_t start = 0, size_t end = size_t(-1), size_t limit = size_t(-1));
+    // Call `func` with every matching object, without building a view. The
+    // objects of a table are visited cluster by cluster in key order, and are
+    // bound to the cluster they are read from, so the table must not be modified
+    // until it returns. Return true from `func` to stop.
+    void for_each(util::FunctionRef<bool(ConstObj&)> func) const;
+    // The keys of the matching objects as a compressed bitmap, which takes far
+    // less memory than a view when the matches are many, and can be combined
+    // with the matches of other queries on the same table.
+    KeyBitmap find_all_keys() const;
 
     // Aggregates
     size_t count() const;
     TableView find_all(const DescriptorOrdering& descriptor);
     size_t count(const DescriptorOrdering& descriptor);
+    // The number of distinct values in the column, null included, over the
+    // matching objects. A query without conditions on an indexed column is
+    // answered by the search index without reading the objects.
+    size_t count_distinct(ColKey column_key);
+    // Group the matching objects by their value in `group_column_key`, null
+    // included, and compute the aggregates for every group in a single pass
+    // with a hash table of the groups. The groups are ordered by value. A
+    // count is an int, a sum is an int for an int column and a double
+    // otherwise, and an average is a double. Nulls are skipped, and the
+    // minimum, maximum and average of a group without values are null. String
+    // values point into the table and are only valid until it is modified.
+    // A query without conditions which only counts, on an indexed column, is
+    // answered by the search index group by group without reading the objects.
+    std::vector<GroupByResult> group_by(ColKey group_column_key,
+                                        const std::vector<GroupByAggregate>& aggregates) const;
     int64_t sum_int(ColKey column_key) const;
     double average_int(ColKey column_key, size_t* resultcount = nullptr) const;
     int64_t maximum_int(ColKey column_key, ObjKey* return_ndx = nullptr) const;
@@ -338,6 +406,14 @@ private:
 
     void find_all(ConstTableView& tv, size_t start = 0, size_t end = size_t(-1), size_t limit = size_t(-1)) const;
     size_t do_count(size_t limit = size_t(-1)) const;
+    // Not recorded in the metrics, for the queries run by other queries
+    void do_for_each(util::FunctionRef<bool(ConstObj&)> func) const;
+    KeyBitmap do_find_all_keys() const;
+    size_t do_count_distinct(ColKey column_key);
+    // True if the conditions read objects of the queried table through links
+    // or backlinks, so that a change to one object may change the result for
+    // others
+    bool links_to_own_table() const;
     void delete_nodes() noexcept;
 
     bool has_conditions() const
@@ -355,6 +431,8 @@ private:
     friend class Table;
     friend class ConstTableView;
     friend class SubQueryCount;
+    template <class, class, class, class>
+    friend class Compare;
     friend class metrics::QueryInfo;
 
     std::string error_code;
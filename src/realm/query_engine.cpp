@@ -20,6 +20,7 @@
 
 #include <realm/query_expression.hpp>
 #include <realm/index_string.hpp>
+#include <realm/index_trigram.hpp>
 #include <realm/db.hpp>
 #include <realm/utilities.hpp>
 
@@ -45,7 +46,11 @@ size_t ParentNode::find_first(size_t start, size_t end)
     size_t nb_cond_to_test = sz;
 
     while (REALM_LIKELY(start < end)) {
-        size_t m = m_children[current_cond]->find_first_local(start, end);
+        ParentNode* cond = m_children[current_cond];
+        // Checking a single row is faster without the planned matches
+        size_t m = (cond->m_planned_matches.is_used() && end - start > 1)
+                       ? cond->m_planned_matches.find_first(cond->m_cluster, start, end)
+                       : cond->find_first_local(start, end);
 
         if (m != start) {
             // Pointer advanced - we will have to check all other conditions
@@ -204,6 +209,84 @@ size_t ParentNode::aggregate_local(QueryStateBase* st, size_t start, size_t end,
     }
 }
 
+double RangeIndexMatches::init(const Table& table, ColKey col_key, RangeIndex::Condition cond, Mixed value)
+{
+    // Visiting a match through the index costs about as much as scanning
+    // this many rows of the column
+    constexpr size_t scan_rows_per_match = 32;
+
+    m_keys.clear();
+    m_used = false;
+    // A removed column is reported when the query reads its leaves
+    if (!table.valid_column(col_key))
+        return 0;
+    RangeIndex* index = table.get_range_index(col_key);
+    RangeIndex::Value v;
+    // Null and NaN are not indexed, so conditions on them must scan
+    if (!index || !RangeIndex::to_value(value, v))
+        return 0;
+
+    auto range = index->find_range(cond, value);
+    size_t count = range.second - range.first;
+    size_t table_size = table.size();
+    if (count * scan_rows_per_match > table_size)
+        return 0;
+
+    index->get_keys(range.first, range.second, m_keys);
+    m_used = true;
+    return double(table_size + 1) / (count + 1);
+}
+
+void StringNodeBase::trigram_index_init(bool is_like, bool case_insensitive)
+{
+    m_use_index_candidates = false;
+    m_index_candidates.clear();
+
+    if (!m_table->valid_column(m_condition_column_key))
+        return;
+    TrigramIndex* index = m_table->get_trigram_index(m_condition_column_key);
+    if (!index || !m_value)
+        return;
+
+    std::vector<StringData> fragments;
+    StringData needle(*m_value);
+    if (is_like) {
+        // Every match contains the literal parts between the wildcards
+        size_t begin = 0;
+        for (size_t i = 0; i <= needle.size(); ++i) {
+            if (i == needle.size() || needle[i] == '*' || needle[i] == '?') {
+                fragments.push_back(needle.substr(begin, i - begin));
+                begin = i + 1;
+            }
+        }
+    }
+    else {
+        fragments.push_back(needle);
+    }
+
+    m_use_index_candidates = index->find_candidates(fragments, case_insensitive, m_index_candidates);
+    if (m_use_index_candidates)
+        m_dT = 0.0;
+}
+
+bool StringNodeBase::prefix_index_init(bool case_insensitive)
+{
+    m_use_index_candidates = false;
+    m_index_candidates.clear();
+
+    // An empty prefix matches all strings, so the index does not help
+    if (!m_table->valid_column(m_condition_column_key) || !m_value || m_value->empty())
+        return false;
+    StringIndex* index = m_table->get_search_index(m_condition_column_key);
+    if (!index)
+        return false;
+
+    m_use_index_candidates = index->find_all_prefix(StringData(*m_value), m_index_candidates, case_insensitive);
+    if (m_use_index_candidates)
+        m_dT = 0.0;
+    return m_use_index_candidates;
+}
+
 void StringNodeEqualBase::init()
 {
     m_dD = 10.0;
@@ -276,6 +359,43 @@ void StringNode<Equal>::_search_index_init()
 
     m_last_start_key = ObjKey();
     m_results_start = 0;
+    const Table* table = ParentNode::m_table.unchecked_ptr();
+    ColKey col_key = ParentNode::m_condition_column_key;
+    bool is_primary_key = table->get_primary_key_column() == col_key;
+    HashIndex* hash_index = nullptr;
+    if (!is_primary_key && !table->has_search_index(col_key))
+        hash_index = table->get_hash_index(col_key);
+    m_use_key_matches = !m_needles.empty() || hash_index;
+    if (m_use_key_matches) {
+        // One lookup per needle, merged so that the matches can be traversed in key order
+        m_index_matches.reset();
+        m_key_matches.clear();
+        auto find_all = [&](StringData value) {
+            if (is_primary_key) {
+                if (ObjKey key = table->find_first(col_key, value))
+                    m_key_matches.push_back(key);
+            }
+            else if (hash_index) {
+                hash_index->find_all(value, m_key_matches);
+            }
+            else {
+                table->get_search_index(col_key)->find_all(m_key_matches, value);
+            }
+        };
+        if (m_needles.empty()) {
+            find_all(StringData(StringNodeBase::m_value));
+        }
+        else {
+            for (auto needle : m_needles)
+                find_all(needle);
+        }
+        std::sort(m_key_matches.begin(), m_key_matches.end());
+        m_key_matches.erase(std::unique(m_key_matches.begin(), m_key_matches.end()), m_key_matches.end());
+        m_results_end = m_key_matches.size();
+        m_actual_key = get_key(0);
+        m_results_ndx = m_results_start;
+        return;
+    }
     if (ParentNode::m_table->get_primary_key_column() == ParentNode::m_condition_column_key) {
         m_actual_key = ParentNode::m_table.unchecked_ptr()->find_first(ParentNode::m_condition_column_key,
                                                                        StringData(StringNodeBase::m_value));
@@ -319,14 +439,19 @@ void StringNode<Equal>::consume_condition(StringNode<Equal>* other)
     if (m_needles.empty()) {
         m_needles.insert(bool(m_value) ? StringData(*m_value) : StringData());
     }
-    if (bool(other->m_value)) {
+    add_needle(bool(other->m_value) ? StringData(*other->m_value) : StringData());
+}
+
+void StringNode<Equal>::add_needle(StringData needle)
+{
+    if (needle.is_null()) {
+        m_needles.insert(StringData());
+    }
+    else if (m_needles.count(needle) == 0) {
         m_needle_storage.push_back(StringBuffer());
-        m_needle_storage.back().append(*other->m_value);
+        m_needle_storage.back().append(needle.data(), needle.size());
         m_needles.insert(StringData(m_needle_storage.back().data(), m_needle_storage.back().size()));
     }
-    else {
-        m_needles.insert(StringData());
-    }
 }
 
 size_t StringNode<Equal>::_find_first_local(size_t start, size_t end)
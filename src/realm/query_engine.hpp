@@ -108,7 +108,10 @@ AggregateState      State of the aggregate - contains a state variable that stor
 #include <realm/util/shared_ptr.hpp>
 #include <realm/util/string_buffer.hpp>
 #include <realm/utilities.hpp>
+#include <realm/index_hash.hpp>
+#include <realm/index_range.hpp>
 #include <realm/index_string.hpp>
+#include <realm/key_bitmap.hpp>
 
 #include <map>
 #include <unordered_set>
@@ -137,6 +140,65 @@ const size_t bitwidth_time_unit = 64;
 typedef bool (*CallbackDummy)(int64_t);
 using Evaluator = util::FunctionRef<bool(ConstObj& obj)>;
 
+// The objects matching one or more conditions, looked up in one or more indexes
+class IndexMatches {
+public:
+    bool is_used() const noexcept
+    {
+        return m_used;
+    }
+
+    size_t size() const noexcept
+    {
+        return m_keys.size();
+    }
+
+    // Use `keys`, which must be ordered
+    void assign(std::vector<ObjKey> keys)
+    {
+        m_keys = std::move(keys);
+        m_used = true;
+    }
+
+    void reset()
+    {
+        m_keys.clear();
+        m_used = false;
+    }
+
+    size_t find_first(const Cluster* cluster, size_t start, size_t end) const
+    {
+        if (start >= end)
+            return not_found;
+        ObjKey first_key = cluster->get_real_key(start);
+        auto it = std::lower_bound(m_keys.begin(), m_keys.end(), first_key);
+        if (it == m_keys.end() || *it > cluster->get_real_key(end - 1))
+            return not_found;
+        return cluster->lower_bound_key(ObjKey(it->value - cluster->get_offset()));
+    }
+
+    void aggregate(const Table& table, size_t limit, Evaluator evaluator) const
+    {
+        for (size_t t = 0; t < m_keys.size() && limit > 0; ++t) {
+            auto obj = table.get_object(m_keys[t]);
+            if (evaluator(obj)) {
+                --limit;
+            }
+        }
+    }
+
+    void add_keys(KeyBitmap& keys) const
+    {
+        for (ObjKey key : m_keys)
+            keys.add(key); // Throws
+    }
+
+protected:
+    // Ordered by key
+    std::vector<ObjKey> m_keys;
+    bool m_used = false;
+};
+
 class ParentNode {
     typedef ParentNode ThisType;
 
@@ -150,6 +212,67 @@ public:
     }
     virtual void index_based_aggregate(size_t, Evaluator) {}
 
+    // Add the keys of the objects given by index_based_aggregate() to `keys`,
+    // without reading the objects. Returns false if the node can't give them.
+    virtual bool index_based_keys(KeyBitmap&) const
+    {
+        return false;
+    }
+    // False if index_based_aggregate() also gives candidates which do not
+    // match this node, and which are only ruled out by evaluating it
+    virtual bool index_based_exact() const
+    {
+        return true;
+    }
+
+    // Like has_search_index() and index_based_aggregate(), but also use the
+    // matches given by the query planner, if any
+    bool has_index_matches() const
+    {
+        return m_planned_matches.is_used() || has_search_index();
+    }
+    void index_matches_aggregate(size_t limit, Evaluator evaluator)
+    {
+        if (m_planned_matches.is_used()) {
+            m_planned_matches.aggregate(*m_table, limit, evaluator);
+        }
+        else {
+            index_based_aggregate(limit, evaluator);
+        }
+    }
+
+    // The number of objects matching this node, if the index lookup done by
+    // init() gives it without reading the objects, or npos
+    virtual size_t index_based_count() const
+    {
+        return npos;
+    }
+    size_t index_matches_count() const
+    {
+        if (m_planned_matches.is_used())
+            return m_planned_matches.size();
+        return index_based_count();
+    }
+    bool index_matches_keys(KeyBitmap& keys) const
+    {
+        if (m_planned_matches.is_used()) {
+            m_planned_matches.add_keys(keys); // Throws
+            return true;
+        }
+        return index_based_keys(keys); // Throws
+    }
+    bool index_matches_exact() const
+    {
+        return m_planned_matches.is_used() || index_based_exact();
+    }
+
+    // If this node is a single `column == value` condition, set `value` and
+    // return true. Such conditions can be answered by a composite index.
+    virtual bool get_equal_value(Mixed&) const
+    {
+        return false;
+    }
+
     void gather_children(std::vector<ParentNode*>& v)
     {
         m_children.clear();
@@ -314,6 +437,11 @@ public:
     size_t m_probes = 0;
     size_t m_matches = 0;
 
+    // The objects matching this and the other conditions covered by a composite
+    // index or by the intersection of the index matches of the conditions, set
+    // up by Query::init() on one of the covered nodes
+    IndexMatches m_planned_matches;
+
 protected:
     typedef bool (ParentNode::*Column_action_specialized)(QueryStateBase*, ArrayPayload*, size_t);
     Column_action_specialized m_column_action_specializer = nullptr;
@@ -435,6 +563,48 @@ protected:
     ArrayPayload* m_source_column = nullptr;
 };
 
+// Comparisons which can be answered by a range index on the column
+template <class TConditionFunction>
+struct RangeSearch {
+    static constexpr bool enabled = false;
+    static constexpr RangeIndex::Condition condition = RangeIndex::Condition::equal;
+};
+template <>
+struct RangeSearch<Equal> {
+    static constexpr bool enabled = true;
+    static constexpr RangeIndex::Condition condition = RangeIndex::Condition::equal;
+};
+template <>
+struct RangeSearch<Greater> {
+    static constexpr bool enabled = true;
+    static constexpr RangeIndex::Condition condition = RangeIndex::Condition::greater;
+};
+template <>
+struct RangeSearch<GreaterEqual> {
+    static constexpr bool enabled = true;
+    static constexpr RangeIndex::Condition condition = RangeIndex::Condition::greater_equal;
+};
+template <>
+struct RangeSearch<Less> {
+    static constexpr bool enabled = true;
+    static constexpr RangeIndex::Condition condition = RangeIndex::Condition::less;
+};
+template <>
+struct RangeSearch<LessEqual> {
+    static constexpr bool enabled = true;
+    static constexpr RangeIndex::Condition condition = RangeIndex::Condition::less_equal;
+};
+
+// The objects matching a comparison, looked up in a range index on the
+// condition column. The index is only used when so few objects match that
+// visiting them beats scanning the column.
+class RangeIndexMatches : public IndexMatches {
+public:
+    // Returns the expected distance between matches if the index is used, or
+    // zero if it is not
+    double init(const Table& table, ColKey col_key, RangeIndex::Condition cond, Mixed value);
+};
+
 template <class LeafType>
 class IntegerNodeBase : public ColumnNodeBase {
     using ThisType = IntegerNodeBase<LeafType>;
@@ -639,6 +809,40 @@ public:
     {
     }
 
+    void init() override
+    {
+        BaseType::init();
+        if (RangeSearch<TConditionFunction>::enabled) {
+            if (double distance = m_range_matches.init(*this->m_table, this->m_condition_column_key,
+                                                       RangeSearch<TConditionFunction>::condition,
+                                                       Mixed(this->m_value))) {
+                this->m_dT = 0;
+                this->m_dD = distance;
+            }
+        }
+    }
+
+    bool has_search_index() const override
+    {
+        return m_range_matches.is_used();
+    }
+
+    void index_based_aggregate(size_t limit, Evaluator evaluator) override
+    {
+        m_range_matches.aggregate(*this->m_table, limit, evaluator);
+    }
+
+    bool index_based_keys(KeyBitmap& keys) const override
+    {
+        m_range_matches.add_keys(keys); // Throws
+        return true;
+    }
+
+    size_t index_based_count() const override
+    {
+        return m_range_matches.size();
+    }
+
     void aggregate_local_prepare(Action action, DataType col_id, bool is_nullable) override
     {
         this->m_fastmode_disabled = (col_id == type_Float || col_id == type_Double);
@@ -657,6 +861,9 @@ public:
 
     size_t find_first_local(size_t start, size_t end) override
     {
+        // A single row is checked faster in the leaf
+        if (m_range_matches.is_used() && end - start > 1)
+            return m_range_matches.find_first(this->m_cluster, start, end);
         return this->m_leaf_ptr->template find_first<TConditionFunction>(this->m_value, start, end);
     }
 
@@ -675,6 +882,9 @@ public:
     {
         return std::unique_ptr<ParentNode>(new ThisType(*this));
     }
+
+private:
+    RangeIndexMatches m_range_matches;
 };
 
 template <class LeafType>
@@ -688,6 +898,12 @@ public:
         : BaseType(value, column_key)
     {
     }
+    // Match any of the values in 'needles', which must not be empty
+    IntegerNode(std::unordered_set<TConditionValue> needles, ColKey column_key)
+        : BaseType(*needles.begin(), column_key)
+        , m_needles(std::move(needles))
+    {
+    }
     ~IntegerNode()
     {
     }
@@ -700,8 +916,26 @@ public:
         if (has_search_index()) {
             // _search_index_init();
             m_result.clear();
-            auto index = ParentNode::m_table->get_search_index(ParentNode::m_condition_column_key);
-            index->find_all(m_result, BaseType::m_value);
+            ColKey col_key = ParentNode::m_condition_column_key;
+            // Without a search index the column has a hash index
+            auto find_all = [&](TConditionValue value) {
+                if (auto index = ParentNode::m_table->get_search_index(col_key)) {
+                    index->find_all(m_result, value);
+                }
+                else {
+                    ParentNode::m_table->get_hash_index(col_key)->find_all(Mixed(value), m_result);
+                }
+            };
+            if (m_needles.empty()) {
+                find_all(BaseType::m_value);
+            }
+            else {
+                // One lookup per needle, merged into a single ordered result
+                for (auto& needle : m_needles)
+                    find_all(needle);
+                std::sort(m_result.begin(), m_result.end());
+                m_result.erase(std::unique(m_result.begin(), m_result.end()), m_result.end());
+            }
             m_result_get = 0;
             m_last_start_key = ObjKey();
             IntegerNodeBase<LeafType>::m_dT = 0;
@@ -720,7 +954,16 @@ public:
 
     bool has_search_index() const override
     {
-        return this->m_table->has_search_index(IntegerNodeBase<LeafType>::m_condition_column_key);
+        ColKey col_key = IntegerNodeBase<LeafType>::m_condition_column_key;
+        return this->m_table->has_search_index(col_key) || this->m_table->has_hash_index(col_key);
+    }
+
+    bool get_equal_value(Mixed& value) const override
+    {
+        if (!m_needles.empty())
+            return false;
+        value = Mixed(BaseType::m_value);
+        return true;
     }
 
     void index_based_aggregate(size_t limit, Evaluator evaluator) override
@@ -733,8 +976,25 @@ public:
         }
     }
 
+    bool index_based_keys(KeyBitmap& keys) const override
+    {
+        for (ObjKey key : m_result)
+            keys.add(key); // Throws
+        return true;
+    }
+
+    size_t index_based_count() const override
+    {
+        return m_result.size();
+    }
+
     void aggregate_local_prepare(Action action, DataType col_id, bool is_nullable) override
     {
+        if (!m_needles.empty()) {
+            // The specialized leaf searches only know about m_value
+            ParentNode::aggregate_local_prepare(action, col_id, is_nullable);
+            return;
+        }
         this->m_fastmode_disabled = (col_id == type_Float || col_id == type_Double);
         this->m_action = action;
         this->m_find_callback_specialized =
@@ -744,6 +1004,8 @@ public:
     size_t aggregate_local(QueryStateBase* st, size_t start, size_t end, size_t local_limit,
                            ArrayPayload* source_column) override
     {
+        if (!m_needles.empty())
+            return ParentNode::aggregate_local(st, start, end, local_limit, source_column);
         constexpr int cond = Equal::condition;
         return this->aggregate_local_impl(st, start, end, local_limit, source_column, cond);
     }
@@ -909,10 +1171,41 @@ public:
     {
         ParentNode::init();
         m_dD = 100.0;
+        if (RangeSearch<TConditionFunction>::enabled) {
+            if (double distance = m_range_matches.init(*m_table, m_condition_column_key,
+                                                       RangeSearch<TConditionFunction>::condition, Mixed(m_value))) {
+                m_dT = 0;
+                m_dD = distance;
+            }
+        }
+    }
+
+    bool has_search_index() const override
+    {
+        return m_range_matches.is_used();
+    }
+
+    void index_based_aggregate(size_t limit, Evaluator evaluator) override
+    {
+        m_range_matches.aggregate(*m_table, limit, evaluator);
+    }
+
+    bool index_based_keys(KeyBitmap& keys) const override
+    {
+        m_range_matches.add_keys(keys); // Throws
+        return true;
+    }
+
+    size_t index_based_count() const override
+    {
+        return m_range_matches.size();
     }
 
     size_t find_first_local(size_t start, size_t end) override
     {
+        if (m_range_matches.is_used() && end - start > 1)
+            return m_range_matches.find_first(m_cluster, start, end);
+
         TConditionFunction cond;
 
         auto find = [&](bool nullability) {
@@ -957,6 +1250,7 @@ public:
 
 protected:
     TConditionValue m_value;
+    RangeIndexMatches m_range_matches;
     // Leaf cache
     using LeafCacheStorage = typename std::aligned_storage<sizeof(LeafType), alignof(LeafType)>::type;
     using LeafPtr = std::unique_ptr<LeafType, PlacementDelete>;
@@ -1005,6 +1299,14 @@ public:
         return not_found;
     }
 
+    std::string describe(util::serializer::SerialisationState& state) const override
+    {
+        REALM_ASSERT(m_condition_column_key);
+        return state.describe_column(ParentNode::m_table, m_condition_column_key) +
+               util::serializer::value_separator + "@size" + " " + TConditionFunction::description() + " " +
+               util::serializer::print_value(m_value);
+    }
+
     std::unique_ptr<ParentNode> clone() const override
     {
         return std::unique_ptr<ParentNode>(new SizeNode(*this));
@@ -1059,18 +1361,28 @@ public:
     size_t find_first_local(size_t start, size_t end) override
     {
         for (size_t s = start; s < end; ++s) {
+            // A list which has never been written to has no ref, but is empty
             ref_type ref = m_leaf_ptr->get(s);
+            int64_t sz = 0;
             if (ref) {
                 ListType list(m_table.unchecked_ptr()->get_alloc());
                 list.init_from_ref(ref);
-                int64_t sz = list.size();
-                if (TConditionFunction()(sz, m_value))
-                    return s;
+                sz = list.size();
             }
+            if (TConditionFunction()(sz, m_value))
+                return s;
         }
         return not_found;
     }
 
+    std::string describe(util::serializer::SerialisationState& state) const override
+    {
+        REALM_ASSERT(m_condition_column_key);
+        return state.describe_column(ParentNode::m_table, m_condition_column_key) +
+               util::serializer::value_separator + "@count" + " " + TConditionFunction::description() + " " +
+               util::serializer::print_value(m_value);
+    }
+
     std::unique_ptr<ParentNode> clone() const override
     {
         return std::unique_ptr<ParentNode>(new SizeListNode(*this));
@@ -1198,6 +1510,14 @@ public:
         m_dD = 100.0;
     }
 
+    bool get_equal_value(Mixed& value) const override
+    {
+        if (!std::is_same<TConditionFunction, Equal>::value)
+            return false;
+        value = Mixed(m_value);
+        return true;
+    }
+
     size_t find_first_local(size_t start, size_t end) override
     {
         TConditionFunction condition;
@@ -1281,8 +1601,51 @@ class TimestampNode : public TimestampNodeBase {
 public:
     using TimestampNodeBase::TimestampNodeBase;
 
+    void init() override
+    {
+        TimestampNodeBase::init();
+        if (RangeSearch<TConditionFunction>::enabled) {
+            if (double distance = m_range_matches.init(*m_table, m_condition_column_key,
+                                                       RangeSearch<TConditionFunction>::condition, Mixed(m_value))) {
+                m_dT = 0;
+                m_dD = distance;
+            }
+        }
+    }
+
+    bool has_search_index() const override
+    {
+        return m_range_matches.is_used();
+    }
+
+    void index_based_aggregate(size_t limit, Evaluator evaluator) override
+    {
+        m_range_matches.aggregate(*m_table, limit, evaluator);
+    }
+
+    bool index_based_keys(KeyBitmap& keys) const override
+    {
+        m_range_matches.add_keys(keys); // Throws
+        return true;
+    }
+
+    size_t index_based_count() const override
+    {
+        return m_range_matches.size();
+    }
+
+    bool get_equal_value(Mixed& value) const override
+    {
+        if (!std::is_same<TConditionFunction, Equal>::value)
+            return false;
+        value = Mixed(m_value);
+        return true;
+    }
+
     size_t find_first_local(size_t start, size_t end) override
     {
+        if (m_range_matches.is_used() && end - start > 1)
+            return m_range_matches.find_first(m_cluster, start, end);
         return m_leaf_ptr->find_first<TConditionFunction>(m_value, start, end);
     }
 
@@ -1297,6 +1660,22 @@ public:
     {
         return std::unique_ptr<ParentNode>(new TimestampNode(*this));
     }
+
+private:
+    RangeIndexMatches m_range_matches;
+};
+
+// Conditions on strings which only match values containing the needle (or,
+// for Like, every literal part of the pattern), so that the candidates can be
+// found in a trigram index.
+template <class TConditionFunction>
+struct TrigramSearch {
+    static constexpr bool is_like = realm::is_any<TConditionFunction, Like, LikeIns>::value;
+    static constexpr bool enabled =
+        is_like || realm::is_any<TConditionFunction, Contains, ContainsIns, BeginsWith, BeginsWithIns, EndsWith,
+                                 EndsWithIns>::value;
+    static constexpr bool case_insensitive =
+        realm::is_any<TConditionFunction, ContainsIns, BeginsWithIns, EndsWithIns, LikeIns>::value;
 };
 
 class StringNodeBase : public ParentNode {
@@ -1352,6 +1731,33 @@ public:
     {
     }
 
+    bool has_search_index() const override
+    {
+        return m_use_index_candidates;
+    }
+
+    void index_based_aggregate(size_t limit, Evaluator evaluator) override
+    {
+        for (size_t t = 0; t < m_index_candidates.size() && limit > 0; ++t) {
+            auto obj = m_table->get_object(m_index_candidates[t]);
+            if (evaluator(obj)) {
+                --limit;
+            }
+        }
+    }
+
+    bool index_based_keys(KeyBitmap& keys) const override
+    {
+        for (ObjKey key : m_index_candidates)
+            keys.add(key); // Throws
+        return true;
+    }
+
+    bool index_based_exact() const override
+    {
+        return false;
+    }
+
     virtual std::string describe(util::serializer::SerialisationState& state) const override
     {
         REALM_ASSERT(m_condition_column_key);
@@ -1378,10 +1784,48 @@ protected:
     size_t m_leaf_start = 0;
     size_t m_leaf_end = 0;
 
+    // Candidates found in a trigram or search index on the column, ordered by key
+    std::vector<ObjKey> m_index_candidates;
+    bool m_use_index_candidates = false;
+
     inline StringData get_string(size_t s)
     {
         return m_leaf_ptr->get(s);
     }
+
+    // Look up the candidates in the trigram index of the column, if it has
+    // one and the needle is long enough to be useful
+    void trigram_index_init(bool is_like, bool case_insensitive);
+
+    template <class TConditionFunction>
+    void trigram_index_init()
+    {
+        using Search = TrigramSearch<TConditionFunction>;
+        if (Search::enabled)
+            trigram_index_init(Search::is_like, Search::case_insensitive);
+    }
+
+    // Look up the matches of a prefix in the search index of the column, if
+    // it has one. Returns false if the index cannot be used.
+    bool prefix_index_init(bool case_insensitive);
+
+    // Return the first candidate row in [start, end) for which `match`
+    // returns true
+    template <class Match>
+    size_t find_first_index_candidate(size_t start, size_t end, Match match)
+    {
+        if (start >= end)
+            return not_found;
+        ObjKey first_key = m_cluster->get_real_key(start);
+        ObjKey last_key = m_cluster->get_real_key(end - 1);
+        auto it = std::lower_bound(m_index_candidates.begin(), m_index_candidates.end(), first_key);
+        for (; it != m_index_candidates.end() && *it <= last_key; ++it) {
+            size_t s = m_cluster->lower_bound_key(ObjKey(it->value - m_cluster->get_offset()));
+            if (match(s))
+                return s;
+        }
+        return not_found;
+    }
 };
 
 // Conditions for strings. Note that Equal is specialized later in this file!
@@ -1409,16 +1853,26 @@ public:
         m_dD = 100.0;
 
         StringNodeBase::init();
+        if (std::is_same<TConditionFunction, BeginsWith>::value ||
+            std::is_same<TConditionFunction, BeginsWithIns>::value) {
+            if (prefix_index_init(std::is_same<TConditionFunction, BeginsWithIns>::value))
+                return;
+        }
+        trigram_index_init<TConditionFunction>();
     }
 
     size_t find_first_local(size_t start, size_t end) override
     {
         TConditionFunction cond;
+        auto match = [&](size_t s) {
+            return cond(StringData(m_value), m_ucase.c_str(), m_lcase.c_str(), get_string(s));
+        };
 
-        for (size_t s = start; s < end; ++s) {
-            StringData t = get_string(s);
+        if (m_use_index_candidates)
+            return find_first_index_candidate(start, end, match);
 
-            if (cond(StringData(m_value), m_ucase.c_str(), m_lcase.c_str(), t))
+        for (size_t s = start; s < end; ++s) {
+            if (match(s))
                 return s;
         }
         return not_found;
@@ -1476,17 +1930,20 @@ public:
         m_dD = 100.0;
 
         StringNodeBase::init();
+        trigram_index_init<Contains>();
     }
 
 
     size_t find_first_local(size_t start, size_t end) override
     {
         Contains cond;
+        auto match = [&](size_t s) { return cond(StringData(m_value), m_charmap, get_string(s)); };
 
-        for (size_t s = start; s < end; ++s) {
-            StringData t = get_string(s);
+        if (m_use_index_candidates)
+            return find_first_index_candidate(start, end, match);
 
-            if (cond(StringData(m_value), m_charmap, t))
+        for (size_t s = start; s < end; ++s) {
+            if (match(s))
                 return s;
         }
         return not_found;
@@ -1555,21 +2012,27 @@ public:
         m_dD = 100.0;
 
         StringNodeBase::init();
+        trigram_index_init<ContainsIns>();
     }
 
 
     size_t find_first_local(size_t start, size_t end) override
     {
         ContainsIns cond;
+        auto match = [&](size_t s) {
+            return cond(StringData(m_value), m_ucase.c_str(), m_lcase.c_str(), m_charmap, get_string(s));
+        };
+
+        if (m_use_index_candidates)
+            return find_first_index_candidate(start, end, match);
 
         for (size_t s = start; s < end; ++s) {
-            StringData t = get_string(s);
             // The current behaviour is to return all results when querying for a null string.
             // See comment above Query_NextGen_StringConditions on why every string including "" contains null.
             if (!bool(m_value)) {
                 return s;
             }
-            if (cond(StringData(m_value), m_ucase.c_str(), m_lcase.c_str(), m_charmap, t))
+            if (match(s))
                 return s;
         }
         return not_found;
@@ -1618,6 +2081,16 @@ public:
         return m_has_search_index;
     }
 
+    size_t index_based_count() const override
+    {
+        return m_results_end - m_results_start;
+    }
+
+    bool index_based_exact() const override
+    {
+        return true;
+    }
+
     void cluster_changed() override
     {
         // If we use searchindex, we do not need further access to clusters
@@ -1661,10 +2134,19 @@ class StringNode<Equal> : public StringNodeEqualBase {
 public:
     using StringNodeEqualBase::StringNodeEqualBase;
 
+    // Match any of the strings in 'needles', which must not be empty
+    StringNode(const std::vector<StringData>& needles, ColKey column)
+        : StringNodeEqualBase(needles.front(), column)
+    {
+        for (auto needle : needles)
+            add_needle(needle);
+    }
+
     void table_changed() override
     {
         StringNodeBase::table_changed();
         m_has_search_index = m_table.unchecked_ptr()->has_search_index(m_condition_column_key) ||
+                             m_table.unchecked_ptr()->has_hash_index(m_condition_column_key) ||
                              m_table.unchecked_ptr()->get_primary_key_column() == m_condition_column_key;
     }
 
@@ -1672,6 +2154,14 @@ public:
 
     void consume_condition(StringNode<Equal>* other);
 
+    bool get_equal_value(Mixed& value) const override
+    {
+        if (!m_needles.empty())
+            return false;
+        value = m_value ? Mixed(StringData(*m_value)) : Mixed();
+        return true;
+    }
+
     std::unique_ptr<ParentNode> clone() const override
     {
         return std::unique_ptr<ParentNode>(new StringNode<Equal>(*this));
@@ -1697,7 +2187,15 @@ public:
     {
         if (limit == 0)
             return;
-        if (m_index_matches == nullptr) {
+        if (m_use_key_matches) {
+            for (size_t t = 0; t < m_results_end && limit > 0; ++t) {
+                auto obj = m_table->get_object(m_key_matches[t]);
+                if (evaluator(obj)) {
+                    --limit;
+                }
+            }
+        }
+        else if (m_index_matches == nullptr) {
             if (m_results_end) { // 1 result
                 auto obj = m_table->get_object(m_actual_key);
                 evaluator(obj);
@@ -1713,11 +2211,31 @@ public:
         }
     }
 
+    bool index_based_keys(KeyBitmap& keys) const override
+    {
+        if (m_use_key_matches) {
+            for (ObjKey key : m_key_matches)
+                keys.add(key); // Throws
+        }
+        else if (m_index_matches == nullptr) {
+            if (m_results_end)
+                keys.add(m_actual_key); // Throws
+        }
+        else {
+            for (size_t t = m_results_start; t < m_results_end; ++t)
+                keys.add(ObjKey(m_index_matches->get(t))); // Throws
+        }
+        return true;
+    }
+
 private:
     std::unique_ptr<IntegerColumn> m_index_matches;
 
     ObjKey get_key(size_t ndx) override
     {
+        if (m_use_key_matches) {
+            return ndx < m_key_matches.size() ? m_key_matches[ndx] : ObjKey();
+        }
         if (IntegerColumn* vec = m_index_matches.get()) {
             return ObjKey(vec->get(ndx));
         }
@@ -1728,8 +2246,13 @@ private:
     }
 
     size_t _find_first_local(size_t start, size_t end) override;
+    void add_needle(StringData needle);
     std::unordered_set<StringData> m_needles;
     std::vector<StringBuffer> m_needle_storage;
+    // Union of the index lookups of all needles, or the matches found in a
+    // hash index, ordered by key
+    std::vector<ObjKey> m_key_matches;
+    bool m_use_key_matches = false;
 };
 
 
@@ -1792,6 +2315,13 @@ public:
         }
     }
 
+    bool index_based_keys(KeyBitmap& keys) const override
+    {
+        for (ObjKey key : m_index_matches)
+            keys.add(key); // Throws
+        return true;
+    }
+
 private:
     // Used for index lookup
     std::vector<ObjKey> m_index_matches;
@@ -1905,6 +2435,41 @@ public:
             v.clear();
             condition->gather_children(v);
         }
+
+        init_index_union();
+    }
+
+    bool has_search_index() const override
+    {
+        return m_use_index_union;
+    }
+
+    void index_based_aggregate(size_t limit, Evaluator evaluator) override
+    {
+        if (limit == 0)
+            return;
+        m_index_union.for_each([&](ObjKey key) {
+            auto obj = m_table->get_object(key);
+            if (evaluator(obj))
+                --limit;
+            return limit == 0;
+        });
+    }
+
+    size_t index_based_count() const override
+    {
+        return (m_use_index_union && m_index_union_exact) ? m_index_union.size() : npos;
+    }
+
+    bool index_based_keys(KeyBitmap& keys) const override
+    {
+        keys |= m_index_union; // Throws
+        return true;
+    }
+
+    bool index_based_exact() const override
+    {
+        return m_index_union_exact;
     }
 
     size_t find_first_local(size_t start, size_t end) override
@@ -2001,6 +2566,39 @@ private:
         }
     }
 
+    // When every condition is a single condition answered by an index, the
+    // objects matching any of them are in the union of the index matches, and
+    // the others need not be read. The union is made from the keys found by
+    // the index lookups, so it is cheap even when most objects match. It holds
+    // exactly the matching objects unless a condition only gives candidates.
+    void init_index_union()
+    {
+        m_index_union.clear();
+        m_use_index_union = false;
+        m_index_union_exact = true;
+        if (m_conditions.empty())
+            return;
+
+        for (auto& condition : m_conditions) {
+            if (condition->m_child || !condition->has_index_matches())
+                return;
+        }
+        for (auto& condition : m_conditions) {
+            if (!condition->index_matches_keys(m_index_union)) {
+                m_index_union.clear();
+                return;
+            }
+            m_index_union_exact = m_index_union_exact && condition->index_matches_exact();
+        }
+        m_use_index_union = true;
+        m_dT = 0.0;
+        m_dD = double(m_table->size() + 1) / (m_index_union.size() + 1);
+    }
+
+    KeyBitmap m_index_union;
+    bool m_use_index_union = false;
+    bool m_index_union_exact = true;
+
     // start index of the last find for each cond
     std::vector<size_t> m_start;
     // last looked at index of the lasft find for each cond
@@ -2310,15 +2908,20 @@ public:
     size_t find_first_local(size_t start, size_t end) override
     {
         if (m_column_type == type_Link) {
+            // The first match is the earliest match of any of the keys
+            size_t first = realm::npos;
             for (auto& key : m_target_keys) {
                 if (key) {
                     // LinkColumn stores link to row N as the integer N + 1
                     auto pos = static_cast<const ArrayKey*>(m_leaf_ptr)->find_first(key, start, end);
                     if (pos != realm::npos) {
-                        return pos;
+                        first = pos;
+                        end = pos;
                     }
                 }
             }
+            if (first != realm::npos)
+                return first;
         }
         else if (m_column_type == type_LinkList) {
             ArrayKeyNonNullable arr(m_table.unchecked_ptr()->get_alloc());
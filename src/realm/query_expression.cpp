@@ -49,8 +49,9 @@ void LinkMap::set_base_table(ConstTableRef table)
 
 void LinkMap::collect_dependencies(std::vector<TableKey>& tables) const
 {
-    for (auto& t : m_tables) {
-        TableKey k = t->get_key();
+    // The base table is the table of the query or of the enclosing link
+    for (auto it = m_tables.begin() + 1; it < m_tables.end(); ++it) {
+        TableKey k = (*it)->get_key();
         if (find(tables.begin(), tables.end(), k) == tables.end()) {
             tables.push_back(k);
         }
@@ -116,11 +117,11 @@ void LinkMap::map_links(size_t column, ObjKey key, LinkMapFunction& lm) const
     }
 }
 
-void LinkMap::map_links(size_t column, size_t row, LinkMapFunction& lm) const
+void LinkMap::map_links(size_t column, size_t row, LinkMapFunction& lm, bool first_hop_only) const
 {
     REALM_ASSERT(m_leaf_ptr != nullptr);
 
-    bool last = (column + 1 == m_link_column_keys.size());
+    bool last = first_hop_only || (column + 1 == m_link_column_keys.size());
     ColumnType type = m_link_types[column];
     if (type == col_type_Link) {
         if (ObjKey k = static_cast<const ArrayKey*>(m_leaf_ptr)->get(row)) {
@@ -173,6 +174,28 @@ std::vector<ObjKey> LinkMap::get_origin_ndxs(ObjKey key, size_t column) const
     }
     std::vector<ObjKey> keys = get_origin_ndxs(key, column + 1);
     std::vector<ObjKey> ret;
+    get_origins(column, keys, ret);
+    return ret;
+}
+
+std::vector<ObjKey> LinkMap::get_origin_keys(std::vector<ObjKey> target_keys) const
+{
+    for (size_t column = 0; column < m_link_column_keys.size(); ++column)
+        m_tables[column]->report_invalid_key(m_link_column_keys[column]);
+    std::sort(target_keys.begin(), target_keys.end());
+    for (size_t column = m_link_types.size(); column > 0; --column) {
+        std::vector<ObjKey> origins;
+        get_origins(column - 1, target_keys, origins);
+        // Objects linking to several of the keys are only followed once
+        std::sort(origins.begin(), origins.end());
+        origins.erase(std::unique(origins.begin(), origins.end()), origins.end());
+        target_keys.swap(origins);
+    }
+    return target_keys;
+}
+
+void LinkMap::get_origins(size_t column, const std::vector<ObjKey>& keys, std::vector<ObjKey>& origins) const
+{
     auto origin_col = m_link_column_keys[column];
     auto origin = m_tables[column];
     auto link_type = m_link_types[column];
@@ -184,14 +207,15 @@ std::vector<ObjKey> LinkMap::get_origin_ndxs(ObjKey key, size_t column) const
         for (auto k : keys) {
             ConstObj o = link_table.unchecked_ptr()->get_object(k);
             if (forward_type == type_Link) {
-                ret.push_back(o.get<ObjKey>(link_col_ndx));
+                if (ObjKey link = o.get<ObjKey>(link_col_ndx))
+                    origins.push_back(link);
             }
             else {
                 REALM_ASSERT(forward_type == type_LinkList);
                 auto ll = o.get_linklist(link_col_ndx);
                 auto sz = ll.size();
                 for (size_t i = 0; i < sz; i++) {
-                    ret.push_back(ll.get(i));
+                    origins.push_back(ll.get(i));
                 }
             }
         }
@@ -202,11 +226,10 @@ std::vector<ObjKey> LinkMap::get_origin_ndxs(ObjKey key, size_t column) const
             ConstObj o = target->get_object(k);
             auto cnt = o.get_backlink_count(*origin, origin_col);
             for (size_t i = 0; i < cnt; i++) {
-                ret.push_back(o.get_backlink(*origin, origin_col, i));
+                origins.push_back(o.get_backlink(*origin, origin_col, i));
             }
         }
     }
-    return ret;
 }
 
 void Columns<Link>::evaluate(size_t index, ValueBase& destination)
@@ -254,7 +277,7 @@ void ColumnListBase::get_lists(size_t index, Value<ref_type>& destination, size_
             ref_type val = 0;
             if (sz == 1) {
                 ConstObj obj = m_link_map.get_target_table()->get_object(links[0]);
-                val = to_ref(obj.get<int64_t>(m_column_key));
+                val = to_ref(obj._get<int64_t>(m_column_key.get_index()));
             }
             destination.init(false, 1, val);
         }
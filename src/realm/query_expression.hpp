@@ -146,6 +146,7 @@ The Columns class encapsulates all this into a simple class that, for any type T
 
 #include <numeric>
 #include <algorithm>
+#include <unordered_map>
 
 // Normally, if a next-generation-syntax condition is supported by the old query_engine.hpp, a query_engine node is
 // created because it's faster (by a factor of 5 - 10). Because many of our existing next-generation-syntax unit
@@ -313,7 +314,7 @@ struct Common<T1, T2, true, false, b> {
 
 
 struct ValueBase {
-    static const size_t chunk_size = 8;
+    static const size_t chunk_size = 256;
     virtual void export_bool(ValueBase& destination) const = 0;
     virtual void export_Timestamp(ValueBase& destination) const = 0;
     virtual void export_int(ValueBase& destination) const = 0;
@@ -365,6 +366,8 @@ std::unique_ptr<Expression> make_expression(Args&&... args)
     return std::unique_ptr<Expression>(new T(std::forward<Args>(args)...));
 }
 
+class LinkMap;
+
 class Subexpr {
 public:
     virtual ~Subexpr()
@@ -388,6 +391,11 @@ public:
     {
     }
 
+    // Called by the expression before every search of the query
+    virtual void init()
+    {
+    }
+
     // Recursively fetch tables of columns in expression tree. Used when user first builds a stand-alone expression
     // and
     // binds it to a Query at a later time
@@ -415,6 +423,18 @@ public:
         return {};
     }
 
+    // A column reached through links returns the links, and the same column
+    // of the target table without them, so that a condition on it can be
+    // evaluated on the target table first, see Compare::init().
+    virtual const LinkMap* get_column_links() const
+    {
+        return nullptr;
+    }
+    virtual std::unique_ptr<Subexpr> get_target_column() const
+    {
+        return nullptr;
+    }
+
     virtual void evaluate(size_t index, ValueBase& destination) = 0;
     // This function supports SubColumnAggregate
     virtual void evaluate(ObjKey, ValueBase&)
@@ -795,7 +815,8 @@ To indicate nulls, we could have chosen a separate bool vector or some other bit
 performance, we customize indication of nulls to match the same indication that is used in the persisted database
 file
 
-Queries in query_expression.hpp execute by processing chunks of 8 rows at a time. Assume you have a column:
+Queries in query_expression.hpp execute by processing chunks of up to ValueBase::chunk_size rows at a time (8 rows
+in the example below). Assume you have a column:
 
     price (int) = {1, 2, 3, null, 1, 6, 6, 9, 5, 2, null}
 
@@ -844,6 +865,32 @@ struct NullableVector {
         m_null = other.m_null;
     }
 
+    NullableVector& operator=(NullableVector&& other) noexcept
+    {
+        if (this != &other) {
+            if (other.m_first == other.m_cache) {
+                // Fits in our storage whatever its capacity
+                std::copy_n(other.m_first, other.m_size, m_first);
+            }
+            else {
+                dealloc();
+                m_first = other.m_first;
+                m_capacity = other.m_capacity;
+                other.m_first = other.m_cache;
+                other.m_capacity = prealloc;
+            }
+            m_size = other.m_size;
+            m_null = other.m_null;
+            other.m_size = 0;
+        }
+        return *this;
+    }
+
+    NullableVector(NullableVector&& other) noexcept
+    {
+        *this = std::move(other);
+    }
+
     ~NullableVector()
     {
         dealloc();
@@ -921,19 +968,16 @@ struct NullableVector {
         }
     }
 
+    // Storage is only ever grown, so a vector that is re-initialized for every chunk of a query does not
+    // allocate again once it has reached its working size
     void init(size_t size)
     {
-        if (size == m_size)
-            return;
-
-        dealloc();
-        m_size = size;
-        if (m_size > 0) {
-            if (m_size > prealloc)
-                m_first = reinterpret_cast<t_storage*>(new t_storage[m_size]);
-            else
-                m_first = m_cache;
+        if (size > m_capacity) {
+            dealloc();
+            m_first = reinterpret_cast<t_storage*>(new t_storage[size]);
+            m_capacity = size;
         }
+        m_size = size;
     }
 
     void init(size_t size, T values)
@@ -953,16 +997,16 @@ struct NullableVector {
 
     void dealloc()
     {
-        if (m_first) {
-            if (m_size > prealloc)
-                delete[] m_first;
-            m_first = nullptr;
-        }
+        if (m_first != m_cache)
+            delete[] m_first;
+        m_first = m_cache;
+        m_capacity = prealloc;
     }
 
     t_storage m_cache[prealloc];
     t_storage* m_first = &m_cache[0];
     size_t m_size = 0;
+    size_t m_capacity = prealloc;
 
     int64_t m_null = reinterpret_cast<int64_t>(&m_null); // choose magic value to represent nulls
 };
@@ -1182,6 +1226,8 @@ public:
 
     Value(const Value&) = default;
     Value& operator=(const Value&) = default;
+    Value(Value&&) noexcept = default;
+    Value& operator=(Value&&) noexcept = default;
 
     void init(bool from_link_list, size_t values, T v)
     {
@@ -1223,7 +1269,23 @@ public:
 
     void evaluate(size_t, ValueBase& destination) override
     {
-        destination.import(*this);
+        size_t rows = destination.m_values;
+        if (ValueBase::m_from_link_list || ValueBase::m_values != 1 || rows <= 1) {
+            destination.import(*this);
+            return;
+        }
+
+        // A constant is the same for every row, so repeat it for all the rows asked for. This lets an operator
+        // combining it with a column process a whole chunk at a time.
+        Value<T> v;
+        Value<T>* d = dynamic_cast<Value<T>*>(&destination);
+        if (!d)
+            d = &v;
+        d->init(false, rows);
+        std::fill_n(d->m_storage.m_first, rows, m_storage.m_first[0]);
+        d->m_storage.m_null = m_storage.m_null;
+        if (d == &v)
+            destination.import(v);
     }
 
 
@@ -1285,7 +1347,7 @@ public:
     export2(ValueBase& destination) const
     {
         Value<D>& d = static_cast<Value<D>&>(destination);
-        d.init(ValueBase::m_from_link_list, ValueBase::m_values, D());
+        d.init(ValueBase::m_from_link_list, ValueBase::m_values);
         for (size_t t = 0; t < ValueBase::m_values; t++) {
             if (m_storage.is_null(t))
                 d.m_storage.set_null(t);
@@ -1348,6 +1410,16 @@ public:
 
     REALM_FORCEINLINE void import(const ValueBase& source) override
     {
+        // No conversion needed, so copy the storage as a whole
+        if (auto same = dynamic_cast<const Value<T>*>(&source)) {
+            if (same != this) {
+                m_storage = same->m_storage;
+                ValueBase::m_from_link_list = same->m_from_link_list;
+                ValueBase::m_values = same->m_values;
+            }
+            return;
+        }
+
         if (std::is_same<T, int>::value)
             source.export_int(*this);
         else if (std::is_same<T, Timestamp>::value)
@@ -1370,15 +1442,16 @@ public:
             REALM_ASSERT_DEBUG(false);
     }
 
-    // Given a TCond (==, !=, >, <, >=, <=) and two Value<T>, return index of first match
+    // Given a TCond (==, !=, >, <, >=, <=) and two Value<T>, return index of first match at or after 'begin'. When
+    // values come from a link list they all belong to a single row, so 'begin' must then be 0.
     template <class TCond>
-    REALM_FORCEINLINE static size_t compare_const(const Value<T>* left, Value<T>* right)
+    REALM_FORCEINLINE static size_t compare_const(const Value<T>* left, Value<T>* right, size_t begin = 0)
     {
         TCond c;
 
         size_t sz = right->ValueBase::m_values;
         bool left_is_null = left->m_storage.is_null(0);
-        for (size_t m = 0; m < sz; m++) {
+        for (size_t m = begin; m < sz; m++) {
             if (c(left->m_storage[0], right->m_storage[m], left_is_null, right->m_storage.is_null(m)))
                 return right->m_from_link_list ? 0 : m;
         }
@@ -1387,14 +1460,14 @@ public:
     }
 
     template <class TCond>
-    REALM_FORCEINLINE static size_t compare(Value<T>* left, Value<T>* right)
+    REALM_FORCEINLINE static size_t compare(Value<T>* left, Value<T>* right, size_t begin = 0)
     {
         TCond c;
 
         if (!left->m_from_link_list && !right->m_from_link_list) {
             // Compare values one-by-one (one value is one row; no link lists)
             size_t min = minimum(left->ValueBase::m_values, right->ValueBase::m_values);
-            for (size_t m = 0; m < min; m++) {
+            for (size_t m = begin; m < min; m++) {
 
                 if (c(left->m_storage[m], right->m_storage[m], left->m_storage.is_null(m),
                       right->m_storage.is_null(m)))
@@ -1884,6 +1957,17 @@ public:
     }
 
     std::vector<ObjKey> get_origin_ndxs(ObjKey key, size_t column = 0) const;
+    /// The objects of the base table linking to any of the target objects,
+    /// in ascending order. Every hop is taken once for all the objects.
+    std::vector<ObjKey> get_origin_keys(std::vector<ObjKey> target_keys) const;
+
+    /// Conditions on the target table are evaluated on all of it once, rather
+    /// than on the objects linked to from each object of the base table,
+    /// unless the target table is the larger one.
+    bool evaluate_target_first() const
+    {
+        return links_exist() && get_target_table()->size() <= get_base_table()->size();
+    }
 
     size_t count_links(size_t row) const
     {
@@ -1904,6 +1988,23 @@ public:
         map_links(0, row, lm);
     }
 
+    /// Only the objects linked to by the first link of the row, which are
+    /// followed the rest of the way by map_links_from_first_hop()
+    void map_first_hop(size_t row, LinkMapFunction& lm) const
+    {
+        map_links(0, row, lm, true);
+    }
+
+    void map_links_from_first_hop(ObjKey key, LinkMapFunction& lm) const
+    {
+        if (m_link_column_keys.size() == 1) {
+            lm.consume(key);
+        }
+        else {
+            map_links(1, key, lm);
+        }
+    }
+
     bool only_unary_links() const
     {
         return m_only_unary_links;
@@ -1927,7 +2028,9 @@ public:
 
 private:
     void map_links(size_t column, ObjKey key, LinkMapFunction& lm) const;
-    void map_links(size_t column, size_t row, LinkMapFunction& lm) const;
+    void map_links(size_t column, size_t row, LinkMapFunction& lm, bool first_hop_only = false) const;
+    // Append the objects linking to `keys` through the link at `column`
+    void get_origins(size_t column, const std::vector<ObjKey>& keys, std::vector<ObjKey>& origins) const;
 
     void get_links(size_t row, std::vector<ObjKey>& result) const
     {
@@ -2049,6 +2152,16 @@ public:
         return ret;
     }
 
+    const LinkMap* get_column_links() const override
+    {
+        return &m_link_map;
+    }
+
+    std::unique_ptr<Subexpr> get_target_column() const override
+    {
+        return make_subexpr<Columns<T>>(m_column_key, m_link_map.get_target_table());
+    }
+
     void collect_dependencies(std::vector<TableKey>& tables) const override
     {
         m_link_map.collect_dependencies(tables);
@@ -2513,6 +2626,11 @@ public:
         m_expr->set_cluster(cluster);
     }
 
+    void init() override
+    {
+        m_expr->init();
+    }
+
     // Recursively fetch tables of columns in expression tree. Used when user first builds a stand-alone expression
     // and binds it to a Query at a later time
     ConstTableRef get_base_table() const override
@@ -2756,6 +2874,69 @@ public:
 template <typename>
 class ColumnListSize;
 
+// Reads the elements of a list for the query engine
+template <typename T>
+struct ListElements {
+    static size_t size(Allocator& alloc, ref_type list_ref, bool)
+    {
+        BPlusTree<T> list(alloc);
+        list.init_from_ref(list_ref);
+        return list.size();
+    }
+    static void get(Allocator& alloc, ref_type list_ref, bool, NullableVector<T>& storage, size_t& k)
+    {
+        BPlusTree<T> list(alloc);
+        list.init_from_ref(list_ref);
+        size_t s = list.size();
+        for (size_t j = 0; j < s; j++) {
+            storage.set(k++, list.get(j));
+        }
+    }
+};
+
+// The elements of a nullable int list are stored as optionals, so they must be
+// read through another B+tree type
+template <>
+struct ListElements<int64_t> {
+    using NullableTree = BPlusTree<util::Optional<int64_t>>;
+
+    static size_t size(Allocator& alloc, ref_type list_ref, bool nullable)
+    {
+        if (!nullable) {
+            BPlusTree<int64_t> list(alloc);
+            list.init_from_ref(list_ref);
+            return list.size();
+        }
+        NullableTree list(alloc);
+        list.init_from_ref(list_ref);
+        return list.size();
+    }
+    static void get(Allocator& alloc, ref_type list_ref, bool nullable, NullableVector<int64_t>& storage, size_t& k)
+    {
+        if (!nullable) {
+            BPlusTree<int64_t> list(alloc);
+            list.init_from_ref(list_ref);
+            size_t s = list.size();
+            for (size_t j = 0; j < s; j++) {
+                storage.set(k++, list.get(j));
+            }
+            return;
+        }
+        NullableTree list(alloc);
+        list.init_from_ref(list_ref);
+        size_t s = list.size();
+        for (size_t j = 0; j < s; j++) {
+            auto value = list.get(j);
+            if (value) {
+                storage.set(k++, *value);
+            }
+            else {
+                storage.set_null(k++);
+            }
+        }
+    }
+};
+
 template <typename T>
 class Columns<Lst<T>> : public Subexpr2<T>, public ColumnListBase {
 public:
@@ -2785,6 +2966,28 @@ public:
         ColumnListBase::set_cluster(cluster);
     }
 
+    bool has_search_index() const override
+    {
+        return m_link_map.get_target_table()->has_search_index(m_column_key);
+    }
+
+    // The objects with at least one element equal to `value`
+    std::vector<ObjKey> find_all(Mixed value) const override
+    {
+        std::vector<ObjKey> ret;
+        std::vector<ObjKey> result;
+
+        ListIndex* index = m_link_map.get_target_table()->get_list_index(m_column_key);
+        index->find_all(value, result);
+
+        for (ObjKey k : result) {
+            auto ndxs = m_link_map.get_origin_ndxs(k);
+            ret.insert(ret.end(), ndxs.begin(), ndxs.end());
+        }
+
+        return ret;
+    }
+
     void collect_dependencies(std::vector<TableKey>& tables) const override
     {
         m_link_map.collect_dependencies(tables);
@@ -2795,12 +2998,14 @@ public:
         Allocator& alloc = get_base_table()->get_alloc();
         Value<ref_type> list_refs;
         get_lists(index, list_refs, 1);
+        // The size in the header of the root is not the number of elements if
+        // the root is an inner node, or the leaf of a nullable int list
+        bool nullable = m_column_key.get_attrs().test(col_attr_Nullable);
         size_t sz = 0;
         for (size_t i = 0; i < list_refs.m_values; i++) {
             ref_type val = list_refs.m_storage[i];
             if (val) {
-                char* header = alloc.translate(val);
-                sz += Array::get_size_from_header(header);
+                sz += ListElements<T>::size(alloc, val, nullable);
             }
         }
         auto v = make_value_for_link<typename util::RemoveOptional<T>::type>(false, sz);
@@ -2808,12 +3013,7 @@ public:
         for (size_t i = 0; i < list_refs.m_values; i++) {
             ref_type list_ref = list_refs.m_storage[i];
             if (list_ref) {
-                BPlusTree<T> list(alloc);
-                list.init_from_ref(list_ref);
-                size_t s = list.size();
-                for (size_t j = 0; j < s; j++) {
-                    v.m_storage.set(k++, list.get(j));
-                }
+                ListElements<T>::get(alloc, list_ref, nullable, v.m_storage, k);
             }
         }
         destination.import(v);
@@ -2864,6 +3064,10 @@ public:
         : Columns<Lst<T>>(other)
     {
     }
+    bool has_search_index() const override
+    {
+        return false;
+    }
     void evaluate(size_t index, ValueBase& destination) override
     {
         REALM_ASSERT_DEBUG(dynamic_cast<Value<SizeOfList>*>(&destination) != nullptr);
@@ -2873,13 +3077,12 @@ public:
         Value<ref_type> list_refs;
         this->get_lists(index, list_refs, 1);
         d->init(list_refs.m_from_link_list, list_refs.m_values);
+        bool nullable = this->m_column_key.get_attrs().test(col_attr_Nullable);
 
         for (size_t i = 0; i < list_refs.m_values; i++) {
             ref_type list_ref = list_refs.m_storage[i];
             if (list_ref) {
-                BPlusTree<T> list(alloc);
-                list.init_from_ref(list_ref);
-                size_t s = list.size();
+                size_t s = ListElements<T>::size(alloc, list_ref, nullable);
                 d->m_storage.set(i, SizeOfList(s));
             }
             else {
@@ -3151,6 +3354,16 @@ public:
         return ret;
     }
 
+    const LinkMap* get_column_links() const override
+    {
+        return &m_link_map;
+    }
+
+    std::unique_ptr<Subexpr> get_target_column() const override
+    {
+        return make_subexpr<Columns<T>>(m_column_key, m_link_map.get_target_table());
+    }
+
     void collect_dependencies(std::vector<TableKey>& tables) const override
     {
         m_link_map.collect_dependencies(tables);
@@ -3190,34 +3403,42 @@ public:
             // Not a Link column
             size_t colsize = leaf->size();
 
-            // Now load `ValueBase::chunk_size` rows from from the leaf into m_storage. If it's an integer
-            // leaf, then it contains the method get_chunk() which copies these values in a super fast way (first
-            // case of the `if` below. Otherwise, copy the values one by one in a for-loop (the `else` case).
-            if (std::is_same<U, int64_t>::value && index + ValueBase::chunk_size <= colsize) {
-                Value<int64_t> v(false, ValueBase::chunk_size);
-
-                // If you want to modify 'chunk_size' then update Array::get_chunk()
-                REALM_ASSERT_3(ValueBase::chunk_size, ==, 8);
-
-                auto leaf_2 = static_cast<const Array*>(leaf);
-                leaf_2->get_chunk(index, v.m_storage.m_first);
+            // Load as many rows as the destination asks for (but at most `ValueBase::chunk_size`). The
+            // destination is written to directly when it has the column's type; otherwise the values are converted
+            // on import.
+            size_t rows = std::min(colsize - index, std::max(destination.m_values, size_t(1)));
+            if (rows > ValueBase::chunk_size)
+                rows = ValueBase::chunk_size;
 
-                destination.import(v);
+            using V = typename util::RemoveOptional<U>::type;
+            if (auto d = dynamic_cast<Value<V>*>(&destination)) {
+                load_rows(leaf, index, rows, *d);
             }
             else {
-                size_t rows = colsize - index;
-                if (rows > ValueBase::chunk_size)
-                    rows = ValueBase::chunk_size;
-                Value<typename util::RemoveOptional<U>::type> v(false, rows);
-
-                for (size_t t = 0; t < rows; t++)
-                    v.m_storage.set(t, leaf->get(index + t));
-
+                Value<V> v;
+                load_rows(leaf, index, rows, v);
                 destination.import(v);
             }
         }
     }
 
+    // If it's an integer leaf, then it contains the method get_chunk() which copies 8 values at a time in a super
+    // fast way. Otherwise, copy the values one by one in a for-loop.
+    template <class LeafType2, class V>
+    static void load_rows(const LeafType2* leaf, size_t index, size_t rows, Value<V>& v)
+    {
+        v.init(false, rows);
+        size_t t = 0;
+        if (std::is_same<typename LeafType2::value_type, int64_t>::value) {
+            auto leaf_2 = static_cast<const Array*>(leaf);
+            auto first = reinterpret_cast<int64_t*>(v.m_storage.m_first);
+            for (; t + 8 <= rows; t += 8)
+                leaf_2->get_chunk(index + t, first + t);
+        }
+        for (; t < rows; t++)
+            v.m_storage.set(t, leaf->get(index + t));
+    }
+
     virtual std::string description(util::serializer::SerialisationState& state) const override
     {
         return state.describe_columns(m_link_map, m_column_key);
@@ -3472,6 +3693,17 @@ public:
         m_link_map.set_cluster(cluster);
     }
 
+    // The subquery is run on the target table once, and the links of every
+    // object are then looked up in its matches
+    void init() override
+    {
+        m_has_matches = m_link_map.evaluate_target_first();
+        if (m_has_matches)
+            m_matches = m_query.do_find_all_keys();
+        else
+            m_matches.clear();
+    }
+
     void collect_dependencies(std::vector<TableKey>& tables) const override
     {
         m_link_map.collect_dependencies(tables);
@@ -3480,13 +3712,17 @@ public:
     void evaluate(size_t index, ValueBase& destination) override
     {
         std::vector<ObjKey> links = m_link_map.get_links(index);
-        // std::sort(links.begin(), links.end());
-        m_query.init();
-
-        size_t count = std::accumulate(links.begin(), links.end(), size_t(0), [this](size_t running_count, ObjKey k) {
-            ConstObj obj = m_link_map.get_target_table()->get_object(k);
-            return running_count + m_query.eval_object(obj);
-        });
+        size_t count;
+        if (m_has_matches) {
+            count = std::count_if(links.begin(), links.end(), [this](ObjKey k) { return m_matches.contains(k); });
+        }
+        else {
+            m_query.init();
+            count = std::accumulate(links.begin(), links.end(), size_t(0), [this](size_t running_count, ObjKey k) {
+                ConstObj obj = m_link_map.get_target_table()->get_object(k);
+                return running_count + m_query.eval_object(obj);
+            });
+        }
 
         destination.import(Value<Int>(false, 1, size_t(count)));
     }
@@ -3511,6 +3747,9 @@ public:
 private:
     Query m_query;
     LinkMap m_link_map;
+    // The objects of the target table matching the subquery, see init()
+    KeyBitmap m_matches;
+    bool m_has_matches = false;
 };
 
 // The unused template parameter is a hack to avoid a circular dependency between table.hpp and query_expression.hpp.
@@ -3677,6 +3916,11 @@ public:
         m_left->set_cluster(cluster);
     }
 
+    void init() override
+    {
+        m_left->init();
+    }
+
     void collect_dependencies(std::vector<TableKey>& tables) const override
     {
         m_left->collect_dependencies(tables);
@@ -3692,11 +3936,10 @@ public:
     // destination = operator(left)
     void evaluate(size_t index, ValueBase& destination) override
     {
-        Value<T> result;
-        Value<T> left;
-        m_left->evaluate(index, left);
-        result.template fun<oper>(&left);
-        destination.import(result);
+        m_left_values.init(false, destination.m_values);
+        m_left->evaluate(index, m_left_values);
+        m_result.template fun<oper>(&m_left_values);
+        destination.import(m_result);
     }
 
     virtual std::string description(util::serializer::SerialisationState& state) const override
@@ -3715,6 +3958,9 @@ public:
 private:
     typedef typename oper::type T;
     std::unique_ptr<TLeft> m_left;
+    // Buffers kept across calls so evaluating a chunk does not allocate
+    Value<T> m_result;
+    Value<T> m_left_values;
 };
 
 
@@ -3758,6 +4004,12 @@ public:
         m_right->set_cluster(cluster);
     }
 
+    void init() override
+    {
+        m_left->init();
+        m_right->init();
+    }
+
     // Recursively fetch tables of columns in expression tree. Used when user first builds a stand-alone expression
     // and
     // binds it to a Query at a later time
@@ -3776,13 +4028,12 @@ public:
     // destination = operator(left, right)
     void evaluate(size_t index, ValueBase& destination) override
     {
-        Value<T> result;
-        Value<T> left;
-        Value<T> right;
-        m_left->evaluate(index, left);
-        m_right->evaluate(index, right);
-        result.template fun<oper>(&left, &right);
-        destination.import(result);
+        m_left_values.init(false, destination.m_values);
+        m_right_values.init(false, destination.m_values);
+        m_left->evaluate(index, m_left_values);
+        m_right->evaluate(index, m_right_values);
+        m_result.template fun<oper>(&m_left_values, &m_right_values);
+        destination.import(m_result);
     }
 
     virtual std::string description(util::serializer::SerialisationState& state) const override
@@ -3807,6 +4058,10 @@ private:
     typedef typename oper::type T;
     std::unique_ptr<TLeft> m_left;
     std::unique_ptr<TRight> m_right;
+    // Buffers kept across calls so evaluating a chunk does not allocate
+    Value<T> m_result;
+    Value<T> m_left_values;
+    Value<T> m_right_values;
 };
 
 namespace {
@@ -3845,6 +4100,7 @@ public:
 
     void set_cluster(const Cluster* cluster) override
     {
+        reset_chunk();
         if (m_has_matches) {
             m_cluster = cluster;
         }
@@ -3856,8 +4112,15 @@ public:
 
     double init() override
     {
+        reset_chunk();
+        m_left->init();
+        m_right->init();
+        m_has_matches = false;
+        m_target_column.reset();
+        m_memo.clear();
         double dT = m_left_is_const ? 10.0 : 50.0;
-        if (std::is_same<TCond, Equal>::value && m_left_is_const && m_right->has_search_index()) {
+        if (std::is_same<TCond, Equal>::value && m_left_is_const && m_right->has_search_index() &&
+            !null_link_matches()) {
             if (m_left_value.m_storage.is_null(0)) {
                 m_matches = m_right->find_all(Mixed());
             }
@@ -3874,6 +4137,16 @@ public:
             m_index_end = m_matches.size();
             dT = 0;
         }
+        else if (m_left_is_const && find_matches_on_target()) {
+            m_has_matches = true;
+            m_index_get = 0;
+            m_index_end = m_matches.size();
+            dT = 0;
+        }
+        else if (m_left_is_const && m_right->get_column_links() && m_right->get_column_links()->links_exist()) {
+            m_target_column = m_right->get_target_column();
+            m_null_link_matches = null_link_matches();
+        }
 
         return dT;
     }
@@ -3938,28 +4211,35 @@ public:
             return m_cluster->lower_bound_key(ObjKey(actual_key.value - m_cluster->get_offset()));
         }
 
-        size_t match;
+        if (m_target_column) {
+            const LinkMap& link_map = *m_right->get_column_links();
+            for (; start < end; ++start) {
+                if (links_match(link_map, start))
+                    return start;
+            }
+            return not_found;
+        }
 
-        Value<T> left;
-        Value<T> right;
+        size_t match;
 
         for (; start < end;) {
+            // Rows evaluated by the previous call are reused when the search resumes inside them, which is what
+            // happens when a query has more matches than there are chunks
+            if (start < m_chunk_start || start >= m_chunk_end)
+                evaluate_chunk(start, end);
+
+            size_t offset = start - m_chunk_start;
             if (m_left_is_const) {
-                m_right->evaluate(start, right);
-                match = Value<T>::template compare_const<TCond>(&m_left_value, &right);
+                match = Value<T>::template compare_const<TCond>(&m_left_value, &m_right_values, offset);
             }
             else {
-                m_left->evaluate(start, left);
-                m_right->evaluate(start, right);
-                match = Value<T>::template compare<TCond>(&left, &right);
+                match = Value<T>::template compare<TCond>(&m_left_values, &m_right_values, offset);
             }
 
-            if (match != not_found && match + start < end)
-                return start + match;
+            if (match != not_found && m_chunk_start + match < end)
+                return m_chunk_start + match;
 
-            size_t rows =
-                (left.m_from_link_list || right.m_from_link_list) ? 1 : minimum(right.m_values, left.m_values);
-            start += rows;
+            start = m_chunk_end;
         }
 
         return not_found; // no match
@@ -3996,6 +4276,102 @@ private:
         }
     }
 
+    // An object whose single link is null has a null value, which is not
+    // found from the target table, neither through an index
+    bool null_link_matches() const
+    {
+        const LinkMap* link_map = m_right->get_column_links();
+        if (!link_map || !link_map->links_exist() || !link_map->only_unary_links())
+            return false;
+        Value<T> null_value;
+        null_value.init(false, 1);
+        null_value.m_storage.set_null(0);
+        return Value<T>::template compare_const<TCond>(&m_left_value, &null_value) != not_found;
+    }
+
+    // A condition on a column reached through links is otherwise evaluated
+    // on the linked objects of every object, again for every object linking
+    // to the same one. Instead run it on the target table, where it is
+    // evaluated once per object, and take the objects linking to the matches
+    // through the backlinks.
+    bool find_matches_on_target()
+    {
+        const LinkMap* link_map = m_right->get_column_links();
+        if (!link_map || !link_map->evaluate_target_first() || null_link_matches())
+            return false;
+        std::unique_ptr<Subexpr> column = m_right->get_target_column();
+        if (!column)
+            return false;
+
+        Query query(make_expression<Compare>(m_left->clone(), std::move(column)));
+        m_matches = link_map->get_origin_keys(query.do_find_all_keys().to_vector());
+        return true;
+    }
+
+    // Otherwise the result for each object linked to by the first link is
+    // remembered during the search, so that the rest of the path and the
+    // target objects are only read once for all the objects linking to it
+    bool links_match(const LinkMap& link_map, size_t row) const
+    {
+        std::vector<ObjKey> first_hop;
+        MakeLinkVector first_hop_links(first_hop);
+        link_map.map_first_hop(row, first_hop_links);
+        if (first_hop.empty())
+            return m_null_link_matches;
+        for (ObjKey key : first_hop) {
+            auto it = m_memo.find(key);
+            if (it == m_memo.end())
+                it = m_memo.emplace(key, targets_match(link_map, key)).first;
+            if (it->second)
+                return true;
+        }
+        return false;
+    }
+
+    bool targets_match(const LinkMap& link_map, ObjKey first_hop) const
+    {
+        std::vector<ObjKey> targets;
+        MakeLinkVector target_links(targets);
+        link_map.map_links_from_first_hop(first_hop, target_links);
+        if (targets.empty())
+            return m_null_link_matches;
+        Value<T> value;
+        value.init(false, 1);
+        for (ObjKey target : targets) {
+            m_target_column->evaluate(target, value);
+            if (Value<T>::template compare_const<TCond>(&m_left_value, &value) != not_found)
+                return true;
+        }
+        return false;
+    }
+
+    // Evaluate both sides for the rows from 'start', but no further than 'end' as single object lookups would
+    // otherwise pay for a full chunk
+    void evaluate_chunk(size_t start, size_t end) const
+    {
+        size_t rows = std::min(end - start, size_t(ValueBase::chunk_size));
+        m_right_values.init(false, rows);
+        m_right->evaluate(start, m_right_values);
+        if (m_left_is_const) {
+            rows = m_right_values.m_from_link_list ? 1 : m_right_values.m_values;
+        }
+        else {
+            m_left_values.init(false, rows);
+            m_left->evaluate(start, m_left_values);
+            rows = (m_left_values.m_from_link_list || m_right_values.m_from_link_list)
+                       ? 1
+                       : minimum(m_right_values.m_values, m_left_values.m_values);
+        }
+        m_chunk_start = start;
+        m_chunk_end = start + std::max(rows, size_t(1));
+    }
+
+    void reset_chunk() const
+    {
+        m_chunk_start = 0;
+        m_chunk_end = 0;
+    }
+
     std::unique_ptr<TLeft> m_left;
     std::unique_ptr<TRight> m_right;
     const Cluster* m_cluster;
@@ -4005,6 +4381,15 @@ private:
     std::vector<ObjKey> m_matches;
     mutable size_t m_index_get = 0;
     size_t m_index_end = 0;
+    // The target column and the result by object of the first link, when the
+    // condition is evaluated per linked object
+    std::unique_ptr<Subexpr> m_target_column;
+    mutable std::unordered_map<ObjKey, bool> m_memo;
+    bool m_null_link_matches = false;
+    mutable Value<T> m_left_values;
+    mutable Value<T> m_right_values;
+    mutable size_t m_chunk_start = 0;
+    mutable size_t m_chunk_end = 0;
 };
 }
 #endif // REALM_QUERY_EXPRESSION_HPP
@@ -19,10 +19,328 @@
 #include <realm/sort_descriptor.hpp>
 #include <realm/table.hpp>
 #include <realm/db.hpp>
+#include <realm/unicode.hpp>
 #include <realm/util/assert.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
 using namespace realm;
 
+namespace {
+
+// Remove the entries which are equal to an earlier one, in a single pass
+// over the entries with a hash set of the entries kept so far
+void remove_duplicates_hashed(BaseDescriptor::IndexPairs& v, const BaseDescriptor::Sorter& predicate)
+{
+    if (v.empty())
+        return;
+    struct Slot {
+        size_t pos;
+        uint64_t hash;
+    };
+    // Open addressing in a single allocation which is at most half full. The
+    // high bits of the mixed hash select the slot.
+    int bits = 1;
+    while ((size_t(1) << bits) < 2 * v.size())
+        ++bits;
+    size_t mask = (size_t(1) << bits) - 1;
+    std::vector<Slot> slots(mask + 1, Slot{npos, 0});
+
+    size_t kept = 0;
+    for (size_t i = 0; i < v.size(); ++i) {
+        uint64_t hash = predicate.hash(v[i]) * 0x9E3779B97F4A7C15ULL;
+        size_t ndx = size_t(hash >> (64 - bits));
+        bool duplicate = false;
+        for (; slots[ndx].pos != npos; ndx = (ndx + 1) & mask) {
+            if (slots[ndx].hash != hash)
+                continue;
+            const auto& other = v[slots[ndx].pos];
+            if (!predicate(other, v[i], false) && !predicate(v[i], other, false)) {
+                duplicate = true;
+                break;
+            }
+        }
+        if (duplicate)
+            continue;
+        slots[ndx] = Slot{kept, hash};
+        if (kept != i)
+            v[kept] = std::move(v[i]);
+        ++kept;
+    }
+    v.erase(v.begin() + kept, v.end());
+}
+
+// The objects to read from one table, as (key, position in the entries)
+using KeyPositions = std::vector<std::pair<ObjKey, size_t>>;
+
+// Call `fn(pos, value)` with the value of every object in `entries`, which are
+// sorted by key. Unless there are few of them, compared to the size of the
+// table, the objects are read cluster by cluster instead of being looked up
+// one at a time.
+template <class T, class Fn>
+void read_values(const Table& table, ColKey col_key, const KeyPositions& entries, Fn&& fn)
+{
+    if (entries.size() * 16 < table.size()) {
+        for (auto& entry : entries)
+            fn(entry.second, table.get_object(entry.first).get_any(col_key));
+        return;
+    }
+
+    typename ColumnTypeTraits<T>::cluster_leaf_type leaf(table.get_alloc());
+    auto it = entries.begin();
+    auto end = entries.end();
+    auto read = [&](const Cluster* cluster) {
+        size_t sz = cluster->node_size();
+        if (sz == 0 || it->first > cluster->get_real_key(sz - 1))
+            return false; // Continue
+        cluster->init_leaf(col_key, &leaf);
+        for (size_t row = 0; row < sz && it != end; ++row) {
+            ObjKey key = cluster->get_real_key(row);
+            for (; it != end && it->first == key; ++it)
+                fn(it->second, Mixed(leaf.get(row)));
+        }
+        return it == end;
+    };
+    table.traverse_clusters(read);
+}
+
+// The sort order of a value is given by its rank first, which orders the
+// kinds of values like Mixed::compare() does, with null links after
+// everything else like Sorter::operator() has them
+enum : uint8_t { rank_null = 0, rank_nan = 1, rank_value = 2, rank_null_link = 3 };
+
+bool is_radix_sortable(DataType type)
+{
+    switch (type) {
+        case type_Int:
+        case type_Bool:
+        case type_Float:
+        case type_Double:
+        case type_Timestamp:
+        case type_Link:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Order preserving unsigned bits of a float or a double. -0.0 is 0.0.
+template <class T, class Bits>
+uint64_t float_sort_bits(T value) noexcept
+{
+    if (value == 0)
+        value = 0;
+    Bits bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const Bits sign = Bits(1) << (8 * sizeof(Bits) - 1);
+    return uint64_t((bits & sign) ? ~bits : (bits | sign));
+}
+
+// The values of one sort column for every entry, in buffers of fixed size
+// keys for the types which can be radix sorted. The order of the keys is the
+// order of the values, including the direction of the sort. Strings in the
+// first column, which are compared by utf8_compare(), are turned into sort
+// keys once. Other strings and binaries are kept as values and compared.
+struct SortKeys {
+    SortKeys(DataType t, bool a, bool first, size_t size)
+        : type(t)
+        , ascending(a)
+        , is_first(first)
+        , radix(is_radix_sortable(t))
+        , ranks(size, rank_value)
+    {
+        // An empty string has an empty key, if the compare method has keys
+        collated = is_first && type == type_String && utf8_sort_key(StringData(""), collation_keys);
+        if (radix) {
+            bits.resize(size);
+            if (type == type_Timestamp)
+                low_bits.resize(size);
+        }
+        else if (collated) {
+            key_ranges.resize(size);
+        }
+        else {
+            values.resize(size);
+        }
+    }
+
+    void set(size_t pos, Mixed value)
+    {
+        if (collated) {
+            if (value.is_null()) {
+                ranks[pos] = rank_null;
+                return;
+            }
+            size_t offset = collation_keys.size();
+            utf8_sort_key(value.get<StringData>(), collation_keys);
+            key_ranges[pos] = {offset, collation_keys.size() - offset};
+            return;
+        }
+        if (!radix) {
+            values[pos] = value;
+            return;
+        }
+        if (value.is_null()) {
+            ranks[pos] = rank_null;
+            return;
+        }
+        const uint64_t sign = uint64_t(1) << 63;
+        switch (type) {
+            case type_Int:
+                bits[pos] = uint64_t(value.get<int64_t>()) ^ sign;
+                break;
+            case type_Link:
+                bits[pos] = uint64_t(value.get<ObjKey>().value) ^ sign;
+                break;
+            case type_Bool:
+                bits[pos] = value.get<bool>() ? 1 : 0;
+                break;
+            case type_Float: {
+                float f = value.get<float>();
+                if (std::isnan(f)) {
+                    // NaNs are ordered by their bits
+                    ranks[pos] = rank_nan;
+                    uint32_t b;
+                    std::memcpy(&b, &f, sizeof(b));
+                    bits[pos] = b;
+                    break;
+                }
+                bits[pos] = float_sort_bits<float, uint32_t>(f);
+                break;
+            }
+            case type_Double: {
+                double d = value.get<double>();
+                if (std::isnan(d)) {
+                    ranks[pos] = rank_nan;
+                    std::memcpy(&bits[pos], &d, sizeof(d));
+                    break;
+                }
+                bits[pos] = float_sort_bits<double, uint64_t>(d);
+                break;
+            }
+            case type_Timestamp: {
+                Timestamp ts = value.get<Timestamp>();
+                bits[pos] = uint64_t(ts.get_seconds()) ^ sign;
+                low_bits[pos] = uint32_t(ts.get_nanoseconds()) ^ (uint32_t(1) << 31);
+                break;
+            }
+            default:
+                REALM_UNREACHABLE();
+        }
+    }
+
+    void set_null_link(size_t pos)
+    {
+        ranks[pos] = rank_null_link;
+    }
+
+    // Turn the keys around for a descending sort. Values are compared the
+    // other way around instead.
+    void finish()
+    {
+        if (ascending)
+            return;
+        for (auto& rank : ranks)
+            rank = uint8_t(rank_null_link - rank);
+        for (auto& b : bits)
+            b = ~b;
+        for (auto& b : low_bits)
+            b = ~b;
+    }
+
+    // Like Sorter::operator(), which compares the first column like
+    // Mixed::compare() does, and the others like ConstObj::cmp() does, except
+    // that floats and doubles are in a total order in every column, with
+    // NaNs after nulls. A limited sort must use this too, so that it keeps
+    // the same entries as a full sort does.
+    int compare(size_t a, size_t b) const
+    {
+        if (ranks[a] != ranks[b])
+            return ranks[a] < ranks[b] ? -1 : 1;
+        if (radix) {
+            if (bits[a] != bits[b])
+                return bits[a] < bits[b] ? -1 : 1;
+            if (!low_bits.empty() && low_bits[a] != low_bits[b])
+                return low_bits[a] < low_bits[b] ? -1 : 1;
+            return 0;
+        }
+        // Two nulls or two null links (ranks are turned around when descending)
+        if (ranks[a] != (ascending ? rank_value : rank_null_link - rank_value))
+            return 0;
+        int c;
+        if (collated) {
+            const char* keys = collation_keys.data();
+            auto& range_a = key_ranges[a];
+            auto& range_b = key_ranges[b];
+            c = std::memcmp(keys + range_a.first, keys + range_b.first, std::min(range_a.second, range_b.second));
+            if (c == 0 && range_a.second != range_b.second)
+                c = range_a.second < range_b.second ? -1 : 1;
+        }
+        else if (is_first || values[a].is_null() || values[b].is_null()) {
+            // Nulls are first in both cases
+            c = values[a].compare(values[b]);
+        }
+        else if (type == type_String) {
+            StringData sa = values[a].get<StringData>();
+            StringData sb = values[b].get<StringData>();
+            c = sa < sb ? -1 : (sb < sa ? 1 : 0);
+        }
+        else {
+            BinaryData ba = values[a].get<BinaryData>();
+            BinaryData bb = values[b].get<BinaryData>();
+            c = ba < bb ? -1 : (bb < ba ? 1 : 0);
+        }
+        return ascending ? c : -c;
+    }
+
+    DataType type;
+    bool ascending;
+    bool is_first;
+    bool radix;
+    bool collated;
+    std::vector<uint8_t> ranks;
+    std::vector<uint64_t> bits;
+    std::vector<uint32_t> low_bits;
+    std::vector<Mixed> values;
+    std::string collation_keys;
+    // The offset and size of the key of every entry in collation_keys
+    std::vector<std::pair<size_t, size_t>> key_ranges;
+};
+
+// Stable LSD radix sort of the positions in `order` by `keys[pos]`, a byte at
+// a time. Bytes which are the same in all keys are skipped.
+template <class T>
+void radix_sort(std::vector<size_t>& order, std::vector<size_t>& buffer, const std::vector<T>& keys)
+{
+    uint64_t first = keys[order[0]];
+    uint64_t differing = 0;
+    for (size_t pos : order)
+        differing |= uint64_t(keys[pos]) ^ first;
+
+    size_t count[256];
+    for (size_t shift = 0; shift < 8 * sizeof(T); shift += 8) {
+        if (((differing >> shift) & 0xff) == 0)
+            continue;
+        std::fill(std::begin(count), std::end(count), 0);
+        for (size_t pos : order)
+            ++count[(uint64_t(keys[pos]) >> shift) & 0xff];
+        size_t offset = 0;
+        for (size_t& c : count) {
+            size_t n = c;
+            c = offset;
+            offset += n;
+        }
+        for (size_t pos : order)
+            buffer[count[(uint64_t(keys[pos]) >> shift) & 0xff]++] = pos;
+        order.swap(buffer);
+    }
+}
+
+} // anonymous namespace
+
 LinkPathPart::LinkPathPart(ColKey col_key, ConstTableRef source)
     : column_key(col_key)
     , from(source->get_key())
@@ -218,6 +536,15 @@ void DistinctDescriptor::execute(IndexPairs& v, const Sorter& predicate, const B
         v.erase(nulls, v.end());
     }
 
+    if (predicate.can_hash()) {
+        // The entries are ordered by index_in_view, so keeping the first of
+        // every set of equal entries keeps the same ones as sorting (the
+        // lowest index_in_view wins), and the order needs no restoring
+        REALM_ASSERT_DEBUG(std::is_sorted(v.begin(), v.end()));
+        remove_duplicates_hashed(v, predicate);
+        return;
+    }
+
     // Sort by the columns to distinct on
     std::sort(v.begin(), v.end(), std::ref(predicate));
 
@@ -247,7 +574,13 @@ BaseDescriptor::Sorter SortDescriptor::sorter(Table const& table, const IndexPai
 
 void SortDescriptor::execute(IndexPairs& v, const Sorter& predicate, const BaseDescriptor* next) const
 {
-    std::sort(v.begin(), v.end(), std::ref(predicate));
+    // If the sort is followed by a limit, only the first 'limit' entries need
+    // to be ordered. The rest is removed by the limit right after.
+    size_t limit = size_t(-1);
+    if (next && next->get_type() == DescriptorType::Limit) {
+        limit = static_cast<const LimitDescriptor*>(next)->get_limit();
+    }
+    predicate.sort(v, limit);
 
     // not doing this on the last step is an optimisation
     if (next) {
@@ -329,29 +662,205 @@ bool BaseDescriptor::Sorter::operator()(IndexPair i, IndexPair j, bool total_ord
     return total_ordering ? i.index_in_view < j.index_in_view : 0;
 }
 
+void BaseDescriptor::Sorter::read_column(size_t t, const IndexPairs& v,
+                                         util::FunctionRef<void(size_t, Mixed)> fn) const
+{
+    auto& col = m_columns[t];
+    KeyPositions entries;
+    entries.reserve(v.size());
+    for (size_t i = 0; i < v.size(); i++) {
+        if (col.translated_keys.empty()) {
+            entries.emplace_back(v[i].key_for_object, i);
+        }
+        else if (!col.is_null[v[i].index_in_view]) {
+            entries.emplace_back(col.translated_keys[v[i].index_in_view], i);
+        }
+    }
+    if (entries.empty())
+        return;
+    // Read the objects in key order, which is the order of the clusters
+    if (!std::is_sorted(entries.begin(), entries.end()))
+        std::sort(entries.begin(), entries.end());
+
+    const Table& table = *col.table;
+    ColKey ck = col.col_key;
+    switch (ck.get_type()) {
+        case col_type_Int:
+            if (ck.get_attrs().test(col_attr_Nullable)) {
+                read_values<util::Optional<int64_t>>(table, ck, entries, fn);
+            }
+            else {
+                read_values<int64_t>(table, ck, entries, fn);
+            }
+            break;
+        case col_type_Bool:
+            read_values<util::Optional<bool>>(table, ck, entries, fn);
+            break;
+        case col_type_Float:
+            read_values<util::Optional<float>>(table, ck, entries, fn);
+            break;
+        case col_type_Double:
+            read_values<util::Optional<double>>(table, ck, entries, fn);
+            break;
+        case col_type_String:
+            read_values<StringData>(table, ck, entries, fn);
+            break;
+        case col_type_Binary:
+            read_values<BinaryData>(table, ck, entries, fn);
+            break;
+        case col_type_Timestamp:
+            read_values<Timestamp>(table, ck, entries, fn);
+            break;
+        case col_type_Link:
+            read_values<ObjKey>(table, ck, entries, fn);
+            break;
+        default:
+            REALM_UNREACHABLE();
+    }
+}
+
 void BaseDescriptor::Sorter::cache_first_column(IndexPairs& v)
 {
     if (m_columns.empty())
         return;
 
     auto& col = m_columns[0];
-    ColKey ck = col.col_key;
-    for (size_t i = 0; i < v.size(); i++) {
-        IndexPair& index = v[i];
-        ObjKey key = index.key_for_object;
+    if (!col.translated_keys.empty()) {
+        for (auto& index : v) {
+            if (col.is_null[index.index_in_view])
+                index.cached_value = Mixed();
+        }
+    }
+    read_column(0, v, [&](size_t i, Mixed value) { v[i].cached_value = value; });
+}
 
+void BaseDescriptor::Sorter::sort(IndexPairs& v, size_t limit) const
+{
+    const size_t n = v.size();
+    if (n < 2 || limit == 0)
+        return;
+    // Equal entries keep their order, which must be the one of index_in_view
+    if (!std::is_sorted(v.begin(), v.end()))
+        std::sort(v.begin(), v.end());
+
+    bool radix = true;
+    std::vector<SortKeys> keys;
+    keys.reserve(m_columns.size());
+    for (size_t t = 0; t < m_columns.size(); t++) {
+        auto& col = m_columns[t];
+        keys.emplace_back(DataType(col.col_key.get_type()), col.ascending, t == 0, n);
+        SortKeys& column_keys = keys.back();
         if (!col.translated_keys.empty()) {
-            if (col.is_null[i]) {
-                index.cached_value = Mixed();
-                continue;
+            for (size_t i = 0; i < n; i++) {
+                if (col.is_null[v[i].index_in_view])
+                    column_keys.set_null_link(i);
             }
-            else {
-                key = col.translated_keys[v[i].index_in_view];
+        }
+        if (t == 0) {
+            for (size_t i = 0; i < n; i++) {
+                if (column_keys.ranks[i] != rank_null_link)
+                    column_keys.set(i, v[i].cached_value);
+            }
+        }
+        else {
+            read_column(t, v, [&](size_t i, Mixed value) { column_keys.set(i, value); });
+        }
+        column_keys.finish();
+        radix = radix && column_keys.radix;
+
+        if (t == 0 && limit < n && m_columns.size() > 1) {
+            // Only the entries which are not after the entry at the limit by
+            // the first column can be kept by the limit. The other columns
+            // are only read for those.
+            std::vector<size_t> order(n);
+            std::iota(order.begin(), order.end(), 0);
+            std::nth_element(order.begin(), order.begin() + (limit - 1), order.end(),
+                             [&](size_t a, size_t b) { return column_keys.compare(a, b) < 0; });
+            size_t last = order[limit - 1];
+            size_t num_candidates = 0;
+            for (size_t i = 0; i < n; i++) {
+                if (column_keys.compare(i, last) <= 0)
+                    ++num_candidates;
+            }
+            if (num_candidates < n) {
+                IndexPairs candidates;
+                std::vector<IndexPair> rest;
+                candidates.reserve(num_candidates);
+                rest.reserve(n - num_candidates);
+                for (size_t i = 0; i < n; i++) {
+                    if (column_keys.compare(i, last) <= 0) {
+                        candidates.push_back(std::move(v[i]));
+                    }
+                    else {
+                        rest.push_back(std::move(v[i]));
+                    }
+                }
+                sort(candidates, limit);
+                auto it = std::move(candidates.begin(), candidates.end(), v.begin());
+                std::move(rest.begin(), rest.end(), it);
+                return;
             }
         }
+    }
+
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    auto less = [&](size_t a, size_t b) {
+        for (auto& column_keys : keys) {
+            if (int c = column_keys.compare(a, b))
+                return c < 0;
+        }
+        return a < b;
+    };
+    if (limit < n) {
+        // The first 'limit' entries are the same as after a full sort
+        std::partial_sort(order.begin(), order.begin() + limit, order.end(), less);
+    }
+    else if (radix) {
+        // From the least significant key to the most significant one
+        std::vector<size_t> buffer(n);
+        for (size_t t = keys.size(); t-- > 0;) {
+            if (!keys[t].low_bits.empty())
+                radix_sort(order, buffer, keys[t].low_bits);
+            radix_sort(order, buffer, keys[t].bits);
+            radix_sort(order, buffer, keys[t].ranks);
+        }
+    }
+    else {
+        std::sort(order.begin(), order.end(), less);
+    }
+
+    std::vector<IndexPair> sorted;
+    sorted.reserve(n);
+    for (size_t pos : order)
+        sorted.push_back(std::move(v[pos]));
+    std::move(sorted.begin(), sorted.end(), v.begin());
+}
 
-        index.cached_value = col.table->get_object(key).get_any(ck);
+bool BaseDescriptor::Sorter::can_hash() const
+{
+    for (size_t t = 1; t < m_columns.size(); t++) {
+        DataType type = DataType(m_columns[t].col_key.get_type());
+        if (type == type_Float || type == type_Double)
+            return false;
+    }
+    return true;
+}
+
+uint64_t BaseDescriptor::Sorter::hash(const IndexPair& i) const
+{
+    uint64_t hash = i.cached_value.hash();
+    for (size_t t = 1; t < m_columns.size(); t++) {
+        ObjKey key = i.key_for_object;
+        if (!m_columns[t].translated_keys.empty()) {
+            if (m_columns[t].is_null[i.index_in_view])
+                continue;
+            key = m_columns[t].translated_keys[i.index_in_view];
+        }
+        uint64_t h = m_columns[t].table->get_object(key).get_any(m_columns[t].col_key).hash();
+        hash = (hash ^ h) * 0x100000001B3ULL + t;
     }
+    return hash;
 }
 
 IncludeDescriptor::IncludeDescriptor(ConstTableRef table, const std::vector<std::vector<LinkPathPart>>& column_links)
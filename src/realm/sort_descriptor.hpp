@@ -94,6 +94,24 @@ public:
         }
         void cache_first_column(IndexPairs& v);
 
+        // Sort the entries in the order given by this predicate. The values of
+        // all the columns are read once for every entry. If all columns hold
+        // ints, bools, floats, doubles, timestamps or links, the entries are
+        // radix sorted on them. The first column must be cached. With a
+        // limit, only the first 'limit' entries are put in order, the others
+        // are left behind them in no particular order, and the columns after
+        // the first are only read for the entries that can be among them.
+        void sort(IndexPairs& v, size_t limit = size_t(-1)) const;
+
+        // Entries can be told apart by a hash of their values instead of
+        // sorting them, unless a column other than the first holds floats or
+        // doubles, which are compared in a way that treats NaN as equal to
+        // every value
+        bool can_hash() const;
+        // A hash of the values of all the columns, which is the same for
+        // entries that compare equal. The first column must be cached.
+        uint64_t hash(const IndexPair& i) const;
+
     private:
         struct SortColumn {
             SortColumn(const Table* t, ColKey c, bool a)
@@ -111,6 +129,10 @@ public:
         };
         std::vector<SortColumn> m_columns;
         friend class ObjList;
+
+        // Call `fn(i, value)` with the value of column `t` for every entry
+        // `v[i]` which has no null link on the way to it
+        void read_column(size_t t, const IndexPairs& v, util::FunctionRef<void(size_t, Mixed)> fn) const;
     };
 
     BaseDescriptor() = default;
@@ -147,6 +169,11 @@ public:
     }
     void collect_dependencies(const Table* table, std::vector<TableKey>& table_keys) const override;
 
+    const std::vector<std::vector<ColKey>>& get_column_keys() const noexcept
+    {
+        return m_column_keys;
+    }
+
 protected:
     std::vector<std::vector<ColKey>> m_column_keys;
 };
@@ -18,10 +18,28 @@
 
 #include "string_data.hpp"
 
+#include <realm/impl/substring_search.hpp>
+
+#include <cstring>
 #include <vector>
 
 using namespace realm;
 
+size_t realm::search_substring(const char* haystack, size_t haystack_size, const char* needle,
+                               size_t needle_size) noexcept
+{
+    if (needle_size == 0)
+        return 0;
+
+    char first = needle[0];
+    char last = needle[needle_size - 1];
+    // The first and last bytes have already been matched
+    auto verify = [&](size_t pos) {
+        return needle_size <= 2 || std::memcmp(haystack + pos + 1, needle + 1, needle_size - 2) == 0;
+    };
+    return _impl::find_substring_candidate(haystack, haystack_size, needle_size, first, first, last, last, verify);
+}
+
 namespace {
 
 template <bool has_alternate_pattern>
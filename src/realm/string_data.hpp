@@ -22,6 +22,7 @@
 #include <realm/null.hpp>
 #include <realm/util/features.h>
 #include <realm/util/optional.hpp>
+#include <realm/utilities.hpp>
 
 #include <algorithm>
 #include <array>
@@ -39,6 +40,12 @@ namespace realm {
 /// non-cryptographic hash function (suitable for std::unordered_map etc.).
 size_t murmur2_or_cityhash(const unsigned char* data, size_t len) noexcept;
 
+/// Returns the position of the first occurrence of the \a needle in the
+/// \a haystack, or \a haystack_size if there is none. Used by
+/// StringData::contains() and BinaryData::contains().
+size_t search_substring(const char* haystack, size_t haystack_size, const char* needle,
+                        size_t needle_size) noexcept;
+
 uint_least32_t murmur2_32(const unsigned char* data, size_t len) noexcept;
 uint_least64_t cityhash_64(const unsigned char* data, size_t len) noexcept;
 
@@ -307,12 +314,14 @@ inline bool StringData::contains(StringData d) const noexcept
     if (is_null() && !d.is_null())
         return false;
 
-    return d.m_size == 0 || std::search(m_data, m_data + m_size, d.m_data, d.m_data + d.m_size) != m_data + m_size;
+    return d.m_size == 0 || search_substring(m_data, m_size, d.m_data, d.m_size) != m_size;
 }
 
 /// This method takes an array that maps chars to distance that can be moved (and zero for chars not in needle),
 /// allowing the method to apply Boyer-Moore for quick substring search
 /// The map is calculated in the StringNode<Contains> class (so it can be reused across searches)
+/// On x86-64 the vectorized search_substring() is faster than Boyer-Moore for
+/// the needle sizes seen in queries, so it is used instead and the map is ignored.
 inline bool StringData::contains(StringData d, const std::array<uint8_t, 256> &charmap) const noexcept
 {
     if (is_null() && !d.is_null())
@@ -321,6 +330,11 @@ inline bool StringData::contains(StringData d, const std::array<uint8_t, 256> &c
     size_t needle_size = d.size();
     if (needle_size == 0)
         return true;
+
+#ifdef REALM_COMPILER_SSE
+    static_cast<void>(charmap);
+    return search_substring(m_data, m_size, d.m_data, needle_size) != m_size;
+#else
     
     // Prepare vars to avoid lookups in loop
     size_t last_char_pos = d.size()-1;
@@ -345,6 +359,7 @@ inline bool StringData::contains(StringData d, const std::array<uint8_t, 256> &c
     }
     
     return false;
+#endif
 }
     
 inline bool StringData::like(StringData d) const noexcept
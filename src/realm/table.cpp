@@ -29,7 +29,12 @@
 #include <realm/exceptions.hpp>
 #include <realm/table.hpp>
 #include <realm/alloc_slab.hpp>
+#include <realm/index_composite.hpp>
+#include <realm/index_hash.hpp>
+#include <realm/index_list.hpp>
+#include <realm/index_range.hpp>
 #include <realm/index_string.hpp>
+#include <realm/index_trigram.hpp>
 #include <realm/db.hpp>
 #include <realm/replication.hpp>
 #include <realm/table_view.hpp>
@@ -489,6 +494,7 @@ void Table::init(ref_type top_ref, ArrayParent* parent, size_t ndx_in_parent, bo
         m_index_refs.init_from_parent();
         m_index_accessors.resize(m_index_refs.size());
     }
+    attach_optional_index_refs();
     if (!m_top.get_as_ref_or_tagged(top_position_for_column_key).is_tagged()) {
         m_top.set(top_position_for_column_key, RefOrTagged::make_tagged(0));
     }
@@ -526,48 +532,17 @@ void Table::populate_search_index(ColKey col_key)
     auto col_ndx = col_key.get_index().val;
     StringIndex* index = m_index_accessors[col_ndx];
 
-    // Insert ref to index
-    for (auto o : *this) {
-        ObjKey key = o.get_key();
-        DataType type = get_column_type(col_key);
-
-        if (type == type_Int) {
-            if (is_nullable(col_key)) {
-                Optional<int64_t> value = o.get<Optional<int64_t>>(col_key);
-                index->insert(key, value); // Throws
-            }
-            else {
-                int64_t value = o.get<int64_t>(col_key);
-                index->insert(key, value); // Throws
-            }
-        }
-        else if (type == type_Bool) {
-            if (is_nullable(col_key)) {
-                Optional<bool> value = o.get<Optional<bool>>(col_key);
-                index->insert(key, value); // Throws
-            }
-            else {
-                bool value = o.get<bool>(col_key);
-                index->insert(key, value); // Throws
-            }
-        }
-        else if (type == type_String) {
-            StringData value = o.get<StringData>(col_key);
-            index->insert(key, value); // Throws
-        }
-        else if (type == type_Timestamp) {
-            Timestamp value = o.get<Timestamp>(col_key);
-            index->insert(key, value); // Throws
-        }
-        else {
-            REALM_ASSERT_RELEASE(false && "Data type does not support search index");
-        }
-    }
+    // Insert all objects at once
+    index->insert_bulk(); // Throws
 }
 
 void Table::add_search_index(ColKey col_key)
 {
     check_column(col_key);
+    if (col_key.get_attrs().test(col_attr_List)) {
+        add_list_index(col_key);
+        return;
+    }
     size_t column_ndx = col_key.get_index().val;
 
     // Early-out if already indexed
@@ -605,6 +580,10 @@ void Table::add_search_index(ColKey col_key)
 void Table::remove_search_index(ColKey col_key)
 {
     check_column(col_key);
+    if (col_key.get_attrs().test(col_attr_List)) {
+        remove_list_index(col_key);
+        return;
+    }
     auto column_ndx = col_key.get_index();
 
     // Early-out if non-indexed
@@ -627,6 +606,329 @@ void Table::remove_search_index(ColKey col_key)
     m_spec.set_column_attr(spec_ndx, attr); // Throws
 }
 
+namespace {
+
+// Add an optional slot at `top_position` in the table top array, holding a
+// refs array with `size` (initially zero) entries
+void create_optional_index_refs(Array& top, Array& refs, size_t top_position, size_t size)
+{
+    while (top.size() <= top_position) {
+        top.add(0); // Throws
+    }
+    bool context_flag = false;
+    MemRef mem = Array::create_array(Array::type_HasRefs, context_flag, size, 0, top.get_alloc()); // Throws
+    refs.init_from_mem(mem);
+    refs.update_parent(); // Throws
+}
+
+// Attach `refs` to the optional slot at `top_position`, or detach it if the
+// table has no such slot
+void attach_optional_index_slot(const Array& top, Array& refs, size_t top_position) noexcept
+{
+    if (top.size() > top_position && top.get_as_ref(top_position)) {
+        refs.init_from_parent();
+    }
+    else {
+        refs.detach();
+    }
+}
+
+} // anonymous namespace
+
+template <class Index>
+Index* OptionalIndexes<Index>::create(ColKey col_key, ClusterTree& clusters, size_t num_columns)
+{
+    if (!m_refs.is_attached()) {
+        // First index of this type in the table - add the slot
+        create_optional_index_refs(m_top, m_refs, m_top_position, num_columns); // Throws
+    }
+    size_t col_ndx = col_key.get_index().val;
+    REALM_ASSERT(col_ndx < m_refs.size());
+    m_accessors.resize(num_columns);
+
+    // Create the index
+    Index* index = new Index(ClusterColumn(&clusters, col_key), m_refs.get_alloc()); // Throws
+    m_accessors[col_ndx] = index;
+
+    // Insert ref to index
+    index->set_parent(&m_refs, col_ndx);
+    m_refs.set(col_ndx, index->get_ref()); // Throws
+    return index;
+}
+
+template <class Index>
+void OptionalIndexes<Index>::destroy(size_t col_ndx)
+{
+    if (col_ndx >= m_accessors.size() || !m_accessors[col_ndx])
+        return;
+    m_accessors[col_ndx]->destroy();
+    delete m_accessors[col_ndx];
+    m_accessors[col_ndx] = nullptr;
+    m_refs.set(col_ndx, 0);
+}
+
+template <class Index>
+void OptionalIndexes<Index>::insert_column(size_t col_ndx)
+{
+    if (!m_refs.is_attached())
+        return;
+    if (col_ndx == m_refs.size()) {
+        m_refs.insert(col_ndx, 0);
+    }
+    else {
+        m_refs.set(col_ndx, 0);
+    }
+}
+
+template <class Index>
+void OptionalIndexes<Index>::erase_column(size_t col_ndx, size_t num_columns)
+{
+    destroy(col_ndx);
+    if (m_accessors.size() > num_columns)
+        m_accessors.resize(num_columns);
+}
+
+template <class Index>
+void OptionalIndexes<Index>::attach() noexcept
+{
+    attach_optional_index_slot(m_top, m_refs, m_top_position);
+}
+
+template <class Index>
+void OptionalIndexes<Index>::detach() noexcept
+{
+    delete_accessors();
+    m_refs.detach();
+}
+
+template <class Index>
+void OptionalIndexes<Index>::delete_accessors() noexcept
+{
+    for (auto index : m_accessors) {
+        delete index;
+    }
+    m_accessors.clear();
+}
+
+template <class Index>
+void OptionalIndexes<Index>::update_from_parent(size_t old_baseline) noexcept
+{
+    if (m_refs.is_attached() && m_refs.update_from_parent(old_baseline)) {
+        for (auto index : m_accessors) {
+            if (index != nullptr) {
+                index->update_from_parent(old_baseline);
+            }
+        }
+    }
+}
+
+// Eliminate, refresh or create the accessors like Table::refresh_index_accessors()
+// does for the search indexes
+template <class Index>
+void OptionalIndexes<Index>::refresh_accessors(const std::vector<ColKey>& leaf_ndx2colkey, ClusterTree& clusters)
+{
+    size_t col_ndx_end = leaf_ndx2colkey.size();
+    for (size_t col_ndx = col_ndx_end; col_ndx < m_accessors.size(); col_ndx++) {
+        delete m_accessors[col_ndx];
+    }
+    m_accessors.resize(col_ndx_end);
+    bool has_refs = m_refs.is_attached();
+    for (size_t col_ndx = 0; col_ndx < col_ndx_end; col_ndx++) {
+        Index*& index = m_accessors[col_ndx];
+        ref_type ref = 0;
+        if (has_refs && col_ndx < m_refs.size())
+            ref = m_refs.get_as_ref(col_ndx);
+
+        if (ref == 0) {
+            delete index;
+            index = nullptr;
+        }
+        else {
+            ClusterColumn virtual_col(&clusters, leaf_ndx2colkey[col_ndx]);
+            if (index) {
+                index->refresh_accessor_tree(virtual_col);
+            }
+            else {
+                index = new Index(ref, &m_refs, col_ndx, virtual_col, m_refs.get_alloc());
+            }
+        }
+    }
+}
+
+template <class Index>
+void OptionalIndexes<Index>::verify() const
+{
+#ifdef REALM_DEBUG
+    for (auto index : m_accessors) {
+        if (index)
+            index->verify();
+    }
+#endif
+}
+
+void Table::add_trigram_index(ColKey col_key)
+{
+    check_column(col_key);
+
+    // Early-out if already indexed
+    if (has_trigram_index(col_key))
+        return;
+
+    if (!TrigramIndex::type_supported(DataType(col_key.get_type())) || col_key.get_attrs().test(col_attr_List))
+        throw LogicError(LogicError::illegal_combination);
+
+    TrigramIndex* index = m_trigram_indexes.create(col_key, m_clusters, m_leaf_ndx2colkey.size()); // Throws
+    for (auto o : *this) {
+        index->insert(o.get_key(), o.get<StringData>(col_key)); // Throws
+    }
+}
+
+void Table::remove_trigram_index(ColKey col_key)
+{
+    check_column(col_key);
+    m_trigram_indexes.destroy(col_key.get_index().val);
+}
+
+void Table::add_range_index(ColKey col_key)
+{
+    check_column(col_key);
+
+    // Early-out if already indexed
+    if (has_range_index(col_key))
+        return;
+
+    if (!RangeIndex::type_supported(DataType(col_key.get_type())) || col_key.get_attrs().test(col_attr_List))
+        throw LogicError(LogicError::illegal_combination);
+
+    RangeIndex* index = m_range_indexes.create(col_key, m_clusters, m_leaf_ndx2colkey.size()); // Throws
+    for (auto o : *this) {
+        index->insert(o.get_key(), o.get_any(col_key)); // Throws
+    }
+}
+
+void Table::remove_range_index(ColKey col_key)
+{
+    check_column(col_key);
+    m_range_indexes.destroy(col_key.get_index().val);
+}
+
+void Table::add_hash_index(ColKey col_key)
+{
+    check_column(col_key);
+
+    // Early-out if already indexed
+    if (has_hash_index(col_key))
+        return;
+
+    if (!HashIndex::type_supported(DataType(col_key.get_type())) || col_key.get_attrs().test(col_attr_List))
+        throw LogicError(LogicError::illegal_combination);
+
+    HashIndex* index = m_hash_indexes.create(col_key, m_clusters, m_leaf_ndx2colkey.size()); // Throws
+    index->insert_bulk(); // Throws
+}
+
+void Table::remove_hash_index(ColKey col_key)
+{
+    check_column(col_key);
+    m_hash_indexes.destroy(col_key.get_index().val);
+}
+
+void Table::add_list_index(ColKey col_key)
+{
+    // Early-out if already indexed
+    if (get_list_index(col_key))
+        return;
+
+    if (!ListIndex::type_supported(DataType(col_key.get_type())))
+        throw LogicError(LogicError::illegal_combination);
+
+    ListIndex* index = m_list_indexes.create(col_key, m_clusters, m_leaf_ndx2colkey.size()); // Throws
+    for (auto o : *this) {
+        index->insert(o.get_key()); // Throws
+    }
+}
+
+void Table::remove_list_index(ColKey col_key)
+{
+    m_list_indexes.destroy(col_key.get_index().val);
+}
+
+void Table::add_composite_index(const std::vector<ColKey>& col_keys)
+{
+    if (col_keys.empty())
+        throw LogicError(LogicError::illegal_combination);
+    for (auto col_key : col_keys) {
+        check_column(col_key);
+        if (!CompositeIndex::type_supported(DataType(col_key.get_type())) ||
+            col_key.get_attrs().test(col_attr_List) ||
+            std::count(col_keys.begin(), col_keys.end(), col_key) > 1)
+            throw LogicError(LogicError::illegal_combination);
+    }
+
+    // Early-out if already indexed
+    if (has_composite_index(col_keys))
+        return;
+
+    if (!m_composite_index_refs.is_attached()) {
+        // First composite index of this table - add the slot
+        create_optional_index_refs(m_top, m_composite_index_refs, top_position_for_composite_indexes,
+                                   0); // Throws
+    }
+
+    // Create the index
+    CompositeIndex* index = new CompositeIndex(col_keys, &m_clusters, get_alloc()); // Throws
+    size_t ndx = m_composite_indexes.size();
+    m_composite_indexes.push_back(index);
+
+    // Insert ref to index
+    index->set_parent(&m_composite_index_refs, ndx);
+    m_composite_index_refs.add(index->get_ref()); // Throws
+
+    for (auto o : *this) {
+        index->insert(o.get_key()); // Throws
+    }
+}
+
+void Table::remove_composite_index(const std::vector<ColKey>& col_keys)
+{
+    for (auto col_key : col_keys)
+        check_column(col_key);
+
+    for (size_t ndx = 0; ndx < m_composite_indexes.size(); ++ndx) {
+        if (m_composite_indexes[ndx]->get_columns() == col_keys) {
+            do_remove_composite_index(ndx);
+            return;
+        }
+    }
+}
+
+void Table::do_remove_composite_index(size_t ndx)
+{
+    CompositeIndex* index = m_composite_indexes[ndx];
+    index->destroy();
+    delete index;
+    m_composite_indexes.erase(m_composite_indexes.begin() + ndx);
+    m_composite_index_refs.erase(ndx);
+
+    // The following indexes have moved down one slot
+    for (size_t i = ndx; i < m_composite_indexes.size(); ++i)
+        m_composite_indexes[i]->set_parent(&m_composite_index_refs, i);
+}
+
+bool Table::has_composite_index(const std::vector<ColKey>& col_keys) const noexcept
+{
+    return get_composite_index(col_keys) != nullptr;
+}
+
+CompositeIndex* Table::get_composite_index(const std::vector<ColKey>& col_keys) const noexcept
+{
+    for (auto index : m_composite_indexes) {
+        if (index->get_columns() == col_keys)
+            return index;
+    }
+    return nullptr;
+}
+
 void Table::enumerate_string_column(ColKey col_key)
 {
     check_column(col_key);
@@ -724,6 +1026,9 @@ ColKey Table::do_insert_root_column(ColKey col_key, ColumnType type, StringData
     else {
         m_index_refs.set(col_ndx, 0);
     }
+    for_each_optional_indexes([&](auto& indexes) {
+        indexes.insert_column(col_ndx); // Throws
+    });
     REALM_ASSERT(col_ndx <= m_opposite_table.size());
     if (col_ndx == m_opposite_table.size()) {
         // m_opposite_table and m_opposite_column are always resized together!
@@ -752,6 +1057,10 @@ void Table::do_erase_root_column(ColKey col_key)
         delete m_index_accessors[col_ndx];
         m_index_accessors[col_ndx] = nullptr;
     }
+    for (size_t ndx = m_composite_indexes.size(); ndx > 0; --ndx) {
+        if (m_composite_indexes[ndx - 1]->has_column(col_key))
+            do_remove_composite_index(ndx - 1);
+    }
     m_opposite_table.set(col_ndx, TableKey().value);
     m_opposite_column.set(col_ndx, ColKey().value);
     m_index_accessors[col_ndx] = nullptr;
@@ -765,6 +1074,9 @@ void Table::do_erase_root_column(ColKey col_key)
         REALM_ASSERT(m_index_accessors.back() == nullptr);
         m_index_accessors.erase(m_index_accessors.end() - 1);
     }
+    for_each_optional_indexes([&](auto& indexes) {
+        indexes.erase_column(col_ndx, m_leaf_ndx2colkey.size());
+    });
 }
 
 LinkType Table::get_link_type(ColKey col_key) const
@@ -808,6 +1120,14 @@ void Table::fully_detach() noexcept
     m_opposite_table.detach();
     m_opposite_column.detach();
     m_index_accessors.clear();
+    for_each_optional_indexes([](auto& indexes) {
+        indexes.detach();
+    });
+    for (auto& index : m_composite_indexes) {
+        delete index;
+    }
+    m_composite_index_refs.detach();
+    m_composite_indexes.clear();
 }
 
 
@@ -826,12 +1146,37 @@ Table::~Table() noexcept
         delete index;
     }
     m_index_accessors.clear();
+    for_each_optional_indexes([](auto& indexes) {
+        indexes.delete_accessors();
+    });
+    for (auto& index : m_composite_indexes) {
+        delete index;
+    }
+    m_composite_indexes.clear();
 }
 
 
 bool Table::has_search_index(ColKey col_key) const noexcept
 {
-    return m_index_accessors[col_key.get_index().val] != nullptr;
+    size_t col_ndx = col_key.get_index().val;
+    if (col_key.get_attrs().test(col_attr_List))
+        return m_list_indexes.get(col_key) != nullptr;
+    return m_index_accessors[col_ndx] != nullptr;
+}
+
+bool Table::has_trigram_index(ColKey col_key) const noexcept
+{
+    return m_trigram_indexes.get(col_key) != nullptr;
+}
+
+bool Table::has_range_index(ColKey col_key) const noexcept
+{
+    return m_range_indexes.get(col_key) != nullptr;
+}
+
+bool Table::has_hash_index(ColKey col_key) const noexcept
+{
+    return m_hash_indexes.get(col_key) != nullptr;
 }
 
 void Table::migrate_column_info()
@@ -1371,6 +1716,18 @@ bool Table::migrate_objects(ColKey pk_col_key)
         add_search_index(orig_row_ndx_col);
     }
 
+    // The search indexes are built in bulk once all objects exist, which is
+    // much faster than updating them for every object created
+    std::vector<ColKey> bulk_indexed_cols;
+    for (size_t col_ndx = 0; col_ndx < m_index_accessors.size(); col_ndx++) {
+        StringIndex*& index = m_index_accessors[col_ndx];
+        if (index && index->is_empty()) {
+            bulk_indexed_cols.push_back(m_leaf_ndx2colkey[col_ndx]);
+            delete index;
+            index = nullptr;
+        }
+    }
+
     for (size_t row_ndx = 0; row_ndx < number_of_objects; row_ndx++) {
         Mixed pk_val;
         // Build a vector of values obtained from the old columns
@@ -1454,6 +1811,14 @@ bool Table::migrate_objects(ColKey pk_col_key)
         }
     }
 
+    for (auto col_key : bulk_indexed_cols) {
+        size_t col_ndx = col_key.get_index().val;
+        ClusterColumn virtual_col(&m_clusters, col_key);
+        m_index_accessors[col_ndx] =
+            new StringIndex(m_index_refs.get_as_ref(col_ndx), &m_index_refs, col_ndx, virtual_col, get_alloc());
+        populate_search_index(col_key); // Throws
+    }
+
     // Destroy values in the old columns that has been copied.
     // This frees up space in the file
     for (auto ndx : cols_to_destroy) {
@@ -1768,6 +2133,9 @@ size_t Table::count_int(ColKey col_key, int64_t value) const
     if (auto index = this->get_search_index(col_key)) {
         return index->count(value);
     }
+    if (auto index = this->get_hash_index(col_key)) {
+        return index->count(value);
+    }
 
     size_t count;
     if (is_nullable(col_key)) {
@@ -1795,6 +2163,9 @@ size_t Table::count_string(ColKey col_key, StringData value) const
     if (auto index = this->get_search_index(col_key)) {
         return index->count(value);
     }
+    if (auto index = this->get_hash_index(col_key)) {
+        return index->count(value);
+    }
     size_t count;
     aggregate<act_Count, StringData, StringData>(col_key, value, &count);
     return count;
@@ -1840,8 +2211,31 @@ double Table::average_double(ColKey col_key, size_t* value_count) const
 
 #define USE_COLUMN_AGGREGATE 1
 
+namespace {
+
+// The smallest and largest values are the first and last entries of a range
+// index, so there is no need to scan the column
+template <class T>
+T range_index_minmax(const RangeIndex& index, bool max, ObjKey* return_ndx)
+{
+    size_t pos = max ? index.find_max() : index.find_min();
+    if (pos == npos) {
+        if (return_ndx)
+            *return_ndx = ObjKey();
+        return T{};
+    }
+    if (return_ndx)
+        *return_ndx = index.get_key(pos);
+    return index.get_value(pos).get<T>();
+}
+
+} // anonymous namespace
+
 int64_t Table::minimum_int(ColKey col_key, ObjKey* return_ndx) const
 {
+    if (RangeIndex* index = get_range_index(col_key)) {
+        return range_index_minmax<int64_t>(*index, false, return_ndx);
+    }
     if (is_nullable(col_key)) {
         return aggregate<act_Min, util::Optional<int64_t>, int64_t>(col_key, 0, nullptr, return_ndx);
     }
@@ -1850,16 +2244,25 @@ int64_t Table::minimum_int(ColKey col_key, ObjKey* return_ndx) const
 
 float Table::minimum_float(ColKey col_key, ObjKey* return_ndx) const
 {
+    if (RangeIndex* index = get_range_index(col_key)) {
+        return range_index_minmax<float>(*index, false, return_ndx);
+    }
     return aggregate<act_Min, float, float>(col_key, 0.f, nullptr, return_ndx);
 }
 
 double Table::minimum_double(ColKey col_key, ObjKey* return_ndx) const
 {
+    if (RangeIndex* index = get_range_index(col_key)) {
+        return range_index_minmax<double>(*index, false, return_ndx);
+    }
     return aggregate<act_Min, double, double>(col_key, 0., nullptr, return_ndx);
 }
 
 Timestamp Table::minimum_timestamp(ColKey col_key, ObjKey* return_ndx) const
 {
+    if (RangeIndex* index = get_range_index(col_key)) {
+        return range_index_minmax<Timestamp>(*index, false, return_ndx);
+    }
     return aggregate<act_Min, Timestamp, Timestamp>(col_key, Timestamp{}, nullptr, return_ndx);
 }
 
@@ -1867,6 +2270,9 @@ Timestamp Table::minimum_timestamp(ColKey col_key, ObjKey* return_ndx) const
 
 int64_t Table::maximum_int(ColKey col_key, ObjKey* return_ndx) const
 {
+    if (RangeIndex* index = get_range_index(col_key)) {
+        return range_index_minmax<int64_t>(*index, true, return_ndx);
+    }
     if (is_nullable(col_key)) {
         return aggregate<act_Max, util::Optional<int64_t>, int64_t>(col_key, 0, nullptr, return_ndx);
     }
@@ -1875,16 +2281,25 @@ int64_t Table::maximum_int(ColKey col_key, ObjKey* return_ndx) const
 
 float Table::maximum_float(ColKey col_key, ObjKey* return_ndx) const
 {
+    if (RangeIndex* index = get_range_index(col_key)) {
+        return range_index_minmax<float>(*index, true, return_ndx);
+    }
     return aggregate<act_Max, float, float>(col_key, 0.f, nullptr, return_ndx);
 }
 
 double Table::maximum_double(ColKey col_key, ObjKey* return_ndx) const
 {
+    if (RangeIndex* index = get_range_index(col_key)) {
+        return range_index_minmax<double>(*index, true, return_ndx);
+    }
     return aggregate<act_Max, double, double>(col_key, 0., nullptr, return_ndx);
 }
 
 Timestamp Table::maximum_timestamp(ColKey col_key, ObjKey* return_ndx) const
 {
+    if (RangeIndex* index = get_range_index(col_key)) {
+        return range_index_minmax<Timestamp>(*index, true, return_ndx);
+    }
     return aggregate<act_Max, Timestamp, Timestamp>(col_key, Timestamp{}, nullptr, return_ndx);
 }
 
@@ -1927,6 +2342,9 @@ ObjKey Table::find_first(ColKey col_key, StringData value) const
     if (StringIndex* index = get_search_index(col_key)) {
         return index->find_first(value);
     }
+    if (HashIndex* index = get_hash_index(col_key)) {
+        return index->find_first(value);
+    }
 
     if (col_key.get_type() == col_type_String && col_key == m_primary_key_col) {
         GlobalKey object_id{value};
@@ -2008,6 +2426,12 @@ template ObjKey Table::find_first(ColKey col_key, BinaryData) const;
 
 ObjKey Table::find_first_int(ColKey col_key, int64_t value) const
 {
+    if (col_key == m_primary_key_col && has_hashed_int_primary_key())
+        return find_hashed_primary_key(value);
+    if (!has_search_index(col_key)) {
+        if (HashIndex* index = get_hash_index(col_key))
+            return index->find_first(value);
+    }
     if (is_nullable(col_key))
         return find_first<util::Optional<int64_t>>(col_key, value);
     else
@@ -2049,6 +2473,8 @@ ObjKey Table::find_first_binary(ColKey col_key, BinaryData value) const
 
 ObjKey Table::find_first_null(ColKey col_key) const
 {
+    if (col_key == m_primary_key_col && has_hashed_int_primary_key())
+        return find_hashed_primary_key(Mixed());
     return where().equal(col_key, null{}).find();
 }
 
@@ -2212,6 +2638,16 @@ void Table::update_from_parent(size_t old_baseline) noexcept
             m_opposite_table.update_from_parent(old_baseline);
         if (m_top.size() > top_position_for_opposite_column)
             m_opposite_column.update_from_parent(old_baseline);
+        for_each_optional_indexes([&](auto& indexes) {
+            indexes.update_from_parent(old_baseline);
+        });
+        if (m_composite_index_refs.is_attached()) {
+            if (m_composite_index_refs.update_from_parent(old_baseline)) {
+                for (auto index : m_composite_indexes) {
+                    index->update_from_parent(old_baseline);
+                }
+            }
+        }
         refresh_content_version();
     }
     m_alloc.bump_storage_version();
@@ -2324,6 +2760,7 @@ void Table::refresh_accessor_tree()
     m_index_refs.init_from_parent();
     m_opposite_table.init_from_parent();
     m_opposite_column.init_from_parent();
+    attach_optional_index_refs();
     auto rot_pk_key = m_top.get_as_ref_or_tagged(top_position_for_pk_col);
     m_primary_key_col = rot_pk_key.is_tagged() ? ColKey(rot_pk_key.get_as_int()) : ColKey();
     refresh_content_version();
@@ -2369,6 +2806,39 @@ void Table::refresh_index_accessors()
             m_index_accessors[col_ndx] = new StringIndex(ref, &m_index_refs, col_ndx, virtual_col, get_alloc());
         }
     }
+
+    for_each_optional_indexes([this](auto& indexes) {
+        indexes.refresh_accessors(m_leaf_ndx2colkey, m_clusters); // Throws
+    });
+    refresh_composite_index_accessors();
+}
+
+void Table::refresh_composite_index_accessors()
+{
+    // Composite indexes are not tied to a column, so there is one ref per index
+    size_t count = m_composite_index_refs.is_attached() ? m_composite_index_refs.size() : 0;
+    for (size_t ndx = count; ndx < m_composite_indexes.size(); ++ndx) {
+        delete m_composite_indexes[ndx];
+    }
+    m_composite_indexes.resize(count);
+    for (size_t ndx = 0; ndx < count; ++ndx) {
+        CompositeIndex*& index = m_composite_indexes[ndx];
+        if (index) {
+            index->refresh_accessor_tree(&m_clusters);
+        }
+        else {
+            index = new CompositeIndex(m_composite_index_refs.get_as_ref(ndx), &m_composite_index_refs, ndx,
+                                       &m_clusters, get_alloc());
+        }
+    }
+}
+
+void Table::attach_optional_index_refs() noexcept
+{
+    for_each_optional_indexes([](auto& indexes) {
+        indexes.attach();
+    });
+    attach_optional_index_slot(m_top, m_composite_index_refs, top_position_for_composite_indexes);
 }
 
 bool Table::is_cross_table_link_target() const noexcept
@@ -2390,6 +2860,12 @@ void Table::verify() const
         m_top.verify();
     m_spec.verify();
     m_clusters.verify();
+    for_each_optional_indexes([](auto& indexes) {
+        indexes.verify();
+    });
+    for (auto index : m_composite_indexes) {
+        index->verify();
+    }
 #endif
 }
 
@@ -2446,7 +2922,8 @@ Obj Table::create_object_with_primary_key(const Mixed& primary_key, bool* did_cr
         *did_create = false;
 
     ObjKey object_key;
-    if (type == type_Int) {
+    bool hashed = type == type_String || has_hashed_int_primary_key();
+    if (type == type_Int && !hashed) {
         if (primary_key.is_null())
             object_key = find_first_null(primary_key_col);
         else
@@ -2458,13 +2935,13 @@ Obj Table::create_object_with_primary_key(const Mixed& primary_key, bool* did_cr
     }
 
     GlobalKey object_id{primary_key};
-    if (type == type_String) {
+    if (hashed) {
         // Generate local ObjKey
         object_key = global_to_local_object_id_hashed(object_id);
         // Check for collision
         if (is_valid(object_key)) {
             Obj existing_obj = get_object(object_key);
-            Mixed existing_pk_value{existing_obj.get<String>(primary_key_col)};
+            Mixed existing_pk_value = existing_obj.get_any(primary_key_col);
 
             // It may just be the same object
             if (existing_pk_value == primary_key) {
@@ -2492,11 +2969,15 @@ ObjKey Table::get_obj_key(GlobalKey id) const
     if (col) {
         if (col.get_type() == col_type_Int) {
             REALM_ASSERT(id.hi() == 0 || col.get_attrs().test(col_attr_Nullable));
-            if (id.hi() != 0 && id.lo() == 0) {
+            Mixed pk = (id.hi() != 0 && id.lo() == 0) ? Mixed() : Mixed(int64_t(id.lo()));
+            if (has_hashed_int_primary_key()) {
+                key = find_hashed_primary_key(pk);
+            }
+            else if (pk.is_null()) {
                 key = find_first_null(col);
             }
             else {
-                key = find_first_int(col, int64_t(id.lo()));
+                key = find_first_int(col, pk.get_int());
             }
         }
         if (col.get_type() == col_type_String) {
@@ -2899,7 +3380,7 @@ void Table::rebuild_table_with_pk_column()
 {
     std::vector<std::pair<ObjKey, ObjKey>> changed_keys;
     for (auto& obj : *this) {
-        StringData pk(obj.get<String>(m_primary_key_col));
+        Mixed pk = obj.get_any(m_primary_key_col);
         GlobalKey object_id{pk};
         ObjKey new_key = global_to_local_object_id_hashed(object_id);
         if (new_key != obj.get_key())
@@ -2937,7 +3418,7 @@ void Table::rebuild_table_with_pk_column()
     }
     for (auto key : tmp_keys) {
         auto old_obj = get_object(key);
-        StringData pk(old_obj.get<String>(m_primary_key_col));
+        Mixed pk = old_obj.get_any(m_primary_key_col);
         auto new_obj = create_object_with_primary_key(pk);
         new_obj.assign(old_obj);
         remove_object(key);
@@ -2952,10 +3433,50 @@ void Table::do_set_primary_key_column(ColKey col_key)
     else {
         m_top.set(top_position_for_pk_col, 0);
     }
+    // The keys of the existing objects are not derived from the new column
+    set_hashed_int_primary_key(false);
 
     m_primary_key_col = col_key;
 }
 
+bool Table::has_hashed_int_primary_key() const noexcept
+{
+    if (!m_primary_key_col || m_primary_key_col.get_type() != col_type_Int)
+        return false;
+    if (m_top.size() <= top_position_for_flags)
+        return false;
+    RefOrTagged rot = m_top.get_as_ref_or_tagged(top_position_for_flags);
+    return rot.is_tagged() && (rot.get_as_int() & flag_hashed_int_primary_key);
+}
+
+void Table::set_hashed_int_primary_key(bool value)
+{
+    if (m_top.size() <= top_position_for_flags) {
+        if (!value)
+            return;
+        while (m_top.size() <= top_position_for_flags)
+            m_top.add(0); // Throws
+    }
+    RefOrTagged rot = m_top.get_as_ref_or_tagged(top_position_for_flags);
+    uint64_t flags = rot.is_tagged() ? rot.get_as_int() : 0;
+    if (value) {
+        flags |= flag_hashed_int_primary_key;
+    }
+    else {
+        flags &= ~uint64_t(flag_hashed_int_primary_key);
+    }
+    m_top.set(top_position_for_flags, RefOrTagged::make_tagged(flags)); // Throws
+}
+
+ObjKey Table::find_hashed_primary_key(Mixed value) const
+{
+    ObjKey key = global_to_local_object_id_hashed(GlobalKey{value});
+    // Another value may hash to the same key
+    if (is_valid(key) && get_object(key).get_any(m_primary_key_col) == value)
+        return key;
+    return null_key;
+}
+
 bool Table::contains_unique_values(ColKey col) const
 {
     if (has_search_index(col)) {
@@ -2979,7 +3500,7 @@ void Table::validate_primary_column()
 {
     if (ColKey col = get_primary_key_column()) {
         validate_column_is_unique(col);
-        if (col.get_type() == col_type_String) {
+        if (col.get_type() == col_type_String || has_hashed_int_primary_key()) {
             rebuild_table_with_pk_column();
         }
     }
@@ -3166,6 +3687,14 @@ ColKey Table::set_nullability(ColKey col_key, bool nullable, bool throw_on_null)
         return col_key;
 
     bool si = has_search_index(col_key);
+    bool ti = has_trigram_index(col_key);
+    bool ri = has_range_index(col_key);
+    bool hi = has_hash_index(col_key);
+    std::vector<std::vector<ColKey>> composite_indexes;
+    for (auto index : m_composite_indexes) {
+        if (index->has_column(col_key))
+            composite_indexes.push_back(index->get_columns());
+    }
     std::string column_name(get_column_name(col_key));
     auto type = get_real_column_type(col_key);
     auto list = is_list(col_key);
@@ -3189,6 +3718,16 @@ ColKey Table::set_nullability(ColKey col_key, bool nullable, bool throw_on_null)
 
     if (si)
         add_search_index(new_col);
+    if (ti)
+        add_trigram_index(new_col);
+    if (ri)
+        add_range_index(new_col);
+    if (hi)
+        add_hash_index(new_col);
+    for (auto& col_keys : composite_indexes) {
+        std::replace(col_keys.begin(), col_keys.end(), col_key, new_col);
+        add_composite_index(col_keys);
+    }
 
     return new_col;
 }
@@ -49,11 +49,16 @@ class BacklinkColumn;
 template <class>
 class BacklinkCount;
 class BinaryColumy;
+class CompositeIndex;
 class ConstTableView;
 class Group;
+class HashIndex;
+class ListIndex;
 class SortDescriptor;
+class RangeIndex;
 class StringIndex;
 class TableView;
+class TrigramIndex;
 template <class>
 class Columns;
 template <class>
@@ -75,6 +80,54 @@ namespace metrics {
 class QueryInfo;
 }
 
+/// The accessors of the indexes of one type which are stored with a ref per
+/// column in an optional slot of the table top array, like the search indexes
+/// are in a fixed slot. The slot is only added when the first index of the
+/// type is created, so tables without such indexes keep their layout.
+///
+/// The members which create or refresh index accessors are defined in
+/// table.cpp, where the index types are complete.
+template <class Index>
+class OptionalIndexes {
+public:
+    OptionalIndexes(Allocator& alloc, Array& top, size_t top_position) noexcept
+        : m_top(top)
+        , m_refs(alloc)
+        , m_top_position(top_position)
+    {
+        m_refs.set_parent(&top, top_position);
+    }
+
+    // Returns nullptr if the column has no index of this type
+    Index* get(ColKey col_key) const noexcept
+    {
+        size_t col_ndx = col_key.get_index().val;
+        return col_ndx < m_accessors.size() ? m_accessors[col_ndx] : nullptr;
+    }
+
+    // Create an empty index on the column, which the caller must fill
+    Index* create(ColKey col_key, ClusterTree& clusters, size_t num_columns);
+    // Destroy the index on the column at `col_ndx`, if there is one
+    void destroy(size_t col_ndx);
+
+    // Keep the refs in step with the columns of the table
+    void insert_column(size_t col_ndx);
+    void erase_column(size_t col_ndx, size_t num_columns);
+
+    void attach() noexcept;
+    void detach() noexcept;
+    void delete_accessors() noexcept;
+    void update_from_parent(size_t old_baseline) noexcept;
+    void refresh_accessors(const std::vector<ColKey>& leaf_ndx2colkey, ClusterTree& clusters);
+    void verify() const;
+
+private:
+    Array& m_top;
+    Array m_refs;
+    std::vector<Index*> m_accessors;
+    size_t m_top_position;
+};
+
 class Table {
 public:
     /// Construct a new freestanding top-level table with static
@@ -225,7 +278,9 @@ public:
     ///
     /// add_search_index() adds a search index to the specified column of the
     /// table. It has no effect if a search index has already been added to the
-    /// specified column (idempotency).
+    /// specified column (idempotency). On a list of ints, strings, timestamps
+    /// or bools it adds a list index, which maps every element to the object
+    /// owning the list, and is used by equality queries on the elements.
     ///
     /// remove_search_index() removes the search index from the specified column
     /// of the table. It has no effect if the specified column has no search
@@ -238,6 +293,57 @@ public:
     void add_search_index(ColKey col_key);
     void remove_search_index(ColKey col_key);
 
+    /// A trigram index on a string column maps every three byte sequence to
+    /// the objects whose value contains it. Queries for `contains`, `like`,
+    /// `begins_with` and `ends_with`, case sensitive or not, use it to find
+    /// candidates instead of scanning the column. It is independent of, and
+    /// can be combined with, a search index on the same column.
+    ///
+    /// add_trigram_index() throws LogicError::illegal_combination for columns
+    /// which are not plain string columns. Like their search index
+    /// counterparts, adding and removing are idempotent.
+    bool has_trigram_index(ColKey col_key) const noexcept;
+    void add_trigram_index(ColKey col_key);
+    void remove_trigram_index(ColKey col_key);
+
+    /// A range index keeps the values of an int, timestamp, float or double
+    /// column in order. Comparison queries (`greater()`, `less()`,
+    /// `between()`, ...) use it to look up the matching objects when only a
+    /// small part of the table matches, and minimum()/maximum() on the column
+    /// read the first and last entry instead of scanning.
+    ///
+    /// add_range_index() throws LogicError::illegal_combination for other
+    /// column types and for lists.
+    bool has_range_index(ColKey col_key) const noexcept;
+    void add_range_index(ColKey col_key);
+    void remove_range_index(ColKey col_key);
+
+    /// A hash index is an alternative to the search index for `equal()`
+    /// conditions and find_first() on an int or string column. It stores a
+    /// fixed size hash of every value, so lookups and updates cost the same
+    /// whatever the length of the values, at the price of no support for
+    /// other conditions. A column may have both kinds of index, in which case
+    /// the search index is used.
+    ///
+    /// add_hash_index() throws LogicError::illegal_combination for other
+    /// column types and for lists.
+    bool has_hash_index(ColKey col_key) const noexcept;
+    void add_hash_index(ColKey col_key);
+    void remove_hash_index(ColKey col_key);
+
+    /// A composite index covers an ordered list of int, string, timestamp and
+    /// bool columns. Queries with `equal()` conditions on a prefix of the
+    /// columns, combined with `and`, look up the objects matching all of those
+    /// conditions at once instead of using one single column index and
+    /// checking the rest. A table may have several composite indexes.
+    ///
+    /// add_composite_index() throws LogicError::illegal_combination if the
+    /// list is empty, has duplicates, or contains columns of other types or
+    /// lists. Removing a column removes the composite indexes containing it.
+    bool has_composite_index(const std::vector<ColKey>& col_keys) const noexcept;
+    void add_composite_index(const std::vector<ColKey>& col_keys);
+    void remove_composite_index(const std::vector<ColKey>& col_keys);
+
     void enumerate_string_column(ColKey col_key);
     bool is_enumerated(ColKey col_key) const noexcept;
     bool contains_unique_values(ColKey col_key) const;
@@ -404,6 +510,37 @@ public:
             return nullptr;
         return m_index_accessors[col.get_index().val];
     }
+    // Will return pointer to trigram index accessor. Will return nullptr if no index
+    TrigramIndex* get_trigram_index(ColKey col) const noexcept
+    {
+        report_invalid_key(col);
+        return m_trigram_indexes.get(col);
+    }
+    // Will return pointer to range index accessor. Will return nullptr if no index
+    RangeIndex* get_range_index(ColKey col) const noexcept
+    {
+        report_invalid_key(col);
+        return m_range_indexes.get(col);
+    }
+    // Will return pointer to hash index accessor. Will return nullptr if no index
+    HashIndex* get_hash_index(ColKey col) const noexcept
+    {
+        report_invalid_key(col);
+        return m_hash_indexes.get(col);
+    }
+    // Will return pointer to list index accessor. Will return nullptr if no index
+    ListIndex* get_list_index(ColKey col) const noexcept
+    {
+        report_invalid_key(col);
+        return m_list_indexes.get(col);
+    }
+    // Will return pointer to the composite index on exactly these columns, or
+    // nullptr if there is none
+    CompositeIndex* get_composite_index(const std::vector<ColKey>& col_keys) const noexcept;
+    const std::vector<CompositeIndex*>& get_composite_indexes() const noexcept
+    {
+        return m_composite_indexes;
+    }
     template <class T>
     ObjKey find_first(ColKey col_key, T value) const;
 
@@ -687,6 +824,12 @@ private:
     Array m_opposite_table;  // 7th slot in m_top
     Array m_opposite_column; // 8th slot in m_top
     std::vector<StringIndex*> m_index_accessors;
+    OptionalIndexes<TrigramIndex> m_trigram_indexes; // 13th slot in m_top
+    OptionalIndexes<RangeIndex> m_range_indexes;     // 14th slot in m_top
+    Array m_composite_index_refs; // 15th slot in m_top, only present once a composite index has been added
+    std::vector<CompositeIndex*> m_composite_indexes;
+    OptionalIndexes<ListIndex> m_list_indexes; // 16th slot in m_top
+    OptionalIndexes<HashIndex> m_hash_indexes; // 18th slot in m_top
     ColKey m_primary_key_col;
     Replication* const* m_repl;
     static Replication* g_dummy_replication;
@@ -755,6 +898,16 @@ private:
     void validate_column_is_unique(ColKey col_key) const;
     void rebuild_table_with_pk_column();
 
+    /// The objects of a table created with an int primary key have keys
+    /// derived from the primary key value, like string primary keys, so they
+    /// can be found without a search. Tables which got an int primary key in
+    /// any other way use sequential keys.
+    bool has_hashed_int_primary_key() const noexcept;
+    void set_hashed_int_primary_key(bool);
+    /// The object with the given primary key value in a table with a hashed
+    /// primary key, or null_key.
+    ObjKey find_hashed_primary_key(Mixed value) const;
+
     ObjKey get_next_key();
     /// Some Object IDs are generated as a tuple of the client_file_ident and a
     /// local sequence number. This function takes the next number in the
@@ -905,6 +1058,29 @@ private:
     /// table.
     void refresh_accessor_tree();
     void refresh_index_accessors();
+    void attach_optional_index_refs() noexcept;
+    // Call `fn` with the accessors of every index type kept by OptionalIndexes
+    template <class F>
+    void for_each_optional_indexes(F fn)
+    {
+        fn(m_trigram_indexes);
+        fn(m_range_indexes);
+        fn(m_list_indexes);
+        fn(m_hash_indexes);
+    }
+    template <class F>
+    void for_each_optional_indexes(F fn) const
+    {
+        fn(m_trigram_indexes);
+        fn(m_range_indexes);
+        fn(m_list_indexes);
+        fn(m_hash_indexes);
+    }
+    void refresh_composite_index_accessors();
+    void do_remove_composite_index(size_t ndx);
+    // The search index of a list column
+    void add_list_index(ColKey col_key);
+    void remove_list_index(ColKey col_key);
     void refresh_content_version();
     void flush_for_commit();
 
@@ -933,6 +1109,16 @@ private:
     static constexpr int top_position_for_collision_map = 10;
     static constexpr int top_position_for_pk_col = 11;
     static constexpr int top_array_size = 12;
+    // Optional slots after the fixed part of m_top
+    static constexpr int top_position_for_trigram_indexes = 12;
+    static constexpr int top_position_for_range_indexes = 13;
+    static constexpr int top_position_for_composite_indexes = 14;
+    static constexpr int top_position_for_list_indexes = 15;
+    static constexpr int top_position_for_flags = 16;
+    static constexpr int top_position_for_hash_indexes = 17;
+
+    // Bits of the tagged value at top_position_for_flags
+    enum { flag_hashed_int_primary_key = 1 };
 
     enum { s_collision_map_lo = 0, s_collision_map_hi = 1, s_collision_map_local_id = 2, s_collision_map_num_slots };
 
@@ -1226,11 +1412,17 @@ inline Table::Table(Allocator& alloc)
     , m_index_refs(m_alloc)
     , m_opposite_table(m_alloc)
     , m_opposite_column(m_alloc)
+    , m_trigram_indexes(m_alloc, m_top, top_position_for_trigram_indexes)
+    , m_range_indexes(m_alloc, m_top, top_position_for_range_indexes)
+    , m_composite_index_refs(m_alloc)
+    , m_list_indexes(m_alloc, m_top, top_position_for_list_indexes)
+    , m_hash_indexes(m_alloc, m_top, top_position_for_hash_indexes)
     , m_repl(&g_dummy_replication)
     , m_own_ref(this, alloc.get_instance_version())
 {
     m_spec.set_parent(&m_top, top_position_for_spec);
     m_index_refs.set_parent(&m_top, top_position_for_search_indexes);
+    m_composite_index_refs.set_parent(&m_top, top_position_for_composite_indexes);
     m_opposite_table.set_parent(&m_top, top_position_for_opposite_table);
     m_opposite_column.set_parent(&m_top, top_position_for_opposite_column);
 
@@ -1248,11 +1440,17 @@ inline Table::Table(Replication* const* repl, Allocator& alloc)
     , m_index_refs(m_alloc)
     , m_opposite_table(m_alloc)
     , m_opposite_column(m_alloc)
+    , m_trigram_indexes(m_alloc, m_top, top_position_for_trigram_indexes)
+    , m_range_indexes(m_alloc, m_top, top_position_for_range_indexes)
+    , m_composite_index_refs(m_alloc)
+    , m_list_indexes(m_alloc, m_top, top_position_for_list_indexes)
+    , m_hash_indexes(m_alloc, m_top, top_position_for_hash_indexes)
     , m_repl(repl)
     , m_own_ref(this, alloc.get_instance_version())
 {
     m_spec.set_parent(&m_top, top_position_for_spec);
     m_index_refs.set_parent(&m_top, top_position_for_search_indexes);
+    m_composite_index_refs.set_parent(&m_top, top_position_for_composite_indexes);
     m_opposite_table.set_parent(&m_top, top_position_for_opposite_table);
     m_opposite_column.set_parent(&m_top, top_position_for_opposite_column);
 }
@@ -20,6 +20,8 @@
 #include <realm/column_integer.hpp>
 #include <realm/index_string.hpp>
 #include <realm/db.hpp>
+#include <realm/object_change_collector.hpp>
+#include <realm/query_expression.hpp>
 
 #include <unordered_set>
 
@@ -62,6 +64,12 @@ ConstTableView::ConstTableView(const ConstTableView& src, Transaction* tr, Paylo
     if (src.m_source_column_key) {
         m_linked_table = tr->import_copy_of(src.m_linked_table);
     }
+    if (src.m_key_bitmap) {
+        // Without the keys, the view is filled again by do_sync() as a bitmap
+        if (mode != PayloadPolicy::Stay)
+            m_table_view_key_bitmap = src.m_table_view_key_bitmap; // Throws
+        m_key_bitmap = &m_table_view_key_bitmap;
+    }
     // don't use methods which throw after this point...or m_table_view_key_values will leak
     if (mode == PayloadPolicy::Copy && src.m_table_view_key_values.is_attached()) {
         m_table_view_key_values = src.m_table_view_key_values;
@@ -96,7 +104,7 @@ R ConstTableView::aggregate(ColKey column_key, size_t* result_count, ObjKey* ret
     REALM_ASSERT(action == act_Sum || action == act_Max || action == act_Min || action == act_Average);
     REALM_ASSERT(m_table->valid_column(column_key));
 
-    if ((m_key_values->size()) == 0) {
+    if (size() == 0) {
         return {};
     }
 
@@ -128,9 +136,9 @@ R ConstTableView::aggregate(ColKey column_key, size_t* result_count, ObjKey* ret
 */
     R res = R{};
     bool is_first = true;
-    for (size_t tv_index = 0; tv_index < m_key_values->size(); ++tv_index) {
+    for (size_t tv_index = 0, sz = size(); tv_index < sz; ++tv_index) {
 
-        ObjKey key(m_key_values->get(tv_index));
+        ObjKey key = get_key(tv_index);
 
         // skip detached references:
         if (key == realm::null_key)
@@ -195,14 +203,14 @@ size_t ConstTableView::aggregate_count(ColKey column_key, T count_target) const
     check_cookie();
     REALM_ASSERT(m_table->valid_column(column_key));
 
-    if ((m_key_values->size()) == 0) {
+    if (size() == 0) {
         return {};
     }
 
     size_t cnt = 0;
-    for (size_t tv_index = 0; tv_index < m_key_values->size(); ++tv_index) {
+    for (size_t tv_index = 0, sz = size(); tv_index < sz; ++tv_index) {
 
-        ObjKey key(m_key_values->get(tv_index));
+        ObjKey key = get_key(tv_index);
 
         // skip detached references:
         if (key == realm::null_key)
@@ -347,7 +355,7 @@ size_t ConstTableView::count_timestamp(ColKey column_key, Timestamp target) cons
     size_t count = 0;
     for (size_t t = 0; t < size(); t++) {
         try {
-            ObjKey key = m_key_values->get(t);
+            ObjKey key = get_key(t);
             ConstObj obj = m_table->get_object(key);
             auto ts = obj.get<Timestamp>(column_key);
             realm::Equal e;
@@ -446,18 +454,149 @@ void ConstTableView::sync_if_needed() const
     }
 }
 
+void ConstTableView::sync_if_needed(const ObjectChangeCollector& changes) const
+{
+    auto self = const_cast<ConstTableView*>(this);
+    if (is_in_sync()) {
+        self->stamp_db_version();
+        return;
+    }
+    if (!self->do_sync_incrementally(changes))
+        self->do_sync();
+}
+
+void ConstTableView::stamp_db_version() noexcept
+{
+    // Only a read transaction is guaranteed to reach its next version through
+    // advance_read(). Changes made in a write transaction may be rolled back
+    // without changing the version.
+    m_last_seen_db_version = 0;
+    if (m_table) {
+        auto tr = dynamic_cast<Transaction*>(_impl::TableFriend::get_parent_group(*m_table));
+        if (tr && tr->get_transact_stage() == DB::transact_Reading)
+            m_last_seen_db_version = tr->get_version();
+    }
+}
+
+bool ConstTableView::do_sync_incrementally(const ObjectChangeCollector& changes)
+{
+    // Only views created by an unrestricted Query::find_all() can be patched
+    if (!m_table || !m_query.m_table || m_query.m_view || m_linklist_source || m_distinct_column_source ||
+        m_source_column_key)
+        return false;
+    if (m_start != 0 || m_end != size_t(-1) || m_limit != size_t(-1))
+        return false;
+    if (m_descriptor_ordering.will_apply_distinct() || m_descriptor_ordering.will_apply_limit() ||
+        m_descriptor_ordering.will_apply_include())
+        return false;
+
+    // The view must have been in sync at the version where collection started
+    if (m_last_seen_db_version == 0 || changes.schema_changed() ||
+        changes.get_transaction() != _impl::TableFriend::get_parent_group(*m_table) ||
+        changes.get_base_version() != m_last_seen_db_version)
+        return false;
+
+    // Changes to linked tables may change the result for any object, and so
+    // may changes to the queried table when its objects are reached through
+    // links or backlinks from other objects of it
+    if (m_query.links_to_own_table())
+        return false;
+    TableKey table_key = m_table->get_key();
+    TableVersions versions = get_dependency_versions();
+    for (auto& version : versions) {
+        if (version.first != table_key && changes.get_table_changes(version.first))
+            return false;
+    }
+
+    CriticalSection cs(m_race_detector);
+    auto table_changes = changes.get_table_changes(table_key);
+    if (table_changes) {
+        if (table_changes->cleared)
+            return false;
+
+        m_query.init();
+        if (m_key_bitmap) {
+            // The bitmap keeps the keys in table order
+            for (auto key : table_changes->removed)
+                m_table_view_key_bitmap.erase(key); // Throws
+            for (auto key : table_changes->changed) {
+                bool match = false;
+                if (m_table->is_valid(key)) {
+                    ConstObj obj = m_table->get_object(key);
+                    match = m_query.eval_object(obj);
+                }
+                if (match) {
+                    m_table_view_key_bitmap.add(key); // Throws
+                }
+                else {
+                    m_table_view_key_bitmap.erase(key); // Throws
+                }
+            }
+            m_last_seen_versions = get_dependency_versions();
+            stamp_db_version();
+            return true;
+        }
+
+        std::vector<ObjKey> keys;
+        std::unordered_set<ObjKey> seen;
+        keys.reserve(m_key_values->size() + table_changes->changed.size());
+        size_t sz = m_key_values->size();
+        for (size_t i = 0; i < sz; i++) {
+            ObjKey key = m_key_values->get(i);
+            if (table_changes->removed.count(key))
+                continue;
+            if (table_changes->changed.count(key)) {
+                seen.insert(key);
+                if (!m_table->is_valid(key))
+                    continue;
+                ConstObj obj = m_table->get_object(key);
+                if (!m_query.eval_object(obj))
+                    continue;
+            }
+            keys.push_back(key);
+        }
+        for (auto key : table_changes->changed) {
+            if (seen.count(key) || !m_table->is_valid(key))
+                continue;
+            ConstObj obj = m_table->get_object(key);
+            if (m_query.eval_object(obj))
+                keys.push_back(key);
+        }
+
+        // Restore table order, which is also what a rerun of the query would
+        // hand over to the sort
+        if (seen.size() != table_changes->changed.size() || m_descriptor_ordering.will_apply_sort())
+            std::sort(keys.begin(), keys.end());
+
+        m_key_values->clear();
+        for (auto key : keys)
+            m_key_values->add(key);
+
+        do_sort(m_descriptor_ordering);
+    }
+
+    m_last_seen_versions = get_dependency_versions();
+    stamp_db_version();
+    return true;
+}
+
 
 void TableView::remove(size_t row_ndx)
 {
     m_table.check();
-    REALM_ASSERT(row_ndx < m_key_values->size());
+    REALM_ASSERT(row_ndx < size());
 
     bool sync_to_keep = m_last_seen_versions == get_dependency_versions();
 
-    ObjKey key = m_key_values->get(row_ndx);
+    ObjKey key = get_key(row_ndx);
 
     // Update refs
-    m_key_values->erase(row_ndx);
+    if (m_key_bitmap) {
+        m_table_view_key_bitmap.erase(key);
+    }
+    else {
+        m_key_values->erase(row_ndx);
+    }
 
     // Delete row in origin table
     get_parent()->remove_object(key);
@@ -479,6 +618,7 @@ void TableView::clear()
 
     bool sync_to_keep = m_last_seen_versions == get_dependency_versions();
 
+    use_key_column(); // Throws
     _impl::TableFriend::batch_erase_rows(*get_parent(), *m_key_values); // Throws
 
     m_key_values->clear();
@@ -546,6 +686,7 @@ void ConstTableView::sort(SortDescriptor order)
     m_descriptor_ordering.append_sort(std::move(order), SortDescriptor::MergeMode::prepend);
     m_descriptor_ordering.collect_dependencies(m_table.unchecked_ptr());
 
+    use_key_column(); // Throws
     do_sort(m_descriptor_ordering);
 }
 
@@ -588,8 +729,15 @@ void ConstTableView::do_sync()
         }
     }
     // FIXME: Unimplemented for link to a column
+    else if (m_key_bitmap && m_descriptor_ordering.is_empty()) {
+        m_query.m_table.check();
+        // A combined view, which stays a bitmap until it is ordered
+        m_table_view_key_bitmap = m_query.do_find_all_keys(); // Throws
+    }
     else {
         m_query.m_table.check();
+        m_key_bitmap = nullptr;
+        m_table_view_key_bitmap.clear();
 
         // valid query, so clear earlier results and reexecute it.
         if (m_key_values->is_attached())
@@ -605,6 +753,96 @@ void ConstTableView::do_sync()
     do_sort(m_descriptor_ordering);
 
     m_last_seen_versions = get_dependency_versions();
+    stamp_db_version();
+}
+
+void ConstTableView::use_key_bitmap(KeyBitmap keys)
+{
+    m_table_view_key_bitmap = std::move(keys);
+    m_key_bitmap = &m_table_view_key_bitmap;
+    m_key_values->clear();
+}
+
+void ConstTableView::use_key_column()
+{
+    if (!m_key_bitmap)
+        return;
+    m_key_values->clear();
+    m_table_view_key_bitmap.for_each([&](ObjKey key) {
+        m_key_values->add(key); // Throws
+        return false;
+    });
+    m_key_bitmap = nullptr;
+    m_table_view_key_bitmap.clear();
+}
+
+KeyBitmap ConstTableView::get_key_bitmap() const
+{
+    if (m_key_bitmap)
+        return *m_key_bitmap; // Throws
+    KeyBitmap keys;
+    for (size_t i = 0, n = m_key_values->size(); i < n; ++i)
+        keys.add(m_key_values->get(i)); // Throws
+    return keys;
+}
+
+void ConstTableView::check_combinable(const ConstTableView& other) const
+{
+    auto is_query_result = [&](const ConstTableView& tv) {
+        return tv.m_table && tv.m_table == m_table && tv.m_query.m_table && !tv.m_query.m_view &&
+               tv.m_descriptor_ordering.is_empty() && tv.m_start == 0 && tv.m_end == size_t(-1) &&
+               tv.m_limit == size_t(-1);
+    };
+    if (!is_query_result(*this) || !is_query_result(other))
+        throw LogicError(LogicError::illegal_combination);
+    sync_if_needed();
+    other.sync_if_needed();
+}
+
+ConstTableView ConstTableView::combine(Query query, KeyBitmap keys) const
+{
+    ConstTableView tv(m_table, query, 0, size_t(-1), size_t(-1));
+    tv.use_key_bitmap(std::move(keys));
+    tv.m_last_seen_versions = tv.get_dependency_versions();
+    tv.stamp_db_version();
+    return tv;
+}
+
+ConstTableView ConstTableView::set_union(const ConstTableView& other) const
+{
+    check_combinable(other);
+    // A query without conditions holds every object
+    Query query = m_query;
+    if (!other.m_query.has_conditions()) {
+        query = other.m_query;
+    }
+    else if (m_query.has_conditions()) {
+        query = query || other.m_query;
+    }
+    return combine(std::move(query), get_key_bitmap() | other.get_key_bitmap());
+}
+
+ConstTableView ConstTableView::set_intersection(const ConstTableView& other) const
+{
+    check_combinable(other);
+    Query query = m_query;
+    query.and_query(other.m_query);
+    return combine(std::move(query), get_key_bitmap() & other.get_key_bitmap());
+}
+
+ConstTableView ConstTableView::set_difference(const ConstTableView& other) const
+{
+    check_combinable(other);
+    Query query = m_query;
+    Query excluded = other.m_query;
+    if (excluded.has_conditions()) {
+        query.and_query(!excluded);
+    }
+    else {
+        // The other view holds every object
+        query.and_query(std::unique_ptr<Expression>(new FalseExpression));
+    }
+    return combine(std::move(query), get_key_bitmap() - other.get_key_bitmap());
 }
 
 bool ConstTableView::is_in_table_order() const
@@ -26,6 +26,8 @@
 
 namespace realm {
 
+class ObjectChangeCollector;
+
 // Views, tables and synchronization between them:
 //
 // Views are built through queries against either tables or another view.
@@ -203,7 +205,7 @@ public:
     //    mode get_operating_mode();
     bool is_empty() const noexcept
     {
-        return m_key_values->size() == 0;
+        return m_key_bitmap ? m_key_bitmap->empty() : m_key_values->size() == 0;
     }
 
     // Tells if the table that this TableView points at still exists or has been deleted.
@@ -214,7 +216,7 @@ public:
 
     bool is_obj_valid(size_t row_ndx) const noexcept
     {
-        return m_table->is_valid(ObjKey(m_key_values->get(row_ndx)));
+        return m_table->is_valid(get_key(row_ndx));
     }
 
     // Get the query used to create this TableView
@@ -269,6 +271,8 @@ public:
     /// within this view is returned, otherwise `realm::not_found` is returned.
     size_t find_by_source_ndx(ObjKey key) const noexcept
     {
+        if (m_key_bitmap)
+            return m_key_bitmap->find(key);
         return m_key_values->find_first(key);
     }
 
@@ -286,7 +290,7 @@ public:
 
     // A TableView is frozen if it is a) obtained from a query against a frozen table
     // and b) is synchronized (is_in_sync())
-    bool is_frozen() { return m_table->is_frozen() && is_in_sync(); }
+    bool is_frozen() const { return m_table->is_frozen() && is_in_sync(); }
     // Tells if this TableView depends on a LinkList or row that has been deleted.
     bool depends_on_deleted_object() const;
 
@@ -302,6 +306,15 @@ public:
     // This will make the TableView empty and in sync with the highest possible table version
     // if the TableView depends on an object (LinkView or row) that has been deleted.
     void sync_if_needed() const override;
+
+    // Synchronize a view after the transaction was advanced with `changes` as
+    // observer. If the view was in sync before the advance, it is brought back
+    // in sync by reevaluating only the created and modified objects of its table
+    // and dropping the removed ones, instead of rerunning the whole query. Views
+    // that are not derived from an unrestricted query, that have a distinct,
+    // limit or include descriptor, or that depend on other tables which have
+    // changed, are synchronized by sync_if_needed().
+    void sync_if_needed(const ObjectChangeCollector& changes) const;
     // Return the version of the source it was created from.
     TableVersions get_dependency_versions() const
     {
@@ -347,6 +360,20 @@ public:
         return m_source_column_key != ColKey();
     }
 
+    // The keys of the objects in the view as a compressed bitmap.
+    KeyBitmap get_key_bitmap() const;
+
+    // The objects in this view or in `other`, in both, or in this view but not
+    // in `other`. Both views must be the unsorted and unlimited result of
+    // Query::find_all() on the same table. The result is computed from the
+    // keys of the views without running their queries again, is in table
+    // order, and is synchronized by running the combined query. Its keys are
+    // held in a KeyBitmap until it is sorted, made distinct, limited, given
+    // includes, or cleared.
+    ConstTableView set_union(const ConstTableView& other) const;
+    ConstTableView set_intersection(const ConstTableView& other) const;
+    ConstTableView set_difference(const ConstTableView& other) const;
+
 protected:
     // This TableView can be "born" from 4 different sources:
     // - LinkView
@@ -357,6 +384,13 @@ protected:
     void get_dependencies(TableVersions&) const override;
 
     void do_sync();
+    bool do_sync_incrementally(const ObjectChangeCollector& changes);
+    void stamp_db_version() noexcept;
+
+    // Hold the keys of the view in `keys` instead of in the key column
+    void use_key_bitmap(KeyBitmap keys);
+    // Move the keys back to the key column, if they are held in a KeyBitmap
+    void use_key_column();
 
     // The source column index that this view contain backlinks for.
     ColKey m_source_column_key;
@@ -383,10 +417,18 @@ protected:
     size_t m_limit = size_t(-1);
 
     mutable TableVersions m_last_seen_versions;
+    // Version of the transaction at the last sync, or 0 if not known. Used to
+    // verify that an ObjectChangeCollector covers all changes since then.
+    uint_fast64_t m_last_seen_db_version = 0;
+
+    // Holds the keys instead of the key column when m_key_bitmap points to it
+    KeyBitmap m_table_view_key_bitmap;
 
 private:
     KeyColumn m_table_view_key_values; // We should generally not use this name
     ObjKey find_first_integer(ColKey column_key, int64_t value) const;
+    void check_combinable(const ConstTableView& other) const;
+    ConstTableView combine(Query query, KeyBitmap keys) const;
     template <class oper>
     Timestamp minmax_timestamp(ColKey column_key, ObjKey* return_key) const;
     RaceDetector m_race_detector;
@@ -543,9 +585,13 @@ inline ConstTableView::ConstTableView(const ConstTableView& tv)
     , m_end(tv.m_end)
     , m_limit(tv.m_limit)
     , m_last_seen_versions(tv.m_last_seen_versions)
+    , m_last_seen_db_version(tv.m_last_seen_db_version)
+    , m_table_view_key_bitmap(tv.m_table_view_key_bitmap)
     , m_table_view_key_values(tv.m_table_view_key_values)
 {
     m_limit_count = tv.m_limit_count;
+    if (tv.m_key_bitmap)
+        m_key_bitmap = &m_table_view_key_bitmap;
 }
 
 inline ConstTableView::ConstTableView(ConstTableView&& tv) noexcept
@@ -563,9 +609,13 @@ inline ConstTableView::ConstTableView(ConstTableView&& tv) noexcept
     // if we are created from a table view which is outdated, take care to use the outdated
     // version number so that we can later trigger a sync if needed.
     , m_last_seen_versions(std::move(tv.m_last_seen_versions))
+    , m_last_seen_db_version(tv.m_last_seen_db_version)
+    , m_table_view_key_bitmap(std::move(tv.m_table_view_key_bitmap))
     , m_table_view_key_values(std::move(tv.m_table_view_key_values))
 {
     m_limit_count = tv.m_limit_count;
+    if (tv.m_key_bitmap)
+        m_key_bitmap = &m_table_view_key_bitmap;
 }
 
 inline ConstTableView& ConstTableView::operator=(ConstTableView&& tv) noexcept
@@ -573,8 +623,11 @@ inline ConstTableView& ConstTableView::operator=(ConstTableView&& tv) noexcept
     m_table = std::move(tv.m_table);
 
     m_table_view_key_values = std::move(tv.m_table_view_key_values);
+    m_table_view_key_bitmap = std::move(tv.m_table_view_key_bitmap);
+    m_key_bitmap = tv.m_key_bitmap ? &m_table_view_key_bitmap : nullptr;
     m_query = std::move(tv.m_query);
     m_last_seen_versions = tv.m_last_seen_versions;
+    m_last_seen_db_version = tv.m_last_seen_db_version;
     m_start = tv.m_start;
     m_end = tv.m_end;
     m_limit = tv.m_limit;
@@ -595,9 +648,12 @@ inline ConstTableView& ConstTableView::operator=(const ConstTableView& tv)
         return *this;
 
     m_table_view_key_values = tv.m_table_view_key_values;
+    m_table_view_key_bitmap = tv.m_table_view_key_bitmap;
+    m_key_bitmap = tv.m_key_bitmap ? &m_table_view_key_bitmap : nullptr;
 
     m_query = tv.m_query;
     m_last_seen_versions = tv.m_last_seen_versions;
+    m_last_seen_db_version = tv.m_last_seen_db_version;
     m_start = tv.m_start;
     m_end = tv.m_end;
     m_limit = tv.m_limit;
@@ -618,7 +674,7 @@ inline ConstTableView& ConstTableView::operator=(const ConstTableView& tv)
 
 #define REALM_ASSERT_ROW(row_ndx)                                                                                    \
     m_table.check();                                                                                                 \
-    REALM_ASSERT(row_ndx < m_key_values->size())
+    REALM_ASSERT(row_ndx < size())
 
 #define REALM_ASSERT_COLUMN_AND_TYPE(column_key, column_type)                                                        \
     REALM_ASSERT_COLUMN(column_key);                                                                                 \
@@ -629,11 +685,11 @@ inline ConstTableView& ConstTableView::operator=(const ConstTableView& tv)
 
 #define REALM_ASSERT_INDEX(column_key, row_ndx)                                                                      \
     REALM_ASSERT_COLUMN(column_key);                                                                                 \
-    REALM_ASSERT(row_ndx < m_key_values->size())
+    REALM_ASSERT(row_ndx < size())
 
 #define REALM_ASSERT_INDEX_AND_TYPE(column_key, row_ndx, column_type)                                                \
     REALM_ASSERT_COLUMN_AND_TYPE(column_key, column_type);                                                           \
-    REALM_ASSERT(row_ndx < m_key_values->size())
+    REALM_ASSERT(row_ndx < size())
 
 #define REALM_ASSERT_INDEX_AND_TYPE_TABLE_OR_MIXED(column_key, row_ndx)                                              \
     REALM_ASSERT_COLUMN(column_key);                                                                                 \
@@ -642,7 +698,7 @@ inline ConstTableView& ConstTableView::operator=(const ConstTableView& tv)
     REALM_ASSERT(m_table->get_column_type(column_key) == type_Table ||                                               \
                  (m_table->get_column_type(column_key) == type_Mixed));                                              \
     REALM_DIAG_POP();                                                                                                \
-    REALM_ASSERT(row_ndx < m_key_values->size())
+    REALM_ASSERT(row_ndx < size())
 
 template <class T>
 ConstTableView ObjList::find_all(ColKey column_key, T value)
@@ -691,7 +747,7 @@ inline TableView::TableView(ConstTableView::DistinctViewTag, TableRef parent, Co
 inline Obj TableView::get(size_t row_ndx)
 {
     REALM_ASSERT_ROW(row_ndx);
-    ObjKey key(m_key_values->get(row_ndx));
+    ObjKey key = get_key(row_ndx);
     REALM_ASSERT(key != realm::null_key);
     return get_parent()->get_object(key);
 }
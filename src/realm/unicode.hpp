@@ -100,6 +100,14 @@ size_t sequence_length(char lead);
 // Return bool(string1 < string2)
 bool utf8_compare(StringData string1, StringData string2);
 
+// Append a sort key for the string to `key`, such that comparing the keys of
+// two strings byte by byte as unsigned chars, with a key that is a prefix of
+// the other first, gives the same order as utf8_compare(). Sorting on keys
+// made once per string is faster than calling utf8_compare() in every
+// comparison. Returns false, and appends nothing, if the current string compare
+// method is STRING_COMPARE_CPP11 or STRING_COMPARE_CALLBACK, which have no keys.
+bool utf8_sort_key(StringData string, std::string& key);
+
 // Return unicode value of character.
 uint32_t utf8value(const char* character);
 
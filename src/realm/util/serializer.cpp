@@ -29,6 +29,7 @@
 #include <realm/util/string_buffer.hpp>
 
 #include <cctype>
+#include <limits>
 
 namespace realm {
 namespace util {
@@ -52,6 +53,29 @@ std::string print_value<>(bool b)
     return "false";
 }
 
+// With enough digits to read back the same value, so that queries on values
+// which differ in the last digits are told apart
+template <typename T>
+std::string print_float(T value)
+{
+    std::stringstream ss;
+    ss.precision(std::numeric_limits<T>::max_digits10);
+    ss << value;
+    return ss.str();
+}
+
+template <>
+std::string print_value<>(float value)
+{
+    return print_float(value);
+}
+
+template <>
+std::string print_value<>(double value)
+{
+    return print_float(value);
+}
+
 template <>
 std::string print_value<>(realm::null)
 {
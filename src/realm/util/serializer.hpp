@@ -52,6 +52,8 @@ const static std::string value_separator = ".";
 // Specializations declared here to be defined in the cpp file
 template <> std::string print_value<>(BinaryData);
 template <> std::string print_value<>(bool);
+template <> std::string print_value<>(float);
+template <> std::string print_value<>(double);
 template <> std::string print_value<>(realm::null);
 template <> std::string print_value<>(StringData);
 template <> std::string print_value<>(realm::Timestamp);
@@ -319,6 +319,21 @@ struct BenchmarkDistinctStringManyDupes : BenchmarkWithStringsManyDup {
     }
 };
 
+// A distinct on a view goes through DistinctDescriptor instead of the search index
+struct BenchmarkDistinctViewStringFewDupes : BenchmarkDistinctStringFewDupes {
+    const char* name() const
+    {
+        return "DistinctViewStringFewDupes";
+    }
+
+    void operator()(DBRef)
+    {
+        ConstTableRef table = m_table;
+        ConstTableView view = table->where().find_all();
+        view.distinct(m_col);
+    }
+};
+
 struct BenchmarkFindAllStringFewDupes : BenchmarkWithStringsFewDup {
     const char* name() const
     {
@@ -1045,6 +1060,38 @@ struct BenchmarkQueryChainedOrIntsIndexed : BenchmarkQueryChainedOrInts {
     }
 };
 
+struct BenchmarkQueryInInts : BenchmarkQueryChainedOrInts {
+    const char* name() const
+    {
+        return "QueryInInts";
+    }
+
+    void operator()(DBRef)
+    {
+        ConstTableRef table = m_table;
+        std::vector<Mixed> values(values_to_query.begin(), values_to_query.end());
+        TableView results = table->where().in(m_col, values).find_all();
+        REALM_ASSERT_EX(results.size() == num_queried_matches, results.size(), num_queried_matches,
+                        values_to_query.size());
+        static_cast<void>(results);
+    }
+};
+
+struct BenchmarkQueryInIntsIndexed : BenchmarkQueryInInts {
+    const char* name() const
+    {
+        return "QueryInIntsIndexed";
+    }
+    void before_all(DBRef group)
+    {
+        BenchmarkQueryInInts::before_all(group);
+        WrtTrans tr(group);
+        TableRef t = tr.get_table(name());
+        t->add_search_index(m_col);
+        tr.commit();
+    }
+};
+
 
 struct BenchmarkQueryIntEquality : BenchmarkQueryChainedOrInts {
     const char* name() const
@@ -1145,6 +1192,23 @@ struct BenchmarkQueryChainedOrStrings : BenchmarkWithStringsTable {
     }
 };
 
+struct BenchmarkQueryInStrings : BenchmarkQueryChainedOrStrings {
+    const char* name() const
+    {
+        return "QueryInStrings";
+    }
+
+    void operator()(DBRef)
+    {
+        ConstTableRef table = m_table;
+        std::vector<Mixed> values(values_to_query.begin(), values_to_query.end());
+        TableView results = table->where().in(m_col, values).find_all();
+        REALM_ASSERT_EX(results.size() == num_queried_matches, results.size(), num_queried_matches,
+                        values_to_query.size());
+        static_cast<void>(results);
+    }
+};
+
 struct BenchmarkSort : BenchmarkWithStrings {
     const char* name() const
     {
@@ -1187,6 +1251,36 @@ struct BenchmarkSortInt : BenchmarkWithInts {
     }
 };
 
+struct BenchmarkSortIntDouble : BenchmarkWithIntsTable {
+    const char* name() const
+    {
+        return "SortIntDouble";
+    }
+
+    void before_all(DBRef group)
+    {
+        BenchmarkWithIntsTable::before_all(group);
+        WrtTrans tr(group);
+        TableRef t = tr.get_table(name());
+        m_col_double = t->add_column(type_Double, "doubles");
+        Random r;
+        for (size_t i = 0; i < BASE_SIZE; ++i) {
+            // Many ties in the first column
+            t->create_object().set(m_col, r.draw_int<int64_t>(0, 100)).set(m_col_double, r.draw_float<double>());
+        }
+        tr.commit();
+    }
+
+    void operator()(DBRef)
+    {
+        ConstTableRef table = m_table;
+        ConstTableView view = table->where().find_all();
+        view.sort(SortDescriptor({{m_col}, {m_col_double}}, {true, false}));
+    }
+
+    ColKey m_col_double;
+};
+
 struct BenchmarkDistinctIntFewDupes : BenchmarkWithIntsTable {
     const char* name() const
     {
@@ -1222,6 +1316,20 @@ struct BenchmarkDistinctIntFewDupes : BenchmarkWithIntsTable {
     }
 };
 
+struct BenchmarkDistinctViewIntFewDupes : BenchmarkDistinctIntFewDupes {
+    const char* name() const
+    {
+        return "DistinctViewIntNoDupes";
+    }
+
+    void operator()(DBRef)
+    {
+        ConstTableRef table = m_table;
+        ConstTableView view = table->where().find_all();
+        view.distinct(m_col);
+    }
+};
+
 struct BenchmarkDistinctIntManyDupes : BenchmarkWithIntsTable {
     const char* name() const
     {
@@ -1956,9 +2064,12 @@ int benchmark_common_tasks_main()
 
     BENCH(BenchmarkSort);
     BENCH(BenchmarkSortInt);
+    BENCH(BenchmarkSortIntDouble);
     BENCH(BenchmarkDistinctIntFewDupes);
+    BENCH(BenchmarkDistinctViewIntFewDupes);
     BENCH(BenchmarkDistinctIntManyDupes);
     BENCH(BenchmarkDistinctStringFewDupes);
+    BENCH(BenchmarkDistinctViewStringFewDupes);
     BENCH(BenchmarkDistinctStringManyDupes);
 
     BENCH(BenchmarkUnorderedTableViewClear);
@@ -1989,6 +2100,9 @@ int benchmark_common_tasks_main()
     BENCH(BenchmarkQueryChainedOrStrings);
     BENCH(BenchmarkQueryChainedOrInts);
     BENCH(BenchmarkQueryChainedOrIntsIndexed);
+    BENCH(BenchmarkQueryInStrings);
+    BENCH(BenchmarkQueryInInts);
+    BENCH(BenchmarkQueryInIntsIndexed);
     BENCH(BenchmarkQueryIntEquality);
     BENCH(BenchmarkQueryIntEqualityIndexed);
     BENCH(BenchmarkIntVsDoubleColumns);
@@ -16,41 +16,86 @@
  *
  **************************************************************************/
 
+// Compares the search index and the hash index on a string column of long,
+// UUID-like values: the time to build each index, the time to look up values,
+// and the size of a file holding the table with each index.
+
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
+#include <string>
+#include <vector>
+
 #include <realm.hpp>
+#include <realm/util/file.hpp>
 
 using namespace realm;
 
-REALM_TABLE_7(IndexTable, s1, String, n1, Int, n2, Int, n3, Int, n4, Int, n5, Int, s2, String)
+namespace {
 
+using Clock = std::chrono::steady_clock;
 
-int main()
+double seconds_since(Clock::time_point start)
 {
-    Group* g = new Group();
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
 
-    BasicTableRef<IndexTable> t = g->add_table<IndexTable>("test");
+std::string make_value(long n)
+{
+    char buf[64];
+    sprintf(buf, "%08lx-4a1b-9c2d-%012ld@example.com", n % 100000, n);
+    return buf;
+}
+
+enum class Backend { none, search, hash };
+
+void run(const char* name, Backend backend, size_t num_rows, size_t num_lookups)
+{
+    Group g;
+    TableRef t = g.add_table("test");
+    ColKey col = t->add_column(type_String, "uuid");
     srandom(1);
-    printf("Adding rows\n");
-    for (size_t i = 0; i < 10000000; ++i) {
-        long n1 = random() % 1000;
-        long n2 = random() % 1000;
-        long n3 = random() % 1000;
-        long n4 = random() % 1000;
-        long n5 = random() % 1000;
-        char s1[512];
-        sprintf(s1, "%ldHello%ld", n1, n2);
-        char s2[512];
-        sprintf(s2, "%ldWorld%ld", n3, n4);
-        t->add(s1, n1, n2, n3, n4, n5, s2);
-        if (i % 50000 == 0) {
-            printf("(%ld) ", i);
-        }
+    for (size_t i = 0; i < num_rows; ++i)
+        t->create_object().set(col, make_value(random()));
+
+    auto start = Clock::now();
+    if (backend == Backend::search)
+        t->add_search_index(col);
+    if (backend == Backend::hash)
+        t->add_hash_index(col);
+    double build_time = seconds_since(start);
+
+    // Look up the values of the first objects
+    std::vector<std::string> needles;
+    srandom(1);
+    for (size_t i = 0; i < num_lookups; ++i)
+        needles.push_back(make_value(random()));
+    start = Clock::now();
+    size_t found = 0;
+    for (auto& needle : needles) {
+        if (t->find_first_string(col, needle))
+            ++found;
     }
-    printf("\nOptimizing\n");
-    t->optimize();
-    printf("Creating index\n");
-    t->column().s1.add_search_index();
-    printf("Writing to disk\n");
-    g->write("test.realm");
+    double lookup_time = seconds_since(start);
+
+    std::string path = std::string("mkindex_") + name + ".realm";
+    util::File::try_remove(path);
+    g.write(path);
+    size_t file_size = size_t(util::File(path).get_size());
+    util::File::remove(path);
+
+    printf("%-8s build: %8.3f s  lookup: %8.3f us  file: %10zu bytes  (found %zu)\n", name, build_time,
+           lookup_time * 1e6 / num_lookups, file_size, found);
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    size_t num_rows = argc > 1 ? size_t(atol(argv[1])) : 1000000;
+    size_t num_lookups = 10000;
+    printf("%zu rows, %zu lookups\n", num_rows, num_lookups);
+    run("none", Backend::none, num_rows, num_lookups / 100);
+    run("search", Backend::search, num_rows, num_lookups);
+    run("hash", Backend::hash, num_rows, num_lookups);
 }
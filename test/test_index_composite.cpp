@@ -0,0 +1,347 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_INDEX_COMPOSITE
+
+#include <realm.hpp>
+#include <realm/history.hpp>
+#include <realm/index_composite.hpp>
+
+#include "test.hpp"
+#include "test_index_helpers.hpp"
+
+using namespace realm;
+using namespace realm::test_util;
+
+// Test independence and thread-safety
+// -----------------------------------
+//
+// All tests must be thread safe and independent of each other. This
+// is required because it allows for both shuffling of the execution
+// order and for parallelized testing.
+//
+// In particular, avoid using std::rand() since it is not guaranteed
+// to be thread safe. Instead use the API offered in
+// `test/util/random.hpp`.
+//
+// All files created in tests must use the TEST_PATH macro (or one of
+// its friends) to obtain a suitable file system path. See
+// `test/util/test_path.hpp`.
+//
+//
+// Debugging and the ONLY() macro
+// ------------------------------
+//
+// A simple way of disabling all tests except one called `Foo`, is to
+// replace TEST(Foo) with ONLY(Foo) and then recompile and rerun the
+// test suite. Note that you can also use filtering by setting the
+// environment varible `UNITTEST_FILTER`. See `README.md` for more on
+// this.
+//
+// Another way to debug a particular test, is to copy that test into
+// `experiments/testcase.cpp` and then run `sh build.sh
+// check-testcase` (or one of its friends) from the command line.
+
+
+namespace {
+
+// Columns with a composite index on (tenant, status, when, flag), and plain
+// copies of them to check the query results against
+struct IndexedColumns {
+    ColKey tenant;
+    ColKey status;
+    ColKey when;
+    ColKey flag;
+    ColKey tenant_plain;
+    ColKey status_plain;
+    ColKey when_plain;
+    ColKey flag_plain;
+};
+
+} // anonymous namespace
+
+
+TEST(CompositeIndex_Table)
+{
+    Table table;
+    auto col_tenant = table.add_column(type_Int, "tenant");
+    auto col_status = table.add_column(type_String, "status", true);
+    auto col_when = table.add_column(type_Timestamp, "when", true);
+    auto col_flag = table.add_column(type_Bool, "flag");
+    auto col_double = table.add_column(type_Double, "double");
+    auto col_list = table.add_column_list(type_Int, "list");
+
+    CHECK_THROW(table.add_composite_index({}), LogicError);
+    CHECK_THROW(table.add_composite_index({col_tenant, col_double}), LogicError);
+    CHECK_THROW(table.add_composite_index({col_tenant, col_list}), LogicError);
+    CHECK_THROW(table.add_composite_index({col_tenant, col_status, col_tenant}), LogicError);
+
+    auto create = [&](int64_t tenant, StringData status, Timestamp when, bool flag) {
+        Obj obj = table.create_object();
+        obj.set(col_tenant, tenant).set(col_status, status).set(col_when, when).set(col_flag, flag);
+    };
+    create(1, "open", Timestamp(10, 0), true);
+    create(1, "closed", Timestamp(10, 0), false);
+    create(2, "open", Timestamp(20, 5), true);
+    create(1, "open", Timestamp(30, 0), false);
+    create(-1, StringData(), Timestamp(), false);
+    create(1, "", Timestamp(10, 0), true);
+
+    std::vector<ColKey> columns = {col_tenant, col_status, col_when};
+    CHECK_NOT(table.has_composite_index(columns));
+    table.add_composite_index(columns);
+    table.add_composite_index(columns);
+    CHECK(table.has_composite_index(columns));
+    CHECK_NOT(table.has_composite_index({col_status, col_tenant}));
+    CHECK_EQUAL(table.get_composite_indexes().size(), 1);
+    table.verify();
+
+    CompositeIndex* index = table.get_composite_index(columns);
+    CHECK_EQUAL(index->size(), 6);
+    CHECK_EQUAL(index->count({}), 6);
+    CHECK_EQUAL(index->count({1}), 4);
+    CHECK_EQUAL(index->count({-1}), 1);
+    CHECK_EQUAL(index->count({1, "open"}), 2);
+    CHECK_EQUAL(index->count({1, ""}), 1);
+    CHECK_EQUAL(index->count({-1, Mixed()}), 1);
+    CHECK_EQUAL(index->count({1, "open", Timestamp(10, 0)}), 1);
+    CHECK_EQUAL(index->count({1, "ope"}), 0);
+
+    std::vector<ObjKey> keys;
+    index->find_all({1}, keys);
+    CHECK_EQUAL(keys.size(), 4);
+    CHECK(std::is_sorted(keys.begin(), keys.end()));
+
+    CHECK_EQUAL(table.where().equal(col_tenant, 1).equal(col_status, "open").count(), 2);
+    CHECK_EQUAL(table.where().equal(col_status, "open").equal(col_tenant, 1).count(), 2);
+    Query q = table.where().equal(col_tenant, 1).equal(col_status, "open");
+    CHECK_EQUAL(q.equal(col_when, Timestamp(30, 0)).count(), 1);
+    CHECK_EQUAL(table.where().equal(col_tenant, 1).equal(col_flag, true).count(), 2);
+    CHECK_EQUAL(table.where().equal(col_tenant, 1).equal(col_status, "open").sum_int(col_tenant), 2);
+
+    // The index is kept up to date
+    table.begin()->set(col_status, "closed");
+    CHECK_EQUAL(index->count({1, "closed"}), 2);
+    CHECK_EQUAL(table.where().equal(col_tenant, 1).equal(col_status, "closed").count(), 2);
+    table.begin()->set_null(col_status);
+    CHECK_EQUAL(index->count({1, Mixed()}), 1);
+    table.begin()->add_int(col_tenant, 2);
+    CHECK_EQUAL(index->count({3}), 1);
+    CHECK_EQUAL(table.where().equal(col_tenant, 3).equal(col_status, null()).count(), 1);
+    table.remove_object(table.begin() + 1);
+    CHECK_EQUAL(index->count({1}), 2);
+    table.verify();
+
+    // Changing the nullability keeps the index
+    col_tenant = table.set_nullability(col_tenant, true, false);
+    columns[0] = col_tenant;
+    CHECK(table.has_composite_index(columns));
+    index = table.get_composite_index(columns);
+    CHECK_EQUAL(index->count({1}), 2);
+    table.begin()->set_null(col_tenant);
+    CHECK_EQUAL(table.where().equal(col_tenant, null()).equal(col_status, null()).count(), 1);
+    table.verify();
+
+    // A second index, and columns added later
+    table.add_composite_index({col_flag, col_tenant});
+    auto col_other = table.add_column(type_Int, "other");
+    table.add_composite_index({col_other, col_status});
+    table.begin()->set(col_other, 7);
+    CHECK_EQUAL(table.where().equal(col_other, 7).count(), 1);
+    CHECK_EQUAL(table.get_composite_indexes().size(), 3);
+    table.verify();
+
+    table.clear();
+    CHECK_EQUAL(index->size(), 0);
+    create(1, "open", Timestamp(10, 0), true);
+    CHECK_EQUAL(index->count({1, "open"}), 1);
+
+    // Removing a column removes the indexes containing it
+    table.remove_column(col_when);
+    CHECK_NOT(table.has_composite_index(columns));
+    CHECK(table.has_composite_index({col_flag, col_tenant}));
+    CHECK_EQUAL(table.get_composite_indexes().size(), 2);
+    table.remove_composite_index({col_flag, col_tenant});
+    CHECK_EQUAL(table.get_composite_indexes().size(), 1);
+    CHECK_EQUAL(table.where().equal(col_other, 0).equal(col_status, "open").count(), 1);
+    table.verify();
+}
+
+TEST(CompositeIndex_Strings)
+{
+    // Embedded zeros and prefixes of other values must not be mixed up
+    Table table;
+    auto col_a = table.add_column(type_String, "a");
+    auto col_b = table.add_column(type_String, "b");
+    table.add_composite_index({col_a, col_b});
+    std::string zero("a\0b", 3);
+    std::string zero_end("a\0", 2);
+    table.create_object().set(col_a, "a").set(col_b, "b");
+    table.create_object().set(col_a, "ab").set(col_b, "");
+    table.create_object().set(col_a, zero).set(col_b, "");
+    table.create_object().set(col_a, zero_end).set(col_b, "b");
+    table.create_object().set(col_a, "").set(col_b, "ab");
+    table.verify();
+
+    CHECK_EQUAL(table.where().equal(col_a, "a").count(), 1);
+    CHECK_EQUAL(table.where().equal(col_a, "a").equal(col_b, "b").count(), 1);
+    CHECK_EQUAL(table.where().equal(col_a, "ab").equal(col_b, "").count(), 1);
+    CHECK_EQUAL(table.where().equal(col_a, zero).equal(col_b, "").count(), 1);
+    CHECK_EQUAL(table.where().equal(col_a, zero_end).equal(col_b, "b").count(), 1);
+    CHECK_EQUAL(table.where().equal(col_a, zero_end).equal(col_b, "").count(), 0);
+    CHECK_EQUAL(table.where().equal(col_a, "").equal(col_b, "ab").count(), 1);
+    CHECK_EQUAL(table.where().equal(col_a, "").equal(col_b, "").count(), 0);
+}
+
+TEST(CompositeIndex_QueryRandom)
+{
+    Random random(random_int<unsigned long>());
+    Table table;
+    IndexedColumns c;
+    c.tenant = table.add_column(type_Int, "tenant", true);
+    c.status = table.add_column(type_String, "status", true);
+    c.when = table.add_column(type_Timestamp, "when", true);
+    c.flag = table.add_column(type_Bool, "flag");
+    c.tenant_plain = table.add_column(type_Int, "tenant_plain", true);
+    c.status_plain = table.add_column(type_String, "status_plain", true);
+    c.when_plain = table.add_column(type_Timestamp, "when_plain", true);
+    c.flag_plain = table.add_column(type_Bool, "flag_plain");
+    table.add_composite_index({c.tenant, c.status, c.when, c.flag});
+    table.add_composite_index({c.status, c.flag});
+
+    static const char* const statuses[] = {"open", "closed", "", "open\0"};
+    auto random_tenant = [&] {
+        return random.chance(1, 10) ? util::Optional<int64_t>() : random.draw_int<int64_t>(-2, 5);
+    };
+    auto random_status = [&] {
+        size_t i = random.draw_int<size_t>(0, 4);
+        return i == 4 ? StringData() : StringData(statuses[i], i == 3 ? 5 : strlen(statuses[i]));
+    };
+    auto random_when = [&] {
+        return random.chance(1, 10) ? Timestamp() : Timestamp(random.draw_int<int64_t>(-1, 1), 0);
+    };
+
+    auto set = [&](Obj obj) {
+        auto tenant = random_tenant();
+        auto status = random_status();
+        auto when = random_when();
+        bool flag = random.chance(1, 2);
+        if (tenant) {
+            obj.set(c.tenant, *tenant);
+            obj.set(c.tenant_plain, *tenant);
+        }
+        else {
+            obj.set_null(c.tenant);
+            obj.set_null(c.tenant_plain);
+        }
+        obj.set(c.status, status);
+        obj.set(c.status_plain, status);
+        obj.set(c.when, when);
+        obj.set(c.when_plain, when);
+        obj.set(c.flag, flag);
+        obj.set(c.flag_plain, flag);
+    };
+
+    auto check = [&](Query q1, Query q2) {
+        check_same_results(test_context, q1, q2);
+    };
+
+    for (int i = 0; i < 500; ++i)
+        set(table.create_object());
+
+    for (int iter = 0; iter < 5; ++iter) {
+        change_randomly(random, table, 200, 100, set);
+        for (int i = 0; i < 20; ++i) {
+            auto tenant = random_tenant();
+            auto status = random_status();
+            auto when = random_when();
+            bool flag = random.chance(1, 2);
+            auto tenant_query = [&](ColKey col, Query q) {
+                return tenant ? q.equal(col, *tenant) : q.equal(col, null());
+            };
+            Query q1 = tenant_query(c.tenant, table.where());
+            Query q2 = tenant_query(c.tenant_plain, table.where());
+            check(q1, q2);
+            check(Query(q1).equal(c.status, status), Query(q2).equal(c.status_plain, status));
+            check(Query(q1).equal(c.status, status).equal(c.when, when),
+                  Query(q2).equal(c.status_plain, status).equal(c.when_plain, when));
+            // Mixed with other conditions
+            check(Query(q1).not_equal(c.status, status).equal(c.flag, flag),
+                  Query(q2).not_equal(c.status_plain, status).equal(c.flag_plain, flag));
+            // In another order than the index
+            q1 = table.where().equal(c.flag, flag).equal(c.when, when).equal(c.status, status);
+            q2 = table.where().equal(c.flag_plain, flag).equal(c.when_plain, when).equal(c.status_plain, status);
+            check(tenant_query(c.tenant, q1), tenant_query(c.tenant_plain, q2));
+            check(table.where().equal(c.status, status).greater(c.when, when),
+                  table.where().equal(c.status_plain, status).greater(c.when_plain, when));
+        }
+    }
+}
+
+TEST(CompositeIndex_Transactions)
+{
+    // Several composite indexes share the refs array, so adding and removing
+    // one must leave the others intact in the next version
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    DBRef db = DB::create(*hist);
+    ColKey col_tenant;
+    ColKey col_status;
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("table");
+        col_tenant = table->add_column(type_Int, "tenant");
+        col_status = table->add_column(type_String, "status");
+        table->create_object(ObjKey(0)).set(col_tenant, 1).set(col_status, "open");
+        table->create_object(ObjKey(1)).set(col_tenant, 2).set(col_status, "open");
+        table->add_composite_index({col_tenant, col_status});
+        wt->commit();
+    }
+
+    auto rt = db->start_read();
+    ConstTableRef table = rt->get_table("table");
+    {
+        auto wt = db->start_write();
+        auto t = wt->get_table("table");
+        t->add_composite_index({col_status});
+        t->create_object(ObjKey(2)).set(col_tenant, 1).set(col_status, "open");
+        wt->commit();
+    }
+    rt->advance_read();
+    CHECK_EQUAL(table->get_composite_indexes().size(), 2);
+    CHECK_EQUAL(table->get_composite_index({col_tenant, col_status})->count({1}), 2);
+    CHECK_EQUAL(table->get_composite_index({col_status})->count({"open"}), 3);
+    table->verify();
+
+    {
+        auto wt = db->start_write();
+        auto t = wt->get_table("table");
+        t->remove_composite_index({col_tenant, col_status});
+        t->remove_object(ObjKey(0));
+        wt->commit();
+    }
+    rt->advance_read();
+    CHECK_EQUAL(table->get_composite_indexes().size(), 1);
+    CHECK(table->has_composite_index({col_status}));
+    CHECK_EQUAL(table->where().equal(col_status, "open").count(), 2);
+    CHECK_EQUAL(table->where().equal(col_tenant, 1).equal(col_status, "open").count(), 1);
+    table->verify();
+}
+
+#endif // TEST_INDEX_COMPOSITE
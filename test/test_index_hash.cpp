@@ -0,0 +1,231 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_INDEX_HASH
+
+#include <realm.hpp>
+#include <realm/index_hash.hpp>
+
+#include "test.hpp"
+#include "test_index_helpers.hpp"
+
+using namespace realm;
+using namespace realm::test_util;
+
+// Test independence and thread-safety
+// -----------------------------------
+//
+// All tests must be thread safe and independent of each other. This
+// is required because it allows for both shuffling of the execution
+// order and for parallelized testing.
+//
+// In particular, avoid using std::rand() since it is not guaranteed
+// to be thread safe. Instead use the API offered in
+// `test/util/random.hpp`.
+//
+// All files created in tests must use the TEST_PATH macro (or one of
+// its friends) to obtain a suitable file system path. See
+// `test/util/test_path.hpp`.
+//
+//
+// Debugging and the ONLY() macro
+// ------------------------------
+//
+// A simple way of disabling all tests except one called `Foo`, is to
+// replace TEST(Foo) with ONLY(Foo) and then recompile and rerun the
+// test suite. Note that you can also use filtering by setting the
+// environment varible `UNITTEST_FILTER`. See `README.md` for more on
+// this.
+//
+// Another way to debug a particular test, is to copy that test into
+// `experiments/testcase.cpp` and then run `sh build.sh
+// check-testcase` (or one of its friends) from the command line.
+
+
+namespace {
+
+template <class T>
+void check_lookups(test_util::unit_test::TestContext& test_context, Table& table, ColKey indexed, ColKey plain,
+                   T value, T other)
+{
+    auto check = [&](Query q1, Query q2) {
+        check_same_results(test_context, q1, q2);
+    };
+    check(table.where().equal(indexed, value), table.where().equal(plain, value));
+    check(table.where().equal(indexed, value).Or().equal(indexed, other),
+          table.where().equal(plain, value).Or().equal(plain, other));
+    check(table.where().equal(indexed, value).not_equal(plain, other),
+          table.where().equal(plain, value).not_equal(plain, other));
+    CHECK_EQUAL(table.find_first(indexed, value), table.find_first(plain, value));
+}
+
+std::string random_string(Random& random)
+{
+    // Long values with a shared prefix, like the ones the hash index is meant for
+    return "user-" + std::string(40, 'x') + util::to_string(random.draw_int<int>(0, 500)) + "@example.com";
+}
+
+} // anonymous namespace
+
+
+TEST(HashIndex_Table)
+{
+    Table table;
+    auto col = table.add_column(type_Int, "int", true);
+    auto col_float = table.add_column(type_Float, "float");
+    auto col_list = table.add_column_list(type_Int, "list");
+
+    CHECK_THROW(table.add_hash_index(col_float), LogicError);
+    CHECK_THROW(table.add_hash_index(col_list), LogicError);
+
+    for (int64_t i = 0; i < 10; ++i)
+        table.create_object(ObjKey(i)).set(col, i % 3);
+    table.create_object(ObjKey(10));
+
+    table.add_hash_index(col);
+    table.verify();
+
+    // Nulls are indexed too, and the matches are ordered by key
+    HashIndex* index = table.get_hash_index(col);
+    CHECK_EQUAL(index->size(), 11);
+    CHECK_NOT(index->has_collisions());
+    CHECK_EQUAL(index->count(Mixed(int64_t(1))), 3);
+    CHECK_EQUAL(index->count(Mixed()), 1);
+    CHECK_EQUAL(index->count(Mixed(int64_t(7))), 0);
+    std::vector<ObjKey> keys;
+    index->find_all(Mixed(int64_t(2)), keys);
+    CHECK_EQUAL(keys.size(), 3);
+    CHECK_EQUAL(keys[0], ObjKey(2));
+    CHECK_EQUAL(keys[2], ObjKey(8));
+    CHECK_EQUAL(index->find_first(Mixed()), ObjKey(10));
+
+    CHECK_EQUAL(table.where().equal(col, 0).count(), 4);
+    CHECK_EQUAL(table.where().equal(col, null()).count(), 1);
+    CHECK_EQUAL(table.count_int(col, 1), 3);
+    CHECK_EQUAL(table.find_first_int(col, 2), ObjKey(2));
+
+    // The index is kept up to date
+    table.get_object(ObjKey(2)).set(col, 100);
+    table.get_object(ObjKey(10)).set(col, 100);
+    CHECK_EQUAL(table.where().equal(col, 100).count(), 2);
+    table.get_object(ObjKey(2)).add_int(col, -200);
+    CHECK_EQUAL(table.find_first_int(col, -100), ObjKey(2));
+    table.get_object(ObjKey(2)).set_null(col);
+    CHECK_EQUAL(table.where().equal(col, null()).count(), 1);
+    table.remove_object(ObjKey(10));
+    CHECK_EQUAL(table.where().equal(col, 100).count(), 0);
+    CHECK_EQUAL(index->size(), 10);
+    table.verify();
+
+    // Hash index and search index side by side
+    table.add_search_index(col);
+    CHECK_EQUAL(table.where().equal(col, 1).count(), 3);
+    table.remove_search_index(col);
+    CHECK_EQUAL(table.where().equal(col, 1).count(), 3);
+    table.verify();
+}
+
+TEST(HashIndex_String)
+{
+    Table table;
+    auto col = table.add_column(type_String, "email", true);
+    auto col_int = table.add_column(type_Int, "int");
+    table.add_hash_index(col);
+
+    std::string long_value(1000, 'a');
+    for (int64_t i = 0; i < 20; ++i) {
+        Obj obj = table.create_object();
+        obj.set(col_int, i);
+        if (i % 5 == 0)
+            obj.set(col, "");
+        else if (i % 5 == 1)
+            obj.set(col, long_value);
+        else if (i % 5 == 2)
+            obj.set(col, "user" + util::to_string(i) + "@example.com");
+    }
+    table.verify();
+
+    // The empty string and null are different values
+    CHECK_EQUAL(table.where().equal(col, "").count(), 4);
+    CHECK_EQUAL(table.where().equal(col, StringData()).count(), 8);
+    CHECK_EQUAL(table.where().equal(col, long_value).count(), 4);
+    CHECK_EQUAL(table.where().equal(col, "user2@example.com").count(), 1);
+    CHECK_EQUAL(table.where().equal(col, "user3@example.com").count(), 0);
+    CHECK_EQUAL(table.where().equal(col, "user2@example.com").Or().equal(col, "").count(), 5);
+    CHECK_EQUAL(table.where().equal(col, long_value).greater(col_int, 10).count(), 2);
+    CHECK_EQUAL(table.count_string(col, long_value), 4);
+    CHECK_EQUAL(table.find_first_string(col, "user7@example.com"), table.get_object(7).get_key());
+
+    table.get_object(7).set(col, long_value);
+    CHECK_EQUAL(table.where().equal(col, long_value).count(), 5);
+    table.get_object(7).set_null(col);
+    CHECK_EQUAL(table.where().equal(col, long_value).count(), 4);
+    CHECK_EQUAL(table.find_first_string(col, "user7@example.com"), ObjKey());
+    table.verify();
+}
+
+TEST_TYPES(HashIndex_QueryRandom, int64_t, StringData)
+{
+    Random random(random_int<unsigned long>());
+    DataType type = ColumnTypeTraits<TEST_TYPE>::id;
+    Table table;
+    auto indexed = table.add_column(type, "indexed", true);
+    auto plain = table.add_column(type, "plain", true);
+
+    auto set = [&](Obj obj) {
+        if (random.chance(1, 20)) {
+            obj.set_null(indexed);
+            obj.set_null(plain);
+        }
+        else if (type == type_Int) {
+            int64_t v = random.draw_int<int64_t>(-500, 500);
+            obj.set(indexed, v);
+            obj.set(plain, v);
+        }
+        else {
+            std::string s = random_string(random);
+            obj.set(indexed, StringData(s));
+            obj.set(plain, StringData(s));
+        }
+    };
+
+    // Half of the objects exist before the index is added
+    for (int i = 0; i < 1000; ++i)
+        set(table.create_object());
+    table.add_hash_index(indexed);
+    for (int i = 0; i < 1000; ++i)
+        set(table.create_object());
+
+    for (int iter = 0; iter < 4; ++iter) {
+        change_randomly(random, table, 300, 200, set);
+        for (int i = 0; i < 20; ++i) {
+            if (type == type_Int) {
+                check_lookups(test_context, table, indexed, plain, random.draw_int<int64_t>(-500, 500),
+                              random.draw_int<int64_t>(-500, 500));
+            }
+            else {
+                std::string s1 = random_string(random);
+                std::string s2 = random_string(random);
+                check_lookups(test_context, table, indexed, plain, StringData(s1), StringData(s2));
+            }
+        }
+    }
+}
+
+#endif // TEST_INDEX_HASH
@@ -0,0 +1,59 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef TEST_TEST_INDEX_HELPERS_HPP_
+#define TEST_TEST_INDEX_HELPERS_HPP_
+
+namespace realm {
+namespace test_util {
+
+// The query on the indexed column must find the same objects, in the same
+// order, as the query on the plain copy of it
+inline void check_same_results(unit_test::TestContext& test_context, Query q1, Query q2)
+{
+    auto tv1 = q1.find_all();
+    auto tv2 = q2.find_all();
+    CHECK_EQUAL(q1.count(), tv2.size());
+    if (CHECK_EQUAL(tv1.size(), tv2.size())) {
+        for (size_t i = 0; i < tv1.size(); ++i)
+            CHECK_EQUAL(tv1.get_key(i), tv2.get_key(i));
+    }
+    CHECK_EQUAL(q1.find(), q2.find());
+}
+
+// Removes one in `remove_one_in` of `num_changes` randomly picked objects and
+// passes the others to `set`, then passes `num_creates` new objects to it
+template <class F>
+void change_randomly(Random& random, Table& table, int num_changes, int num_creates, F set, int remove_one_in = 4)
+{
+    for (int i = 0; i < num_changes; ++i) {
+        size_t ndx = random.draw_int<size_t>(0, table.size() - 1);
+        if (random.chance(1, remove_one_in))
+            table.remove_object(table.begin() + ndx);
+        else
+            set(*(table.begin() + ndx));
+    }
+    for (int i = 0; i < num_creates; ++i)
+        set(table.create_object());
+    table.verify();
+}
+
+} // namespace test_util
+} // namespace realm
+
+#endif // TEST_TEST_INDEX_HELPERS_HPP_
@@ -0,0 +1,295 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_INDEX_LIST
+
+#include <realm.hpp>
+#include <realm/index_list.hpp>
+
+#include "test.hpp"
+#include "test_index_helpers.hpp"
+
+using namespace realm;
+using namespace realm::test_util;
+
+// Test independence and thread-safety
+// -----------------------------------
+//
+// All tests must be thread safe and independent of each other. This
+// is required because it allows for both shuffling of the execution
+// order and for parallelized testing.
+//
+// In particular, avoid using std::rand() since it is not guaranteed
+// to be thread safe. Instead use the API offered in
+// `test/util/random.hpp`.
+//
+// All files created in tests must use the TEST_PATH macro (or one of
+// its friends) to obtain a suitable file system path. See
+// `test/util/test_path.hpp`.
+//
+//
+// Debugging and the ONLY() macro
+// ------------------------------
+//
+// A simple way of disabling all tests except one called `Foo`, is to
+// replace TEST(Foo) with ONLY(Foo) and then recompile and rerun the
+// test suite. Note that you can also use filtering by setting the
+// environment varible `UNITTEST_FILTER`. See `README.md` for more on
+// this.
+//
+// Another way to debug a particular test, is to copy that test into
+// `experiments/testcase.cpp` and then run `sh build.sh
+// check-testcase` (or one of its friends) from the command line.
+
+
+namespace {
+
+std::vector<ObjKey> keys_of(const TableView& tv)
+{
+    std::vector<ObjKey> keys;
+    for (size_t i = 0; i < tv.size(); ++i)
+        keys.push_back(tv.get_key(i));
+    return keys;
+}
+
+} // unnamed namespace
+
+
+TEST(ListIndex_Table)
+{
+    Table table;
+    auto col_tags = table.add_column_list(type_String, "tags");
+    auto col_id = table.add_column(type_Int, "id");
+    CHECK_NOT(table.has_search_index(col_tags));
+
+    auto obj0 = table.create_object(ObjKey(0)).set(col_id, 0);
+    auto obj1 = table.create_object(ObjKey(1)).set(col_id, 1);
+    auto obj2 = table.create_object(ObjKey(2)).set(col_id, 2);
+    obj0.get_list<String>(col_tags).add("red");
+    obj0.get_list<String>(col_tags).add("blue");
+    obj1.get_list<String>(col_tags).add("red");
+    obj1.get_list<String>(col_tags).add("red");
+
+    table.add_search_index(col_tags);
+    CHECK(table.has_search_index(col_tags));
+    CHECK_NOT(table.get_search_index(col_tags));
+    ListIndex* index = table.get_list_index(col_tags);
+    CHECK(index);
+    CHECK_EQUAL(index->size(), 4);
+    CHECK_EQUAL(index->count("red"), 3);
+    table.verify();
+
+    auto find = [&](StringData value) {
+        return keys_of((table.column<Lst<String>>(col_tags) == value).find_all());
+    };
+    CHECK(find("red") == std::vector<ObjKey>({ObjKey(0), ObjKey(1)}));
+    CHECK(find("blue") == std::vector<ObjKey>({ObjKey(0)}));
+    CHECK(find("green").empty());
+    CHECK_EQUAL((table.column<Lst<String>>(col_tags) == "red").count(), 2);
+    // Combined with other conditions
+    CHECK_EQUAL((table.column<Lst<String>>(col_tags) == "red" && table.column<Int>(col_id) > 0).count(), 1);
+
+    // Insert, set and remove single elements
+    auto list2 = obj2.get_list<String>(col_tags);
+    list2.add("green");
+    list2.insert(0, "red");
+    CHECK(find("red") == std::vector<ObjKey>({ObjKey(0), ObjKey(1), ObjKey(2)}));
+    list2.set(0, "blue");
+    CHECK(find("red") == std::vector<ObjKey>({ObjKey(0), ObjKey(1)}));
+    CHECK(find("blue") == std::vector<ObjKey>({ObjKey(0), ObjKey(2)}));
+    auto list1 = obj1.get_list<String>(col_tags);
+    list1.remove(0);
+    CHECK(find("red") == std::vector<ObjKey>({ObjKey(0), ObjKey(1)}));
+    list1.remove(0);
+    CHECK(find("red") == std::vector<ObjKey>({ObjKey(0)}));
+    // Moving and swapping elements leaves the index alone
+    list2.move(0, 1);
+    list2.swap(0, 1);
+    table.verify();
+
+    // Clearing a list and removing an object
+    obj0.get_list<String>(col_tags).clear();
+    CHECK(find("red").empty());
+    table.remove_object(ObjKey(2));
+    CHECK(find("blue").empty());
+    CHECK_EQUAL(index->size(), 0);
+    table.verify();
+}
+
+TEST(ListIndex_Types)
+{
+    Table table;
+    auto col_int = table.add_column_list(type_Int, "ints", true);
+    auto col_bool = table.add_column_list(type_Bool, "bools");
+    auto col_date = table.add_column_list(type_Timestamp, "dates");
+    auto col_double = table.add_column_list(type_Double, "doubles");
+    table.add_search_index(col_int);
+    table.add_search_index(col_bool);
+    table.add_search_index(col_date);
+    CHECK_THROW(table.add_search_index(col_double), LogicError);
+    CHECK_NOT(table.has_search_index(col_double));
+
+    auto obj0 = table.create_object();
+    auto obj1 = table.create_object();
+    auto ints0 = obj0.get_list<util::Optional<int64_t>>(col_int);
+    ints0.add(5);
+    ints0.add(util::none);
+    obj1.get_list<util::Optional<int64_t>>(col_int).add(-5);
+    obj0.get_list<bool>(col_bool).add(true);
+    obj1.get_list<bool>(col_bool).add(false);
+    obj1.get_list<Timestamp>(col_date).add(Timestamp(10, 20));
+    table.verify();
+
+    CHECK_EQUAL((table.column<Lst<Int>>(col_int) == 5).count(), 1);
+    CHECK_EQUAL((table.column<Lst<Int>>(col_int) == -5).count(), 1);
+    CHECK_EQUAL((table.column<Lst<Int>>(col_int) == 5.0).count(), 1);
+    CHECK_EQUAL((table.column<Lst<Int>>(col_int) == 5.5).count(), 0);
+    CHECK_EQUAL((table.column<Lst<Int>>(col_int) == null()).count(), 1);
+    CHECK_EQUAL((table.column<Lst<Bool>>(col_bool) == false).count(), 1);
+    CHECK_EQUAL((table.column<Lst<Timestamp>>(col_date) == Timestamp(10, 20)).count(), 1);
+    CHECK_EQUAL((table.column<Lst<Timestamp>>(col_date) == Timestamp(10, 21)).count(), 0);
+
+    ints0.set(1, 7);
+    CHECK_EQUAL((table.column<Lst<Int>>(col_int) == null()).count(), 0);
+    CHECK_EQUAL((table.column<Lst<Int>>(col_int) == 7).count(), 1);
+    ints0.resize(1);
+    CHECK_EQUAL((table.column<Lst<Int>>(col_int) == 7).count(), 0);
+    table.verify();
+
+    // Changing the nullability keeps the index
+    col_int = table.set_nullability(col_int, false, true);
+    CHECK(table.has_search_index(col_int));
+    CHECK_EQUAL((table.column<Lst<Int>>(col_int) == 5).count(), 1);
+    table.verify();
+}
+
+TEST(ListIndex_QueryRandom)
+{
+    Random random(random_int<unsigned long>());
+    Group g;
+    auto table = g.add_table("table");
+    auto origin = g.add_table("origin");
+    auto col_ints = table->add_column_list(type_Int, "ints", true);
+    auto col_ints_plain = table->add_column_list(type_Int, "ints_plain", true);
+    auto col_strings = table->add_column_list(type_String, "strings");
+    auto col_strings_plain = table->add_column_list(type_String, "strings_plain");
+    auto col_link = origin->add_column_link(type_Link, "link", *table);
+    table->add_search_index(col_ints);
+    table->add_search_index(col_strings);
+
+    static const char* const strings[] = {"a", "b", "", "a\0"};
+    auto random_value = [&] {
+        return random.chance(1, 10) ? util::Optional<int64_t>() : random.draw_int<int64_t>(-3, 3);
+    };
+    auto random_string = [&] {
+        size_t i = random.draw_int<size_t>(0, 3);
+        return StringData(strings[i], i == 3 ? 2 : strlen(strings[i]));
+    };
+
+    auto modify = [&](Obj obj) {
+        auto ints = obj.get_list<util::Optional<int64_t>>(col_ints);
+        auto ints_plain = obj.get_list<util::Optional<int64_t>>(col_ints_plain);
+        auto strs = obj.get_list<String>(col_strings);
+        auto strs_plain = obj.get_list<String>(col_strings_plain);
+        switch (random.draw_int<int>(0, 5)) {
+            case 0:
+            case 1: {
+                auto value = random_value();
+                size_t ndx = random.draw_int<size_t>(0, ints.size());
+                ints.insert(ndx, value);
+                ints_plain.insert(ndx, value);
+                auto str = random_string();
+                strs.add(str);
+                strs_plain.add(str);
+                break;
+            }
+            case 2:
+                if (ints.size() > 0) {
+                    auto value = random_value();
+                    size_t ndx = random.draw_int<size_t>(0, ints.size() - 1);
+                    ints.set(ndx, value);
+                    ints_plain.set(ndx, value);
+                }
+                if (strs.size() > 0) {
+                    auto str = random_string();
+                    strs.set(0, str);
+                    strs_plain.set(0, str);
+                }
+                break;
+            case 3:
+                if (ints.size() > 0) {
+                    size_t ndx = random.draw_int<size_t>(0, ints.size() - 1);
+                    ints.remove(ndx);
+                    ints_plain.remove(ndx);
+                }
+                if (strs.size() > 0) {
+                    strs.remove(strs.size() - 1);
+                    strs_plain.remove(strs_plain.size() - 1);
+                }
+                break;
+            case 4:
+                ints.clear();
+                ints_plain.clear();
+                break;
+            case 5:
+                if (ints.size() > 1) {
+                    ints.move(0, ints.size() - 1);
+                    ints_plain.move(0, ints_plain.size() - 1);
+                }
+                break;
+        }
+    };
+
+    for (int i = 0; i < 300; ++i) {
+        auto obj = table->create_object();
+        for (int j = random.draw_int<int>(0, 4); j > 0; --j)
+            modify(obj);
+    }
+
+    for (int iter = 0; iter < 5; ++iter) {
+        change_randomly(random, *table, 300, 30, modify, 20);
+        while (origin->size() < 100)
+            origin->create_object();
+        for (auto o : *origin) {
+            if (random.chance(1, 3))
+                o.set(col_link, (table->begin() + random.draw_int<size_t>(0, table->size() - 1))->get_key());
+        }
+        table->verify();
+
+        for (int i = 0; i < 10; ++i) {
+            auto value = random_value();
+            auto str = random_string();
+            auto int_query = [&](ColKey col) {
+                return value ? table->column<Lst<Int>>(col) == *value : table->column<Lst<Int>>(col) == null();
+            };
+            check_same_results(test_context, int_query(col_ints), int_query(col_ints_plain));
+            check_same_results(test_context, table->column<Lst<String>>(col_strings) == str,
+                               table->column<Lst<String>>(col_strings_plain) == str);
+            check_same_results(test_context, (table->column<Lst<String>>(col_strings) == str) || int_query(col_ints),
+                               (table->column<Lst<String>>(col_strings_plain) == str) || int_query(col_ints_plain));
+            // Through a link
+            if (value) {
+                check_same_results(test_context, origin->link(col_link).column<Lst<Int>>(col_ints) == *value,
+                                   origin->link(col_link).column<Lst<Int>>(col_ints_plain) == *value);
+            }
+        }
+    }
+}
+
+#endif // TEST_INDEX_LIST
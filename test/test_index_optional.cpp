@@ -0,0 +1,350 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_INDEX_OPTIONAL
+
+#include <realm.hpp>
+#include <realm/history.hpp>
+
+#include "test.hpp"
+
+using namespace realm;
+using namespace realm::test_util;
+
+// Test independence and thread-safety
+// -----------------------------------
+//
+// All tests must be thread safe and independent of each other. This
+// is required because it allows for both shuffling of the execution
+// order and for parallelized testing.
+//
+// In particular, avoid using std::rand() since it is not guaranteed
+// to be thread safe. Instead use the API offered in
+// `test/util/random.hpp`.
+//
+// All files created in tests must use the TEST_PATH macro (or one of
+// its friends) to obtain a suitable file system path. See
+// `test/util/test_path.hpp`.
+//
+//
+// Debugging and the ONLY() macro
+// ------------------------------
+//
+// A simple way of disabling all tests except one called `Foo`, is to
+// replace TEST(Foo) with ONLY(Foo) and then recompile and rerun the
+// test suite. Note that you can also use filtering by setting the
+// environment varible `UNITTEST_FILTER`. See `README.md` for more on
+// this.
+//
+// Another way to debug a particular test, is to copy that test into
+// `experiments/testcase.cpp` and then run `sh build.sh
+// check-testcase` (or one of its friends) from the command line.
+
+
+// The tests in this file are run for each of the indexes which are kept
+// outside of the search index. The checks specific to one of them are in
+// test_index_<kind>.cpp.
+
+namespace {
+
+std::string value_string(int64_t value)
+{
+    return "value-" + util::to_string(value);
+}
+
+// Each kind has the index on one nullable column, stores an int value in it
+// and finds the objects holding a value through a query the index serves
+
+struct TrigramIndexed {
+    static ColKey add_column(Table& table, StringData name)
+    {
+        return table.add_column(type_String, name, true);
+    }
+    static void set(Obj obj, ColKey col, int64_t value)
+    {
+        std::string s = value_string(value);
+        obj.set(col, StringData(s));
+    }
+    static Query find(const Table& table, ColKey col, int64_t value)
+    {
+        // A substring rather than the whole value, as the index serves those
+        std::string needle = value_string(value).substr(1);
+        return table.where().contains(col, StringData(needle));
+    }
+    static void add_index(Table& table, ColKey col)
+    {
+        table.add_trigram_index(col);
+    }
+    static void remove_index(Table& table, ColKey col)
+    {
+        table.remove_trigram_index(col);
+    }
+    static bool has_index(const Table& table, ColKey col)
+    {
+        return table.has_trigram_index(col);
+    }
+};
+
+struct RangeIndexed {
+    static ColKey add_column(Table& table, StringData name)
+    {
+        return table.add_column(type_Timestamp, name, true);
+    }
+    static void set(Obj obj, ColKey col, int64_t value)
+    {
+        obj.set(col, Timestamp(value, 0));
+    }
+    static Query find(const Table& table, ColKey col, int64_t value)
+    {
+        return table.where().greater_equal(col, Timestamp(value, 0)).less(col, Timestamp(value, 1));
+    }
+    static void add_index(Table& table, ColKey col)
+    {
+        table.add_range_index(col);
+    }
+    static void remove_index(Table& table, ColKey col)
+    {
+        table.remove_range_index(col);
+    }
+    static bool has_index(const Table& table, ColKey col)
+    {
+        return table.has_range_index(col);
+    }
+};
+
+struct CompositeIndexed {
+    static ColKey add_column(Table& table, StringData name)
+    {
+        return table.add_column(type_Int, name, true);
+    }
+    static void set(Obj obj, ColKey col, int64_t value)
+    {
+        obj.set(col, value);
+    }
+    static Query find(const Table& table, ColKey col, int64_t value)
+    {
+        return table.where().equal(col, value);
+    }
+    static void add_index(Table& table, ColKey col)
+    {
+        table.add_composite_index({col});
+    }
+    static void remove_index(Table& table, ColKey col)
+    {
+        table.remove_composite_index({col});
+    }
+    static bool has_index(const Table& table, ColKey col)
+    {
+        return table.has_composite_index({col});
+    }
+};
+
+struct ListIndexed {
+    static ColKey add_column(Table& table, StringData name)
+    {
+        return table.add_column_list(type_String, name, true);
+    }
+    static void set(Obj obj, ColKey col, int64_t value)
+    {
+        auto list = obj.get_list<String>(col);
+        list.clear();
+        std::string s = value_string(value);
+        list.add(StringData(s));
+        list.add(StringData());
+    }
+    static Query find(const Table& table, ColKey col, int64_t value)
+    {
+        std::string s = value_string(value);
+        return table.column<Lst<String>>(col) == StringData(s);
+    }
+    static void add_index(Table& table, ColKey col)
+    {
+        table.add_search_index(col);
+    }
+    static void remove_index(Table& table, ColKey col)
+    {
+        table.remove_search_index(col);
+    }
+    static bool has_index(const Table& table, ColKey col)
+    {
+        return table.get_list_index(col) != nullptr;
+    }
+};
+
+struct HashIndexed {
+    static ColKey add_column(Table& table, StringData name)
+    {
+        return table.add_column(type_String, name, true);
+    }
+    static void set(Obj obj, ColKey col, int64_t value)
+    {
+        std::string s = value_string(value);
+        obj.set(col, StringData(s));
+    }
+    static Query find(const Table& table, ColKey col, int64_t value)
+    {
+        std::string s = value_string(value);
+        return table.where().equal(col, StringData(s));
+    }
+    static void add_index(Table& table, ColKey col)
+    {
+        table.add_hash_index(col);
+    }
+    static void remove_index(Table& table, ColKey col)
+    {
+        table.remove_hash_index(col);
+    }
+    static bool has_index(const Table& table, ColKey col)
+    {
+        return table.has_hash_index(col);
+    }
+};
+
+} // anonymous namespace
+
+
+TEST_TYPES(OptionalIndex_Table, TrigramIndexed, RangeIndexed, CompositeIndexed, ListIndexed, HashIndexed)
+{
+    using Kind = TEST_TYPE;
+    Table table;
+    auto col = Kind::add_column(table, "indexed");
+    auto col_int = table.add_column(type_Int, "int");
+    for (int64_t i = 0; i < 10; ++i)
+        Kind::set(table.create_object(ObjKey(i)).set(col_int, i), col, i % 3);
+    table.create_object(ObjKey(10));
+
+    CHECK_NOT(Kind::has_index(table, col));
+    Kind::add_index(table, col);
+    Kind::add_index(table, col);
+    CHECK(Kind::has_index(table, col));
+    CHECK_NOT(table.get_search_index(col));
+    table.verify();
+    CHECK_EQUAL(Kind::find(table, col, 1).count(), 3);
+    CHECK_EQUAL(Kind::find(table, col, 1).greater(col_int, 4).count(), 1);
+    CHECK_EQUAL(Kind::find(table, col, 1).find(), ObjKey(1));
+
+    // The index is kept up to date
+    Kind::set(table.get_object(ObjKey(10)), col, 1);
+    Kind::set(table.get_object(ObjKey(1)), col, 7);
+    CHECK_EQUAL(Kind::find(table, col, 1).count(), 3);
+    CHECK_EQUAL(Kind::find(table, col, 7).count(), 1);
+    Kind::set(table.get_object(ObjKey(1)), col, 8);
+    CHECK_EQUAL(Kind::find(table, col, 7).count(), 0);
+    table.remove_object(ObjKey(4));
+    CHECK_EQUAL(Kind::find(table, col, 1).count(), 2);
+    CHECK_EQUAL(Kind::find(table, col, 1).find(), ObjKey(7));
+    table.verify();
+
+    table.clear();
+    CHECK_EQUAL(Kind::find(table, col, 1).count(), 0);
+    Kind::set(table.create_object(), col, 1);
+    CHECK_EQUAL(Kind::find(table, col, 1).count(), 1);
+
+    // Changing the nullability keeps the index
+    col = table.set_nullability(col, false, false);
+    CHECK(Kind::has_index(table, col));
+    table.create_object();
+    CHECK_EQUAL(Kind::find(table, col, 1).count(), 1);
+    table.verify();
+
+    Kind::remove_index(table, col);
+    Kind::remove_index(table, col);
+    CHECK_NOT(Kind::has_index(table, col));
+    CHECK_EQUAL(Kind::find(table, col, 1).count(), 1);
+
+    // Columns added later get a slot in the existing refs array, and
+    // removing an indexed column leaves the other indexes alone
+    Kind::add_index(table, col);
+    auto col_2 = Kind::add_column(table, "other");
+    Kind::add_index(table, col_2);
+    Kind::set(*table.begin(), col_2, 2);
+    CHECK_EQUAL(Kind::find(table, col_2, 2).count(), 1);
+    table.remove_column(col);
+    CHECK(Kind::has_index(table, col_2));
+    CHECK_EQUAL(Kind::find(table, col_2, 2).count(), 1);
+    table.verify();
+}
+
+TEST_TYPES(OptionalIndex_Transactions, TrigramIndexed, RangeIndexed, CompositeIndexed, ListIndexed, HashIndexed)
+{
+    using Kind = TEST_TYPE;
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    DBRef db = DB::create(*hist);
+    ColKey col;
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("table");
+        col = Kind::add_column(*table, "indexed");
+        for (int64_t i = 0; i < 100; ++i)
+            Kind::set(table->create_object(ObjKey(i)), col, i % 50);
+        wt->commit();
+    }
+
+    auto rt = db->start_read();
+    ConstTableRef table = rt->get_table("table");
+    CHECK_NOT(Kind::has_index(*table, col));
+
+    {
+        auto wt = db->start_write();
+        auto t = wt->get_table("table");
+        Kind::add_index(*t, col);
+        Kind::set(t->create_object(ObjKey(100)), col, 7);
+        wt->commit();
+    }
+
+    rt->advance_read();
+    CHECK(Kind::has_index(*table, col));
+    CHECK_EQUAL(Kind::find(*table, col, 7).count(), 3);
+
+    {
+        // Changes which are rolled back must not be visible in the index
+        auto wt = db->start_write();
+        auto t = wt->get_table("table");
+        Kind::set(t->get_object(ObjKey(0)), col, 7);
+        CHECK_EQUAL(Kind::find(*t, col, 7).count(), 4);
+        wt->rollback_and_continue_as_read();
+        CHECK_EQUAL(Kind::find(*t, col, 7).count(), 3);
+        t->verify();
+    }
+
+    {
+        auto wt = db->start_write();
+        auto t = wt->get_table("table");
+        t->remove_object(ObjKey(100));
+        wt->commit();
+    }
+    rt->advance_read();
+    CHECK_EQUAL(Kind::find(*table, col, 7).count(), 2);
+    CHECK_EQUAL(Kind::find(*table, col, 0).find(), ObjKey(0));
+    table->verify();
+
+    {
+        auto wt = db->start_write();
+        auto t = wt->get_table("table");
+        Kind::remove_index(*t, col);
+        wt->commit();
+    }
+    rt->advance_read();
+    CHECK_NOT(Kind::has_index(*table, col));
+    CHECK_EQUAL(Kind::find(*table, col, 7).count(), 2);
+    table->verify();
+}
+
+#endif // TEST_INDEX_OPTIONAL
@@ -0,0 +1,311 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_INDEX_RANGE
+
+#include <realm.hpp>
+#include <realm/index_range.hpp>
+
+#include "test.hpp"
+#include "test_index_helpers.hpp"
+
+using namespace realm;
+using namespace realm::test_util;
+
+// Test independence and thread-safety
+// -----------------------------------
+//
+// All tests must be thread safe and independent of each other. This
+// is required because it allows for both shuffling of the execution
+// order and for parallelized testing.
+//
+// In particular, avoid using std::rand() since it is not guaranteed
+// to be thread safe. Instead use the API offered in
+// `test/util/random.hpp`.
+//
+// All files created in tests must use the TEST_PATH macro (or one of
+// its friends) to obtain a suitable file system path. See
+// `test/util/test_path.hpp`.
+//
+//
+// Debugging and the ONLY() macro
+// ------------------------------
+//
+// A simple way of disabling all tests except one called `Foo`, is to
+// replace TEST(Foo) with ONLY(Foo) and then recompile and rerun the
+// test suite. Note that you can also use filtering by setting the
+// environment varible `UNITTEST_FILTER`. See `README.md` for more on
+// this.
+//
+// Another way to debug a particular test, is to copy that test into
+// `experiments/testcase.cpp` and then run `sh build.sh
+// check-testcase` (or one of its friends) from the command line.
+
+
+namespace {
+
+template <class T>
+void check_comparisons(test_util::unit_test::TestContext& test_context, Table& table, ColKey indexed, ColKey plain,
+                       T value, T other)
+{
+    auto check = [&](Query q1, Query q2) {
+        check_same_results(test_context, q1, q2);
+    };
+    check(table.where().equal(indexed, value), table.where().equal(plain, value));
+    check(table.where().greater(indexed, value), table.where().greater(plain, value));
+    check(table.where().greater_equal(indexed, value), table.where().greater_equal(plain, value));
+    check(table.where().less(indexed, value), table.where().less(plain, value));
+    check(table.where().less_equal(indexed, value), table.where().less_equal(plain, value));
+    // A range, and a range combined with another condition
+    check(table.where().greater_equal(indexed, value).less_equal(indexed, other),
+          table.where().greater_equal(plain, value).less_equal(plain, other));
+    check(table.where().greater(indexed, value).not_equal(plain, other),
+          table.where().greater(plain, value).not_equal(plain, other));
+    check(table.where().less(indexed, value).Or().equal(indexed, other),
+          table.where().less(plain, value).Or().equal(plain, other));
+}
+
+void check_minmax(test_util::unit_test::TestContext& test_context, Table& table, ColKey indexed, ColKey plain,
+                  int64_t)
+{
+    ObjKey k1, k2;
+    CHECK_EQUAL(table.minimum_int(indexed, &k1), table.minimum_int(plain, &k2));
+    CHECK_EQUAL(k1, k2);
+    CHECK_EQUAL(table.maximum_int(indexed, &k1), table.maximum_int(plain, &k2));
+    CHECK_EQUAL(k1, k2);
+}
+
+void check_minmax(test_util::unit_test::TestContext& test_context, Table& table, ColKey indexed, ColKey plain, float)
+{
+    ObjKey k1, k2;
+    CHECK_EQUAL(table.minimum_float(indexed, &k1), table.minimum_float(plain, &k2));
+    CHECK_EQUAL(k1, k2);
+    CHECK_EQUAL(table.maximum_float(indexed, &k1), table.maximum_float(plain, &k2));
+    CHECK_EQUAL(k1, k2);
+}
+
+void check_minmax(test_util::unit_test::TestContext& test_context, Table& table, ColKey indexed, ColKey plain,
+                  double)
+{
+    ObjKey k1, k2;
+    CHECK_EQUAL(table.minimum_double(indexed, &k1), table.minimum_double(plain, &k2));
+    CHECK_EQUAL(k1, k2);
+    CHECK_EQUAL(table.maximum_double(indexed, &k1), table.maximum_double(plain, &k2));
+    CHECK_EQUAL(k1, k2);
+}
+
+void check_minmax(test_util::unit_test::TestContext& test_context, Table& table, ColKey indexed, ColKey plain,
+                  Timestamp)
+{
+    ObjKey k1, k2;
+    CHECK_EQUAL(table.minimum_timestamp(indexed, &k1), table.minimum_timestamp(plain, &k2));
+    CHECK_EQUAL(k1, k2);
+    CHECK_EQUAL(table.maximum_timestamp(indexed, &k1), table.maximum_timestamp(plain, &k2));
+    CHECK_EQUAL(k1, k2);
+}
+
+// Values from a limited range, so that there are many duplicates
+template <class T>
+struct RandomValue;
+
+template <>
+struct RandomValue<int64_t> {
+    static int64_t get(Random& random)
+    {
+        return random.draw_int<int64_t>(-500, 500);
+    }
+};
+
+template <>
+struct RandomValue<float> {
+    static float get(Random& random)
+    {
+        // Both signs of zero
+        if (random.chance(1, 100))
+            return -0.0f;
+        return random.draw_int<int>(-500, 500) / 4.0f;
+    }
+};
+
+template <>
+struct RandomValue<double> {
+    static double get(Random& random)
+    {
+        if (random.chance(1, 100))
+            return -0.0;
+        return random.draw_int<int>(-500, 500) / 4.0;
+    }
+};
+
+template <>
+struct RandomValue<Timestamp> {
+    static Timestamp get(Random& random)
+    {
+        int64_t seconds = random.draw_int<int64_t>(-50, 50);
+        int32_t nanoseconds = random.draw_int<int32_t>(0, 9) * 100000000;
+        if (seconds < 0 || (seconds == 0 && random.chance(1, 2)))
+            nanoseconds = -nanoseconds;
+        return Timestamp(seconds, nanoseconds);
+    }
+};
+
+template <class T>
+void test_random_queries(test_util::unit_test::TestContext& test_context)
+{
+    Random random(random_int<unsigned long>());
+    DataType type = ColumnTypeTraits<T>::id;
+    Table table;
+    auto indexed = table.add_column(type, "indexed", true);
+    auto plain = table.add_column(type, "plain", true);
+    table.add_range_index(indexed);
+
+    auto set = [&](Obj obj) {
+        if (random.chance(1, 20)) {
+            obj.set_null(indexed);
+            obj.set_null(plain);
+        }
+        else {
+            T value = RandomValue<T>::get(random);
+            obj.set(indexed, value);
+            obj.set(plain, value);
+        }
+    };
+
+    for (int i = 0; i < 2000; ++i)
+        set(table.create_object());
+
+    for (int iter = 0; iter < 4; ++iter) {
+        change_randomly(random, table, 300, 200, set);
+        check_minmax(test_context, table, indexed, plain, T());
+        for (int i = 0; i < 20; ++i) {
+            T value = RandomValue<T>::get(random);
+            T other = RandomValue<T>::get(random);
+            check_comparisons(test_context, table, indexed, plain, value, other);
+        }
+    }
+}
+
+} // anonymous namespace
+
+
+TEST(RangeIndex_Table)
+{
+    Table table;
+    auto col = table.add_column(type_Int, "int", true);
+    auto col_str = table.add_column(type_String, "string");
+    auto col_list = table.add_column_list(type_Int, "list");
+
+    CHECK_THROW(table.add_range_index(col_str), LogicError);
+    CHECK_THROW(table.add_range_index(col_list), LogicError);
+
+    for (int64_t i = 0; i < 10; ++i)
+        table.create_object(ObjKey(i)).set(col, 9 - i);
+    table.create_object(ObjKey(10));
+
+    table.add_range_index(col);
+    table.verify();
+
+    // Nulls are not indexed, and the entries are ordered by value
+    RangeIndex* index = table.get_range_index(col);
+    CHECK_EQUAL(index->size(), 10);
+    CHECK_EQUAL(index->get_key(0), ObjKey(9));
+    CHECK_EQUAL(index->get_value(0), Mixed(int64_t(0)));
+    auto range = index->find_range(RangeIndex::Condition::greater, Mixed(int64_t(6)));
+    CHECK_EQUAL(range.first, 7);
+    CHECK_EQUAL(range.second, 10);
+    range = index->find_range(RangeIndex::Condition::less_equal, Mixed(int64_t(6)));
+    CHECK_EQUAL(range.first, 0);
+    CHECK_EQUAL(range.second, 7);
+    range = index->find_range(RangeIndex::Condition::equal, Mixed());
+    CHECK_EQUAL(range.first, range.second);
+
+    CHECK_EQUAL(table.where().greater(col, 6).count(), 3);
+    CHECK_EQUAL(table.where().between(col, 2, 4).count(), 3);
+    CHECK_EQUAL(table.where().equal(col, null()).count(), 1);
+
+    ObjKey key;
+    CHECK_EQUAL(table.minimum_int(col, &key), 0);
+    CHECK_EQUAL(key, ObjKey(9));
+    CHECK_EQUAL(table.maximum_int(col, &key), 9);
+    CHECK_EQUAL(key, ObjKey(0));
+
+    // The minimum and maximum are kept up to date, and ties go to the lowest key
+    table.get_object(ObjKey(5)).set(col, 100);
+    table.get_object(ObjKey(10)).set(col, 100);
+    CHECK_EQUAL(table.maximum_int(col, &key), 100);
+    CHECK_EQUAL(key, ObjKey(5));
+    table.get_object(ObjKey(5)).add_int(col, -200);
+    CHECK_EQUAL(table.minimum_int(col, &key), -100);
+    CHECK_EQUAL(key, ObjKey(5));
+    table.get_object(ObjKey(5)).set_null(col);
+    CHECK_EQUAL(index->size(), 10);
+    table.remove_object(ObjKey(10));
+    CHECK_EQUAL(table.maximum_int(col, &key), 9);
+    CHECK_EQUAL(key, ObjKey(0));
+    table.verify();
+
+    // Range index and search index side by side
+    table.add_search_index(col);
+    CHECK_EQUAL(table.where().equal(col, 3).count(), 1);
+    CHECK_EQUAL(table.where().less(col, 3).count(), 3);
+
+    table.clear();
+    CHECK_EQUAL(index->size(), 0);
+    CHECK_EQUAL(table.minimum_int(col, &key), 0);
+    CHECK_EQUAL(key, ObjKey());
+    table.create_object().set(col, 5);
+
+    // Range and trigram indexes on different columns
+    table.add_trigram_index(col_str);
+    table.begin()->set(col_str, "abcdef");
+    CHECK_EQUAL(table.where().contains(col_str, "bcd").greater(col, 4).count(), 1);
+    table.remove_column(col_str);
+    CHECK_EQUAL(table.where().greater(col, 4).count(), 1);
+    table.verify();
+}
+
+TEST(RangeIndex_FloatOrder)
+{
+    Table table;
+    auto col = table.add_column(type_Double, "double", true);
+    table.add_range_index(col);
+    for (double d : {1.5, -0.0, -1e300, 0.0, -2.5, 1e-300, -1e-300, 2.0})
+        table.create_object().set(col, d);
+    table.create_object().set(col, std::numeric_limits<double>::quiet_NaN());
+    table.create_object();
+    table.verify();
+
+    // NaN and null are left out, and -0.0 equals 0.0
+    RangeIndex* index = table.get_range_index(col);
+    CHECK_EQUAL(index->size(), 8);
+    CHECK_EQUAL(index->get_value(0).get<double>(), -1e300);
+    CHECK_EQUAL(index->get_value(1).get<double>(), -2.5);
+    CHECK_EQUAL(index->get_value(2).get<double>(), -1e-300);
+    CHECK_EQUAL(index->get_value(7).get<double>(), 2.0);
+    CHECK_EQUAL(table.where().equal(col, 0.0).count(), 2);
+    CHECK_EQUAL(table.where().less(col, 0.0).count(), 3);
+    CHECK_EQUAL(table.where().greater_equal(col, -0.0).count(), 5);
+}
+
+TEST_TYPES(RangeIndex_QueryRandom, int64_t, float, double, Timestamp)
+{
+    test_random_queries<TEST_TYPE>(test_context);
+}
+
+#endif // TEST_INDEX_RANGE
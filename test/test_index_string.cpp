@@ -1837,4 +1837,263 @@ TEST(StringIndex_QuerySingleObject)
     CHECK_EQUAL(q.count(), 0);
 }
 
+// An index added to a populated table is built in bulk. It must find the same
+// objects as an index maintained while the objects were created, and accept
+// later changes like one.
+TEST(StringIndex_InsertBulk)
+{
+    Group g;
+    auto t = g.add_table("table");
+    auto col_incremental = t->add_column(type_String, "incremental", true);
+    auto col_bulk = t->add_column(type_String, "bulk", true);
+    t->add_search_index(col_incremental);
+
+    // Values sharing prefixes longer than StringIndex::s_max_offset, with
+    // embedded zeroes and bytes which give negative keys
+    std::string long_prefix(StringIndex::s_max_offset + 10, 'a');
+    std::vector<std::string> chunks = {"", "a", "ab", "abc", "abcd", "abcde", std::string("\0\0", 2), "\xff\xfe",
+                                       "hello", "kitty", "kitten", long_prefix};
+    auto random_value = [&]() {
+        std::string str;
+        size_t n = fastrand(4);
+        for (size_t c = 0; c < n; c++)
+            str += chunks[fastrand(chunks.size() - 1)];
+        if (fastrand(3) == 0)
+            str += util::to_string(fastrand(2000));
+        return str;
+    };
+
+    for (size_t i = 0; i < 3000; i++) {
+        if (fastrand(20) == 0) {
+            t->create_object().set_null(col_incremental).set_null(col_bulk);
+        }
+        else {
+            std::string str = random_value();
+            t->create_object().set(col_incremental, str).set(col_bulk, str);
+        }
+    }
+    t->add_search_index(col_bulk);
+
+    auto check_indexes = [&]() {
+        const StringIndex* incremental = t->get_search_index(col_incremental);
+        const StringIndex* bulk = t->get_search_index(col_bulk);
+        bulk->verify();
+        std::vector<ObjKey> res_incremental;
+        std::vector<ObjKey> res_bulk;
+        for (auto obj : *t) {
+            StringData value = obj.get<String>(col_bulk);
+            res_incremental.clear();
+            res_bulk.clear();
+            incremental->find_all(res_incremental, value);
+            bulk->find_all(res_bulk, value);
+            CHECK(res_bulk == res_incremental);
+            CHECK_EQUAL(bulk->count(value), incremental->count(value));
+            CHECK_EQUAL(bulk->find_first(value), incremental->find_first(value));
+        }
+        CHECK_EQUAL(bulk->count(StringData("not there")), 0);
+    };
+    check_indexes();
+
+    for (size_t i = 0; i < 500; i++) {
+        ObjKey key = t->get_object(fastrand(t->size() - 1)).get_key();
+        switch (fastrand(2)) {
+            case 0: {
+                std::string str = random_value();
+                t->get_object(key).set(col_incremental, str).set(col_bulk, str);
+                break;
+            }
+            case 1:
+                t->remove_object(key);
+                break;
+            case 2: {
+                std::string str = random_value();
+                t->create_object().set(col_incremental, str).set(col_bulk, str);
+                break;
+            }
+        }
+    }
+    check_indexes();
+    t->verify();
+}
+
+TEST(StringIndex_InsertBulk_Types)
+{
+    Group g;
+    auto t = g.add_table("table");
+    auto col_int = t->add_column(type_Int, "int");
+    auto col_int_null = t->add_column(type_Int, "int_null", true);
+    auto col_bool = t->add_column(type_Bool, "bool", true);
+    auto col_date = t->add_column(type_Timestamp, "date", true);
+
+    for (size_t i = 0; i < 600; i++) {
+        auto obj = t->create_object();
+        int64_t v = int64_t(fastrand(300)) - 150;
+        obj.set(col_int, v * 1000003);
+        if (fastrand(10) == 0) {
+            obj.set_null(col_int_null).set_null(col_bool).set_null(col_date);
+        }
+        else {
+            int32_t ns = int32_t(fastrand(2)) * (v < 0 ? -1 : 1);
+            obj.set(col_int_null, v).set(col_bool, v > 0).set(col_date, Timestamp(v, ns));
+        }
+    }
+    for (auto col : {col_int, col_int_null, col_bool, col_date})
+        t->add_search_index(col);
+    t->verify();
+
+    // Compare with a plain scan of the column
+    for (auto col : {col_int, col_int_null, col_bool, col_date}) {
+        StringIndex* index = t->get_search_index(col);
+        index->verify();
+        for (auto obj : *t) {
+            Mixed value = obj.get_any(col);
+            std::vector<ObjKey> expected;
+            for (auto o : *t) {
+                if (o.get_any(col) == value)
+                    expected.push_back(o.get_key());
+            }
+            std::vector<ObjKey> res;
+            if (value.is_null()) {
+                index->find_all(res, null{});
+            }
+            else if (col == col_bool) {
+                index->find_all(res, value.get<bool>());
+            }
+            else if (col == col_date) {
+                index->find_all(res, value.get<Timestamp>());
+            }
+            else {
+                index->find_all(res, value.get<int64_t>());
+            }
+            CHECK(res == expected);
+        }
+    }
+}
+
+TEST(StringIndex_InsertBulk_ConvertColumn)
+{
+    Group g;
+    auto t = g.add_table("table");
+    auto col_short = t->add_column(type_String, "short");
+    auto col_medium = t->add_column(type_String, "medium");
+    auto col_long = t->add_column(type_String, "long");
+    auto col_int = t->add_column(type_Int, "int");
+
+    for (size_t i = 0; i < 600; i++) {
+        auto v = fastrand(50);
+        std::string s = util::to_string(v);
+        std::string medium = "medium length string " + s;
+        std::string big = std::string(70, 'x') + s;
+        t->create_object()
+            .set(col_short, StringData(s))
+            .set(col_medium, StringData(medium))
+            .set(col_long, StringData(big))
+            .set(col_int, int64_t(v));
+    }
+    for (auto col : {col_short, col_medium, col_long, col_int})
+        t->add_search_index(col);
+
+    // Converting the columns rebuilds their indexes from the new leaves
+    std::vector<ColKey> cols;
+    for (auto col : {col_short, col_medium, col_long, col_int}) {
+        ColKey new_col = t->set_nullability(col, true, false);
+        CHECK(t->has_search_index(new_col));
+        cols.push_back(new_col);
+    }
+    t->verify();
+
+    for (auto col : cols) {
+        StringIndex* index = t->get_search_index(col);
+        index->verify();
+        for (auto obj : *t) {
+            Mixed value = obj.get_any(col);
+            std::vector<ObjKey> expected;
+            for (auto o : *t) {
+                if (o.get_any(col) == value)
+                    expected.push_back(o.get_key());
+            }
+            std::vector<ObjKey> res;
+            if (col.get_type() == col_type_Int) {
+                index->find_all(res, value.get<int64_t>());
+            }
+            else {
+                index->find_all(res, value.get<StringData>());
+            }
+            CHECK(res == expected);
+        }
+    }
+}
+
+TEST(StringIndex_FindAllPrefix)
+{
+    Group g;
+    auto t = g.add_table("table");
+    auto col_indexed = t->add_column(type_String, "indexed", true);
+    auto col_plain = t->add_column(type_String, "plain", true);
+
+    // Chunks with the bytes used in the keys for the end of a value, and
+    // prefixes shared beyond StringIndex::s_max_offset
+    std::string long_prefix(StringIndex::s_max_offset + 10, 'a');
+    std::vector<std::string> chunks = {"",      "a",     "ab",     "abc",  "abcd", "X",       "x",
+                                       "abcX",  "Hello", "hELLO",  "kitty", "Kit", "\xff\xfe", long_prefix,
+                                       std::string("\0", 1), std::string("a\0X", 3)};
+    auto random_value = [&]() {
+        std::string str;
+        size_t n = fastrand(4);
+        for (size_t c = 0; c < n; c++)
+            str += chunks[fastrand(chunks.size() - 1)];
+        return str;
+    };
+
+    std::vector<std::string> prefixes = {"a", "X", "x", "abcX", "abcd", "HELLO", "kit", "\xff", long_prefix,
+                                         long_prefix + "X", std::string("\0", 1), std::string("a\0", 2)};
+    for (size_t i = 0; i < 2000; i++) {
+        if (fastrand(20) == 0) {
+            t->create_object().set_null(col_indexed).set_null(col_plain);
+        }
+        else {
+            std::string str = random_value();
+            t->create_object().set(col_indexed, str).set(col_plain, str);
+            if (i % 50 == 0)
+                prefixes.push_back(str.substr(0, fastrand(str.size())));
+        }
+    }
+    t->add_search_index(col_indexed);
+    const StringIndex* index = t->get_search_index(col_indexed);
+
+    for (auto& p : prefixes) {
+        StringData prefix(p);
+        std::vector<ObjKey> expected;
+        std::vector<ObjKey> expected_ins;
+        for (auto obj : *t) {
+            StringData value = obj.get<String>(col_plain);
+            if (!value.is_null() && value.begins_with(prefix))
+                expected.push_back(obj.get_key());
+            if (BeginsWithIns()(prefix, value))
+                expected_ins.push_back(obj.get_key());
+        }
+
+        std::vector<ObjKey> res;
+        CHECK(index->find_all_prefix(prefix, res));
+        CHECK(res == expected);
+        CHECK_EQUAL(t->where().begins_with(col_indexed, prefix).count(), expected.size());
+        TableView tv = t->where().begins_with(col_indexed, prefix).find_all();
+        if (CHECK_EQUAL(tv.size(), expected.size())) {
+            for (size_t i = 0; i < tv.size(); ++i)
+                CHECK_EQUAL(tv.get_key(i), expected[i]);
+        }
+
+        // A prefix which is not valid UTF-8 has no case variants
+        res.clear();
+        if (!case_map(prefix, true)) {
+            CHECK_NOT(index->find_all_prefix(prefix, res, true));
+            CHECK(res.empty());
+            continue;
+        }
+        CHECK(index->find_all_prefix(prefix, res, true));
+        CHECK(res == expected_ins);
+        CHECK_EQUAL(t->where().begins_with(col_indexed, prefix, false).count(), expected_ins.size());
+    }
+}
+
 #endif // TEST_INDEX_STRING
@@ -0,0 +1,203 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_INDEX_TRIGRAM
+
+#include <realm.hpp>
+#include <realm/index_trigram.hpp>
+
+#include "test.hpp"
+#include "test_index_helpers.hpp"
+
+using namespace realm;
+using namespace realm::test_util;
+
+// Test independence and thread-safety
+// -----------------------------------
+//
+// All tests must be thread safe and independent of each other. This
+// is required because it allows for both shuffling of the execution
+// order and for parallelized testing.
+//
+// In particular, avoid using std::rand() since it is not guaranteed
+// to be thread safe. Instead use the API offered in
+// `test/util/random.hpp`.
+//
+// All files created in tests must use the TEST_PATH macro (or one of
+// its friends) to obtain a suitable file system path. See
+// `test/util/test_path.hpp`.
+//
+//
+// Debugging and the ONLY() macro
+// ------------------------------
+//
+// A simple way of disabling all tests except one called `Foo`, is to
+// replace TEST(Foo) with ONLY(Foo) and then recompile and rerun the
+// test suite. Note that you can also use filtering by setting the
+// environment varible `UNITTEST_FILTER`. See `README.md` for more on
+// this.
+//
+// Another way to debug a particular test, is to copy that test into
+// `experiments/testcase.cpp` and then run `sh build.sh
+// check-testcase` (or one of its friends) from the command line.
+
+
+namespace {
+
+std::string random_string(Random& random, size_t max_size)
+{
+    // A small alphabet, in both cases and with a multi byte character, so
+    // that trigrams are shared between many values
+    static const char* const letters[] = {"a", "b", "c", "A", "B", "C", "\xc3\xa6"};
+    std::string s;
+    size_t size = random.draw_int<size_t>(0, max_size);
+    for (size_t i = 0; i < size; ++i)
+        s += letters[random.draw_int<size_t>(0, 6)];
+    return s;
+}
+
+// Every string condition must give the same result on the column with the
+// trigram index as on the plain copy of it
+void check_conditions(test_util::unit_test::TestContext& test_context, Table& table, ColKey indexed, ColKey plain,
+                      StringData needle)
+{
+    for (bool case_sensitive : {true, false}) {
+        auto check = [&](Query q1, Query q2) {
+            check_same_results(test_context, q1, q2);
+        };
+        check(table.where().contains(indexed, needle, case_sensitive),
+              table.where().contains(plain, needle, case_sensitive));
+        check(table.where().begins_with(indexed, needle, case_sensitive),
+              table.where().begins_with(plain, needle, case_sensitive));
+        check(table.where().ends_with(indexed, needle, case_sensitive),
+              table.where().ends_with(plain, needle, case_sensitive));
+        std::string pattern = "*" + std::string(needle) + "?*";
+        check(table.where().like(indexed, pattern, case_sensitive),
+              table.where().like(plain, pattern, case_sensitive));
+        // Combined with another condition
+        check(table.where().contains(indexed, needle, case_sensitive).not_equal(plain, ""),
+              table.where().contains(plain, needle, case_sensitive).not_equal(plain, ""));
+    }
+}
+
+} // anonymous namespace
+
+
+TEST(TrigramIndex_Trigrams)
+{
+    std::vector<TrigramIndex::trigram_type> trigrams;
+    TrigramIndex::get_trigrams("ab", trigrams);
+    CHECK(trigrams.empty());
+
+    // Folded to lower case, sorted and without duplicates
+    TrigramIndex::get_trigrams("AbcabC", trigrams);
+    CHECK_EQUAL(trigrams.size(), 3);
+    CHECK_EQUAL(trigrams[0], 'a' << 16 | 'b' << 8 | 'c');
+    CHECK_EQUAL(trigrams[1], 'b' << 16 | 'c' << 8 | 'a');
+    CHECK_EQUAL(trigrams[2], 'c' << 16 | 'a' << 8 | 'b');
+
+    trigrams.clear();
+    TrigramIndex::get_trigrams("ab\xc3\xa6", trigrams, true);
+    CHECK(trigrams.empty());
+    TrigramIndex::get_trigrams("ab\xc3\xa6", trigrams);
+    CHECK_EQUAL(trigrams.size(), 2);
+}
+
+TEST(TrigramIndex_Table)
+{
+    Table table;
+    auto col = table.add_column(type_String, "name", true);
+    auto col_int = table.add_column(type_Int, "int");
+    auto col_list = table.add_column_list(type_String, "list");
+
+    CHECK_THROW(table.add_trigram_index(col_int), LogicError);
+    CHECK_THROW(table.add_trigram_index(col_list), LogicError);
+
+    table.create_object().set(col, "Hello world");
+    table.create_object().set(col, "hello there");
+    table.create_object().set(col, "goodbye");
+    table.create_object();
+
+    table.add_trigram_index(col);
+    table.verify();
+
+    TrigramIndex* index = table.get_trigram_index(col);
+    CHECK_EQUAL(index->count('e' << 16 | 'l' << 8 | 'l'), 2);
+    CHECK_EQUAL(index->count('o' << 16 | 'o' << 8 | 'd'), 1);
+    CHECK_EQUAL(index->count('x' << 16 | 'y' << 8 | 'z'), 0);
+
+    CHECK_EQUAL(table.where().contains(col, "hello").count(), 1);
+    CHECK_EQUAL(table.where().contains(col, "HELLO", false).count(), 2);
+    CHECK_EQUAL(table.where().contains(col, "lo").count(), 2);
+    CHECK_EQUAL(table.where().like(col, "*o w*").count(), 1);
+    CHECK_EQUAL(table.where().begins_with(col, "good").count(), 1);
+
+    // The trigram counts are kept up to date
+    table.begin()->set(col, "Jello world");
+    CHECK_EQUAL(table.where().contains(col, "hello", false).count(), 1);
+    CHECK_EQUAL(index->count('e' << 16 | 'l' << 8 | 'l'), 2);
+    CHECK_EQUAL(index->count('h' << 16 | 'e' << 8 | 'l'), 1);
+    table.begin()->set_null(col);
+    CHECK_EQUAL(index->count('e' << 16 | 'l' << 8 | 'l'), 1);
+    table.remove_object(table.begin() + 1);
+    CHECK_EQUAL(index->count('e' << 16 | 'l' << 8 | 'l'), 0);
+    CHECK_EQUAL(table.where().contains(col, "hello", false).count(), 0);
+    table.verify();
+
+    // Search index and trigram index side by side
+    table.add_search_index(col);
+    table.create_object().set(col, "goodbye");
+    CHECK_EQUAL(table.where().equal(col, "goodbye").count(), 2);
+    CHECK_EQUAL(table.where().contains(col, "odby").count(), 2);
+    table.verify();
+}
+
+TEST(TrigramIndex_QueryRandom)
+{
+    Random random(random_int<unsigned long>());
+    Table table;
+    auto indexed = table.add_column(type_String, "indexed", true);
+    auto plain = table.add_column(type_String, "plain", true);
+    table.add_trigram_index(indexed);
+
+    auto set = [&](Obj obj) {
+        if (random.chance(1, 10)) {
+            obj.set_null(indexed);
+            obj.set_null(plain);
+        }
+        else {
+            std::string s = random_string(random, 12);
+            obj.set(indexed, s);
+            obj.set(plain, s);
+        }
+    };
+
+    for (int i = 0; i < 500; ++i)
+        set(table.create_object());
+
+    for (int iter = 0; iter < 5; ++iter) {
+        change_randomly(random, table, 200, 100, set);
+        for (int i = 0; i < 20; ++i) {
+            std::string needle = random_string(random, 5);
+            check_conditions(test_context, table, indexed, plain, needle);
+        }
+    }
+}
+
+#endif // TEST_INDEX_TRIGRAM
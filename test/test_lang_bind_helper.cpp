@@ -133,6 +133,128 @@ TEST(Transactions_Frozen)
 }
 
 
+TEST(Transactions_AsyncQuery)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist_w(make_in_realm_history(path));
+    DBRef db = DB::create(*hist_w);
+    ColKey col, col_double;
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("my_table");
+        col = table->add_column(type_Int, "my_col_1");
+        col_double = table->add_column(type_Double, "my_col_2");
+        for (int j = 0; j < 1000; ++j)
+            table->create_object().set_all(j, 1.0 + j * 1e-7);
+        wt->commit();
+    }
+
+    auto rt = db->start_read();
+    auto table = rt->get_table("my_table");
+    Query q = table->where().greater(col, 500);
+    auto request = db->find_all_async(q, rt->get_version_of_current_transaction());
+    const ConstTableView* view = request->get_view();
+    CHECK(request->is_ready());
+    CHECK(request->get_transaction()->is_frozen());
+    if (CHECK(view)) {
+        CHECK(view->is_frozen());
+        CHECK_EQUAL(view->size(), 499);
+        CHECK_EQUAL(view->get_object(0).get<Int>(col), 501);
+    }
+    CHECK_EQUAL(q.count(), 499);
+
+    {
+        auto wt = db->start_write();
+        wt->get_table("my_table")->create_object().set_all(2000);
+        wt->commit();
+    }
+    // The latest version by default, while the first result stays as it was
+    auto latest = db->find_all_async(q);
+    CHECK_EQUAL(latest->get_view()->size(), 500);
+    CHECK_EQUAL(view->size(), 499);
+    latest.reset();
+
+    // Block all the threads in callbacks, so that the next requests stay queued
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool release = false;
+    std::vector<AsyncQueryRef> blockers;
+    for (int j = 0; j < 4; ++j) {
+        Query blocking = table->where().equal(col, j);
+        blockers.push_back(db->find_all_async(blocking, VersionID(), [&](AsyncQuery&) {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&] { return release; });
+        }));
+    }
+
+    // Requests for the same query on the same version share the result
+    Query q2 = table->where().less(col, 10);
+    std::atomic<int> num_callbacks(0);
+    auto count_callback = [&](AsyncQuery& r) {
+        if (r.get_view()->size() == 10)
+            ++num_callbacks;
+    };
+    auto first = db->find_all_async(q2, VersionID(), count_callback);
+    auto second = db->find_all_async(q2, VersionID(), count_callback);
+    auto cancelled_shared = db->find_all_async(q2, VersionID(), count_callback);
+    auto other_version = db->find_all_async(q2, rt->get_version_of_current_transaction());
+    // Values which only differ in the last digits are different queries
+    Query close1 = table->where().greater(col_double, 1.0000001);
+    Query close2 = table->where().greater(col_double, 1.0000002);
+    auto close_request1 = db->find_all_async(close1);
+    auto close_request2 = db->find_all_async(close2);
+    cancelled_shared->cancel();
+    CHECK(cancelled_shared->is_cancelled());
+    CHECK(cancelled_shared->is_ready());
+    CHECK_NOT(cancelled_shared->get_view());
+
+    // A cancelled request which nobody else waits for is not run
+    Query q3 = table->where().equal(col, 7);
+    auto cancelled = db->find_all_async(q3, VersionID(), count_callback);
+    CHECK_NOT(cancelled->is_ready());
+    cancelled->cancel();
+    CHECK_NOT(cancelled->wait());
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        release = true;
+    }
+    cv.notify_all();
+
+    CHECK(first->wait());
+    CHECK_EQUAL(first->get_view(), second->get_view());
+    CHECK_EQUAL(first->get_transaction(), second->get_transaction());
+    CHECK_EQUAL(first->get_view()->size(), 10);
+    CHECK_NOT_EQUAL(first->get_view(), other_version->get_view());
+    CHECK_EQUAL(other_version->get_view()->size(), 10);
+    CHECK_NOT_EQUAL(close_request1->get_view(), close_request2->get_view());
+    CHECK_EQUAL(close_request1->get_view()->size(), close1.count());
+    CHECK_EQUAL(close_request2->get_view()->size(), close2.count());
+    CHECK_NOT_EQUAL(close1.count(), close2.count());
+    for (auto& blocker : blockers)
+        CHECK(blocker->wait());
+    // The callbacks run after the waiters are woken up
+    first.reset();
+    second.reset();
+    for (int j = 0; j < 1000 && num_callbacks < 2; ++j)
+        millisleep(1);
+    CHECK_EQUAL(num_callbacks, 2);
+
+    // The threads release the frozen transactions of the requests they called
+    // back, so wait for them before the file is closed
+    request.reset();
+    other_version.reset();
+    close_request1.reset();
+    close_request2.reset();
+    blockers.clear();
+    cancelled.reset();
+    cancelled_shared.reset();
+    rt.reset();
+    for (int j = 0; j < 1000 && db.use_count() > 1; ++j)
+        millisleep(1);
+    CHECK_EQUAL(db.use_count(), 1);
+}
+
 
 TEST(Transactions_ConcurrentFrozenTableGetByName)
 {
@@ -194,6 +194,40 @@ TEST(Metrics_QueryTypes)
     CHECK_EQUAL(queries->at(16).get_type(), QueryInfo::type_Minimum);
 }
 
+TEST(Metrics_CountDistinct)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    DBOptions options(crypt_key());
+    options.enable_metrics = true;
+    DBRef sg = DB::create(*hist, options);
+    auto wt = sg->start_write();
+    auto table = wt->add_table("table");
+    auto int_col = table->add_column(type_Int, "col_int");
+    auto indexed_col = table->add_column(type_Int, "col_indexed");
+    table->add_search_index(indexed_col);
+    for (int64_t i = 0; i < 10; ++i)
+        table->create_object().set(int_col, i % 3).set(indexed_col, i % 4);
+    wt->commit();
+    auto rt = sg->start_read();
+    table = rt->get_table("table");
+
+    // Each call is reported once, whether or not it is answered by the index
+    DescriptorOrdering ordering;
+    ordering.append_distinct(DistinctDescriptor({{int_col}}));
+    CHECK_EQUAL(table->where().count(ordering), 3);
+    CHECK_EQUAL(table->where().count_distinct(int_col), 3);
+    CHECK_EQUAL(table->where().count_distinct(indexed_col), 4);
+    CHECK_EQUAL(table->where().greater(int_col, 0).count_distinct(indexed_col), 4);
+
+    rt->end_read();
+    std::unique_ptr<Metrics::QueryInfoList> queries = sg->get_metrics()->take_queries();
+    CHECK(queries);
+    CHECK_EQUAL(queries->size(), 4);
+    for (auto& query : *queries)
+        CHECK_EQUAL(query.get_type(), QueryInfo::type_Count);
+}
+
 size_t find_count(std::string haystack, std::string needle)
 {
     size_t find_pos = 0;
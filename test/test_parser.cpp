@@ -55,6 +55,7 @@
 #include <realm.hpp>
 #include <realm/history.hpp>
 #include <realm/parser/parser.hpp>
+#include <realm/parser/prepared_query.hpp>
 #include <realm/parser/query_builder.hpp>
 #include <realm/query_expression.hpp>
 #include <realm/replication.hpp>
@@ -235,6 +236,14 @@ static std::vector<std::string> valid_queries = {
     // backlinks
     "p.@links.class.prop.@count > 2",
     "p.@links.class.prop.@sum.prop2 > 2",
+
+    // list of values
+    "a IN {1, 2, 3}",
+    "a in{1,2}",
+    "a IN { 'x', \"y\", $0, null }",
+    "a IN {}",
+    "a IN { }",
+    "NOT a IN {T1:2, 2020-01-01@10:00:00}",
 };
 
 static std::vector<std::string> invalid_queries = {
@@ -3218,6 +3227,17 @@ TEST(Parser_OperatorIN)
     CHECK_EQUAL(
         message,
         "The keypath preceeding 'IN' must not contain a list, list vs list comparisons are not currently supported");
+
+    // list of values
+    verify_query(test_context, t, "customer_id IN {0, 2, 7}", 2);
+    verify_query(test_context, t, "NOT customer_id IN {0, 2, 7}", 1);
+    verify_query(test_context, t, "customer_id IN {}", 0);
+    verify_query(test_context, items, "name IN {'milk', 'pizza', 'bread'}", 2);
+    verify_query(test_context, items, "name IN[c] {'MILK', 'Pizza'}", 2);  // expanded to equalities
+    verify_query(test_context, items, "price IN {4.0, 6.5}", 2);           // expanded to equalities
+    verify_query(test_context, t, "fav_item.name IN {'milk', 'oranges'}", 2); // through link
+    CHECK_THROW_ANY(verify_query(test_context, t, "customer_id == {0, 1}", 0));
+    CHECK_THROW_ANY(verify_query(test_context, t, "{0, 1} IN customer_id", 0));
 }
 
 
@@ -3397,4 +3417,122 @@ TEST(Parser_TimestampNullable)
 }
 
 
+TEST(Parser_PreparedQuery)
+{
+    Group g;
+    TableRef t = g.add_table("person");
+    ColKey int_col = t->add_column(type_Int, "age");
+    ColKey str_col = t->add_column(type_String, "name");
+    std::vector<std::string> names = {"Billy", "Bob", "Joe", "Jane", "Joel"};
+    for (size_t i = 0; i < names.size(); ++i)
+        t->create_object().set(int_col, int64_t(i)).set(str_col, StringData(names[i]));
+
+    query_builder::AnyContext ctx;
+    auto count = [&](const query_builder::PreparedQuery& prepared, std::vector<util::Any> values) {
+        query_builder::ArgumentConverter<util::Any, query_builder::AnyContext> args(ctx, values.data(),
+                                                                                    values.size());
+        return prepared.bind(t, args).count();
+    };
+
+    query_builder::PreparedQuery prepared("age > $0 && name BEGINSWITH $1");
+    CHECK_EQUAL(prepared.get_num_arguments(), 2);
+    CHECK_EQUAL(count(prepared, {Int(0), StringData("J")}), 3);
+    CHECK_EQUAL(count(prepared, {Int(2), StringData("J")}), 2);
+    CHECK_EQUAL(count(prepared, {Int(0), StringData("B")}), 1);
+    CHECK_THROW_ANY(count(prepared, {Int(0)}));
+    CHECK_EQUAL(query_builder::PreparedQuery("age > 2").get_num_arguments(), 0);
+    CHECK_EQUAL(query_builder::PreparedQuery("age IN {$0, $3}").get_num_arguments(), 4);
+
+    query_builder::PreparedQuery sorted("age < $0 SORT(name DESC) LIMIT(2)");
+    std::vector<util::Any> values = {Int(4)};
+    query_builder::ArgumentConverter<util::Any, query_builder::AnyContext> args(ctx, values.data(), values.size());
+    TableView tv = sorted.bind(t, args).find_all(sorted.bind_ordering(t, args));
+    CHECK_EQUAL(tv.size(), 2);
+    CHECK_EQUAL(tv.get(0).get<String>(str_col), "Joe");
+    CHECK_EQUAL(tv.get(1).get<String>(str_col), "Jane");
+
+    query_builder::QueryCache cache(2);
+    auto first = cache.get("age > $0");
+    CHECK(cache.get("age > $0") == first);
+    CHECK_EQUAL(count(*first, {Int(3)}), 1);
+    cache.get("age < $0");
+    // A string which does not parse is not cached
+    CHECK_THROW_ANY(cache.get("age >"));
+    CHECK_EQUAL(cache.size(), 2);
+    // The least recently used query is evicted
+    cache.get("age == $0");
+    CHECK_EQUAL(cache.size(), 2);
+    CHECK(cache.get("age > $0") != first);
+    cache.clear();
+    CHECK_EQUAL(cache.size(), 0);
+}
+
+
+TEST(Parser_LoweredToNodes)
+{
+    Group g;
+    TableRef items = g.add_table("item");
+    TableRef t = g.add_table("person");
+    ColKey int_col = t->add_column(type_Int, "age", true);
+    ColKey double_col = t->add_column(type_Double, "score", true);
+    ColKey bool_col = t->add_column(type_Bool, "active", true);
+    ColKey date_col = t->add_column(type_Timestamp, "born", true);
+    ColKey str_col = t->add_column(type_String, "name", true);
+    ColKey tag_col = t->add_column(type_String, "tag");
+    ColKey list_col = t->add_column_link(type_LinkList, "items", *items);
+    t->add_search_index(int_col);
+
+    std::vector<ObjKey> item_keys;
+    items->create_objects(3, item_keys);
+    for (int i = 0; i < 10; ++i) {
+        Obj obj = t->create_object();
+        obj.set(tag_col, std::string(size_t(i % 4), 'x'));
+        if (i % 3 == 0)
+            continue;
+        obj.set(int_col, i).set(double_col, i / 2.).set(bool_col, i % 2 == 0).set(date_col, Timestamp(i, 0));
+        obj.set(str_col, std::string(size_t(i % 5), 'a'));
+        auto list = obj.get_linklist(list_col);
+        for (int j = 0; j < i % 4; ++j)
+            list.add(item_keys[size_t(j)]);
+    }
+
+    // Null checks on nullable columns
+    verify_query(test_context, t, "age == NULL", 4);
+    verify_query(test_context, t, "NULL == age", 4);
+    verify_query(test_context, t, "age != NULL", 6);
+    verify_query(test_context, t, "score == NULL", 4);
+    verify_query(test_context, t, "active != NULL", 6);
+    verify_query(test_context, t, "born == NULL", 4);
+    verify_query(test_context, t, "name == NULL", 4);
+    verify_query(test_context, t, "age == NULL || age > 7", 5);
+    verify_query(test_context, t, "NOT age == NULL", 6);
+
+    // Sizes of strings and lists of the queried table
+    verify_query(test_context, t, "tag.@size == 2", 2);
+    verify_query(test_context, t, "tag.@size != 2", 8);
+    verify_query(test_context, t, "tag.@size > 1", 4);
+    verify_query(test_context, t, "1 < tag.@size", 4);
+    verify_query(test_context, t, "2 >= tag.@size", 8);
+    verify_query(test_context, t, "name.@size >= 2", 4);
+    verify_query(test_context, t, "name.@size <= 1", 2);
+    // A null string has no size, but is not equal to any number
+    verify_query(test_context, t, "name.@size != 1", 9);
+    verify_query(test_context, t, "items.@count == 0", 6);
+    verify_query(test_context, t, "items.@count != 0", 4);
+    verify_query(test_context, t, "3 <= items.@count", 1);
+    verify_query(test_context, t, "items.@count > 1 && age != NULL", 2);
+
+    // The same queries built with expressions have the same results
+    auto check = [&](std::string query_string, Query expected) {
+        CHECK_EQUAL(verify_query(test_context, t, query_string, expected.count()).count(), expected.count());
+    };
+    check("age == NULL", t->where().and_query(t->column<Int>(int_col) == realm::null()));
+    check("score != NULL", t->where().and_query(t->column<Double>(double_col) != realm::null()));
+    check("born != NULL", t->where().and_query(t->column<Timestamp>(date_col) != realm::null()));
+    check("name.@size != 2", t->where().and_query(t->column<String>(str_col).size() != 2));
+    check("name.@size < 3", t->where().and_query(t->column<String>(str_col).size() < 3));
+    check("items.@count >= 2", t->where().and_query(t->column<Link>(list_col).count() >= 2));
+}
+
+
 #endif // TEST_PARSER
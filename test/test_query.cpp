@@ -124,6 +124,626 @@ TEST(Query_Count)
     }
 }
 
+TEST(Query_CountIndexed)
+{
+    Table table;
+    auto col_int = table.add_column(type_Int, "int", true);
+    auto col_str = table.add_column(type_String, "str", true);
+    auto col_other = table.add_column(type_Int, "other");
+    table.add_search_index(col_int);
+    table.add_search_index(col_str);
+
+    const char* strings[] = {"foo", "bar", "FOO", "baz", ""};
+    for (int64_t i = 0; i < 2000; ++i) {
+        auto obj = table.create_object().set(col_other, i);
+        if (i % 7)
+            obj.set(col_int, i % 13);
+        if (i % 11)
+            obj.set(col_str, strings[i % 5]);
+    }
+
+    auto expected = [&](Query q) {
+        return q.find_all().size();
+    };
+    for (int64_t v = -1; v < 14; ++v) {
+        size_t n = 0;
+        for (auto& obj : table) {
+            if (obj.get<util::Optional<int64_t>>(col_int) == v)
+                ++n;
+        }
+        Query q = table.where().equal(col_int, v);
+        CHECK_EQUAL(q.count(), n);
+        CHECK_EQUAL(q.count(), expected(q));
+        CHECK_EQUAL(q.count(), table.count_int(col_int, v));
+    }
+    for (const char* s : strings) {
+        Query q = table.where().equal(col_str, s);
+        CHECK_EQUAL(q.count(), expected(q));
+        CHECK_EQUAL(q.count(), table.count_string(col_str, s));
+        Query q_ins = table.where().equal(col_str, s, false);
+        CHECK_EQUAL(q_ins.count(), expected(q_ins));
+    }
+    Query q_null = table.where().equal(col_str, StringData());
+    CHECK_EQUAL(q_null.count(), expected(q_null));
+    CHECK_EQUAL(table.where().equal(col_str, "foo").count(DescriptorOrdering()), table.count_string(col_str, "foo"));
+
+    // More conditions are still evaluated for every object found in the index
+    Query q_and = table.where().equal(col_int, 3).greater(col_other, 1000);
+    CHECK_EQUAL(q_and.count(), expected(q_and));
+    Query q_in = table.where().equal(col_str, "foo").Or().equal(col_str, "bar");
+    CHECK_EQUAL(q_in.count(), expected(q_in));
+
+    // Distinct values, including null
+    CHECK_EQUAL(table.where().count_distinct(col_int), 14);
+    CHECK_EQUAL(table.where().count_distinct(col_str), 6);
+    CHECK_EQUAL(table.where().count_distinct(col_other), 2000);
+    CHECK_EQUAL(table.where().greater(col_other, 1990).count_distinct(col_str), 6);
+    CHECK_EQUAL(table.where().count_distinct(col_str), table.get_distinct_view(col_str).size());
+    DescriptorOrdering ordering;
+    ordering.append_distinct(DistinctDescriptor({{col_int}}));
+    CHECK_EQUAL(table.where().count(ordering), 14);
+    CHECK_EQUAL(table.where().less(col_other, 5).count(ordering), 5);
+
+    Table empty;
+    auto col_empty = empty.add_column(type_String, "str");
+    empty.add_search_index(col_empty);
+    CHECK_EQUAL(empty.where().count_distinct(col_empty), 0);
+}
+
+TEST(Query_GroupBy)
+{
+    Table table;
+    auto col_str = table.add_column(type_String, "str", true);
+    auto col_int = table.add_column(type_Int, "int", true);
+    auto col_double = table.add_column(type_Double, "double");
+    auto col_date = table.add_column(type_Timestamp, "date");
+    auto col_list = table.add_column_list(type_Int, "list");
+
+    const char* strings[] = {"foo", "bar", "", nullptr};
+    for (int i = 0; i < 1000; ++i) {
+        Obj obj = table.create_object();
+        obj.set(col_str, StringData(strings[i % 4]));
+        if (i % 7 != 0)
+            obj.set(col_int, i % 10);
+        obj.set(col_double, i * 0.5);
+        obj.set(col_date, Timestamp(i, 0));
+    }
+
+    auto check = [&](Query q) {
+        auto results = q.group_by(col_str, {GroupByAggregate::sum(col_int), GroupByAggregate::count(),
+                                            GroupByAggregate::maximum(col_double), GroupByAggregate::minimum(col_int),
+                                            GroupByAggregate::average(col_int), GroupByAggregate::minimum(col_date)});
+        TableView tv = q.find_all();
+        tv.distinct(col_str);
+        CHECK_EQUAL(results.size(), tv.size());
+        for (size_t i = 0; i < results.size(); ++i) {
+            auto& result = results[i];
+            if (i > 0)
+                CHECK_LESS(results[i - 1].value.compare(result.value), 0);
+            Query group = q;
+            StringData value = result.value.is_null() ? StringData() : result.value.get_string();
+            group.and_query(table.where().equal(col_str, value));
+            size_t count = group.count();
+            CHECK_EQUAL(result.count, count);
+            CHECK_EQUAL(result.aggregates.size(), 6);
+            CHECK_EQUAL(result.aggregates[0].get_int(), group.sum_int(col_int));
+            CHECK_EQUAL(result.aggregates[1].get_int(), int64_t(count));
+            CHECK_EQUAL(result.aggregates[2].get_double(), group.maximum_double(col_double));
+            CHECK_EQUAL(result.aggregates[3].get_int(), group.minimum_int(col_int));
+            TableView matches = group.find_all();
+            int64_t sum = 0;
+            size_t non_null = 0;
+            for (size_t j = 0; j < matches.size(); ++j) {
+                if (auto v = matches[j].get<util::Optional<int64_t>>(col_int)) {
+                    sum += *v;
+                    ++non_null;
+                }
+            }
+            CHECK_APPROXIMATELY_EQUAL(result.aggregates[4].get_double(), double(sum) / non_null, 1e-9);
+            matches.sort(col_date);
+            CHECK_EQUAL(result.aggregates[5].get_timestamp(), matches[0].get<Timestamp>(col_date));
+        }
+    };
+
+    check(table.where());
+    check(table.where().greater(col_double, 100.));
+    check(table.where().equal(col_int, 3).Or().equal(col_int, 4));
+    TableView view = table.where().less(col_date, Timestamp(500, 0)).find_all();
+    check(table.where(&view).not_equal(col_int, 5));
+
+    // Groups on an int column, where null is a group of its own
+    auto results = table.where().group_by(col_int, {GroupByAggregate::count(), GroupByAggregate::sum(col_double)});
+    CHECK_EQUAL(results.size(), 11);
+    CHECK(results[0].value.is_null());
+    CHECK_EQUAL(results[0].count, 143);
+    CHECK_EQUAL(results[1].value.get_int(), 0);
+    CHECK_EQUAL(results[10].value.get_int(), 9);
+    size_t total = 0;
+    for (auto& result : results)
+        total += result.count;
+    CHECK_EQUAL(total, 1000);
+
+    // Counting the groups of an indexed column reads the search index
+    auto expected = table.where().group_by(col_str, {GroupByAggregate::count()});
+    table.add_search_index(col_str);
+    auto indexed = table.where().group_by(col_str, {GroupByAggregate::count()});
+    if (CHECK_EQUAL(indexed.size(), 4)) {
+        CHECK(indexed[0].value.is_null());
+        CHECK_EQUAL(indexed[1].value.get_string(), "");
+        for (size_t i = 0; i < indexed.size(); ++i) {
+            CHECK_EQUAL(indexed[i].value, expected[i].value);
+            CHECK_EQUAL(indexed[i].count, 250);
+            CHECK_EQUAL(indexed[i].aggregates[0].get_int(), 250);
+        }
+    }
+    check(table.where());
+    check(table.where().equal(col_str, "foo"));
+
+    // A group without values has a null minimum and average, and a zero sum
+    Table t2;
+    auto col_key = t2.add_column(type_Bool, "key");
+    auto col_value = t2.add_column(type_Float, "value", true);
+    t2.create_object().set(col_key, true);
+    t2.create_object().set(col_key, false).set(col_value, 1.5f);
+    t2.create_object().set(col_key, false).set(col_value, 2.5f);
+    results = t2.where().group_by(col_key, {GroupByAggregate::sum(col_value), GroupByAggregate::minimum(col_value),
+                                            GroupByAggregate::average(col_value)});
+    if (CHECK_EQUAL(results.size(), 2)) {
+        CHECK_EQUAL(results[0].value.get_bool(), false);
+        CHECK_EQUAL(results[0].aggregates[0].get_double(), 4.0);
+        CHECK_EQUAL(results[0].aggregates[1].get_float(), 1.5f);
+        CHECK_EQUAL(results[0].aggregates[2].get_double(), 2.0);
+        CHECK_EQUAL(results[1].count, 1);
+        CHECK_EQUAL(results[1].aggregates[0].get_double(), 0.0);
+        CHECK(results[1].aggregates[1].is_null());
+        CHECK(results[1].aggregates[2].is_null());
+    }
+
+    CHECK_THROW(table.where().group_by(col_list, {}), LogicError);
+    CHECK_THROW(table.where().group_by(col_int, {GroupByAggregate::sum(col_str)}), LogicError);
+    CHECK_THROW(table.where().group_by(col_int, {GroupByAggregate::average(col_date)}), LogicError);
+    CHECK_THROW(table.where().group_by(col_int, {GroupByAggregate::maximum(col_list)}), LogicError);
+    CHECK(table.where().equal(col_int, 100).group_by(col_str, {GroupByAggregate::count()}).empty());
+}
+
+TEST(Query_ForEach)
+{
+    Table table;
+    auto col_int = table.add_column(type_Int, "int");
+    auto col_str = table.add_column(type_String, "str");
+    for (int i = 0; i < 3000; ++i)
+        table.create_object(ObjKey(i * 2)).set(col_int, i % 100).set(col_str, i % 3 ? "foo" : "bar");
+
+    auto check = [&](Query q) {
+        TableView tv = q.find_all();
+        size_t n = 0;
+        q.for_each([&](ConstObj& obj) {
+            if (n < tv.size()) {
+                CHECK_EQUAL(obj.get_key(), tv.get_key(n));
+                CHECK_EQUAL(obj.get<Int>(col_int), tv[n].get<Int>(col_int));
+            }
+            ++n;
+            return false;
+        });
+        CHECK_EQUAL(n, tv.size());
+
+        // Stop after the fifth match
+        n = 0;
+        q.for_each([&](ConstObj&) { return ++n == 5; });
+        CHECK_EQUAL(n, std::min(tv.size(), size_t(5)));
+    };
+
+    check(table.where());
+    check(table.where().greater(col_int, 90));
+    check(table.where().equal(col_str, "bar").less(col_int, 10));
+    check(table.where().equal(col_int, 1000));
+    TableView view = table.where().less(col_int, 50).find_all();
+    check(table.where(&view));
+    check(table.where(&view).equal(col_str, "foo"));
+    table.add_search_index(col_int);
+    check(table.where().equal(col_int, 7));
+    check(table.where().equal(col_int, 7).equal(col_str, "foo"));
+}
+
+TEST(Query_OrIndexUnion)
+{
+    Table table;
+    auto col_int = table.add_column(type_Int, "int");
+    auto col_str = table.add_column(type_String, "str", true);
+    auto col_other = table.add_column(type_Int, "other");
+    const char* strings[] = {"a", "b", "c", "d", "e"};
+    for (int i = 0; i < 5000; ++i)
+        table.create_object().set_all(i % 500, strings[i % 5], i % 7);
+
+    auto check = [&](Query q, auto matches) {
+        size_t expected_count = 0;
+        int64_t expected_sum = 0;
+        KeyBitmap expected_keys;
+        for (auto& obj : table) {
+            if (matches(obj)) {
+                ++expected_count;
+                expected_sum += obj.get<Int>(col_other);
+                expected_keys.add(obj.get_key());
+            }
+        }
+        CHECK_EQUAL(q.count(), expected_count);
+        CHECK_EQUAL(q.sum_int(col_other), expected_sum);
+        CHECK(q.find_all_keys() == expected_keys);
+        TableView tv = q.find_all();
+        CHECK(tv.get_key_bitmap() == expected_keys);
+        CHECK_EQUAL(q.find_all(0, size_t(-1), 3).size(), std::min(expected_count, size_t(3)));
+    };
+    auto run = [&] {
+        // Few matches, answered by the union of the index matches
+        check(table.where().equal(col_int, 3).Or().equal(col_int, 42).Or().equal(col_str, "z"),
+              [&](const ConstObj& obj) {
+                  int64_t v = obj.get<Int>(col_int);
+                  return v == 3 || v == 42 || obj.get<String>(col_str) == "z";
+              });
+        check(table.where().equal(col_other, 2).group().equal(col_int, 3).Or().equal(col_int, 10).end_group(),
+              [&](const ConstObj& obj) {
+                  int64_t v = obj.get<Int>(col_int);
+                  return obj.get<Int>(col_other) == 2 && (v == 3 || v == 10);
+              });
+        // A condition with an AND chain is not an index lookup
+        check(table.where().equal(col_int, 3).Or().equal(col_int, 4).equal(col_other, 4),
+              [&](const ConstObj& obj) {
+                  int64_t v = obj.get<Int>(col_int);
+                  return v == 3 || (v == 4 && obj.get<Int>(col_other) == 4);
+              });
+        // Many matches, also taken from the union
+        check(table.where().equal(col_str, "a").Or().equal(col_int, 7), [&](const ConstObj& obj) {
+            return obj.get<String>(col_str) == "a" || obj.get<Int>(col_int) == 7;
+        });
+    };
+
+    run();
+    table.add_search_index(col_int);
+    run();
+    table.add_search_index(col_str);
+    run();
+}
+
+TEST(Query_IndexIntersection)
+{
+    Table table;
+    auto col_int = table.add_column(type_Int, "int");
+    auto col_str = table.add_column(type_String, "str", true);
+    auto col_date = table.add_column(type_Timestamp, "date");
+    auto col_other = table.add_column(type_Int, "other");
+    const char* strings[] = {"a", "b", "c", "d", "e"};
+    for (int i = 0; i < 5000; ++i)
+        table.create_object().set_all(i % 50, strings[i % 5], Timestamp(i % 300, 0), i % 7);
+
+    auto check = [&](Query q, auto matches) {
+        size_t expected_count = 0;
+        int64_t expected_sum = 0;
+        std::vector<ObjKey> expected_keys;
+        for (auto& obj : table) {
+            if (matches(obj)) {
+                ++expected_count;
+                expected_sum += obj.get<Int>(col_other);
+                expected_keys.push_back(obj.get_key());
+            }
+        }
+        CHECK_EQUAL(q.count(), expected_count);
+        CHECK_EQUAL(q.sum_int(col_other), expected_sum);
+        CHECK_EQUAL(q.find(), expected_keys.empty() ? null_key : expected_keys.front());
+        TableView tv = q.find_all();
+        if (CHECK_EQUAL(tv.size(), expected_keys.size())) {
+            for (size_t i = 0; i < tv.size(); ++i)
+                CHECK_EQUAL(tv.get_key(i), expected_keys[i]);
+        }
+        CHECK_EQUAL(q.find_all(0, size_t(-1), 3).size(), std::min(expected_count, size_t(3)));
+    };
+    auto run = [&] {
+        // Every object with int 3 has str "d", and none has str "a"
+        check(table.where().equal(col_int, 3).equal(col_str, "d"), [&](const ConstObj& obj) {
+            return obj.get<Int>(col_int) == 3 && obj.get<String>(col_str) == "d";
+        });
+        check(table.where().equal(col_int, 3).equal(col_str, "a"), [&](const ConstObj& obj) {
+            return obj.get<Int>(col_int) == 3 && obj.get<String>(col_str) == "a";
+        });
+        check(table.where().equal(col_str, "b").greater(col_date, Timestamp(295, 0)).equal(col_int, 41),
+              [&](const ConstObj& obj) {
+                  return obj.get<String>(col_str) == "b" && obj.get<Timestamp>(col_date) > Timestamp(295, 0) &&
+                         obj.get<Int>(col_int) == 41;
+              });
+        // Conditions which are not index lookups are checked on the intersection
+        check(table.where()
+                  .equal(col_str, "b")
+                  .greater(col_other, 3)
+                  .group()
+                  .equal(col_int, 1)
+                  .Or()
+                  .equal(col_int, 11)
+                  .end_group(),
+              [&](const ConstObj& obj) {
+                  int64_t v = obj.get<Int>(col_int);
+                  return obj.get<String>(col_str) == "b" && obj.get<Int>(col_other) > 3 && (v == 1 || v == 11);
+              });
+        check(table.where().less(col_date, Timestamp(2, 0)).begins_with(col_str, "c").equal(col_int, 2),
+              [&](const ConstObj& obj) {
+                  return obj.get<Timestamp>(col_date) < Timestamp(2, 0) &&
+                         obj.get<String>(col_str).begins_with("c") && obj.get<Int>(col_int) == 2;
+              });
+    };
+
+    run();
+    table.add_search_index(col_int);
+    run();
+    table.add_search_index(col_str);
+    run();
+    table.add_range_index(col_date);
+    run();
+}
+
+TEST(Query_LinkConditionsOnTarget)
+{
+    Group g;
+    TableRef cities = g.add_table("city");
+    TableRef customers = g.add_table("customer");
+    TableRef products = g.add_table("product");
+    TableRef orders = g.add_table("order");
+    auto col_city_name = cities->add_column(type_String, "name");
+    auto col_name = customers->add_column(type_String, "name", true);
+    auto col_born = customers->add_column(type_Timestamp, "born");
+    auto col_rank = customers->add_column(type_Int, "rank", true);
+    auto col_city = customers->add_column_link(type_Link, "city", *cities);
+    auto col_price = products->add_column(type_Double, "price");
+    auto col_total = orders->add_column(type_Int, "total");
+    auto col_customer = orders->add_column_link(type_Link, "customer", *customers);
+    auto col_items = orders->add_column_link(type_LinkList, "items", *products);
+
+    std::vector<ObjKey> city_keys, customer_keys, product_keys;
+    cities->create_objects(5, city_keys);
+    for (size_t i = 0; i < city_keys.size(); ++i)
+        cities->get_object(city_keys[i]).set(col_city_name, std::string(1, char('a' + i)));
+    for (int i = 0; i < 50; ++i) {
+        Obj customer = customers->create_object().set(col_born, Timestamp(i, 0)).set(col_city, city_keys[i % 5]);
+        if (i % 10 != 0)
+            customer.set(col_name, "c" + util::to_string(i)).set(col_rank, i % 4);
+        customer_keys.push_back(customer.get_key());
+    }
+    for (int i = 0; i < 100; ++i)
+        product_keys.push_back(products->create_object().set(col_price, i * 1.5).get_key());
+    for (int i = 0; i < 500; ++i) {
+        Obj order = orders->create_object().set(col_total, i % 150);
+        if (i % 7 != 0)
+            order.set(col_customer, customer_keys[(i * 13) % 50]);
+        auto items = order.get_linklist(col_items);
+        for (int j = 0; j < i % 4; ++j)
+            items.add(product_keys[size_t((i + j * 31) % 100)]);
+    }
+
+    auto check = [&](Query q, auto matches) {
+        KeyBitmap expected;
+        for (auto& obj : *q.get_table()) {
+            if (matches(obj))
+                expected.add(obj.get_key());
+        }
+        CHECK(q.find_all_keys() == expected);
+        CHECK_EQUAL(q.count(), expected.size());
+    };
+    auto customer_of = [&](const ConstObj& order) {
+        ObjKey key = order.get<ObjKey>(col_customer);
+        return key ? customers->get_object(key) : ConstObj();
+    };
+    auto any_item = [&](const ConstObj& order, auto matches) {
+        auto items = order.get_linklist(col_items);
+        for (size_t i = 0; i < items.size(); ++i) {
+            if (matches(products->get_object(items.get(i)).template get<double>(col_price)))
+                return true;
+        }
+        return false;
+    };
+    auto customer = orders->link(col_customer);
+
+    auto run = [&] {
+        check(customer.column<String>(col_name) == "c13", [&](const ConstObj& o) {
+            auto c = customer_of(o);
+            return c.is_valid() && c.get<String>(col_name) == "c13";
+        });
+        check(customer.column<String>(col_name).begins_with("c1"), [&](const ConstObj& o) {
+            auto c = customer_of(o);
+            return c.is_valid() && c.get<String>(col_name).begins_with("c1");
+        });
+        check(customer.column<Timestamp>(col_born) > Timestamp(20, 0), [&](const ConstObj& o) {
+            auto c = customer_of(o);
+            return c.is_valid() && c.get<Timestamp>(col_born) > Timestamp(20, 0);
+        });
+        check(customer.column<Int>(col_rank) >= 2, [&](const ConstObj& o) {
+            auto c = customer_of(o);
+            return c.is_valid() && !c.is_null(col_rank) && *c.get<util::Optional<Int>>(col_rank) >= 2;
+        });
+        check(orders->link(col_customer).link(col_city).column<String>(col_city_name) == "c",
+              [&](const ConstObj& o) {
+                  auto c = customer_of(o);
+                  if (!c.is_valid())
+                      return false;
+                  return cities->get_object(c.get<ObjKey>(col_city)).get<String>(col_city_name) == "c";
+              });
+        // A null link gives a null value, which matches these conditions, so they are evaluated through the links
+        check(customer.column<String>(col_name) != "c13", [&](const ConstObj& o) {
+            auto c = customer_of(o);
+            return !c.is_valid() || c.get<String>(col_name) != "c13";
+        });
+        check(customer.column<Int>(col_rank) == realm::null(), [&](const ConstObj& o) {
+            auto c = customer_of(o);
+            return !c.is_valid() || c.is_null(col_rank);
+        });
+        // Any of the objects in a list
+        check(orders->link(col_items).column<double>(col_price) > 120., [&](const ConstObj& o) {
+            return any_item(o, [](double price) { return price > 120.; });
+        });
+        check(orders->link(col_items).column<double>(col_price) == 45., [&](const ConstObj& o) {
+            return any_item(o, [](double price) { return price == 45.; });
+        });
+        // Through the backlinks, where the target table is the larger one
+        check(customers->backlink(*orders, col_customer).column<Int>(col_total) > 140, [&](const ConstObj& c) {
+            for (auto& o : *orders) {
+                if (o.get<ObjKey>(col_customer) == c.get_key() && o.get<Int>(col_total) > 140)
+                    return true;
+            }
+            return false;
+        });
+        // A subquery over the lists is run on the products once
+        check(orders->column<Link>(col_items, products->column<double>(col_price) < 60.).count() >= 2,
+              [&](const ConstObj& o) {
+                  auto items = o.get_linklist(col_items);
+                  size_t n = 0;
+                  for (size_t i = 0; i < items.size(); ++i)
+                      n += products->get_object(items.get(i)).get<double>(col_price) < 60.;
+                  return n >= 2;
+              });
+        // The result stays current when the query is run again
+        Query q = customer.column<String>(col_name) == "c13";
+        size_t before = q.count();
+        Obj order = orders->create_object().set(col_customer, customer_keys[13]);
+        CHECK_EQUAL(q.count(), before + 1);
+        order.remove();
+        CHECK_EQUAL(q.count(), before);
+    };
+
+    run();
+    customers->add_search_index(col_name);
+    customers->add_search_index(col_rank);
+    run();
+}
+
+TEST(Query_LinkConditionsMemoized)
+{
+    // The target table is larger than the origin table, so the conditions are
+    // evaluated through the links, once for each project
+    Group g;
+    TableRef people = g.add_table("person");
+    TableRef projects = g.add_table("project");
+    TableRef tasks = g.add_table("task");
+    auto col_name = people->add_column(type_String, "name");
+    auto col_age = people->add_column(type_Int, "age", true);
+    auto col_owner = projects->add_column_link(type_Link, "owner", *people);
+    auto col_reviewers = projects->add_column_link(type_LinkList, "reviewers", *people);
+    auto col_project = tasks->add_column_link(type_Link, "project", *projects);
+    auto col_related = tasks->add_column_link(type_LinkList, "related", *projects);
+
+    std::vector<ObjKey> person_keys, project_keys;
+    for (int i = 0; i < 1000; ++i) {
+        Obj person = people->create_object().set(col_name, "p" + util::to_string(i));
+        if (i % 9 != 0)
+            person.set(col_age, i % 70);
+        person_keys.push_back(person.get_key());
+    }
+    for (int i = 0; i < 20; ++i) {
+        Obj project = projects->create_object();
+        if (i % 6 != 0)
+            project.set(col_owner, person_keys[size_t(i * 37)]);
+        auto reviewers = project.get_linklist(col_reviewers);
+        for (int j = 0; j < i % 3; ++j)
+            reviewers.add(person_keys[size_t(i * 11 + j * 101)]);
+        project_keys.push_back(project.get_key());
+    }
+    for (int i = 0; i < 200; ++i) {
+        Obj task = tasks->create_object();
+        if (i % 8 != 0)
+            task.set(col_project, project_keys[size_t((i * 7) % 20)]);
+        auto related = task.get_linklist(col_related);
+        for (int j = 0; j < i % 3; ++j)
+            related.add(project_keys[size_t((i + j * 3) % 20)]);
+    }
+
+    auto check = [&](Query q, auto matches) {
+        KeyBitmap expected;
+        for (auto& obj : *q.get_table()) {
+            if (matches(obj))
+                expected.add(obj.get_key());
+        }
+        CHECK(q.find_all_keys() == expected);
+        CHECK_EQUAL(q.count(), expected.size());
+    };
+    auto get_link = [](const ConstObj& obj, ColKey col) {
+        ObjKey key = obj.is_valid() ? obj.get<ObjKey>(col) : ObjKey();
+        return key ? obj.get_table()->get_opposite_table(col)->get_object(key) : ConstObj();
+    };
+    auto age_of = [&](const ConstObj& person) {
+        return person.is_valid() ? person.get<util::Optional<Int>>(col_age) : util::none;
+    };
+    auto any_reviewer = [&](const ConstObj& project, auto matches) {
+        if (!project.is_valid())
+            return false;
+        auto reviewers = project.get_linklist(col_reviewers);
+        for (size_t i = 0; i < reviewers.size(); ++i) {
+            if (matches(people->get_object(reviewers.get(i))))
+                return true;
+        }
+        return false;
+    };
+    auto owner = tasks->link(col_project).link(col_owner);
+
+    auto run = [&] {
+        check(owner.column<Int>(col_age) > 30, [&](const ConstObj& t) {
+            auto age = age_of(get_link(get_link(t, col_project), col_owner));
+            return age && *age > 30;
+        });
+        check(owner.column<String>(col_name) == "p111", [&](const ConstObj& t) {
+            auto person = get_link(get_link(t, col_project), col_owner);
+            return person.is_valid() && person.get<String>(col_name) == "p111";
+        });
+        // A null link at any step gives a null value
+        check(owner.column<Int>(col_age) != 37, [&](const ConstObj& t) {
+            auto age = age_of(get_link(get_link(t, col_project), col_owner));
+            return !age || *age != 37;
+        });
+        check(owner.column<Int>(col_age) == realm::null(), [&](const ConstObj& t) {
+            return !age_of(get_link(get_link(t, col_project), col_owner));
+        });
+        check(tasks->link(col_project).column<Link>(col_owner) == realm::null(), [&](const ConstObj& t) {
+            return !get_link(get_link(t, col_project), col_owner).is_valid();
+        });
+        // Lists at the first and at the last step
+        check(tasks->link(col_project).link(col_reviewers).column<Int>(col_age) < 20, [&](const ConstObj& t) {
+            return any_reviewer(get_link(t, col_project), [&](const ConstObj& p) {
+                auto age = age_of(p);
+                return age && *age < 20;
+            });
+        });
+        check(tasks->link(col_related).link(col_owner).column<String>(col_name).begins_with("p1"),
+              [&](const ConstObj& t) {
+                  auto related = t.get_linklist(col_related);
+                  for (size_t i = 0; i < related.size(); ++i) {
+                      auto person = get_link(projects->get_object(related.get(i)), col_owner);
+                      if (person.is_valid() && person.get<String>(col_name).begins_with("p1"))
+                          return true;
+                  }
+                  return false;
+              });
+        check(tasks->link(col_related).link(col_reviewers).column<Int>(col_age) != 10, [&](const ConstObj& t) {
+            auto related = t.get_linklist(col_related);
+            for (size_t i = 0; i < related.size(); ++i) {
+                if (any_reviewer(projects->get_object(related.get(i)), [&](const ConstObj& p) {
+                        auto age = age_of(p);
+                        return !age || *age != 10;
+                    }))
+                    return true;
+            }
+            return false;
+        });
+        // The results are not kept from one run of the query to the next
+        Query q = owner.column<Int>(col_age) == 65;
+        size_t before = q.count();
+        Obj person = people->get_object(person_keys[37]);
+        auto age = person.get<util::Optional<Int>>(col_age);
+        person.set(col_age, 65);
+        CHECK_EQUAL(q.count(), before + tasks->where().links_to(col_project, project_keys[1]).count());
+        person.set(col_age, age);
+        CHECK_EQUAL(q.count(), before);
+    };
+
+    run();
+    people->add_search_index(col_name);
+    people->add_search_index(col_age);
+    run();
+}
+
 TEST(Query_NextGenSyntaxTypedString)
 {
     Table books;
@@ -1678,6 +2298,62 @@ TEST(Query_size)
     CHECK_EQUAL(6, tv.size());
 }
 
+// The nodes which the query parser uses for null checks and sizes of columns of
+// the queried table must match like the expressions they replace
+TEST(Query_NodesMatchExpressions)
+{
+    Group g;
+    TableRef items = g.add_table("item");
+    TableRef table = g.add_table("person");
+    ColKey int_col = table->add_column(type_Int, "age", true);
+    ColKey bool_col = table->add_column(type_Bool, "active", true);
+    ColKey double_col = table->add_column(type_Double, "score", true);
+    ColKey date_col = table->add_column(type_Timestamp, "born", true);
+    ColKey str_col = table->add_column(type_String, "name", true);
+    ColKey list_col = table->add_column_link(type_LinkList, "items", *items);
+    table->add_search_index(int_col);
+
+    std::vector<ObjKey> item_keys;
+    items->create_objects(3, item_keys);
+    for (int i = 0; i < 10; ++i) {
+        Obj obj = table->create_object();
+        if (i % 3 == 0)
+            continue;
+        obj.set(int_col, i).set(bool_col, i % 2 == 0).set(double_col, i / 2.).set(date_col, Timestamp(i, 0));
+        obj.set(str_col, std::string(size_t(i % 5), 'a'));
+        auto list = obj.get_linklist(list_col);
+        for (int j = 0; j < i % 4; ++j)
+            list.add(item_keys[size_t(j)]);
+    }
+
+    auto check = [&](Query node, Query expression, size_t expected) {
+        CHECK_EQUAL(node.count(), expected);
+        CHECK_EQUAL(expression.count(), expected);
+    };
+    check(table->where().equal(int_col, null()), table->where().and_query(table->column<Int>(int_col) == null()), 4);
+    check(table->where().not_equal(int_col, null()), table->where().and_query(table->column<Int>(int_col) != null()),
+          6);
+    check(table->where().equal(bool_col, null()), table->where().and_query(table->column<Bool>(bool_col) == null()),
+          4);
+    check(table->where().not_equal(double_col, null()),
+          table->where().and_query(table->column<Double>(double_col) != null()), 6);
+    check(table->where().equal(date_col, null()),
+          table->where().and_query(table->column<Timestamp>(date_col) == null()), 4);
+
+    // Null strings never match a size, but an empty list has the size 0
+    auto name_size = table->column<String>(str_col).size();
+    check(table->where().size_equal(str_col, 0), table->where().and_query(name_size == 0), 1);
+    check(table->where().size_greater_equal(str_col, 2), table->where().and_query(name_size >= 2), 4);
+    check(table->where().size_less(str_col, 2), table->where().and_query(name_size < 2), 2);
+    auto count = table->column<Link>(list_col).count();
+    check(table->where().size_equal(list_col, 0), table->where().and_query(count == 0), 6);
+    check(table->where().size_not_equal(list_col, 0), table->where().and_query(count != 0), 4);
+    check(table->where().size_less_equal(list_col, 1), table->where().and_query(count <= 1), 8);
+
+    CHECK_EQUAL(table->where().size_equal(str_col, 2).get_description(), "name.@size == 2");
+    CHECK_EQUAL(table->where().size_greater(list_col, 1).get_description(), "items.@count > 1");
+}
+
 TEST(Query_ListOfPrimitives)
 {
     Group g;
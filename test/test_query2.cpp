@@ -5313,4 +5313,133 @@ TEST(Query_NotImmediatelyBeforeKnownRange)
     CHECK_EQUAL(q.count(), 1);
 }
 
+TEST(Query_ExpressionChunks)
+{
+    // Evaluate expressions over more rows than fit in one chunk and check every row against a plain loop
+    Table table;
+    auto col_int = table.add_column(type_Int, "int", true);
+    auto col_double = table.add_column(type_Double, "double");
+    Random random(random_int<unsigned long>());
+
+    const size_t num_rows = 3000;
+    for (size_t i = 0; i < num_rows; i++) {
+        Obj obj = table.create_object();
+        if (random.draw_int_mod(10) != 0)
+            obj.set(col_int, random.draw_int<int64_t>(-50, 50));
+        obj.set(col_double, double(random.draw_int<int64_t>(-50, 50)));
+    }
+
+    auto expected = [&](auto pred) {
+        size_t cnt = 0;
+        for (auto obj : table) {
+            if (pred(obj))
+                cnt++;
+        }
+        return cnt;
+    };
+
+    Query q1 = table.column<Int>(col_int) + 10 > 25;
+    CHECK_EQUAL(q1.count(), expected([&](ConstObj& o) {
+                    auto v = o.get<util::Optional<Int>>(col_int);
+                    return v && *v + 10 > 25;
+                }));
+    CHECK_EQUAL(q1.find_all().size(), q1.count());
+
+    Query q2 = table.column<Int>(col_int) == table.column<Double>(col_double) * 2;
+    CHECK_EQUAL(q2.count(), expected([&](ConstObj& o) {
+                    auto v = o.get<util::Optional<Int>>(col_int);
+                    return v && double(*v) == o.get<double>(col_double) * 2;
+                }));
+
+    Query q3 = table.column<Int>(col_int) == null();
+    CHECK_EQUAL(q3.count(), expected([&](ConstObj& o) {
+                    return o.is_null(col_int);
+                }));
+
+    // Dense matches make every call resume inside an already evaluated chunk
+    Query q4 = table.column<Double>(col_double) > -1000;
+    CHECK_EQUAL(q4.count(), num_rows);
+
+    // Single object evaluation must not see neighbouring rows
+    for (auto obj : table) {
+        auto v = obj.get<util::Optional<Int>>(col_int);
+        bool match = v && *v + 10 > 25;
+        CHECK_EQUAL(q1.eval_object(obj), match);
+    }
+}
+
+TEST(Query_In)
+{
+    Group g;
+    TableRef target = g.add_table("target");
+    TableRef table = g.add_table("table");
+    auto col_int = table->add_column(type_Int, "int");
+    auto col_int_null = table->add_column(type_Int, "int_null", true);
+    auto col_str = table->add_column(type_String, "str", true);
+    auto col_date = table->add_column(type_Timestamp, "date", true);
+    auto col_link = table->add_column_link(type_Link, "link", *target);
+
+    std::vector<ObjKey> target_keys;
+    target->create_objects(4, target_keys);
+
+    const size_t num_rows = 1000;
+    for (size_t i = 0; i < num_rows; i++) {
+        Obj obj = table->create_object();
+        obj.set(col_int, int64_t(i % 100));
+        if (i % 10)
+            obj.set(col_int_null, int64_t(i % 50));
+        std::string str = util::to_string(i % 20);
+        obj.set(col_str, (i % 7) ? StringData(str) : StringData());
+        obj.set(col_date, Timestamp(int64_t(i % 30), 0));
+        obj.set(col_link, target_keys[i % 4]);
+    }
+
+    auto check = [&](Query q, Query expected) {
+        CHECK_EQUAL(q.count(), expected.count());
+        CHECK_EQUAL(q.find_all().size(), expected.count());
+        CHECK_EQUAL(q.sum_int(col_int), expected.sum_int(col_int));
+    };
+
+    std::vector<Mixed> ints;
+    for (int64_t i = 0; i < 500; i += 3)
+        ints.push_back(Mixed(i));
+
+    auto run_all = [&] {
+        Query expected = table->where().group();
+        for (auto& v : ints)
+            expected.Or().equal(col_int, v.get<int64_t>());
+        expected.end_group();
+        check(table->where().in(col_int, ints), expected);
+        check(table->where().in(col_int, {Mixed(5), Mixed(), Mixed(5)}), table->where().equal(col_int, 5));
+
+        check(table->where().in(col_int_null, {Mixed(1), Mixed(), Mixed(49)}),
+              table->where().equal(col_int_null, 1).Or().equal(col_int_null, null()).Or().equal(col_int_null, 49));
+
+        check(table->where().in(col_str, {Mixed("3"), Mixed(), Mixed("19"), Mixed("nope")}),
+              table->where().equal(col_str, "3").Or().equal(col_str, StringData()).Or().equal(col_str, "19"));
+
+        check(table->where().in(col_date, {Mixed(Timestamp(1, 0)), Mixed(Timestamp(29, 0))}),
+              table->where().equal(col_date, Timestamp(1, 0)).Or().equal(col_date, Timestamp(29, 0)));
+
+        check(table->where().in(col_link, {Mixed(target_keys[0]), Mixed(target_keys[3])}),
+              table->where().links_to(col_link, target_keys[0]).Or().links_to(col_link, target_keys[3]));
+
+        // Combined with other conditions and negated
+        check(table->where().greater(col_int, 50).in(col_str, {Mixed("3"), Mixed("4")}),
+              table->where().greater(col_int, 50).group().equal(col_str, "3").Or().equal(col_str, "4").end_group());
+        check(table->where().Not().in(col_int, {Mixed(1), Mixed(2)}),
+              table->where().not_equal(col_int, 1).not_equal(col_int, 2));
+
+        CHECK_EQUAL(table->where().in(col_int, {}).count(), 0);
+    };
+
+    run_all();
+    table->add_search_index(col_int);
+    table->add_search_index(col_int_null);
+    table->add_search_index(col_str);
+    run_all();
+
+    CHECK_THROW(table->where().in(col_int, {Mixed("text")}), LogicError);
+}
+
 #endif // TEST_QUERY
@@ -446,6 +446,59 @@ TEST(StringData_Substrings)
 }
 
 
+TEST(StringData_SearchSubstring)
+{
+    // Compare against std::search for haystacks that straddle the 16 byte
+    // blocks of the vectorized search, using a small alphabet to get plenty
+    // of partial matches.
+    test_util::Random random(test_util::random_int<unsigned long>());
+    for (int iter = 0; iter < 2000; ++iter) {
+        size_t haystack_size = random.draw_int<size_t>(0, 100);
+        size_t needle_size = random.draw_int<size_t>(1, 40);
+        std::string haystack, needle;
+        for (size_t i = 0; i < haystack_size; ++i)
+            haystack += char('a' + random.draw_int<int>(0, 2));
+        if (needle_size <= haystack_size && random.chance(1, 2)) {
+            size_t pos = random.draw_int<size_t>(0, haystack_size - needle_size);
+            needle = haystack.substr(pos, needle_size);
+        }
+        else {
+            for (size_t i = 0; i < needle_size; ++i)
+                needle += char('a' + random.draw_int<int>(0, 2));
+        }
+
+        size_t expected = std::search(haystack.begin(), haystack.end(), needle.begin(), needle.end()) -
+                          haystack.begin();
+        CHECK_EQUAL(expected, search_substring(haystack.data(), haystack.size(), needle.data(), needle.size()));
+
+        StringData h(haystack), n(needle);
+        CHECK_EQUAL(expected != haystack_size, h.contains(n));
+        CHECK_EQUAL(expected != haystack_size, BinaryData(haystack.data(), haystack.size()).contains(
+                                                   BinaryData(needle.data(), needle.size())));
+
+        // The case insensitive search must find the same position when the
+        // case of the haystack is scrambled.
+        std::string scrambled = haystack;
+        for (char& c : scrambled) {
+            if (random.chance(1, 2))
+                c = char(c - 'a' + 'A');
+        }
+        std::string upper = case_map(n, true, IgnoreErrors);
+        std::string lower = case_map(n, false, IgnoreErrors);
+        CHECK_EQUAL(expected, search_case_fold(StringData(scrambled), upper.c_str(), lower.c_str(), needle_size));
+    }
+
+    // Matches at the very start and end of long strings
+    std::string long_string(1000, 'x');
+    long_string[0] = 'a';
+    long_string[999] = 'b';
+    CHECK_EQUAL(0, search_substring(long_string.data(), long_string.size(), "ax", 2));
+    CHECK_EQUAL(998, search_substring(long_string.data(), long_string.size(), "xb", 2));
+    CHECK_EQUAL(999, search_substring(long_string.data(), long_string.size(), "b", 1));
+    CHECK_EQUAL(1000, search_substring(long_string.data(), long_string.size(), "ba", 2));
+}
+
+
 TEST(StringData_STL_String)
 {
     const char* pre = "hilbert";
@@ -4060,6 +4060,85 @@ TEST(Table_PrimaryKeyString)
     wt->commit();
 }
 
+TEST(Table_PrimaryKeyInt)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBRef sg = DB::create(path);
+    auto wt = sg->start_write();
+    TableRef t0 = wt->add_table_with_primary_key("class_t0", type_Int, "pk", true);
+    auto pk_col = t0->get_primary_key_column();
+    auto val_col = t0->add_column(type_Int, "val");
+
+    // The keys are derived from the primary key values
+    for (int64_t i = 0; i < 100; ++i) {
+        auto obj = t0->create_object_with_primary_key(i * 3).set(val_col, i);
+        CHECK_EQUAL(obj.get_key(), ObjKey(i * 3));
+    }
+
+    // Null and negative values collide with the key of other values
+    const int64_t colliding = 0x3fffffffffffffff;
+    std::vector<Mixed> pks = {Mixed(), Mixed(int64_t(-1)), Mixed(colliding), Mixed(int64_t(-3)),
+                              Mixed(std::numeric_limits<int64_t>::min())};
+    for (auto& pk : pks) {
+        bool did_create = false;
+        t0->create_object_with_primary_key(pk, &did_create).set(val_col, -1);
+        CHECK(did_create);
+    }
+    CHECK_EQUAL(t0->size(), 105);
+    for (auto& pk : pks) {
+        bool did_create = true;
+        auto obj = t0->create_object_with_primary_key(pk, &did_create);
+        CHECK_NOT(did_create);
+        CHECK_EQUAL(obj.get_any(pk_col), pk);
+        CHECK_EQUAL(t0->get_obj_key(GlobalKey{pk}), obj.get_key());
+        if (pk.is_null()) {
+            CHECK_EQUAL(t0->find_first_null(pk_col), obj.get_key());
+        }
+        else {
+            CHECK_EQUAL(t0->find_first_int(pk_col, pk.get_int()), obj.get_key());
+        }
+    }
+    for (int64_t i = 0; i < 300; ++i) {
+        ObjKey k = t0->find_first_int(pk_col, i);
+        if (i % 3 == 0) {
+            CHECK_EQUAL(k, ObjKey(i));
+            CHECK_EQUAL(t0->get_object(k).get<int64_t>(val_col), i / 3);
+        }
+        else {
+            CHECK_NOT(k);
+        }
+        CHECK_EQUAL(t0->get_obj_key(GlobalKey{Mixed(i)}), k);
+    }
+    // A value which is not there, but maps to the key of an object, as it only
+    // differs from `colliding` in the sign bit
+    CHECK_NOT(t0->find_first_int(pk_col, int64_t(uint64_t(colliding) ^ (uint64_t(1) << 63))));
+
+    // Removing one of the colliding objects leaves the others reachable
+    t0->remove_object(t0->find_first_int(pk_col, -1));
+    CHECK_NOT(t0->find_first_int(pk_col, -1));
+    CHECK(t0->find_first_int(pk_col, colliding));
+    CHECK(t0->find_first_null(pk_col));
+    CHECK(t0->find_first_int(pk_col, 0));
+    wt->commit();
+
+    // The table keeps using derived keys after being reopened
+    auto rt = sg->start_write();
+    TableRef t1 = rt->get_table("class_t0");
+    CHECK_EQUAL(t1->create_object_with_primary_key(1000).get_key(), ObjKey(1000));
+    CHECK_EQUAL(t1->find_first_int(pk_col, 1000), ObjKey(1000));
+    t1->verify();
+
+    // A primary key set on an existing column does not change the keys
+    TableRef t2 = rt->add_table("class_t2");
+    auto col = t2->add_column(type_Int, "id");
+    auto k = t2->create_object().set(col, 7).get_key();
+    t2->set_primary_key_column(col);
+    CHECK_EQUAL(t2->find_first_int(col, 7), k);
+    CHECK_EQUAL(t2->create_object_with_primary_key(7).get_key(), k);
+    CHECK_EQUAL(t2->get_obj_key(GlobalKey{Mixed(int64_t(7))}), k);
+    CHECK_NOT(t2->find_first_int(col, 8));
+}
+
 TEST(Table_3)
 {
     Table table;
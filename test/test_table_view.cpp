@@ -19,13 +19,17 @@
 #include "testsettings.hpp"
 #ifdef TEST_TABLE_VIEW
 
+#include <iterator>
 #include <limits>
+#include <set>
 #include <string>
 #include <sstream>
 #include <ostream>
 #include <cwchar>
 
 #include <realm.hpp>
+#include <realm/history.hpp>
+#include <realm/object_change_collector.hpp>
 
 #include "util/misc.hpp"
 
@@ -1581,6 +1585,187 @@ TEST(TableView_DistinctOverNullLink)
     CHECK_EQUAL(tv.get(1).get_linked_object(col_link).get<Int>(col_int), 1);
 }
 
+TEST(TableView_DistinctRandom)
+{
+    Random random(random_int<unsigned long>());
+    Table table;
+    auto col_int = table.add_column(type_Int, "int", true);
+    auto col_str = table.add_column(type_String, "string", true);
+    auto col_double = table.add_column(type_Double, "double");
+    const char* strings[] = {"", "a", "ab", "abc"};
+    for (int i = 0; i < 1000; ++i) {
+        Obj obj = table.create_object();
+        if (!random.chance(1, 10))
+            obj.set(col_int, random.draw_int<int64_t>(0, 20));
+        if (!random.chance(1, 10))
+            obj.set(col_str, strings[random.draw_int<int>(0, 3)]);
+        // Both signs of zero compare equal
+        obj.set(col_double, random.chance(1, 2) ? 0.0 : -0.0);
+    }
+
+    // The expected result keeps the first object of every set of equal values
+    auto check = [&](TableView& tv, const std::vector<ColKey>& cols, TableView& before) {
+        std::vector<ConstObj> expected;
+        for (size_t i = 0; i < before.size(); ++i) {
+            ConstObj obj = before.get(i);
+            bool found = std::any_of(expected.begin(), expected.end(), [&](const ConstObj& other) {
+                return std::all_of(cols.begin(), cols.end(),
+                                   [&](ColKey col) { return obj.get_any(col) == other.get_any(col); });
+            });
+            if (!found)
+                expected.push_back(obj);
+        }
+        if (CHECK_EQUAL(tv.size(), expected.size())) {
+            for (size_t i = 0; i < tv.size(); ++i)
+                CHECK_EQUAL(tv.get_key(i), expected[i].get_key());
+        }
+    };
+
+    for (auto& cols : std::vector<std::vector<ColKey>>{
+             {col_int}, {col_str}, {col_double}, {col_int, col_str}, {col_str, col_int, col_double}}) {
+        std::vector<std::vector<ColKey>> descriptor;
+        for (auto col : cols)
+            descriptor.push_back({col});
+
+        TableView tv = table.where().find_all();
+        TableView before = table.where().find_all();
+        tv.distinct(DistinctDescriptor(descriptor));
+        check(tv, cols, before);
+
+        // A preceding sort decides which object of a set is kept
+        tv = table.where().find_all();
+        tv.sort(SortDescriptor({{col_str}, {col_int}}, {false, true}));
+        before = tv;
+        tv.distinct(DistinctDescriptor(descriptor));
+        check(tv, cols, before);
+    }
+}
+
+TEST(TableView_SortRandom)
+{
+    Random random(random_int<unsigned long>());
+    Group g;
+    TableRef target = g.add_table("target");
+    TableRef origin = g.add_table("origin");
+    auto col_int = target->add_column(type_Int, "int", true);
+    auto col_double = target->add_column(type_Double, "double", true);
+    auto col_float = target->add_column(type_Float, "float");
+    auto col_date = target->add_column(type_Timestamp, "date", true);
+    auto col_bool = target->add_column(type_Bool, "bool", true);
+    auto col_str = target->add_column(type_String, "string", true);
+    auto col_link = origin->add_column_link(type_Link, "link", *target);
+    auto col_origin_int = origin->add_column(type_Int, "int");
+
+    const char* strings[] = {"", "a", "B", "ab", "Ab", "\xc3\xa6", "\xe2\x82\xac"};
+    const double doubles[] = {-2.5, -0.0, 0.0, 1.5, std::numeric_limits<double>::infinity(), std::nan("")};
+    for (int i = 0; i < 3000; ++i) {
+        Obj obj = target->create_object();
+        if (!random.chance(1, 10))
+            obj.set(col_int, random.draw_int<int64_t>(-1000, 1000));
+        if (!random.chance(1, 10))
+            obj.set(col_double, doubles[random.draw_int<int>(0, 5)]);
+        obj.set(col_float, float(random.draw_int<int>(-3, 3)) / 2);
+        if (!random.chance(1, 10)) {
+            int64_t seconds = random.draw_int<int64_t>(-5, 5);
+            int32_t nanoseconds = random.draw_int<int32_t>(0, 2);
+            obj.set(col_date, Timestamp(seconds, seconds < 0 ? -nanoseconds : nanoseconds));
+        }
+        if (!random.chance(1, 10))
+            obj.set(col_bool, random.chance(1, 2));
+        if (!random.chance(1, 10))
+            obj.set(col_str, strings[random.draw_int<int>(0, 6)]);
+    }
+    for (int i = 0; i < 2000; ++i) {
+        Obj obj = origin->create_object();
+        obj.set(col_origin_int, random.draw_int<int64_t>(0, 10));
+        if (!random.chance(1, 10))
+            obj.set(col_link, (target->begin() + random.draw_int<size_t>(0, target->size() - 1))->get_key());
+    }
+
+    // The expected order is the one of a stable sort comparing the first
+    // column like Mixed::compare() does, and strings in the other columns
+    // byte by byte. Null links are at the end when ascending.
+    auto get_value = [](ConstObj obj, const std::vector<ColKey>& chain, Mixed& value) {
+        for (size_t j = 0; j + 1 < chain.size(); ++j) {
+            if (obj.is_null(chain[j]))
+                return false;
+            obj = obj.get_linked_object(chain[j]);
+        }
+        value = obj.get_any(chain.back());
+        return true;
+    };
+    auto check = [&](TableView tv, const std::vector<std::vector<ColKey>>& cols, const std::vector<bool>& ascending) {
+        std::vector<ConstObj> expected;
+        for (size_t i = 0; i < tv.size(); ++i)
+            expected.push_back(tv.get(i));
+        std::stable_sort(expected.begin(), expected.end(), [&](const ConstObj& a, const ConstObj& b) {
+            for (size_t t = 0; t < cols.size(); ++t) {
+                Mixed va, vb;
+                bool has_a = get_value(a, cols[t], va);
+                bool has_b = get_value(b, cols[t], vb);
+                if (!has_a || !has_b) {
+                    if (has_a == has_b)
+                        continue;
+                    return ascending[t] == has_a;
+                }
+                int c = va.compare(vb);
+                if (t > 0 && cols[t].back().get_type() == col_type_String && !va.is_null() && !vb.is_null()) {
+                    StringData sa = va.get<StringData>();
+                    StringData sb = vb.get<StringData>();
+                    c = sa < sb ? -1 : (sb < sa ? 1 : 0);
+                }
+                if (c)
+                    return ascending[t] ? c < 0 : c > 0;
+            }
+            return false;
+        });
+
+        tv.sort(SortDescriptor(cols, ascending));
+        if (CHECK_EQUAL(tv.size(), expected.size())) {
+            for (size_t i = 0; i < tv.size(); ++i)
+                CHECK_EQUAL(tv.get_key(i), expected[i].get_key());
+        }
+    };
+
+    std::vector<std::pair<std::vector<std::vector<ColKey>>, std::vector<bool>>> target_sorts = {
+        {{{col_int}}, {true}},
+        {{{col_int}}, {false}},
+        {{{col_double}}, {true}},
+        {{{col_float}, {col_double}}, {false, true}},
+        {{{col_date}, {col_int}}, {true, false}},
+        {{{col_bool}, {col_str}, {col_int}}, {true, false, true}},
+        {{{col_str}, {col_date}}, {true, true}},
+        {{{col_float}, {col_str}, {col_bool}, {col_date}}, {false, true, false, true}},
+    };
+    for (auto& sort : target_sorts) {
+        // All objects, read cluster by cluster, and a few objects, which are
+        // looked up one at a time
+        check(target->where().find_all(), sort.first, sort.second);
+        check(target->where().equal(col_int, 5).Or().greater(col_int, 990).find_all(), sort.first, sort.second);
+
+        // Sorted by another sort first, which becomes the last column
+        TableView tv = target->where().find_all();
+        tv.sort(col_float, false);
+        check(tv, sort.first, sort.second);
+
+        // After a distinct on floats, which leaves the entries out of order
+        tv = target->where().find_all();
+        tv.distinct(DistinctDescriptor({{col_bool}, {col_float}}));
+        check(tv, sort.first, sort.second);
+    }
+
+    std::vector<std::pair<std::vector<std::vector<ColKey>>, std::vector<bool>>> origin_sorts = {
+        {{{col_link, col_int}}, {true}},
+        {{{col_link, col_str}}, {false}},
+        {{{col_origin_int}, {col_link, col_double}}, {true, false}},
+        {{{col_link, col_bool}, {col_link, col_date}, {col_origin_int}}, {false, true, true}},
+    };
+    for (auto& sort : origin_sorts) {
+        check(origin->where().find_all(), sort.first, sort.second);
+        check(origin->where().equal(col_origin_int, 3).find_all(), sort.first, sort.second);
+    }
+}
+
 TEST(TableView_IsRowAttachedAfterClear)
 {
     Table t;
@@ -2918,4 +3103,415 @@ TEST(TableView_TimestampMaxRemoveRow)
     CHECK_EQUAL(tv.maximum_timestamp(col_date), Timestamp(8, 0));
 }
 
+TEST(TableView_IncrementalSync)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    DBRef db = DB::create(*hist);
+    ColKey col_int;
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("table");
+        col_int = table->add_column(type_Int, "int");
+        for (int i = 0; i < 100; ++i) {
+            table->create_object(ObjKey(i)).set(col_int, i);
+        }
+        wt->commit();
+    }
+
+    auto rt = db->start_read();
+    ConstTableRef table = rt->get_table("table");
+    ConstTableView tv = table->where().greater(col_int, 50).find_all();
+    ConstTableView sorted = table->where().less(col_int, 10).find_all();
+    sorted.sort(col_int, false);
+    CHECK_EQUAL(tv.size(), 49);
+    CHECK_EQUAL(sorted.size(), 10);
+
+    {
+        auto wt = db->start_write();
+        auto t = wt->get_table("table");
+        t->get_object(ObjKey(60)).set(col_int, 0);  // leaves tv, enters sorted
+        t->get_object(ObjKey(5)).set(col_int, 99);  // enters tv, leaves sorted
+        t->get_object(ObjKey(70)).set(col_int, 71); // stays in tv
+        t->remove_object(ObjKey(80));
+        t->create_object(ObjKey(200)).set(col_int, 1000);
+        t->create_object(ObjKey(201)).set(col_int, 3);
+        wt->commit();
+    }
+
+    ObjectChangeCollector changes(*rt);
+    rt->advance_read(&changes);
+    tv.sync_if_needed(changes);
+    sorted.sync_if_needed(changes);
+    CHECK(tv.is_in_sync());
+    CHECK(sorted.is_in_sync());
+
+    auto expected = table->where().greater(col_int, 50).find_all();
+    CHECK_EQUAL(tv.size(), expected.size());
+    for (size_t i = 0; i < tv.size(); ++i) {
+        CHECK_EQUAL(tv.get_key(i), expected.get_key(i));
+    }
+    CHECK_EQUAL(tv.get_key(0), ObjKey(5));
+    CHECK_EQUAL(tv.get_key(tv.size() - 1), ObjKey(200));
+
+    auto expected_sorted = table->where().less(col_int, 10).find_all();
+    expected_sorted.sort(col_int, false);
+    CHECK_EQUAL(sorted.size(), expected_sorted.size());
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        CHECK_EQUAL(sorted.get_key(i), expected_sorted.get_key(i));
+    }
+
+    // A collector which does not cover all changes since the last sync makes
+    // the view fall back to rerunning the query
+    {
+        auto wt = db->start_write();
+        wt->get_table("table")->get_object(ObjKey(0)).set(col_int, 500);
+        wt->commit();
+    }
+    rt->advance_read();
+    ObjectChangeCollector late_changes(*rt);
+    {
+        auto wt = db->start_write();
+        wt->get_table("table")->get_object(ObjKey(1)).set(col_int, 500);
+        wt->commit();
+    }
+    rt->advance_read(&late_changes);
+    tv.sync_if_needed(late_changes);
+    CHECK_EQUAL(tv.size(), expected.size() + 2);
+    CHECK_EQUAL(tv.get_key(0), ObjKey(0));
+    CHECK_EQUAL(tv.get_key(1), ObjKey(1));
+}
+
+TEST(TableView_IncrementalSyncSelfLinks)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    DBRef db = DB::create(*hist);
+    ColKey col_name, col_link;
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("person");
+        col_name = table->add_column(type_String, "name");
+        col_link = table->add_column_link(type_Link, "friend", *table);
+        table->create_object(ObjKey(1)).set(col_name, "b");
+        table->create_object(ObjKey(0)).set(col_name, "a").set(col_link, ObjKey(1));
+        table->create_object(ObjKey(2)).set(col_name, "c").set(col_link, ObjKey(1));
+        wt->commit();
+    }
+
+    auto rt = db->start_read();
+    ConstTableRef table = rt->get_table("person");
+    ConstTableView linked = (table->link(col_link).column<String>(col_name) == "x").find_all();
+    ConstTableView backlinked = (table->backlink(*table, col_link).column<String>(col_name) == "y").find_all();
+    CHECK_EQUAL(linked.size(), 0);
+    CHECK_EQUAL(backlinked.size(), 0);
+
+    // Only the linked object changes, not the objects linking to it
+    {
+        auto wt = db->start_write();
+        auto t = wt->get_table("person");
+        t->get_object(ObjKey(1)).set(col_name, "x");
+        t->get_object(ObjKey(2)).set(col_name, "y");
+        wt->commit();
+    }
+
+    ObjectChangeCollector changes(*rt);
+    rt->advance_read(&changes);
+    linked.sync_if_needed(changes);
+    backlinked.sync_if_needed(changes);
+    CHECK(linked.is_in_sync());
+    CHECK(backlinked.is_in_sync());
+    CHECK_EQUAL(linked.size(), 2);
+    CHECK_EQUAL(linked.get_key(0), ObjKey(0));
+    CHECK_EQUAL(linked.get_key(1), ObjKey(2));
+    CHECK_EQUAL(backlinked.size(), 1);
+    CHECK_EQUAL(backlinked.get_key(0), ObjKey(1));
+}
+
+TEST(TableView_SortThenLimit)
+{
+    Table table;
+    auto col_int = table.add_column(type_Int, "int");
+    auto col_str = table.add_column(type_String, "str");
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    const char* strings[] = {"a", "b", "c", "d", "e", "f", "g"};
+    for (int i = 0; i < 1000; ++i) {
+        int v = random.draw_int_mod(50); // plenty of ties
+        table.create_object().set(col_int, v).set(col_str, strings[random.draw_int_mod(7)]);
+    }
+
+    for (size_t limit : {size_t(0), size_t(1), size_t(20), size_t(999), size_t(1000), size_t(5000)}) {
+        TableView full = table.where().find_all();
+        full.sort(SortDescriptor({{col_int}, {col_str}}, {false, true}));
+
+        DescriptorOrdering ordering;
+        ordering.append_sort(SortDescriptor({{col_int}, {col_str}}, {false, true}));
+        ordering.append_limit(limit);
+        TableView top = table.where().find_all(ordering);
+
+        CHECK_EQUAL(top.size(), std::min(limit, full.size()));
+        CHECK_EQUAL(top.get_num_results_excluded_by_limit(), full.size() - top.size());
+        for (size_t i = 0; i < top.size(); ++i) {
+            CHECK_EQUAL(top.get_key(i), full.get_key(i));
+        }
+    }
+}
+
+TEST(TableView_SortThenLimitFloatNaN)
+{
+    Table table;
+    auto col_int = table.add_column(type_Int, "int");
+    auto col_float = table.add_column(type_Float, "float", true);
+    auto col_double = table.add_column(type_Double, "double", true);
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    for (int i = 0; i < 1000; ++i) {
+        Obj obj = table.create_object().set(col_int, random.draw_int_mod(5)); // plenty of ties
+        // NaN and null compare equal to everything in ConstObj::cmp()
+        switch (random.draw_int_mod(4)) {
+            case 0:
+                obj.set_null(col_float);
+                obj.set_null(col_double);
+                break;
+            case 1:
+                obj.set(col_float, std::numeric_limits<float>::quiet_NaN());
+                obj.set(col_double, std::numeric_limits<double>::quiet_NaN());
+                break;
+            default:
+                obj.set(col_float, float(random.draw_int_mod(20)) / 4);
+                obj.set(col_double, double(random.draw_int_mod(20)) / 4);
+                break;
+        }
+    }
+
+    for (bool ascending : {true, false}) {
+        for (ColKey col : {col_float, col_double}) {
+            SortDescriptor sort({{col_int}, {col}}, {true, ascending});
+            TableView full = table.where().find_all();
+            full.sort(sort);
+
+            for (size_t limit : {size_t(1), size_t(10), size_t(333), size_t(999)}) {
+                DescriptorOrdering ordering;
+                ordering.append_sort(sort);
+                ordering.append_limit(limit);
+                TableView top = table.where().find_all(ordering);
+
+                CHECK_EQUAL(top.size(), limit);
+                for (size_t i = 0; i < top.size(); ++i) {
+                    CHECK_EQUAL(top.get_key(i), full.get_key(i));
+                }
+            }
+        }
+    }
+}
+
+TEST(TableView_KeyBitmap)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    auto make_keys = [&](int64_t dense_begin, int64_t dense_end, size_t num_sparse) {
+        std::set<int64_t> keys;
+        // Dense ranges are held as bitmaps, the others as arrays
+        for (int64_t k = dense_begin; k < dense_end; ++k) {
+            if (random.draw_int_mod(4) != 0)
+                keys.insert(k);
+        }
+        for (size_t i = 0; i < num_sparse; ++i)
+            keys.insert(random.draw_int<int64_t>(-1000000, 10000000));
+        return keys;
+    };
+    auto to_bitmap = [](const std::set<int64_t>& keys) {
+        KeyBitmap bitmap;
+        // Not in ascending order
+        for (auto it = keys.rbegin(); it != keys.rend(); ++it)
+            bitmap.add(ObjKey(*it));
+        return bitmap;
+    };
+    auto check_equal = [&](const KeyBitmap& bitmap, const std::set<int64_t>& keys) {
+        CHECK_EQUAL(bitmap.size(), keys.size());
+        std::vector<ObjKey> expected;
+        for (int64_t k : keys)
+            expected.push_back(ObjKey(k));
+        CHECK(bitmap.to_vector() == expected);
+        // Access by position, as done by a view holding the bitmap
+        size_t mismatches = 0;
+        for (size_t i = 0; i < expected.size(); ++i) {
+            if (bitmap.get(i) != expected[i] || bitmap.find(expected[i]) != i)
+                ++mismatches;
+        }
+        CHECK_EQUAL(mismatches, 0);
+    };
+
+    std::set<int64_t> a = make_keys(0, 100000, 3000);
+    std::set<int64_t> b = make_keys(50000, 200000, 3000);
+    KeyBitmap bitmap_a = to_bitmap(a);
+    KeyBitmap bitmap_b = to_bitmap(b);
+    check_equal(bitmap_a, a);
+    check_equal(bitmap_b, b);
+    CHECK(bitmap_a == KeyBitmap(bitmap_a.to_vector()));
+    CHECK(bitmap_a != bitmap_b);
+    // Far less than the 8 bytes of a key in a view
+    CHECK_LESS(bitmap_a.get_memory_usage(), a.size() * 2);
+
+    std::set<int64_t> expected;
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::inserter(expected, expected.end()));
+    check_equal(bitmap_a | bitmap_b, expected);
+    expected.clear();
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::inserter(expected, expected.end()));
+    check_equal(bitmap_a & bitmap_b, expected);
+    expected.clear();
+    std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::inserter(expected, expected.end()));
+    check_equal(bitmap_a - bitmap_b, expected);
+    check_equal(bitmap_a - bitmap_a, {});
+    CHECK((bitmap_a & KeyBitmap()).empty());
+
+    for (int64_t k : {int64_t(-1000000), int64_t(0), int64_t(65535), int64_t(65536), int64_t(150000)}) {
+        CHECK_EQUAL(bitmap_b.contains(ObjKey(k)), b.count(k) == 1);
+        CHECK_EQUAL(bitmap_b.erase(ObjKey(k)), b.erase(k) == 1);
+        CHECK_NOT(bitmap_b.contains(ObjKey(k)));
+        CHECK_EQUAL(bitmap_b.find(ObjKey(k)), npos);
+    }
+    check_equal(bitmap_b, b);
+    // Erasing most keys of a bitmap block turns it back into an array
+    for (int64_t k = 50000; k < 195000; ++k) {
+        bitmap_b.erase(ObjKey(k));
+        b.erase(k);
+    }
+    check_equal(bitmap_b, b);
+    CHECK(bitmap_b == to_bitmap(b));
+}
+
+TEST(TableView_SetOperations)
+{
+    Table table;
+    auto col = table.add_column(type_Int, "int");
+    for (int i = 0; i < 100; ++i)
+        table.create_object().set(col, i);
+
+    auto check_view = [&](const ConstTableView& tv, Query query) {
+        TableView expected = query.find_all();
+        CHECK(tv.is_in_sync());
+        if (CHECK_EQUAL(tv.size(), expected.size())) {
+            for (size_t i = 0; i < tv.size(); ++i)
+                CHECK_EQUAL(tv.get_key(i), expected.get_key(i));
+        }
+    };
+
+    TableView greater = table.where().greater(col, 60).find_all();
+    TableView less = table.where().less(col, 70).find_all();
+    TableView all = table.where().find_all();
+
+    ConstTableView tv_union = greater.set_union(less);
+    ConstTableView tv_intersection = greater.set_intersection(less);
+    ConstTableView tv_difference = greater.set_difference(less);
+    CHECK_EQUAL(tv_union.size(), 100);
+    CHECK_EQUAL(tv_intersection.size(), 9);
+    CHECK_EQUAL(tv_difference.size(), 30);
+    CHECK(tv_difference.is_in_table_order());
+    check_view(tv_intersection, table.where().greater(col, 60).less(col, 70));
+    check_view(tv_difference, table.where().greater_equal(col, 70));
+    CHECK_EQUAL(tv_difference.find_by_source_ndx(tv_difference.get_key(5)), 5);
+    CHECK_EQUAL(tv_difference.find_by_source_ndx(table.begin()->get_key()), npos);
+    CHECK_EQUAL(tv_difference.sum_int(col), 2535);
+    CHECK_EQUAL(tv_intersection.maximum_int(col), 69);
+    CHECK_EQUAL(greater.set_union(all).size(), 100);
+    CHECK_EQUAL(all.set_intersection(less).size(), 70);
+    CHECK_EQUAL(less.set_difference(all).size(), 0);
+
+    // The results follow the table like the combined queries
+    table.get_object(0).set(col, 65);
+    table.create_object().set(col, 80);
+    table.remove_object(table.begin() + 50);
+    for (auto tv : {&tv_union, &tv_intersection, &tv_difference})
+        tv->sync_if_needed();
+    check_view(tv_union, table.where());
+    check_view(tv_intersection, table.where().greater(col, 60).less(col, 70));
+    check_view(tv_difference, table.where().greater_equal(col, 70));
+
+    // A combined view can be ordered like any other view
+    ConstTableView sorted_union = tv_union;
+    sorted_union.sort(col, false);
+    CHECK_EQUAL(sorted_union.size(), tv_union.size());
+    for (size_t i = 1; i < sorted_union.size(); ++i)
+        CHECK_GREATER_EQUAL(sorted_union.get_object(i - 1).get<Int>(col), sorted_union.get_object(i).get<Int>(col));
+    check_view(tv_union, table.where());
+    ConstTableView distinct_union = tv_union;
+    distinct_union.distinct(col);
+    CHECK_EQUAL(distinct_union.size(), tv_union.size() - 2); // 65 and 80 occur twice
+    table.create_object().set(col, 65);
+    distinct_union.sync_if_needed();
+    tv_union.sync_if_needed();
+    CHECK_EQUAL(distinct_union.size(), tv_union.size() - 3);
+
+    // Views which are not the plain result of a query can not be combined
+    TableView sorted = table.where().find_all();
+    sorted.sort(col);
+    CHECK_LOGIC_ERROR(greater.set_union(sorted), LogicError::illegal_combination);
+    Table other;
+    other.add_column(type_Int, "int");
+    CHECK_LOGIC_ERROR(greater.set_union(other.where().find_all()), LogicError::illegal_combination);
+}
+
+TEST(TableView_SetOperationsSync)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    DBRef db = DB::create(*hist);
+    ColKey col_int;
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("table");
+        col_int = table->add_column(type_Int, "int");
+        for (int i = 0; i < 100; ++i) {
+            table->create_object(ObjKey(i)).set(col_int, i);
+        }
+        wt->commit();
+    }
+
+    auto check_view = [&](const ConstTableView& tv, Query query) {
+        ConstTableView expected = query.find_all();
+        if (CHECK_EQUAL(tv.size(), expected.size())) {
+            for (size_t i = 0; i < tv.size(); ++i)
+                CHECK_EQUAL(tv.get_key(i), expected.get_key(i));
+        }
+    };
+
+    auto rt = db->start_read();
+    ConstTableRef table = rt->get_table("table");
+    ConstTableView greater = table->where().greater(col_int, 60).find_all();
+    ConstTableView less = table->where().less(col_int, 70).find_all();
+    ConstTableView tv = greater.set_difference(less);
+    check_view(tv, table->where().greater_equal(col_int, 70));
+
+    // Handed over with its keys, or filled again by the receiver
+    auto rt2 = db->start_read();
+    ConstTableRef table2 = rt2->get_table("table");
+    auto copied = rt2->import_copy_of(tv, PayloadPolicy::Copy);
+    auto stayed = rt2->import_copy_of(tv, PayloadPolicy::Stay);
+    CHECK(copied->is_in_sync());
+    CHECK_NOT(stayed->is_in_sync());
+    stayed->sync_if_needed();
+    check_view(*copied, table2->where().greater_equal(col_int, 70));
+    check_view(*stayed, table2->where().greater_equal(col_int, 70));
+
+    {
+        auto wt = db->start_write();
+        auto t = wt->get_table("table");
+        t->get_object(ObjKey(10)).set(col_int, 80); // enters tv
+        t->get_object(ObjKey(75)).set(col_int, 5);  // leaves tv
+        t->remove_object(ObjKey(90));
+        t->create_object(ObjKey(200)).set(col_int, 1000);
+        wt->commit();
+    }
+
+    // Patched from the changes, or by running the combined query
+    ObjectChangeCollector changes(*rt);
+    rt->advance_read(&changes);
+    tv.sync_if_needed(changes);
+    CHECK(tv.is_in_sync());
+    check_view(tv, table->where().greater_equal(col_int, 70));
+    CHECK_EQUAL(tv.get_key(0), ObjKey(10));
+    rt2->advance_read();
+    copied->sync_if_needed();
+    check_view(*copied, table2->where().greater_equal(col_int, 70));
+}
+
 #endif // TEST_TABLE_VIEW
@@ -1508,6 +1508,20 @@ TEST_IF(Upgrade_Database_9_10, REALM_MAX_BPNODE_SIZE == 4 || REALM_MAX_BPNODE_SI
         CHECK_EQUAL(obj18.get<String>(col_string), "");
         CHECK_EQUAL(obj18.get<String>(col_string_i), StringData());
 
+        // The search index is rebuilt in bulk by the upgrade
+        for (auto o : *t) {
+            StringData value = o.get<String>(col_string_i);
+            std::vector<ObjKey> expected;
+            for (auto o2 : *t) {
+                if (o2.get<String>(col_string_i) == value)
+                    expected.push_back(o2.get_key());
+            }
+            auto tv = t->where().equal(col_string_i, value).find_all();
+            CHECK_EQUAL(tv.size(), expected.size());
+            for (size_t i = 0; i < tv.size() && i < expected.size(); i++)
+                CHECK_EQUAL(tv.get_key(i), expected[i]);
+        }
+
         auto int_list = obj23.get_list<Int>(col_int_list);
         CHECK(!int_list.is_empty());
         CHECK_EQUAL(int_list.size(), 18);
@@ -1719,6 +1733,49 @@ TEST(Upgrade_FixColumnKeys)
     DB::create(*hist)->start_read()->verify();
 }
 
+TEST(Upgrade_Database_11_12)
+{
+    // Version 12 only adds optional entries to the table top arrays, so a
+    // version 11 file is upgraded by changing the version
+    SHARED_GROUP_TEST_PATH(path);
+    ColKey col;
+    {
+        DBRef db = DB::create(path);
+        auto wt = db->start_write();
+        auto table = wt->add_table("table");
+        col = table->add_column(type_String, "name");
+        table->create_object().set(col, "foo");
+        wt->commit();
+    }
+    {
+        // Must match the file header declared in alloc_slab.hpp
+        struct FileHeader {
+            uint64_t m_top_ref[2];
+            uint8_t m_mnemonic[4];
+            uint8_t m_file_format[2];
+            uint8_t m_reserved;
+            uint8_t m_flags;
+        };
+        File f(path, File::mode_Update);
+        File::Map<FileHeader> map(f, File::access_ReadWrite);
+        FileHeader* header = map.get_addr();
+        CHECK_EQUAL(header->m_file_format[header->m_flags & 1], 12);
+        header->m_file_format[0] = header->m_file_format[1] = 11;
+        map.sync();
+    }
+
+    CHECK_THROW(Group(path), FileFormatUpgradeRequired);
+    bool no_create = true;
+    bool allow_upgrade = false;
+    CHECK_THROW(DB::create(path, no_create, DBOptions(DBOptions::Durability::Full, nullptr, allow_upgrade)),
+                FileFormatUpgradeRequired);
+
+    DBRef db = DB::create(path, no_create);
+    auto rt = db->start_read();
+    CHECK_EQUAL(_impl::GroupFriend::get_file_format_version(*rt), 12);
+    CHECK_EQUAL(rt->get_table("table")->begin()->get<String>(col), "foo");
+}
+
 /*
 TEST(Upgrade_bug)
 {
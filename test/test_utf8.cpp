@@ -267,6 +267,50 @@ TEST(UTF8_Compare_Core_utf8_zero)
     CHECK_EQUAL(false, utf8_compare(StringData("a\0\0", 3), StringData("a\0", 2)));
 }
 
+NONCONCURRENT_TEST(UTF8_SortKey)
+{
+    // Comparing sort keys byte by byte must give the order of utf8_compare()
+    const char* chars[] = {"a", "A", "b", "Z", "0", " ", "~", uae, uAE, ua, uA, u16sur, u16sur2, "\xe2\x82\xac"};
+    Random random(random_int<unsigned long>());
+    auto key_compare = [](const std::string& a, const std::string& b) {
+        // std::string compares chars, which may be signed
+        return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(), [](char x, char y) {
+            return static_cast<unsigned char>(x) < static_cast<unsigned char>(y);
+        });
+    };
+
+    for (auto method : {STRING_COMPARE_CORE, STRING_COMPARE_CORE_SIMILAR}) {
+        set_string_compare_method(method, nullptr);
+        for (int i = 0; i < 1000; ++i) {
+            std::string s1, s2;
+            for (int j = random.draw_int<int>(0, 4); j > 0; --j)
+                s1 += chars[random.draw_int<size_t>(0, 13)];
+            for (int j = random.draw_int<int>(0, 4); j > 0; --j)
+                s2 += chars[random.draw_int<size_t>(0, 13)];
+            if (random.chance(1, 4))
+                s2 = s1 + s2;
+            std::string key1, key2;
+            CHECK(utf8_sort_key(s1, key1));
+            CHECK(utf8_sort_key(s2, key2));
+            CHECK_EQUAL(utf8_compare(s1, s2), key_compare(key1, key2));
+            CHECK_EQUAL(utf8_compare(s2, s1), key_compare(key2, key1));
+        }
+    }
+
+    // Strings with a 0 in them
+    std::string key1, key2;
+    utf8_sort_key(StringData("a\0", 2), key1);
+    utf8_sort_key(StringData("a\0\0", 3), key2);
+    CHECK(key_compare(key1, key2));
+
+    // The callback compare method has no keys
+    set_string_compare_method(STRING_COMPARE_CALLBACK, [](const char*, const char*) { return false; });
+    std::string key = "x";
+    CHECK_NOT(utf8_sort_key("a", key));
+    CHECK_EQUAL(key, "x");
+    set_string_compare_method(STRING_COMPARE_CORE, nullptr);
+}
+
 template <class Int>
 struct IntChar {
     typedef Int int_type;
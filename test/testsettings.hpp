@@ -56,7 +56,13 @@
 #define TEST_FILE_LOCKS
 #define TEST_GROUP
 #define TEST_UPGRADE
+#define TEST_INDEX_COMPOSITE
+#define TEST_INDEX_HASH
+#define TEST_INDEX_LIST
+#define TEST_INDEX_OPTIONAL
+#define TEST_INDEX_RANGE
 #define TEST_INDEX_STRING
+#define TEST_INDEX_TRIGRAM
 #define TEST_LANG_BIND_HELPER
 #define TEST_METRICS
 #define TEST_PARSER